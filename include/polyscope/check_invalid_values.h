@@ -13,10 +13,10 @@
 namespace polyscope {
 
 template <typename T>
-void checkInvalidValues(std::string name, const std::vector<T>& data) {
+void checkInvalidValues(std::string name, const T* data, size_t count) {
   if (options::warnForInvalidValues) {
-    for (const T& val : data) {
-      if (!allComponentsFinite(val)) {
+    for (size_t i = 0; i < count; i++) {
+      if (!allComponentsFinite(data[i])) {
         info("Invalid +-inf or NaN values detected in buffer: " + name);
         break;
       }
@@ -24,4 +24,9 @@ void checkInvalidValues(std::string name, const std::vector<T>& data) {
   }
 }
 
+template <typename T>
+void checkInvalidValues(std::string name, const std::vector<T>& data) {
+  checkInvalidValues(name, data.data(), data.size());
+}
+
 } // namespace polyscope
\ No newline at end of file
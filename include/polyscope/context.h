@@ -62,6 +62,7 @@ struct Context {
   std::vector<std::unique_ptr<SlicePlane>> slicePlanes;
   std::vector<WeakHandle<Widget>> widgets;
   bool doDefaultMouseInteraction = true;
+  uint64_t sceneGeneration = 0; // incremented by requestRedraw(), whenever anything in the scene may have changed
   std::function<void()> userCallback = nullptr;
 
 
@@ -98,6 +99,8 @@ struct Context {
   glm::dualquat flightTargetViewR, flightInitialViewR;
   glm::vec3 flightTargetViewT, flightInitialViewT;
   float flightTargetFov, flightInitialFov;
+  bool haveRenderSubWindow = false;
+  glm::ivec4 renderSubWindow;
 
   // ======================================================
   // === Picking globals from pick.h / pick.cpp
@@ -106,7 +109,16 @@ struct Context {
   PickResult currSelectionPickResult;
   bool haveSelectionVal = false;
   uint64_t nextPickBufferInd = 1;
-  std::unordered_map<Structure*, std::tuple<uint64_t, uint64_t>> structureRanges;
+  std::unordered_map<Structure*, std::tuple<uint64_t, uint64_t>> structureRanges; // [start, end) for each structure
+  std::map<uint64_t, std::tuple<uint64_t, Structure*>> pickRangesByStart;         // start --> (end, structure)
+  std::map<uint64_t, uint64_t> freePickRanges;            // start --> end, released ranges below nextPickBufferInd
+  std::multimap<uint64_t, uint64_t> freePickRangesBySize; // size --> start, the same ranges, to find the best fit
+  bool pickCacheValid = false; // the last rendered window of the pick buffer, read back to the host
+  uint64_t pickCacheSceneGeneration = 0;
+  glm::ivec2 pickCacheBufferSize;
+  glm::ivec4 pickCacheWindow; // (x, y, width, height), from the bottom-left of the buffer
+  std::vector<std::array<float, 4>> pickCacheColors;
+  std::vector<float> pickCacheDepths;
 
   // ======================================================
   // === Internal globals from internal.h
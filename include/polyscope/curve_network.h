@@ -135,6 +135,7 @@ public:
 
   // get data related to picking/selection
   CurveNetworkPickResult interpretPickResult(const PickResult& result);
+  std::vector<CurveNetworkPickResult> interpretPickResult(const RegionPickResult& result); // one per picked element
 
   // === Get/set visualization parameters
 
@@ -198,6 +199,7 @@ private:
   float computeEdgeRadiusMultiplierUniform();
 
   // Pick helpers
+  CurveNetworkPickResult interpretPickIndex(uint64_t localIndex, glm::vec3 position);
   void buildNodePickUI(const CurveNetworkPickResult& result);
   void buildEdgePickUI(const CurveNetworkPickResult& result);
 
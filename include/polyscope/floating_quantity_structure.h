@@ -73,6 +73,11 @@ template <class T>
 ScalarImageQuantity* addScalarImageQuantity(std::string name, size_t dimX, size_t dimY, const T& values,
                                             ImageOrigin imageOrigin, DataType type = DataType::STANDARD);
 
+template <class T>
+ScalarImageQuantity* addScalarImageQuantityQuantized(std::string name, size_t dimX, size_t dimY, const T& storedValues,
+                                                     ScalarQuantization quantization, ImageOrigin imageOrigin,
+                                                     DataType type = DataType::STANDARD);
+
 template <class T>
 ColorImageQuantity* addColorImageQuantity(std::string name, size_t dimX, size_t dimY, const T& values_rgb,
                                           ImageOrigin imageOrigin);
@@ -14,6 +14,14 @@ ScalarImageQuantity* addScalarImageQuantity(std::string name, size_t dimX, size_
   return q->addScalarImageQuantity(name, dimX, dimY, values, imageOrigin, type);
 }
 
+template <class T>
+ScalarImageQuantity* addScalarImageQuantityQuantized(std::string name, size_t dimX, size_t dimY, const T& storedValues,
+                                                     ScalarQuantization quantization, ImageOrigin imageOrigin,
+                                                     DataType type) {
+  FloatingQuantityStructure* q = getGlobalFloatingQuantityStructure();
+  return q->addScalarImageQuantityQuantized(name, dimX, dimY, storedValues, quantization, imageOrigin, type);
+}
+
 template <class T>
 ColorImageQuantity* addColorImageQuantity(std::string name, size_t dimX, size_t dimY, const T& values_rgb,
                                           ImageOrigin imageOrigin) {
@@ -0,0 +1,84 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace polyscope {
+
+// A summary of the minimum and maximum value within each brick of a grid, used to skip the parts of the grid which
+// cannot matter for some query (for instance, bricks which an isosurface does not pass through).
+//
+// Bricks are blocks of brickSize^3 cells, with the bricks at the end of each axis possibly smaller. For values on
+// nodes, each brick covers all of the nodes of its cells, so neighboring bricks share a layer of nodes. For values on
+// cells, each brick covers just its own cells.
+class GridBrickRanges {
+
+public:
+  static const uint32_t brickSize = 32;
+
+  // Summarize every brick. The values are indexed with x fastest, as in VolumeGrid::flattenNodeIndex(), and there
+  // are valueDim of them along each axis.
+  void build(const std::vector<float>& values, glm::uvec3 valueDim, bool valuesOnNodes);
+
+  // Re-summarize only the bricks which hold a value in one of the given [start, end) ranges of flat indices. The
+  // values must have the same dimensions as when the table was built.
+  void update(const std::vector<float>& values, const std::vector<std::array<size_t, 2>>& changedRanges);
+
+  // Summarize every brick, like build(), from values which are read a slab of z layers at a time with
+  // `readValues(start, count, out)`, so that they never all need to be in memory. Each slab holds about
+  // maxSlabValues values (but at least one layer).
+  void buildFromSlabs(glm::uvec3 valueDim, bool valuesOnNodes, size_t maxSlabValues,
+                      const std::function<void(size_t, size_t, float*)>& readValues);
+
+  // Summarize bricks which are not laid out as one dense grid, such as the occupied bricks of a SparseVolumeGrid.
+  // `readBrick(iBrick, out)` fills `out` with the values of a brick. Such a table only holds the range of each brick:
+  // the bricks are numbered along x, and update() and brickCellRange() do not apply to it.
+  void buildFromBricks(size_t nBricks, const std::function<void(size_t, std::vector<float>&)>& readBrick);
+
+  // A table for just the cells [cellZStart, cellZEnd) along z, as if they were a grid of their own (for instance, a slab
+  // read from this grid). Its bricks need not line up with the bricks of this table, so each one gets the combined
+  // range of the bricks it overlaps, which bounds its values.
+  GridBrickRanges sliceZ(uint32_t cellZStart, uint32_t cellZEnd) const;
+
+  bool isBuilt() const;
+  glm::uvec3 getBrickDim() const;
+  size_t nBricks() const;
+  glm::uvec3 brickCoords(size_t iBrick) const;
+  size_t brickIndex(glm::uvec3 brick) const;
+
+  // The cells [cellStart, cellEnd) covered by a brick
+  void brickCellRange(size_t iBrick, glm::uvec3& cellStart, glm::uvec3& cellEnd) const;
+
+  // The range of values in a brick. A brick holding any NaN value gets the range [-inf, inf], so that it is never
+  // skipped.
+  float getBrickMin(size_t iBrick) const;
+  float getBrickMax(size_t iBrick) const;
+
+  // True if the brick holds both a value less than `level` and one greater or equal to it, so that the level set
+  // might pass through it
+  bool brickStraddles(size_t iBrick, float level) const;
+
+  // True if the brick holds any value in [low, high]
+  bool brickOverlaps(size_t iBrick, float low, float high) const;
+
+private:
+  bool built = false;
+  glm::uvec3 valueDim{0, 0, 0};
+  glm::uvec3 cellDim{0, 0, 0};
+  glm::uvec3 brickDim{0, 0, 0};
+  bool valuesOnNodes = true;
+  std::vector<float> brickMin;
+  std::vector<float> brickMax;
+
+  void setLayout(glm::uvec3 valueDim, bool valuesOnNodes);
+  void summarizeBrick(const std::vector<float>& values, size_t iBrick);
+};
+
+} // namespace polyscope
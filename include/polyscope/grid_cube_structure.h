@@ -0,0 +1,67 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#pragma once
+
+#include "polyscope/persistent_value.h"
+#include "polyscope/render/managed_buffer.h"
+#include "polyscope/structure.h"
+
+#include <cstdint>
+#include <string>
+
+namespace polyscope {
+
+// The parts shared by the structures which draw a grid of little cubes (VolumeGrid and SparseVolumeGrid): the
+// appearance options, their UI, and the reference planes which the cubes are drawn from. S is the structure type.
+template <typename S>
+class GridCubeStructure : public QuantityStructure<S> {
+public:
+  GridCubeStructure(std::string name, std::string subtypeName);
+
+  virtual void buildCustomOptionsUI() override;
+
+  // === Getters and setters for visualization settings
+
+  // Color of the grid volume
+  S* setColor(glm::vec3 val);
+  glm::vec3 getColor();
+
+  // Color of edges
+  S* setEdgeColor(glm::vec3 val);
+  glm::vec3 getEdgeColor();
+
+  // Material
+  S* setMaterial(std::string name);
+  std::string getMaterial();
+
+  // Width of the edges. Scaled such that 1 is a reasonable weight for visible edges, but values  1 can be used for
+  // bigger edges. Use 0. to disable.
+  S* setEdgeWidth(double newVal);
+  double getEdgeWidth();
+
+  // Scaling factor for the size of the little cubes
+  S* setCubeSizeFactor(double newVal);
+  double getCubeSizeFactor();
+
+protected:
+  // === Visualization parameters
+  PersistentValue<glm::vec3> color;
+  PersistentValue<glm::vec3> edgeColor;
+  PersistentValue<std::string> material;
+  PersistentValue<float> edgeWidth;
+  PersistentValue<float> cubeSizeFactor;
+
+  // The color and edge options, for the structure's buildCustomUI()
+  void buildColorAndEdgeUI();
+
+  // Fill the buffers with the planes between the cells of a reference [0,1]^3 cube which has cellDim cells along each
+  // axis, outermost planes first.
+  void fillGridPlaneReferenceGeometry(glm::uvec3 cellDim, render::ManagedBuffer<glm::vec3>& positions,
+                                      render::ManagedBuffer<glm::vec3>& normals,
+                                      render::ManagedBuffer<int32_t>& axisInds);
+
+private:
+  S* derived() { return static_cast<S*>(this); }
+};
+
+} // namespace polyscope
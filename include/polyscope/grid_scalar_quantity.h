@@ -0,0 +1,88 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#pragma once
+
+#include "polyscope/color_management.h"
+#include "polyscope/marching_cubes.h"
+#include "polyscope/persistent_value.h"
+#include "polyscope/polyscope.h"
+#include "polyscope/render/engine.h"
+#include "polyscope/surface_mesh.h"
+#include "polyscope/view.h"
+
+namespace polyscope {
+
+// Encapsulates logic which is common to the scalar quantities on dense and sparse volume grids. The QuantityT must also
+// be a ScalarQuantity<QuantityT>.
+
+template <typename QuantityT>
+class GridScalarQuantity {
+public:
+  GridScalarQuantity(QuantityT& quantity);
+
+  // Build the ImGUI UI, with menus to pick the visualizations and set the scalar options
+  void buildGridScalarUI();
+
+  // === Members
+  QuantityT& quantity;
+
+  // === Get/set visualization parameters
+
+  // Gridcube viz
+  QuantityT* setGridcubeVizEnabled(bool val);
+  bool getGridcubeVizEnabled();
+
+protected:
+  // More visualizations add to the UI of buildGridScalarUI() here
+  virtual void buildVizModeUI() {}    // called inside of the mode menu
+  virtual void buildVizOptionsUI() {} // called inside of the options menu
+  virtual void buildVizUI() {}
+
+  // Visualize as a grid of cubes
+  PersistentValue<bool> gridcubeVizEnabled;
+};
+
+// Node scalars can also be visualized as an isosurface. The QuantityT must provide getIsosurfaceMesh(), which extracts
+// the level set at the isosurface level.
+
+template <typename QuantityT>
+class GridIsosurfaceQuantity : public GridScalarQuantity<QuantityT> {
+public:
+  GridIsosurfaceQuantity(QuantityT& quantity);
+
+  // Draw the isosurface, if it is enabled
+  void drawIsosurface();
+
+  SurfaceMesh* registerIsosurfaceAsMesh(std::string structureName = "");
+
+  // === Get/set visualization parameters
+
+  QuantityT* setIsosurfaceVizEnabled(bool val);
+  bool getIsosurfaceVizEnabled();
+
+  QuantityT* setIsosurfaceLevel(float value);
+  float getIsosurfaceLevel();
+
+  QuantityT* setIsosurfaceColor(glm::vec3 val);
+  glm::vec3 getIsosurfaceColor();
+
+  QuantityT* setSlicePlanesAffectIsosurface(bool val);
+  bool getSlicePlanesAffectIsosurface();
+
+protected:
+  virtual void buildVizModeUI() override;
+  virtual void buildVizOptionsUI() override;
+  virtual void buildVizUI() override;
+
+  // Visualize as isosurface
+  PersistentValue<bool> isosurfaceVizEnabled;
+  PersistentValue<float> isosurfaceLevel;
+  PersistentValue<glm::vec3> isosurfaceColor;
+  PersistentValue<bool> slicePlanesAffectIsosurface;
+  std::shared_ptr<render::ShaderProgram> isosurfaceProgram;
+  void createIsosurfaceProgram();
+};
+
+} // namespace polyscope
+
+#include "polyscope/grid_scalar_quantity.ipp"
@@ -0,0 +1,234 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+namespace polyscope {
+
+// ========================================================
+// ==========          Grid Scalar               ==========
+// ========================================================
+
+template <typename QuantityT>
+GridScalarQuantity<QuantityT>::GridScalarQuantity(QuantityT& quantity_)
+    : quantity(quantity_), gridcubeVizEnabled(quantity.uniquePrefix() + "gridcubeVizEnabled", true) {}
+
+template <typename QuantityT>
+void GridScalarQuantity<QuantityT>::buildGridScalarUI() {
+
+  // Select which viz to use
+  ImGui::SameLine();
+  if (ImGui::Button("Mode")) {
+    ImGui::OpenPopup("ModePopup");
+  }
+  if (ImGui::BeginPopup("ModePopup")) {
+    if (ImGui::MenuItem("Gridcube", NULL, &gridcubeVizEnabled.get())) setGridcubeVizEnabled(getGridcubeVizEnabled());
+    buildVizModeUI();
+    ImGui::EndPopup();
+  }
+
+
+  // == Options popup
+  ImGui::SameLine();
+  if (ImGui::Button("Options")) {
+    ImGui::OpenPopup("OptionsPopup");
+  }
+  if (ImGui::BeginPopup("OptionsPopup")) {
+    quantity.buildScalarOptionsUI();
+    buildVizOptionsUI();
+    ImGui::EndPopup();
+  }
+
+  if (gridcubeVizEnabled.get()) {
+    quantity.buildScalarUI();
+  }
+
+  buildVizUI();
+}
+
+template <typename QuantityT>
+QuantityT* GridScalarQuantity<QuantityT>::setGridcubeVizEnabled(bool val) {
+  gridcubeVizEnabled = val;
+  requestRedraw();
+  return &quantity;
+}
+
+template <typename QuantityT>
+bool GridScalarQuantity<QuantityT>::getGridcubeVizEnabled() {
+  return gridcubeVizEnabled.get();
+}
+
+// ========================================================
+// ==========          Grid Isosurface           ==========
+// ========================================================
+
+template <typename QuantityT>
+GridIsosurfaceQuantity<QuantityT>::GridIsosurfaceQuantity(QuantityT& quantity_)
+    : GridScalarQuantity<QuantityT>(quantity_),
+      isosurfaceVizEnabled(quantity_.uniquePrefix() + "isosurfaceVizEnabled", false),
+      isosurfaceLevel(quantity_.uniquePrefix() + "isosurfaceLevel", 0.f),
+      isosurfaceColor(quantity_.uniquePrefix() + "isosurfaceColor", getNextUniqueColor()),
+      slicePlanesAffectIsosurface(quantity_.uniquePrefix() + "slicePlanesAffectIsosurface", false) {}
+
+template <typename QuantityT>
+void GridIsosurfaceQuantity<QuantityT>::buildVizModeUI() {
+  if (ImGui::MenuItem("Isosurface", NULL, &isosurfaceVizEnabled.get()))
+    setIsosurfaceVizEnabled(getIsosurfaceVizEnabled());
+}
+
+template <typename QuantityT>
+void GridIsosurfaceQuantity<QuantityT>::buildVizOptionsUI() {
+  if (ImGui::MenuItem("Slice plane affects isosurface", NULL, &slicePlanesAffectIsosurface.get()))
+    setSlicePlanesAffectIsosurface(getSlicePlanesAffectIsosurface());
+
+  if (ImGui::MenuItem("Register isosurface as mesh")) registerIsosurfaceAsMesh();
+}
+
+template <typename QuantityT>
+void GridIsosurfaceQuantity<QuantityT>::buildVizUI() {
+  if (!isosurfaceVizEnabled.get()) return;
+
+  ImGui::TextUnformatted("Isosurface:");
+  // Color picker
+  if (ImGui::ColorEdit3("##Color", &isosurfaceColor.get()[0], ImGuiColorEditFlags_NoInputs)) {
+    setIsosurfaceColor(getIsosurfaceColor());
+  }
+  ImGui::SameLine();
+
+  // Set isovalue
+  std::pair<double, double> mapRange = this->quantity.getMapRange();
+  ImGui::PushItemWidth(120 * options::uiScale);
+  if (ImGui::SliderFloat("##Radius", &isosurfaceLevel.get(), static_cast<float>(mapRange.first),
+                         static_cast<float>(mapRange.second), "%.4e")) {
+    // Note: we intentionally do this rather than calling setIsosurfaceLevel(), because that function immediately
+    // recomputes the levelset mesh, which is too expensive during user interaction
+    isosurfaceLevel.manuallyChanged();
+  }
+  ImGui::PopItemWidth();
+  ImGui::SameLine();
+  if (ImGui::Button("Refresh")) {
+    this->quantity.refresh();
+  }
+}
+
+template <typename QuantityT>
+void GridIsosurfaceQuantity<QuantityT>::drawIsosurface() {
+  if (!isosurfaceVizEnabled.get()) return;
+
+  if (isosurfaceProgram == nullptr) {
+    createIsosurfaceProgram();
+  }
+  auto& parent = this->quantity.parent;
+  parent.setStructureUniforms(*isosurfaceProgram);
+  render::engine->setMaterialUniforms(*isosurfaceProgram, parent.getMaterial());
+  isosurfaceProgram->setUniform("u_baseColor", getIsosurfaceColor());
+
+  glm::mat4 P = view::getCameraPerspectiveMatrix();
+  glm::mat4 Pinv = glm::inverse(P);
+  isosurfaceProgram->setUniform("u_invProjMatrix", glm::value_ptr(Pinv));
+  isosurfaceProgram->setUniform("u_viewport", render::engine->getCurrentViewport());
+
+  render::engine->setBackfaceCull(false);
+  isosurfaceProgram->draw();
+}
+
+template <typename QuantityT>
+void GridIsosurfaceQuantity<QuantityT>::createIsosurfaceProgram() {
+
+  // Extract the isosurface from the level set of the scalar field
+  const IsosurfaceMesh& isosurfaceMesh = this->quantity.getIsosurfaceMesh();
+  auto& parent = this->quantity.parent;
+
+  std::vector<std::string> isoProgramRules{"SHADE_BASECOLOR", "PROJ_AND_INV_PROJ_MAT",
+                                           "COMPUTE_SHADE_NORMAL_FROM_POSITION"};
+  if (getSlicePlanesAffectIsosurface() && render::engine->slicePlanesEnabled()) {
+    isoProgramRules.push_back("GENERATE_VIEW_POS");
+    isoProgramRules.push_back("CULL_POS_FROM_VIEW");
+  }
+
+  // Create a render program to draw it
+  // clang-format off
+  isosurfaceProgram = render::engine->requestShader("SIMPLE_MESH",
+      render::engine->addMaterialRules(parent.getMaterial(),
+        parent.addStructureRules(
+          isoProgramRules
+        )
+      ),
+    getSlicePlanesAffectIsosurface() ?
+     render::ShaderReplacementDefaults::SceneObject :
+     render::ShaderReplacementDefaults::SceneObjectNoSlice
+    );
+  // clang-format on
+
+  // Populate the program buffers with the extracted mesh
+  isosurfaceProgram->setAttribute("a_vertexPositions", isosurfaceMesh.vertices);
+  std::shared_ptr<render::AttributeBuffer> indexBuff = render::engine->generateAttributeBuffer(RenderDataType::UInt);
+  indexBuff->setData(isosurfaceMesh.indices);
+  isosurfaceProgram->setIndex(indexBuff);
+
+  render::engine->setMaterial(*isosurfaceProgram, parent.getMaterial());
+}
+
+template <typename QuantityT>
+SurfaceMesh* GridIsosurfaceQuantity<QuantityT>::registerIsosurfaceAsMesh(std::string structureName) {
+
+  // set the name to default
+  if (structureName == "") {
+    structureName = this->quantity.parent.name + " - " + this->quantity.name + " - isosurface";
+  }
+
+  // extract the mesh (or reuse the one which is being drawn)
+  const IsosurfaceMesh& isosurfaceMesh = this->quantity.getIsosurfaceMesh();
+
+  return registerSurfaceMesh(structureName, isosurfaceMesh.vertices,
+                             std::make_tuple(isosurfaceMesh.indices.data(), isosurfaceMesh.indices.size() / 3, 3));
+}
+
+template <typename QuantityT>
+QuantityT* GridIsosurfaceQuantity<QuantityT>::setIsosurfaceVizEnabled(bool val) {
+  isosurfaceVizEnabled = val;
+  requestRedraw();
+  return &this->quantity;
+}
+
+template <typename QuantityT>
+bool GridIsosurfaceQuantity<QuantityT>::getIsosurfaceVizEnabled() {
+  return isosurfaceVizEnabled.get();
+}
+
+template <typename QuantityT>
+QuantityT* GridIsosurfaceQuantity<QuantityT>::setIsosurfaceLevel(float val) {
+  isosurfaceLevel = val;
+  isosurfaceProgram.reset(); // delete the program so it gets recreated with the new value
+  requestRedraw();
+  return &this->quantity;
+}
+
+template <typename QuantityT>
+float GridIsosurfaceQuantity<QuantityT>::getIsosurfaceLevel() {
+  return isosurfaceLevel.get();
+}
+
+template <typename QuantityT>
+QuantityT* GridIsosurfaceQuantity<QuantityT>::setIsosurfaceColor(glm::vec3 val) {
+  isosurfaceColor = val;
+  requestRedraw();
+  return &this->quantity;
+}
+
+template <typename QuantityT>
+glm::vec3 GridIsosurfaceQuantity<QuantityT>::getIsosurfaceColor() {
+  return isosurfaceColor.get();
+}
+
+template <typename QuantityT>
+QuantityT* GridIsosurfaceQuantity<QuantityT>::setSlicePlanesAffectIsosurface(bool val) {
+  slicePlanesAffectIsosurface = val;
+  isosurfaceProgram.reset(); // delete the program so it gets recreated with the new value
+  requestRedraw();
+  return &this->quantity;
+}
+
+template <typename QuantityT>
+bool GridIsosurfaceQuantity<QuantityT>::getSlicePlanesAffectIsosurface() {
+  return slicePlanesAffectIsosurface.get();
+}
+
+} // namespace polyscope
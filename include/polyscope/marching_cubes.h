@@ -0,0 +1,42 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "polyscope/grid_brick_ranges.h"
+
+namespace polyscope {
+
+// A triangle mesh extracted from a grid of values
+struct IsosurfaceMesh {
+  std::vector<glm::vec3> vertices;
+  std::vector<uint32_t> indices; // 3 per triangle
+};
+
+// Extract the isosurface where the values equal isoValue, with marching cubes.
+//
+// The values live on the nodes of a grid with gridNodeDim nodes along each axis, indexed with x fastest as in
+// VolumeGrid::flattenNodeIndex(). The nodes span [boundMin, boundMax], and vertices are output at those world-space
+// positions. The grid is split in to bricks of cells which are processed in parallel, and vertices on grid edges shared
+// between bricks are welded, so the result is the same as a single pass over the grid.
+//
+// If brickRanges is given, it must summarize these values (on nodes), and bricks which the isosurface cannot pass
+// through are skipped without looking at their values.
+//
+// If vertexEdgeKeys is given, it is filled with the grid edge each vertex lies on, as 3 * (flattened index of the
+// edge's lower node) + (axis of the edge). This allows welding surfaces extracted from neighboring grids.
+void marchingCubes(const std::vector<float>& values, glm::uvec3 gridNodeDim, glm::vec3 boundMin, glm::vec3 boundMax,
+                   float isoValue, IsosurfaceMesh& result, const GridBrickRanges* brickRanges = nullptr,
+                   std::vector<uint64_t>* vertexEdgeKeys = nullptr);
+
+// Concatenate isosurfaces extracted from neighboring pieces of a grid, welding vertices which lie on the same grid
+// edge. pieceEdgeKeys gives the edge of each vertex of each piece as from marchingCubes(), but indexed in the whole grid.
+void weldIsosurfacePieces(const std::vector<IsosurfaceMesh>& pieces,
+                          const std::vector<std::vector<uint64_t>>& pieceEdgeKeys, IsosurfaceMesh& result);
+
+} // namespace polyscope
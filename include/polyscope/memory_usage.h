@@ -0,0 +1,75 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace polyscope {
+
+// forward declarations
+class Structure;
+class Quantity;
+namespace render {
+class AttributeBuffer;
+class TextureBuffer;
+class ShaderProgram;
+} // namespace render
+
+// Memory consumed by some part of Polyscope, in bytes.
+//   - host: CPU-side copies of data held by Polyscope (e.g. ManagedBuffer::data). Memory owned by the caller and
+//           wrapped via ManagedBuffer::setExternalData() is not included.
+//   - device: render buffers and textures allocated on the GPU (or in the mock backend, what would be allocated).
+//             Attribute buffers count their whole allocation, which grows ahead of the data they hold.
+struct MemoryUsage {
+  int64_t hostBytes = 0;
+  int64_t deviceBytes = 0;
+};
+
+// One row of the memory report. `quantityName` is empty for the structure itself (not including its quantities).
+struct MemoryUsageEntry {
+  std::string structureType;
+  std::string structureName;
+  std::string quantityName;
+  MemoryUsage usage;
+};
+
+// Accumulates memory usage over many buffers. Device buffers are often shared (for instance an indexed view may be
+// attached to several shader programs), so each one is counted only the first time it is seen.
+class MemoryUsageTally {
+public:
+  void addHostBytes(int64_t bytes);
+  void addDeviceBuffer(const render::AttributeBuffer* buffer);
+  void addDeviceBuffer(const render::TextureBuffer* buffer);
+  void addShaderProgram(render::ShaderProgram* program); // all buffers attached to the program
+
+  MemoryUsage usage;
+
+private:
+  std::unordered_set<uint64_t> seenDeviceBuffers;
+};
+
+// === Queries
+
+// Memory used by a structure, optionally including all of its quantities
+MemoryUsage getMemoryUsage(Structure* structure, bool includeQuantities = true);
+
+// Memory used by a single quantity
+MemoryUsage getMemoryUsage(Quantity* quantity);
+
+// One entry for every registered structure and every quantity
+std::vector<MemoryUsageEntry> getMemoryUsageReport();
+
+// Total memory used by all structures. The device total also includes render buffers which are not attributed to any
+// structure (e.g. the ground plane).
+MemoryUsage getTotalMemoryUsage();
+
+// Format a byte count for display, like "12.3 MB"
+std::string formatByteCount(int64_t bytes);
+
+// Build an ImGui table of the memory report
+void buildMemoryUsageGui();
+
+} // namespace polyscope
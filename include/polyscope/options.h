@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <functional>
 #include <string>
 #include <tuple>
@@ -72,6 +73,33 @@ extern bool warnForInvalidValues;
 // Show warnings/errors in popup modal dialogs
 extern bool displayMessagePopups;
 
+// Limit on the total size (in bytes) of host-side copies of data held in managed buffers. When exceeded, the host copies
+// of buffers which can be restored on demand (because they are also held on the device, or are lazily computed) are
+// dropped, least-recently-used first. Checked once per frame. (default: -1, no limit)
+extern int64_t hostMemoryBudget;
+
+// If true, updates to managed buffers are not sent to the render device immediately. Instead they are queued, and all
+// pending updates are sent at once just before the scene is rendered, so data which changes many times in one frame is
+// only uploaded once. (default: true)
+extern bool deferRenderUploads;
+
+// Managed buffers whose values are streamed from elsewhere, e.g. from a memory-mapped file, are uploaded to the render
+// device in chunks of about this many bytes, so that only one chunk is held in memory at a time. (default: 64 MB)
+extern int64_t streamedUploadChunkBytes;
+
+// Maximum number of threads used for CPU-side work, such as recomputing geometry after vertex positions are updated.
+// Set to 1 to do all work on the calling thread. (default: -1, use all hardware threads)
+extern int maxThreads;
+
+// Pick queries render only a square window of the pick buffer around the queried pixel, this many pixels wide, and keep
+// the result. Later queries inside the window are answered without rendering until the scene changes, which makes
+// hover picking cheap. Set to 1 to render just the queried pixel, or 0 to render the whole buffer. (default: 32)
+extern int pickWindowSize;
+
+// If true, volume meshes are split in to tetrahedra on a background thread as soon as they are registered, instead of
+// the first time a slice plane needs them. (default: false)
+extern bool precomputeVolumeMeshTets;
+
 // === Scene options
 
 // Behavior of the ground plane
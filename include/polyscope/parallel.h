@@ -0,0 +1,56 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <future>
+
+namespace polyscope {
+
+// A simple parallel-for over a shared pool of worker threads, used internally for CPU-side work like recomputing
+// geometry buffers. The number of threads is controlled by options::maxThreads.
+//
+// The range [0, n) is split in to contiguous blocks, which are processed concurrently. Callers which produce each
+// output from a fixed set of inputs (rather than accumulating across blocks) get results which do not depend on the
+// number of threads.
+
+// The number of threads which parallel work will use, including the calling thread.
+size_t getParallelThreadCount();
+
+// A split of the range [0, n) in to nBlocks contiguous blocks of blockSize entries (the last ones may be shorter)
+struct ParallelPartition {
+  size_t n = 0;
+  size_t nBlocks = 1;
+  size_t blockSize = 0;
+};
+
+// The split parallelForBlocks() uses for a range of size n, with one block per thread but at least minBlockSize entries
+// in each block. Passes which must see the same blocks, like counting outputs per block and then writing them at
+// per-block offsets, should get this once and share it: options::maxThreads may change in between.
+ParallelPartition getParallelPartition(size_t n, size_t minBlockSize);
+
+// Call func(iBlock, start, end) for each block of the range [0, n), with iBlock in [0, partition.nBlocks). Blocks may
+// run concurrently, and this returns after all have finished. If any block throws, one of the exceptions is rethrown
+// here. Nested calls from inside a block run serially on the calling thread.
+void parallelForBlocks(const ParallelPartition& partition, const std::function<void(size_t, size_t, size_t)>& func);
+
+// As above, over getParallelPartition(n, minBlockSize)
+void parallelForBlocks(size_t n, size_t minBlockSize, const std::function<void(size_t, size_t, size_t)>& func);
+
+// Call func(i) for each i in [0, n), possibly concurrently.
+template <typename Func>
+void parallelFor(size_t n, Func&& func, size_t minBlockSize = 1024) {
+  parallelForBlocks(n, minBlockSize, [&](size_t, size_t start, size_t end) {
+    for (size_t i = start; i < end; i++) {
+      func(i);
+    }
+  });
+}
+
+// Run func on a separate thread, returning a future which becomes ready when it finishes (and rethrows anything func
+// threw). Parallel loops inside func run serially, so background work does not hold up the shared pool. As with
+// std::async, destroying the future waits for func to finish.
+std::future<void> runInBackground(std::function<void()> func);
+
+} // namespace polyscope
@@ -2,9 +2,12 @@
 
 #pragma once
 
+#include <array>
 #include <cstdint>
+#include <functional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "polyscope/utilities.h"
 #include "polyscope/weak_handle.h"
@@ -41,6 +44,36 @@ struct PickResult {
 PickResult pickAtScreenCoords(glm::vec2 screenCoords); // takes screen coordinates
 PickResult pickAtBufferInds(glm::ivec2 bufferInds);    // takes indices into render buffer
 
+// Query functions which cast a ray on the CPU instead of rendering. The hit position is exact, so structure-specific
+// interpretation (like barycentric coordinates on a surface mesh) is too. This works without a display, but only
+// surface meshes (faces and vertices) and point clouds support it; other structures are skipped, as are slice planes.
+// The acceleration structures are built on the first query, and refit when the geometry is updated.
+PickResult rayPickAtScreenCoords(glm::vec2 screenCoords);  // takes screen coordinates
+PickResult rayPick(glm::vec3 rayStart, glm::vec3 rayDir); // takes a ray in world coordinates
+
+// == Region queries
+
+// Region pick queries find everything visible in an area of the screen. The pick buffer is rendered once for the
+// region's bounding box and read back in one transfer. Only visible elements are found, since the pick buffer is depth
+// tested. Results can be passed to the structure-specific batch interpretPickResult() overloads.
+
+// Return type for region pick queries, one per structure with something in the region
+struct RegionPickResult {
+  Structure* structure = nullptr;
+  WeakHandle<Structure> structureHandle; // same as .structure, but with lifetime tracking
+  std::string structureType = "";
+  std::string structureName = "";
+  std::vector<uint64_t> localIndices; // sorted, each element once (same indexing as PickResult::localIndex)
+  std::vector<glm::vec3> positions;   // for each entry of localIndices, the nearest point seen on the element
+  std::vector<float> depths;          // for each entry of localIndices, the distance from the camera to that point
+};
+
+// Query functions for regions, in indices into the render buffer. Polygon vertices are in the same coordinates, where
+// the center of a pixel is at +0.5. If maxDepth > 0, anything further than that from the camera is ignored. Results
+// are sorted by structure type and name.
+std::vector<RegionPickResult> pickInRectangle(glm::ivec2 cornerA, glm::ivec2 cornerB, float maxDepth = -1.);
+std::vector<RegionPickResult> pickInPolygon(const std::vector<glm::vec2>& polygon, float maxDepth = -1.);
+
 
 // == Stateful picking: track and update a current selection
 
@@ -61,14 +94,36 @@ std::pair<Structure*, uint64_t> pickAtScreenCoords(glm::vec2 screenCoords); // t
 std::pair<Structure*, uint64_t> pickAtBufferCoords(int xPos, int yPos);     // takes indices into the buffer
 std::pair<Structure*, uint64_t> evaluatePickQuery(int xPos, int yPos); // old, badly named. takes buffer coordinates.
 
+// Render the pick buffer for a window (x, y, width, height) of the render buffer, measured from the bottom-left. The
+// pick framebuffer is resized to the window. Returns false if the framebuffer could not be bound.
+bool renderPickWindow(glm::ivec4 window);
+
+// Get the global pick index and depth at a location in the render buffer (same indices as pickAtBufferCoords()). This
+// renders a window of options::pickWindowSize pixels around the location and caches it, so further queries inside
+// the window do not render again until the scene changes. Returns false if the location is outside of the buffer.
+bool queryPickBuffer(int xPos, int yPos, uint64_t& globalInd, float& depth);
+
+// Decode a window of the pick buffer read back for a region query, covering the buffer indices [minInds, maxInds]
+// (inclusive). `colors` and `depths` hold its pixels row by row, starting from the bottom row as framebuffer pixels do.
+// Only pixels where inRegion(x, y) is true count. Each element is reported once, at its nearest pixel, sorted by index
+// within each structure, and the structures are sorted by type and name.
+std::vector<RegionPickResult> decodePickRegion(const std::vector<std::array<float, 4>>& colors,
+                                               const std::vector<float>& depths, glm::ivec2 minInds,
+                                               glm::ivec2 maxInds, const std::function<bool(int, int)>& inRegion,
+                                               float maxDepth);
+
 
 // == Helpers
 
 // Set up picking (internal)
 // Called by a structure to figure out what data it should render to the pick buffer.
 // Request 'count' contiguous indices for drawing a pick buffer. The return value is the start of the range.
+// If the structure already has a range, it is released first. Released ranges are reused by later requests.
 uint64_t requestPickBufferRange(Structure* requestingStructure, uint64_t count);
 
+// Give back the range held by a structure, if any (called when a structure is removed)
+void releasePickBufferRange(Structure* requestingStructure);
+
 // Convert between global pick indexing for the whole program, and local per-structure pick indexing
 std::pair<Structure*, uint64_t> globalIndexToLocal(uint64_t globalInd);
 uint64_t localIndexToGlobal(std::pair<Structure*, uint64_t> localPick);
@@ -11,6 +11,7 @@
 #include "polyscope/render/engine.h"
 #include "polyscope/render/managed_buffer.h"
 #include "polyscope/scaled_value.h"
+#include "polyscope/spatial_index.h"
 #include "polyscope/standardize_data_array.h"
 #include "polyscope/structure.h"
 
@@ -49,6 +50,10 @@ public:
   // Construct a new point cloud structure
   PointCloud(std::string name, std::vector<glm::vec3> points);
 
+  // Construct a point cloud whose positions live in caller-owned memory, which is read in place rather than copied.
+  // The memory must stay valid while the point cloud uses it, pass an owner to have it kept alive.
+  PointCloud(std::string name, const glm::vec3* points, size_t nPoints, std::shared_ptr<const void> owner = nullptr);
+
   // === Overrides
 
   // Build the imgui display
@@ -60,6 +65,7 @@ public:
   virtual void draw() override;
   virtual void drawDelayed() override;
   virtual void drawPick() override;
+  virtual bool rayPick(glm::vec3 rayStart, glm::vec3 rayDir, float& tHit, uint64_t& localIndex) override;
   virtual void updateObjectSpaceBounds() override;
   virtual std::string typeName() override;
   virtual void refresh() override;
@@ -99,6 +105,12 @@ public:
   template <class V>
   void updatePointPositions2D(const V& newPositions);
 
+  // Use new positions from caller-owned memory, without copying them (see registerPointCloudExternal()). If the memory
+  // is modified in place afterwards, call this again (or points.markHostBufferUpdated()) to send the new values. The
+  // owner given here always replaces the previous one.
+  void updatePointPositionsExternal(const glm::vec3* newPositions, size_t count,
+                                    std::shared_ptr<const void> owner = nullptr);
+
   // === Set point size from a scalar quantity
   // effect is multiplicative with pointRadius
   // negative values are always clamped to 0
@@ -123,6 +135,7 @@ public:
 
   // get data related to picking/selection
   PointCloudPickResult interpretPickResult(const PickResult& result);
+  std::vector<PointCloudPickResult> interpretPickResult(const RegionPickResult& result); // one per picked element
 
   // Misc data
   static const std::string structureTypeName;
@@ -161,6 +174,12 @@ private:
   // Storage for the managed buffers above. You should generally interact with this directly through them.
   std::vector<glm::vec3> pointsData;
 
+  // For CPU ray queries, built on the first call to rayPick() and refit when the points move
+  PointKDTree pointKDTree;
+  uint64_t pointKDTreePositionsVersion = 0; // data version of the points the tree was built or refit from
+  uint64_t pointKDTreeRadiiBufferID = 0;    // uniqueID of the radius buffer the tree's radii came from
+  uint64_t pointKDTreeRadiiDataVersion = 0; // and its data version at the time
+
   // === Visualization parameters
   PersistentValue<std::string> pointRenderMode;
   PersistentValue<glm::vec3> pointColor;
@@ -207,6 +226,11 @@ PointCloud* registerPointCloud(std::string name, const T& points);
 template <class T>
 PointCloud* registerPointCloud2D(std::string name, const T& points);
 
+// Register a point cloud whose positions are read in place from caller-owned memory, with no host-side copy. The memory
+// must stay valid while the point cloud uses it, pass an owner to have it kept alive.
+PointCloud* registerPointCloudExternal(std::string name, const glm::vec3* points, size_t nPoints,
+                                       std::shared_ptr<const void> owner = nullptr);
+
 // Shorthand to get a point cloud from polyscope
 inline PointCloud* getPointCloud(std::string name = "");
 inline bool hasPointCloud(std::string name = "");
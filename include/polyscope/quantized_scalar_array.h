@@ -0,0 +1,67 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "polyscope/standardize_data_array.h"
+
+namespace polyscope {
+
+// How quantized scalar values are stored: as 8 or 16 bit unsigned integers, or as half floats
+enum class QuantizedScalarType { UInt8 = 0, UInt16, Float16 };
+
+// Quantized scalar values decode to scale * stored + offset
+struct ScalarQuantization {
+  QuantizedScalarType type = QuantizedScalarType::UInt16;
+  float scale = 1.;
+  float offset = 0.;
+};
+
+// An array of scalar values, held in their quantized form. For Float16, the stored values are the bits of IEEE half
+// floats.
+class QuantizedScalarArray {
+public:
+  QuantizedScalarArray(std::vector<uint8_t> storedValues, ScalarQuantization quantization);  // for UInt8
+  QuantizedScalarArray(std::vector<uint16_t> storedValues, ScalarQuantization quantization); // for UInt16 and Float16
+
+  size_t size() const;
+  size_t sizeInBytes() const;
+  const ScalarQuantization& getQuantization() const;
+
+  // Decoded values
+  float getValue(size_t ind) const;
+  void readValues(size_t start, size_t count, float* out) const;
+
+  // Stored values, without decoding: writes uint8_t values for UInt8, and uint16_t values otherwise
+  void readStoredValues(size_t start, size_t count, void* out) const;
+
+  // Quantize new values for [start, start+count), rounding them and clamping them to the range of the stored type
+  void writeValues(size_t start, size_t count, const float* values);
+
+  // The smallest and largest finite decoded values, in one pass over the stored values (infinite if there are none)
+  std::pair<float, float> getValueRange() const;
+
+  // Decoded values spread evenly over the array, at most about maxCount of them. Used to estimate the histogram of the
+  // values without decoding all of them.
+  std::vector<float> sampleValues(size_t maxCount) const;
+
+private:
+  ScalarQuantization quantization;
+  std::vector<uint8_t> storedValues8;   // for UInt8
+  std::vector<uint16_t> storedValues16; // for UInt16 and Float16
+};
+
+// Build an array from any array of stored values
+template <class T>
+QuantizedScalarArray makeQuantizedScalarArray(const T& storedValues, ScalarQuantization quantization) {
+  if (quantization.type == QuantizedScalarType::UInt8) {
+    return QuantizedScalarArray(standardizeArray<uint8_t, T>(storedValues), quantization);
+  }
+  return QuantizedScalarArray(standardizeArray<uint16_t, T>(storedValues), quantization);
+}
+
+} // namespace polyscope
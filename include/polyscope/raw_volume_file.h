@@ -0,0 +1,78 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <glm/glm.hpp>
+
+namespace polyscope {
+
+enum class RawVolumeDataType { UInt8 = 0, Int8, UInt16, Int16, UInt32, Int32, Float32, Float64 };
+
+// Where the values of a volume are in a file, and how they are stored
+struct RawVolumeLayout {
+  glm::uvec3 dim{0, 0, 0}; // number of values along each axis
+  RawVolumeDataType dataType = RawVolumeDataType::Float32;
+  bool bigEndian = false;
+  uint64_t headerBytes = 0; // offset of the first value in the file
+
+  // If 0, the values are stored with x varying fastest. Otherwise they are stored in bricks of brickSize^3 values, each
+  // with x varying fastest, and the bricks are also ordered with x varying fastest. Bricks at the far edges of the
+  // volume are padded out to the full size.
+  uint32_t brickSize = 0;
+};
+
+// A volume of values in a file, which is memory-mapped rather than read in to memory. Values are read on demand, and
+// converted to float, so volumes much larger than the available memory can be viewed.
+//
+// Files can either be described by a RawVolumeLayout, or carry a header describing their layout. The header is the
+// NRRD format (https://teem.sourceforge.net/nrrd/format.html), restricted to 3D volumes with raw encoding. A detached
+// header (.nhdr) which names its data file is also supported. Bricked files give the brick size with the key/value
+// pair "polyscope_brick_size:=N".
+class RawVolumeFile {
+public:
+  // Open a file which starts with a NRRD header, or a detached NRRD header
+  RawVolumeFile(std::string filename);
+
+  // Open a file with the given layout
+  RawVolumeFile(std::string filename, const RawVolumeLayout& layout);
+
+  ~RawVolumeFile();
+
+  RawVolumeFile(const RawVolumeFile&) = delete;
+  RawVolumeFile& operator=(const RawVolumeFile&) = delete;
+
+  const std::string& getFilename() const;
+  const RawVolumeLayout& getLayout() const;
+  glm::uvec3 getDim() const;
+  uint64_t nValues() const;
+
+  // Read the values [start, start+count), in order with x varying fastest, converted to float. May be called from
+  // several threads at once.
+  void readValues(uint64_t start, uint64_t count, float* out) const;
+  float getValue(glm::uvec3 ind) const;
+
+private:
+  std::string filename;
+  RawVolumeLayout layout;
+
+  // The mapped file
+  const unsigned char* mappedData = nullptr;
+  uint64_t mappedBytes = 0;
+  void* mappingHandle = nullptr; // only used on Windows
+  void mapFile(std::string dataFilename);
+  void unmapFile();
+
+  // Read values which are contiguous in the file
+  void readStoredValues(uint64_t storedStart, uint64_t count, float* out) const;
+};
+
+// Shorthand to open a file and share it, e.g. between the quantities which stream from it
+std::shared_ptr<RawVolumeFile> openRawVolumeFile(std::string filename);
+std::shared_ptr<RawVolumeFile> openRawVolumeFile(std::string filename, const RawVolumeLayout& layout);
+
+} // namespace polyscope
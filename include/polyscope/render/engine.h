@@ -4,7 +4,10 @@
 
 #include <array>
 #include <cstdint>
+#include <functional>
 #include <string>
+#include <tuple>
+#include <unordered_set>
 #include <vector>
 
 #include "polyscope/render/color_maps.h"
@@ -36,7 +39,7 @@ enum class DrawMode {
   TriangleStripInstanced,
 };
 
-enum class TextureFormat { RGB8 = 0, RGBA8, RG16F, RGB16F, RGBA16F, RGBA32F, RGB32F, R32F, R16F, DEPTH24 };
+enum class TextureFormat { RGB8 = 0, RGBA8, RG16F, RGB16F, RGBA16F, RGBA32F, RGB32F, R32F, R16F, R16, R8, DEPTH24 };
 enum class RenderBufferType { Color, ColorAlpha, Depth, Float4 };
 enum class DepthMode { Less, LEqual, LEqualReadOnly, Greater, Disable, PassReadOnly };
 enum class BlendMode { AlphaOver, OverNoWrite, AlphaUnder, Zero, WeightedAdd, Add, Source, Disable };
@@ -66,6 +69,12 @@ std::string deviceBufferTypeName(const DeviceBufferType& d);
 
 namespace render {
 
+// Total size of all render buffers and textures which currently exist (used for memory accounting)
+int64_t getTotalDeviceBufferBytes();
+
+// Buffers store floats, so double data is converted as it is uploaded
+void convertToFloat(const double* data, size_t count, float* out);
+
 class AttributeBuffer {
 public:
   AttributeBuffer(RenderDataType dataType_, int arrayCount);
@@ -90,13 +99,51 @@ public:
   virtual void setData(const std::vector<std::array<glm::vec3, 3>>& data) = 0;
   virtual void setData(const std::vector<std::array<glm::vec3, 4>>& data) = 0;
 
+  // Same as setData(), but reads `count` values from contiguous memory, which need not be held in a std::vector (for
+  // instance, memory owned by the caller)
+  virtual void setData(const glm::vec2* data, size_t count) = 0;
+  virtual void setData(const glm::vec3* data, size_t count) = 0;
+  virtual void setData(const glm::vec4* data, size_t count) = 0;
+  virtual void setData(const float* data, size_t count) = 0;
+  virtual void setData(const double* data, size_t count) = 0;
+  virtual void setData(const int32_t* data, size_t count) = 0;
+  virtual void setData(const uint32_t* data, size_t count) = 0;
+  virtual void setData(const glm::uvec2* data, size_t count) = 0;
+  virtual void setData(const glm::uvec3* data, size_t count) = 0;
+  virtual void setData(const glm::uvec4* data, size_t count) = 0;
+  virtual void setData(const std::array<glm::vec3, 2>* data, size_t count) = 0;
+  virtual void setData(const std::array<glm::vec3, 3>* data, size_t count) = 0;
+  virtual void setData(const std::array<glm::vec3, 4>* data, size_t count) = 0;
+
+  // Update a sub-range of an already-allocated buffer, copying data[dataStart, dataEnd) to the buffer starting at
+  // element bufferStart. The buffer is not resized, so the range must fit within the current data size.
+  // clang-format off
+  virtual void setDataRange(const std::vector<glm::vec2>& data, size_t dataStart, size_t dataEnd, size_t bufferStart) = 0;
+  virtual void setDataRange(const std::vector<glm::vec3>& data, size_t dataStart, size_t dataEnd, size_t bufferStart) = 0;
+  virtual void setDataRange(const std::vector<glm::vec4>& data, size_t dataStart, size_t dataEnd, size_t bufferStart) = 0;
+  virtual void setDataRange(const std::vector<float>& data, size_t dataStart, size_t dataEnd, size_t bufferStart) = 0;
+  virtual void setDataRange(const std::vector<double>& data, size_t dataStart, size_t dataEnd, size_t bufferStart) = 0;
+  virtual void setDataRange(const std::vector<int32_t>& data, size_t dataStart, size_t dataEnd, size_t bufferStart) = 0;
+  virtual void setDataRange(const std::vector<uint32_t>& data, size_t dataStart, size_t dataEnd, size_t bufferStart) = 0;
+  virtual void setDataRange(const std::vector<glm::uvec2>& data, size_t dataStart, size_t dataEnd, size_t bufferStart) = 0;
+  virtual void setDataRange(const std::vector<glm::uvec3>& data, size_t dataStart, size_t dataEnd, size_t bufferStart) = 0;
+  virtual void setDataRange(const std::vector<glm::uvec4>& data, size_t dataStart, size_t dataEnd, size_t bufferStart) = 0;
+  virtual void setDataRange(const std::vector<std::array<glm::vec3, 2>>& data, size_t dataStart, size_t dataEnd, size_t bufferStart) = 0;
+  virtual void setDataRange(const std::vector<std::array<glm::vec3, 3>>& data, size_t dataStart, size_t dataEnd, size_t bufferStart) = 0;
+  virtual void setDataRange(const std::vector<std::array<glm::vec3, 4>>& data, size_t dataStart, size_t dataEnd, size_t bufferStart) = 0;
+  // clang-format on
+
   virtual uint32_t getNativeBufferID() = 0; // used to interop with external things, e.g. ImGui
 
   // == Getters
   RenderDataType getType() const { return dataType; }
   int getArrayCount() const { return arrayCount; }
   int64_t getDataSize() const { return dataSize; }
-  int64_t getDataSizeInBytes() const { return dataSize * sizeInBytes(dataType) * getArrayCount(); }
+  int64_t getDataSizeInBytes() const { return isSet() ? dataSize * sizeInBytes(dataType) * getArrayCount() : 0; }
+  // The whole allocation, which grows ahead of the data size
+  int64_t getAllocatedSizeInBytes() const {
+    return isSet() ? static_cast<int64_t>(bufferSize) * sizeInBytes(dataType) * getArrayCount() : 0;
+  }
   uint64_t getUniqueID() const { return uniqueID; }
   bool isSet() const { return setFlag; }
 
@@ -134,6 +181,21 @@ protected:
   uint64_t uniqueID;
 };
 
+// A handle to a pending asynchronous copy of a texture's contents back to the host, see TextureBuffer::getDataAsync().
+// The copy is started when the handle is created, and the caller can keep working (e.g. finish rendering the frame)
+// while it completes.
+class TextureReadback {
+public:
+  virtual ~TextureReadback() {};
+
+  // True once the values have arrived, and getData() will not block
+  virtual bool isReady() = 0;
+
+  // The texel values, as dimension(format) interleaved float components per texel (in the same layout as the
+  // getData*() functions on the texture). Blocks until the copy is complete if it is not ready yet.
+  virtual std::vector<float> getData() = 0;
+};
+
 class TextureBuffer {
 public:
   // abstract class: use the factory methods from the Engine class
@@ -168,6 +230,47 @@ public:
   virtual void setData(const std::vector<std::array<glm::vec3, 3>>& data) = 0;
   virtual void setData(const std::vector<std::array<glm::vec3, 4>>& data) = 0;
 
+  // Update a box-shaped sub-region of the texture. `data` holds values for the _entire_ texture, in the same layout as
+  // setData(), but only the texels in [offset, offset+size) are uploaded. Unused dimensions should have offset 0 and
+  // size 1.
+  // NOTE: some of these are not implemented yet, matching setData() above
+  // clang-format off
+  virtual void setDataRegion(const std::vector<glm::vec2>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) = 0;
+  virtual void setDataRegion(const std::vector<glm::vec3>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) = 0;
+  virtual void setDataRegion(const std::vector<glm::vec4>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) = 0;
+  virtual void setDataRegion(const std::vector<float>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) = 0;
+  virtual void setDataRegion(const std::vector<double>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) = 0;
+  virtual void setDataRegion(const std::vector<int32_t>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) = 0;
+  virtual void setDataRegion(const std::vector<uint32_t>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) = 0;
+  virtual void setDataRegion(const std::vector<glm::uvec2>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) = 0;
+  virtual void setDataRegion(const std::vector<glm::uvec3>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) = 0;
+  virtual void setDataRegion(const std::vector<glm::uvec4>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) = 0;
+  virtual void setDataRegion(const std::vector<std::array<glm::vec3, 2>>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) = 0;
+  virtual void setDataRegion(const std::vector<std::array<glm::vec3, 3>>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) = 0;
+  virtual void setDataRegion(const std::vector<std::array<glm::vec3, 4>>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) = 0;
+  // clang-format on
+
+  // Same as setDataRegion() above, but `data` holds just the values of the region, packed with x varying fastest. This
+  // allows uploading a large texture in pieces, without ever holding all of its values in memory. The 8 and 16 bit
+  // integer versions are for the R8 and R16 formats, or hold the bits of half floats for R16F.
+  // clang-format off
+  virtual void setDataRegion(const glm::vec2* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) = 0;
+  virtual void setDataRegion(const glm::vec3* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) = 0;
+  virtual void setDataRegion(const glm::vec4* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) = 0;
+  virtual void setDataRegion(const float* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) = 0;
+  virtual void setDataRegion(const double* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) = 0;
+  virtual void setDataRegion(const int32_t* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) = 0;
+  virtual void setDataRegion(const uint32_t* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) = 0;
+  virtual void setDataRegion(const glm::uvec2* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) = 0;
+  virtual void setDataRegion(const glm::uvec3* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) = 0;
+  virtual void setDataRegion(const glm::uvec4* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) = 0;
+  virtual void setDataRegion(const std::array<glm::vec3, 2>* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) = 0;
+  virtual void setDataRegion(const std::array<glm::vec3, 3>* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) = 0;
+  virtual void setDataRegion(const std::array<glm::vec3, 4>* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) = 0;
+  virtual void setDataRegion(const uint8_t* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) = 0;
+  virtual void setDataRegion(const uint16_t* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) = 0;
+  // clang-format on
+
   unsigned int getSizeX() const { return sizeX; }
   unsigned int getSizeY() const { return sizeY; }
   unsigned int getSizeZ() const { return sizeZ; }
@@ -185,6 +288,10 @@ public:
   virtual std::vector<float> getDataScalar() = 0;
   virtual std::vector<glm::vec2> getDataVector2() = 0;
   virtual std::vector<glm::vec3> getDataVector3() = 0;
+  virtual std::vector<glm::vec4> getDataVector4() = 0;
+
+  // Start copying the texture data back to the host without waiting for it (see TextureReadback)
+  virtual std::shared_ptr<TextureReadback> getDataAsync() = 0;
 
   // Set texture data
   // void fillTextureData1D(std::string name, unsigned char* texData, unsigned int length);
@@ -263,6 +370,10 @@ public:
   // Query pixel
   virtual std::array<float, 4> readFloat4(int xPos, int yPos) = 0;
   virtual float readDepth(int xPos, int yPos) = 0;
+
+  // Query a block of (sizeX, sizeY) pixels starting at (xPos, yPos), in one transfer. Rows are ordered bottom-to-top.
+  virtual std::vector<std::array<float, 4>> readFloat4Region(int xPos, int yPos, int sizeX, int sizeY) = 0;
+  virtual std::vector<float> readDepthRegion(int xPos, int yPos, int sizeX, int sizeY) = 0;
   virtual void blitTo(FrameBuffer* other) = 0;
   virtual std::vector<unsigned char> readBuffer() = 0;
 
@@ -398,6 +509,7 @@ public:
   // Indices
   virtual void setIndex(std::shared_ptr<AttributeBuffer> externalBuffer) = 0;
   virtual void setPrimitiveRestartIndex(unsigned int restartIndex) = 0;
+  bool usesIndex() const { return useIndex; } // true if the draw mode takes an index buffer
 
   // Indices
   virtual void setInstanceCount(uint32_t instanceCount) = 0;
@@ -410,6 +522,10 @@ public:
 
   virtual void validateData() = 0;
 
+  // All buffers currently attached to the program, including the index buffer (used for memory accounting)
+  virtual std::vector<AttributeBuffer*> getAttributeBuffers() = 0;
+  virtual std::vector<TextureBuffer*> getTextureBuffers() = 0;
+
   uint64_t getUniqueID() const { return uniqueID; }
 
 protected:
@@ -435,6 +551,14 @@ protected:
 };
 
 
+// Counts of data sent to the render device over one frame (see Engine::getUploadStats())
+struct UploadStats {
+  size_t uploadCount = 0;    // number of writes to render buffers and textures
+  size_t uploadBytes = 0;    // total size of those writes
+  size_t queuedRequests = 0; // uploads requested via Engine::queueUpload(), including repeats which were coalesced
+  size_t queuedUploads = 0;  // queued uploads which were actually performed
+};
+
 class Engine {
 
 public:
@@ -638,6 +762,22 @@ public:
   // which happens at the end of the frame.
   void preserveResourceUntilImguiFrameCompletes(std::shared_ptr<TextureBuffer> texture);
 
+  // == Deferred uploads
+  // Updates to render data (e.g. from ManagedBuffer::markHostBufferUpdated()) are queued rather than sent to the device
+  // immediately, and the whole queue is flushed at once just before the scene is rendered. Each queued upload has a
+  // key, usually the unique ID of the data it sends. Queueing a key which is already pending does nothing, so data
+  // which is updated many times within a frame only gets sent once. See options::deferRenderUploads.
+  void queueUpload(uint64_t key, std::function<void()> uploadFunc);
+  void cancelQueuedUpload(uint64_t key);
+  void flushUploadQueue();
+  size_t getUploadQueueSize();
+
+  // Statistics about uploads. The backend calls recordUpload() for every write to a render buffer or texture, and the
+  // counts are rolled over to getUploadStats() once per frame by endUploadStatsFrame().
+  void recordUpload(size_t nBytes);
+  void endUploadStatsFrame();
+  const UploadStats& getUploadStats(); // counts for the most recent complete frame
+
 protected:
   // TODO Manage a cache of compiled shaders?
 
@@ -675,6 +815,12 @@ protected:
   // Lists of points to support preserving resources until the end of an ImGUI frame (see note above)
   void clearResourcesPreservedForImguiFrame();
   std::vector<std::shared_ptr<TextureBuffer>> resourcesPreservedForImGuiFrame;
+
+  // Deferred uploads, in the order they were first requested
+  std::vector<std::tuple<uint64_t, std::function<void()>>> uploadQueue;
+  std::unordered_set<uint64_t> uploadQueueKeys;
+  UploadStats currFrameUploadStats;
+  UploadStats lastFrameUploadStats;
 };
 
 
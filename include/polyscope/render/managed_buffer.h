@@ -7,6 +7,7 @@
 #include <unordered_map>
 #include <vector>
 
+#include "polyscope/memory_usage.h"
 #include "polyscope/render/engine.h"
 #include "polyscope/utilities.h"
 #include "polyscope/weak_handle.h"
@@ -17,6 +18,62 @@ namespace render {
 // forward declaration
 class ManagedBufferRegistry;
 
+// The inverse of an index buffer, stored in compressed-sparse-row form. For an index buffer `ind`, which expands
+// some data as view[i] = data[ind[i]], the expanded slots i which read from source entry s are
+//    slots[start[s]], ..., slots[start[s+1]-1]
+// (in increasing order). Source entries larger than the largest index have no slots.
+struct IndexInverseMap {
+  std::vector<uint32_t> start; // one entry per source entry, plus one
+  std::vector<uint32_t> slots; // one entry per index
+};
+
+// Type-erased view of a managed buffer's host-side copy of its data, used to keep the total size of all host copies
+// under options::hostMemoryBudget. Every ManagedBuffer<> is one of these, and is tracked globally while it is alive.
+class HostCopyEvictable {
+public:
+  virtual ~HostCopyEvictable() = default;
+
+  virtual size_t getHostCopyBytes() = 0;           // bytes currently held by the host copy
+  virtual bool hostCopyIsEvictable() = 0;          // true if the host copy could be dropped and restored on demand
+  virtual bool hostCopyIsRecomputable() const = 0; // true if restoring means calling computeFunc(), not a readback
+  virtual void evictHostCopy() = 0;                // drop the host copy (only if hostCopyIsEvictable())
+
+  // Logical timestamp of the last time the host copy was used, for least-recently-used eviction
+  uint64_t lastHostCopyUse = 0;
+
+protected:
+  void markHostCopyUsed();
+};
+
+// Total size of the host copies of all managed buffers, in bytes
+int64_t getTotalManagedBufferHostBytes();
+
+// If the host copies of all managed buffers exceed options::hostMemoryBudget, evict host copies until they fit (or
+// nothing more can be evicted). Lazily-computed buffers are evicted first, since they can be restored without touching
+// the render device, then the ones which were least-recently used. Evicted host copies are restored transparently the
+// next time they are needed, either by calling computeFunc() or by reading back the render buffer.
+//
+// This is called once per frame by the main loop. Returns the number of bytes freed.
+int64_t enforceHostMemoryBudget();
+int64_t enforceHostMemoryBudget(int64_t budgetBytes); // same as above, with an explicit budget
+
+template <typename T>
+class ManagedBuffer;
+
+// A handle to a pending asynchronous copy of a managed buffer's values from the render device back to the host, see
+// ManagedBuffer::ensureHostBufferPopulatedAsync(). The handle may outlive the buffer, in which case it does nothing.
+template <typename T>
+class ManagedBufferReadback {
+public:
+  bool isReady(); // true if wait() will return without blocking
+  void wait();    // block until the values have been copied in to the buffer's host-side `data`
+
+private:
+  friend class ManagedBuffer<T>;
+  WeakHandle<ManagedBuffer<T>> buffer;
+  std::shared_ptr<render::TextureReadback> readback; // null if nothing needed to be read back
+};
+
 /*
  * This class is a wrapper which sits on top of data buffers in Polyscope, and handles common data-management concerns
  * of:
@@ -34,7 +91,7 @@ class ManagedBufferRegistry;
  * data buffer.
  */
 template <typename T>
-class ManagedBuffer : public virtual WeakReferrable {
+class ManagedBuffer : public virtual WeakReferrable, public HostCopyEvictable {
 public:
   // === Constructors
   // (second variants are advanced versions which allow creation of multi-dimensional texture values)
@@ -59,6 +116,15 @@ public:
   // A globally-unique ID
   const uint64_t uniqueID;
 
+  // Incremented every time the values change (on the host or on the device). Things which are computed from the values
+  // and cached elsewhere can compare this to tell if they are stale.
+  uint64_t getDataVersion() const { return dataVersion; }
+
+  // Get the ranges [start, end) of `data` which have been written since the values had the given version, merged and
+  // sorted. Only the last few partial updates are remembered, and a full update forgets everything before it. Returns
+  // false if the history does not reach back to `version`, in which case all of the values should be treated as changed.
+  bool getRangesUpdatedSince(uint64_t version, std::vector<std::array<size_t, 2>>& ranges) const;
+
   // The registry in which it is tracked (can be null)
   ManagedBufferRegistry* registry;
 
@@ -109,6 +175,12 @@ public:
   // is lazily computed by computeFunc(), it ensures that that function has been called.
   void ensureHostBufferPopulated();
 
+  // Asynchronous variant of ensureHostBufferPopulated(). If the values currently live only in a render texture, the
+  // copy back to the host is started, but this returns immediately rather than stalling until it completes. Call
+  // wait() on the returned handle (or ensureHostBufferPopulated()) when the values are needed; isReady() tells if that
+  // will block. In all other cases the host buffer is populated right away, and the returned handle is already ready.
+  ManagedBufferReadback<T> ensureHostBufferPopulatedAsync();
+
   // Ensure that the `data` member has the proper size. This does _not_ populate the buffer with any particular data,
   // just ensures it is allocated. It is useful for when an external wants to fill the buffer with data.
   void ensureHostBufferAllocated();
@@ -120,6 +192,81 @@ public:
   // reflecting updates to the render buffer.
   void markHostBufferUpdated();
 
+  // Variants of markHostBufferUpdated() for when only part of `data` has changed. Only the entries [start,
+  // start+count) are re-sent to the render buffers, so the cost of the update scales with the size of the edit
+  // rather than the size of the buffer.
+  //
+  // Several ranges can be accumulated with markHostBufferRangeDirty() and then sent all at once with
+  // markHostBufferDirtyRangesUpdated(); overlapping and adjacent ranges are merged before uploading.
+  //
+  // When options::deferRenderUploads is set, the updates above are queued in the render engine and sent just before
+  // the next frame is rendered. Marking the same buffer updated many times within a frame results in one upload.
+  // Getting a render buffer (getRenderAttributeBuffer() etc.) sends this buffer's queued update first.
+  void markHostBufferUpdated(size_t start, size_t count);
+  void markHostBufferRangeDirty(size_t start, size_t count);
+  void markHostBufferDirtyRangesUpdated();
+
+  // Immediately send any updates which are waiting in the engine's upload queue
+  void flushQueuedDeviceUpload();
+  bool hasQueuedDeviceUpload() const;
+
+  // == External (caller-owned) memory
+
+  // Instead of holding its values in `data`, the buffer can wrap a contiguous array of `count` values in memory owned
+  // by the caller. The values are uploaded to the render buffers directly from that memory, and no host-side copy is
+  // made.
+  //
+  // The memory must remain valid until the buffer lets go of it, which happens when releaseExternalData() or
+  // setExternalData() is called again, when something needs the host-side `data` vector (see below), or when the
+  // buffer is destroyed. If an `owner` token is given, the buffer holds a reference to it for exactly that long, so
+  // passing e.g. a shared_ptr to the object which owns the memory ties the two lifetimes together.
+  //
+  // Accessors like getValue(), size(), and getHostDataPtr() read the external memory directly. Anything which needs the
+  // `data` vector itself (ensureHostBufferPopulated(), getPopulatedHostBufferRef(), etc) first copies the values in
+  // to `data` and releases the external memory. If the external values are modified in place, call
+  // markHostBufferUpdated() to re-upload them.
+  void setExternalData(const T* ptr, size_t count, std::shared_ptr<const void> owner = nullptr);
+  void releaseExternalData(); // copies the values in to `data` and stops referencing the external memory
+  bool hasExternalData() const;
+
+  // Read-only pointer to the size() current host-side values, wherever they live. Unlike ensureHostBufferPopulated(),
+  // this does not copy external memory.
+  const T* getHostDataPtr();
+
+  // == Streamed (out-of-core) values
+
+  // For textures which are too large to hold in memory, e.g. values in a memory-mapped file, the values can instead be
+  // read on demand by a caller-provided function. readFunc(start, count, out) must write the values [start,
+  // start+count) to `out`, and may be called from several threads at once.
+  //
+  // No host-side copy is made. The render texture is filled a slab at a time (see options::streamedUploadChunkBytes),
+  // and getValue() and readValues() read just the values they need. As with external memory, anything which needs the
+  // `data` vector itself reads all of the values in to it and stops streaming, as does writing new values to `data`
+  // and calling markHostBufferUpdated().
+  //
+  // If the values are already held in the texture encoding (see setTextureEncoding()), readEncodedFunc(start, count,
+  // out) can write them as stored: uint8_t values for R8, uint16_t values for R16 and R16F. The render texture is then
+  // filled from those directly, rather than by decoding and re-encoding every value.
+  void setStreamedData(size_t count, std::function<void(size_t, size_t, T*)> readFunc,
+                       std::function<void(size_t, size_t, void*)> readEncodedFunc = nullptr);
+  bool hasStreamedData() const;
+
+  // Copy the values [start, start+count) to `out`, from wherever they live. Streamed and external values are read
+  // directly, otherwise the host buffer is populated first.
+  void readValues(size_t start, size_t count, T* out);
+
+  // == Compact texture storage
+
+  // Scalar (float) textures can store their values more compactly than as 32-bit floats. They are stored as
+  // (value - offset) / scale: in an R8 or R16 texture rounded and clamped to unsigned integers, or in an R16F texture
+  // as half floats. Shaders read the integer formats normalized to [0,1], so the values which shaders read decode as
+  // getTextureDecodeScale() * texel + offset. Must be set before the render texture is created.
+  void setTextureEncoding(TextureFormat format, float scale, float offset);
+  bool hasTextureEncoding() const;
+  TextureFormat getTextureEncodingFormat() const;
+  float getTextureDecodeScale() const;
+  float getTextureDecodeOffset() const;
+
   // Get the value at index `i`. It may be dynamically fetched from either the cpu-side `data` member or the render
   // buffer, depending on where the data currently lives.
   // If the data lives only on the device-side render buffer, this function is expensive, so don't call it in a
@@ -140,6 +287,23 @@ public:
 
   std::string summaryString(); // for debugging
 
+  // Add the memory used by this buffer to the tally: the host-side data, plus any render buffers and indexed views
+  void tallyMemoryUsage(MemoryUsageTally& tally);
+
+  // == Host memory budget (see enforceHostMemoryBudget())
+
+  // If true, the host copy is never evicted. Set for user data which host-side computations read all the time, where
+  // reading it back from the device on every access would be a stall.
+  bool hostCopyIsPinned = false;
+
+  // A buffer's host copy may be evicted if it holds no unsent writes, and it can be restored later, either because the
+  // buffer is lazily computed or because the values also live in a render buffer or texture. Buffers which hold double
+  // values are never restored by readback, since the render buffer only has float precision.
+  size_t getHostCopyBytes() override;
+  bool hostCopyIsEvictable() override;
+  bool hostCopyIsRecomputable() const override;
+  void evictHostCopy() override;
+
   // ========================================================================
   // == Direct access to the GPU (device-side) render attribute buffer
   // ========================================================================
@@ -178,6 +342,11 @@ public:
   // same view will be returned repeatedly at no additional cost.
   std::shared_ptr<render::AttributeBuffer> getIndexedRenderAttributeBuffer(ManagedBuffer<uint32_t>& indices);
 
+  // Only valid for index buffers (ManagedBuffer<uint32_t>). Get the inverse of the index map, which is used to update
+  // just the affected entries of indexed views when a few source values change (see markHostBufferUpdated(start,
+  // count)). It is built lazily and cached until the index data changes.
+  const IndexInverseMap& getInverseIndexMap();
+
   // ========================================================================
   // == Direct access to the GPU (device-side) render texture buffer
   // ========================================================================
@@ -194,9 +363,37 @@ protected:
 
   bool hostBufferIsPopulated; // true if the host buffer contains currently-valid data
 
+  // Caller-owned memory holding the values, if any (see setExternalData())
+  const T* externalData = nullptr;
+  size_t externalDataSize = 0;
+  std::shared_ptr<const void> externalDataOwner;
+
+  // Function which reads the values, if they are streamed (see setStreamedData())
+  std::function<void(size_t, size_t, T*)> streamedDataReadFunc;
+  std::function<void(size_t, size_t, void*)> streamedEncodedDataReadFunc; // (optional)
+  size_t streamedDataSize = 0;
+  void stopStreaming();                // forget the streamed values, without reading them
+  void uploadStreamedTextureToDevice(); // fill the render texture from the streamed values, a slab at a time
+
+  // Compact storage for the render texture, if any (see setTextureEncoding())
+  bool textureIsEncoded = false;
+  TextureFormat textureEncodingFormat = TextureFormat::R32F;
+  float textureEncodingScale = 1.;
+  float textureEncodingOffset = 0.;
+  // upload a box of packed values to the render texture, encoding them if needed
+  void setTextureRegion(const T* values, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size);
+  void setWholeTexture(const T* values);
+  size_t hostDataSize(); // number of values in either `data` or the external memory
+  std::vector<T> gatherHostValues(const std::vector<uint32_t>& indices); // gather() from either of the above
+
   std::shared_ptr<render::AttributeBuffer> renderAttributeBuffer;
   std::shared_ptr<render::TextureBuffer> renderTextureBuffer;
 
+  // An in-progress asynchronous readback of the current render texture contents, if any
+  friend class ManagedBufferReadback<T>;
+  std::shared_ptr<render::TextureReadback> pendingTextureReadback;
+  void finishTextureReadback(const std::shared_ptr<render::TextureReadback>& readback);
+
   // For storing as textures
 
   // For data that can be interpreted as a 1/2/3 dimensional texture
@@ -205,6 +402,19 @@ protected:
   uint32_t sizeY = 0; // holds 0 if texture dim < 2
   uint32_t sizeZ = 0; // holds 0 if texture dim < 3
 
+  // Ranges [start, end) of `data` which have been marked as written, but not yet sent to the render buffers
+  std::vector<std::array<size_t, 2>> dirtyHostRanges;
+  void uploadTextureRange(size_t start, size_t end); // send one range of `data` to the render texture
+
+  // Sending host values to the render buffers and indexed views, either immediately or via the engine's upload queue
+  bool deviceUploadQueued = false;         // true if this buffer has an entry in the engine's upload queue
+  bool deviceUploadQueuedIsFull = false;   // if true, the queued upload re-sends everything, not just dirty ranges
+  bool shouldQueueDeviceUpload();          // true if uploads should be deferred right now
+  void queueDeviceUpload(bool full);       // add (or widen) this buffer's entry in the upload queue
+  void cancelQueuedDeviceUpload();         // remove this buffer's entry from the upload queue
+  void uploadHostBufferToDevice();         // send all of the values
+  void uploadDirtyHostRangesToDevice();    // send just the dirty ranges
+
 
   // == Internal representation of indexed views
   // NOTE: this seems like a problem, we are storing pointers as keys in a cache. Here, it works out because if the
@@ -213,8 +423,22 @@ protected:
   std::vector<std::tuple<render::ManagedBuffer<uint32_t>*, std::weak_ptr<render::AttributeBuffer>>>
       existingIndexedViews;
   void updateIndexedViews();
+  void updateIndexedViews(const std::vector<std::array<size_t, 2>>& sourceRanges); // only the given source ranges
   void removeDeletedIndexedViews();
 
+  // If this is an index buffer, the cached inverse map (empty if not built yet)
+  IndexInverseMap inverseIndexMap;
+  void invalidateInverseIndexMap();
+
+  uint64_t dataVersion = 0; // see getDataVersion()
+
+  // The ranges written by recent partial updates, tagged with the version each one produced. All versions after
+  // updateHistoryBaseVersion are recorded here.
+  std::vector<std::tuple<uint64_t, std::vector<std::array<size_t, 2>>>> recentUpdateRanges;
+  uint64_t updateHistoryBaseVersion = 0;
+  void recordFullUpdate();
+  void recordPartialUpdate(const std::vector<std::array<size_t, 2>>& ranges);
+
   // == Internal helper functions
 
   void invalidateHostBuffer();
@@ -222,7 +446,7 @@ protected:
   void checkDeviceBufferTypeIs(DeviceBufferType targetType);
   void checkDeviceBufferTypeIsTexture();
 
-  enum class CanonicalDataSource { HostData = 0, NeedsCompute, RenderBuffer };
+  enum class CanonicalDataSource { HostData = 0, NeedsCompute, RenderBuffer, ExternalData, StreamedData };
   CanonicalDataSource currentCanonicalDataSource();
 
   // Manage the program which copies indexed data from the renderBuffer to the indexed views
@@ -232,6 +456,11 @@ protected:
 };
 
 
+// The inverse index map is only defined for index buffers
+template <>
+const IndexInverseMap& ManagedBuffer<uint32_t>::getInverseIndexMap();
+
+
 // == Manage a store of all registered managed buffers
 
 // These registries are set up to be static: once a buffer is added it is never removed.
@@ -245,6 +474,8 @@ public:
   ManagedBuffer<T>& getManagedBuffer(std::string name);
   bool hasManagedBuffer(std::string name);
 
+  void tallyMemoryUsage(MemoryUsageTally& tally); // all buffers in the map
+
   // internal helper for template things
   static ManagedBufferMap<T>& getManagedBufferMapRef(ManagedBufferRegistry* r);
 
@@ -275,6 +506,15 @@ public:
   template <typename T>
   void addManagedBuffer(ManagedBuffer<T>* buffer);
 
+  // == Memory accounting
+
+  // Add the memory used by all buffers in the registry to the tally, as well as any tracked programs
+  void tallyMemoryUsage(MemoryUsageTally& tally);
+
+  // Also count the buffers attached to this program towards the registry's memory usage. This is for render data which
+  // does not live in a managed buffer, such as pick buffers. Programs are held weakly, and dropped once deleted.
+  void trackProgramMemoryUsage(const std::shared_ptr<render::ShaderProgram>& program);
+
   // clang-format off
   ManagedBufferMap<float>        managedBufferMap_float;
   ManagedBufferMap<double>       managedBufferMap_double;
@@ -290,6 +530,9 @@ public:
   ManagedBufferMap<glm::uvec3>   managedBufferMap_uvec3;
   ManagedBufferMap<glm::uvec4>   managedBufferMap_uvec4;
   // clang-format on
+
+private:
+  std::vector<std::weak_ptr<render::ShaderProgram>> memoryTrackedPrograms;
 };
 
 } // namespace render
@@ -31,6 +31,13 @@ void ManagedBufferMap<T>::addManagedBuffer(ManagedBuffer<T>* buffer) {
 }
 
 
+template <typename T>
+void ManagedBufferMap<T>::tallyMemoryUsage(MemoryUsageTally& tally) {
+  for (ManagedBuffer<T>* buff : allBuffers) {
+    buff->tallyMemoryUsage(tally);
+  }
+}
+
 template <typename T>
 ManagedBuffer<T>& ManagedBufferMap<T>::getManagedBuffer(std::string name) {
 
@@ -39,6 +39,38 @@ public:
   void setData(const std::vector<std::array<glm::vec3, 3>>& data) override;
   void setData(const std::vector<std::array<glm::vec3, 4>>& data) override;
 
+  // Set from contiguous memory
+  void setData(const glm::vec2* data, size_t count) override;
+  void setData(const glm::vec3* data, size_t count) override;
+  void setData(const glm::vec4* data, size_t count) override;
+  void setData(const float* data, size_t count) override;
+  void setData(const double* data, size_t count) override;
+  void setData(const int32_t* data, size_t count) override;
+  void setData(const uint32_t* data, size_t count) override;
+  void setData(const glm::uvec2* data, size_t count) override;
+  void setData(const glm::uvec3* data, size_t count) override;
+  void setData(const glm::uvec4* data, size_t count) override;
+  void setData(const std::array<glm::vec3, 2>* data, size_t count) override;
+  void setData(const std::array<glm::vec3, 3>* data, size_t count) override;
+  void setData(const std::array<glm::vec3, 4>* data, size_t count) override;
+
+  // Update a sub-range of the buffer
+  // clang-format off
+  void setDataRange(const std::vector<glm::vec2>& data, size_t dataStart, size_t dataEnd, size_t bufferStart) override;
+  void setDataRange(const std::vector<glm::vec3>& data, size_t dataStart, size_t dataEnd, size_t bufferStart) override;
+  void setDataRange(const std::vector<glm::vec4>& data, size_t dataStart, size_t dataEnd, size_t bufferStart) override;
+  void setDataRange(const std::vector<float>& data, size_t dataStart, size_t dataEnd, size_t bufferStart) override;
+  void setDataRange(const std::vector<double>& data, size_t dataStart, size_t dataEnd, size_t bufferStart) override;
+  void setDataRange(const std::vector<int32_t>& data, size_t dataStart, size_t dataEnd, size_t bufferStart) override;
+  void setDataRange(const std::vector<uint32_t>& data, size_t dataStart, size_t dataEnd, size_t bufferStart) override;
+  void setDataRange(const std::vector<glm::uvec2>& data, size_t dataStart, size_t dataEnd, size_t bufferStart) override;
+  void setDataRange(const std::vector<glm::uvec3>& data, size_t dataStart, size_t dataEnd, size_t bufferStart) override;
+  void setDataRange(const std::vector<glm::uvec4>& data, size_t dataStart, size_t dataEnd, size_t bufferStart) override;
+  void setDataRange(const std::vector<std::array<glm::vec3, 2>>& data, size_t dataStart, size_t dataEnd, size_t bufferStart) override;
+  void setDataRange(const std::vector<std::array<glm::vec3, 3>>& data, size_t dataStart, size_t dataEnd, size_t bufferStart) override;
+  void setDataRange(const std::vector<std::array<glm::vec3, 4>>& data, size_t dataStart, size_t dataEnd, size_t bufferStart) override;
+  // clang-format on
+
   // get data at a single index from the buffer
   float getData_float(size_t ind) override;
   double getData_double(size_t ind) override;
@@ -72,7 +104,10 @@ private:
 
   // internal implementation helpers
   template <typename T>
-  void setData_helper(const std::vector<T>& data);
+  void setData_helper(const T* data, size_t count);
+
+  template <typename T>
+  void setDataRange_helper(const std::vector<T>& data, size_t dataStart, size_t dataEnd, size_t bufferStart);
 
   template <typename T>
   T getData_helper(size_t ind);
@@ -81,6 +116,18 @@ private:
   std::vector<T> getDataRange_helper(size_t start, size_t count);
 };
 
+// The mock engine has no device memory to wait on, so readbacks complete immediately
+class GLTextureReadback : public TextureReadback {
+public:
+  GLTextureReadback(std::vector<float> data);
+
+  bool isReady() override;
+  std::vector<float> getData() override;
+
+private:
+  std::vector<float> data;
+};
+
 class GLTextureBuffer : public TextureBuffer {
 public:
   // create a 1D texture from data
@@ -126,6 +173,39 @@ public:
   void setData(const std::vector<std::array<glm::vec3, 3>>& data) override;
   void setData(const std::vector<std::array<glm::vec3, 4>>& data) override;
 
+  // Update a sub-region of the texture
+  // NOTE: some of these are not implemented yet
+  // clang-format off
+  void setDataRegion(const std::vector<glm::vec2>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) override;
+  void setDataRegion(const std::vector<glm::vec3>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) override;
+  void setDataRegion(const std::vector<glm::vec4>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) override;
+  void setDataRegion(const std::vector<float>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) override;
+  void setDataRegion(const std::vector<double>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) override;
+  void setDataRegion(const std::vector<int32_t>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) override;
+  void setDataRegion(const std::vector<uint32_t>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) override;
+  void setDataRegion(const std::vector<glm::uvec2>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) override;
+  void setDataRegion(const std::vector<glm::uvec3>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) override;
+  void setDataRegion(const std::vector<glm::uvec4>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) override;
+  void setDataRegion(const std::vector<std::array<glm::vec3, 2>>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) override;
+  void setDataRegion(const std::vector<std::array<glm::vec3, 3>>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) override;
+  void setDataRegion(const std::vector<std::array<glm::vec3, 4>>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) override;
+  void setDataRegion(const glm::vec2* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) override;
+  void setDataRegion(const glm::vec3* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) override;
+  void setDataRegion(const glm::vec4* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) override;
+  void setDataRegion(const float* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) override;
+  void setDataRegion(const double* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) override;
+  void setDataRegion(const int32_t* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) override;
+  void setDataRegion(const uint32_t* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) override;
+  void setDataRegion(const glm::uvec2* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) override;
+  void setDataRegion(const glm::uvec3* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) override;
+  void setDataRegion(const glm::uvec4* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) override;
+  void setDataRegion(const std::array<glm::vec3, 2>* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) override;
+  void setDataRegion(const std::array<glm::vec3, 3>* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) override;
+  void setDataRegion(const std::array<glm::vec3, 4>* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) override;
+  void setDataRegion(const uint8_t* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) override;
+  void setDataRegion(const uint16_t* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) override;
+  // clang-format on
+
   void setFilterMode(FilterMode newMode) override;
   void* getNativeHandle() override;
   uint32_t getNativeBufferID() override;
@@ -133,10 +213,17 @@ public:
   std::vector<float> getDataScalar() override;
   std::vector<glm::vec2> getDataVector2() override;
   std::vector<glm::vec3> getDataVector3() override;
+  std::vector<glm::vec4> getDataVector4() override;
+  std::shared_ptr<TextureReadback> getDataAsync() override;
 
   void bind();
 
-protected:
+private:
+  template <typename T>
+  void setDataRegion_helper(const std::vector<T>& data, std::array<unsigned int, 3> offset,
+                            std::array<unsigned int, 3> size);
+  template <typename T>
+  void setDataRegionPacked_helper(const T* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size);
 };
 
 class GLRenderBuffer : public RenderBuffer {
@@ -179,6 +266,8 @@ public:
   std::vector<unsigned char> readBuffer() override;
   std::array<float, 4> readFloat4(int xPos, int yPos) override;
   float readDepth(int xPos, int yPos) override;
+  std::vector<std::array<float, 4>> readFloat4Region(int xPos, int yPos, int sizeX, int sizeY) override;
+  std::vector<float> readDepthRegion(int xPos, int yPos, int sizeX, int sizeY) override;
   void blitTo(FrameBuffer* other) override;
 
   // Getters
@@ -296,6 +385,9 @@ public:
   void draw() override;
   void validateData() override;
 
+  std::vector<AttributeBuffer*> getAttributeBuffers() override;
+  std::vector<TextureBuffer*> getTextureBuffers() override;
+
 protected:
   // Lists of attributes and uniforms that need to be set
   std::vector<GLShaderUniform> uniforms;
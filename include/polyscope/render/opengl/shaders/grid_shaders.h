@@ -16,12 +16,17 @@ extern const ShaderStageSpecification FLEX_GRIDCUBE_FRAG_SHADER;
 extern const ShaderStageSpecification FLEX_GRIDCUBE_PLANE_VERT_SHADER;
 extern const ShaderStageSpecification FLEX_GRIDCUBE_PLANE_FRAG_SHADER;
 
+extern const ShaderStageSpecification SPARSE_GRIDCUBE_PLANE_VERT_SHADER;
+
 // Rules
 extern const ShaderReplacementRule GRIDCUBE_PROPAGATE_NODE_VALUE;
 extern const ShaderReplacementRule GRIDCUBE_PROPAGATE_CELL_VALUE;
 extern const ShaderReplacementRule GRIDCUBE_WIREFRAME;
 extern const ShaderReplacementRule GRIDCUBE_CONSTANT_PICK;
 extern const ShaderReplacementRule GRIDCUBE_CULLPOS_FROM_CENTER;
+extern const ShaderReplacementRule SPARSE_GRIDCUBE_BRICK;
+extern const ShaderReplacementRule SPARSE_GRIDCUBE_PROPAGATE_NODE_VALUE;
+extern const ShaderReplacementRule SPARSE_GRIDCUBE_PROPAGATE_CELL_VALUE;
 
 
 } // namespace backend_openGL3
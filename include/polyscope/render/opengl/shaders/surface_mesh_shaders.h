@@ -35,6 +35,7 @@ extern const ShaderReplacementRule MESH_PROPAGATE_HALFEDGE_VALUE;
 extern const ShaderReplacementRule MESH_PROPAGATE_CULLPOS;
 extern const ShaderReplacementRule MESH_PROPAGATE_PICK;
 extern const ShaderReplacementRule MESH_PROPAGATE_PICK_SIMPLE;
+extern const ShaderReplacementRule MESH_PROPAGATE_PICK_SIMPLE_FROM_INDS;
 extern const ShaderReplacementRule MESH_PROPAGATE_TYPE_AND_BASECOLOR2_SHADE;
 
 
@@ -51,14 +51,15 @@ std::shared_ptr<TextureBuffer> generateTextureBuffer(DeviceBufferType D, Engine*
 // template <typename T, DeviceBufferType D>
 // T getTextureBufferData(TextureBuffer& buff, size_t indX, size_t indY = 0, size_t indZ = 0);
 
-// Get a range of data values from a buffer of a templated type
-// (use std::array<T>s to get arraycount repeated attributes)
-template <typename T, DeviceBufferType D>
-std::vector<T> getTextureBufferData(TextureBuffer& buff) {
-  // TODO write these specializations
-  exception("bad call"); // default implementation, should be specialized to use
-  return std::vector<T>();
-}
+// Get all data values from a texture buffer of a templated type
+// (only supported for the types which textures can hold: float, double, and vec2/3/4)
+template <typename T>
+std::vector<T> getTextureBufferData(TextureBuffer& buff);
+
+// Convert the interleaved float components from a TextureReadback to values of a templated type
+// (supported for the same types as above)
+template <typename T>
+std::vector<T> unpackTextureReadbackData(const std::vector<float>& components);
 
 
 } // namespace render
@@ -17,6 +17,10 @@ public:
   ScalarImageQuantity(Structure& parent_, std::string name, size_t dimX, size_t dimY, const std::vector<float>& data,
                       ImageOrigin imageOrigin, DataType dataType);
 
+  // Quantized values, see addScalarImageQuantityQuantized()
+  ScalarImageQuantity(Structure& parent_, std::string name, size_t dimX, size_t dimY, QuantizedScalarArray data,
+                      ImageOrigin imageOrigin, DataType dataType);
+
   virtual void buildCustomUI() override;
 
   virtual void refresh() override;
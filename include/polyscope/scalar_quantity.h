@@ -6,6 +6,7 @@
 #include "polyscope/histogram.h"
 #include "polyscope/persistent_value.h"
 #include "polyscope/polyscope.h"
+#include "polyscope/quantized_scalar_array.h"
 #include "polyscope/render/engine.h"
 #include "polyscope/render/managed_buffer.h"
 #include "polyscope/scaled_value.h"
@@ -33,6 +34,20 @@ public:
   template <class V>
   void updateData(const V& newValues);
 
+  // Update just the values [start, start + newValues.size()). Only that range is re-sent to the render buffers, and
+  // caches which track changed ranges (like the brick ranges of volume grid scalars) only refresh the affected parts.
+  // Values streamed from a file cannot be updated this way, use updateData() to replace them.
+  template <class V>
+  void updateDataRange(const V& newValues, size_t start);
+
+  // Store the values quantized rather than as floats, both on the host and in the render texture (which must not have
+  // been created yet). Values read from `values` are decoded on demand, and updates are re-quantized. Internal passes
+  // over all of the values (like building brick ranges) decode them a slab at a time; only an explicit
+  // values.ensureHostBufferPopulated() keeps a decoded copy, until the next update. Only for scalars stored in
+  // textures, and not for categorical scalars. Move the array in to avoid copying it.
+  void setQuantizedValues(QuantizedScalarArray newValues);
+  bool hasQuantizedValues() const;
+
   // === Members
   QuantityT& quantity;
 
@@ -72,6 +87,11 @@ public:
 protected:
   std::vector<float> valuesData;
   const DataType dataType;
+  std::shared_ptr<QuantizedScalarArray> quantizedValues; // if the values are quantized, see setQuantizedValues()
+
+  // Make quantizedValues the streamed source of `values` again, dropping any decoded copy which was read in to the host
+  // buffer since, and re-send them
+  void streamQuantizedValues();
 
   // === Visualization parameters
 
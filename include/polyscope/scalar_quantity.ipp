@@ -248,19 +248,26 @@ std::vector<std::string> ScalarQuantity<QuantityT>::addScalarRules(std::vector<s
 
 template <typename QuantityT>
 void ScalarQuantity<QuantityT>::setScalarUniforms(render::ShaderProgram& p) {
+
+  // Shaders see encoded texture values as (value - offset) / scale, so map the range and period in to those units
+  // rather than decoding every sample. Isolines are shifted by the offset.
+  float decodeScale = values.getTextureDecodeScale();
+  float decodeOffset = values.getTextureDecodeOffset();
+  float modLen = getIsolinePeriod() / std::abs(decodeScale);
+
   if (dataType != DataType::CATEGORICAL) {
-    p.setUniform("u_rangeLow", vizRangeMin.get());
-    p.setUniform("u_rangeHigh", vizRangeMax.get());
+    p.setUniform("u_rangeLow", (vizRangeMin.get() - decodeOffset) / decodeScale);
+    p.setUniform("u_rangeHigh", (vizRangeMax.get() - decodeOffset) / decodeScale);
   }
 
   if (isolinesEnabled.get()) {
     switch (isolineStyle.get()) {
     case IsolineStyle::Stripe:
-      p.setUniform("u_modLen", getIsolinePeriod());
+      p.setUniform("u_modLen", modLen);
       p.setUniform("u_modDarkness", getIsolineDarkness());
       break;
     case IsolineStyle::Contour:
-      p.setUniform("u_modLen", getIsolinePeriod());
+      p.setUniform("u_modLen", modLen);
       p.setUniform("u_modThickness", getIsolineContourThickness());
       p.setUniform("u_modDarkness", getIsolineDarkness());
       break;
@@ -298,10 +305,88 @@ template <typename QuantityT>
 template <class V>
 void ScalarQuantity<QuantityT>::updateData(const V& newValues) {
   validateSize(newValues, values.size(), "scalar quantity " + quantity.name);
+  if (quantizedValues) {
+    // re-quantize, the values keep streaming from the quantized array
+    std::vector<float> newData = standardizeArray<float, V>(newValues);
+    quantizedValues->writeValues(0, newData.size(), newData.data());
+    streamQuantizedValues();
+    return;
+  }
   values.data = standardizeArray<float, V>(newValues);
   values.markHostBufferUpdated();
 }
 
+template <typename QuantityT>
+template <class V>
+void ScalarQuantity<QuantityT>::updateDataRange(const V& newValues, size_t start) {
+  std::vector<float> newData = standardizeArray<float, V>(newValues);
+  if (start + newData.size() > values.size()) {
+    exception("scalar quantity " + quantity.name + " updated range [" + std::to_string(start) + "," +
+              std::to_string(start + newData.size()) + "), but it has " + std::to_string(values.size()) + " values");
+  }
+  if (quantizedValues) {
+    // streamed values are re-sent in full
+    quantizedValues->writeValues(start, newData.size(), newData.data());
+    streamQuantizedValues();
+    return;
+  }
+  if (values.hasStreamedData()) {
+    // patching them would mean reading all of the values in to memory
+    exception("scalar quantity " + quantity.name +
+              " streams its values from elsewhere, so a range of them cannot be updated. Use updateData() instead.");
+  }
+  values.ensureHostBufferPopulated();
+  std::copy(newData.begin(), newData.end(), values.data.begin() + start);
+  values.markHostBufferUpdated(start, newData.size());
+}
+
+template <typename QuantityT>
+void ScalarQuantity<QuantityT>::setQuantizedValues(QuantizedScalarArray newValues) {
+  if (dataType == DataType::CATEGORICAL) {
+    exception("scalar quantity " + quantity.name + " is categorical, its values cannot be quantized");
+  }
+
+  const ScalarQuantization quantization = newValues.getQuantization();
+  TextureFormat format = TextureFormat::R16;
+  switch (quantization.type) {
+  case QuantizedScalarType::UInt8:
+    format = TextureFormat::R8;
+    break;
+  case QuantizedScalarType::UInt16:
+    format = TextureFormat::R16;
+    break;
+  case QuantizedScalarType::Float16:
+    format = TextureFormat::R16F;
+    break;
+  }
+  values.setTextureEncoding(format, quantization.scale, quantization.offset);
+
+  quantizedValues = std::make_shared<QuantizedScalarArray>(std::move(newValues)); // no copy of the stored values
+  streamQuantizedValues();
+
+  // The range is exact even if the quantity was constructed from a sample of the values
+  std::pair<float, float> valueRange = quantizedValues->getValueRange();
+  dataRange = robustMinMax(std::vector<float>{valueRange.first, valueRange.second}, 1e-5);
+  if (vizRangeMin.holdsDefaultValue()) {
+    resetMapRange();
+  }
+}
+
+template <typename QuantityT>
+void ScalarQuantity<QuantityT>::streamQuantizedValues() {
+  // the read functions hold on to the quantized array, the float values are never stored. The stored values match the
+  // texture encoding, so the texture is filled from them directly.
+  std::shared_ptr<QuantizedScalarArray> q = quantizedValues;
+  values.setStreamedData(
+      q->size(), [q](size_t start, size_t count, float* out) { q->readValues(start, count, out); },
+      [q](size_t start, size_t count, void* out) { q->readStoredValues(start, count, out); });
+}
+
+template <typename QuantityT>
+bool ScalarQuantity<QuantityT>::hasQuantizedValues() const {
+  return static_cast<bool>(quantizedValues);
+}
+
 
 template <typename QuantityT>
 QuantityT* ScalarQuantity<QuantityT>::setColorMap(std::string val) {
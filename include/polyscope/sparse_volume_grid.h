@@ -0,0 +1,199 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#pragma once
+
+#include "polyscope/affine_remapper.h"
+#include "polyscope/color_management.h"
+#include "polyscope/grid_cube_structure.h"
+#include "polyscope/polyscope.h"
+#include "polyscope/render/engine.h"
+#include "polyscope/standardize_data_array.h"
+#include "polyscope/structure.h"
+
+#include "polyscope/sparse_volume_grid_quantity.h"
+#include "polyscope/sparse_volume_grid_scalar_quantity.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace polyscope {
+
+class SparseVolumeGrid;
+class SparseVolumeGridNodeScalarQuantity;
+class SparseVolumeGridCellScalarQuantity;
+
+template <> // Specialize the quantity type
+struct QuantityTypeHelper<SparseVolumeGrid> {
+  typedef SparseVolumeGridQuantity type;
+};
+
+struct SparseVolumeGridPickResult {
+  VolumeGridElement elementType; // which kind of element did we click
+  glm::uvec3 index;              // grid index of the clicked node or cell
+  int64_t brickIndex;            // which occupied brick it is in (any of them, for a node shared between bricks)
+};
+
+// A grid like VolumeGrid, for domains which are mostly empty. The grid is split in to bricks of brickSize^3 cells, and
+// only the occupied bricks are stored, so memory scales with the number of occupied bricks rather than the size of the
+// grid.
+//
+// Quantities give values for each occupied brick in turn, in the same order as the bricks were given. Each brick holds
+// (brickSize+1)^3 node values or brickSize^3 cell values, indexed with x fastest. Nodes on the faces between bricks are
+// repeated in each brick, and should have the same values.
+class SparseVolumeGrid : public GridCubeStructure<SparseVolumeGrid> {
+public:
+  // Construct a new sparse volume grid structure. The number of cells along each axis must be a multiple of brickSize,
+  // and occupiedBricks are given in units of bricks.
+  SparseVolumeGrid(std::string name, glm::uvec3 gridNodeDim_, glm::vec3 boundMin_, glm::vec3 boundMax_,
+                   uint32_t brickSize_, const std::vector<glm::uvec3>& occupiedBricks_);
+
+  // === Overloads
+
+  // Standard structure overrides
+  virtual void draw() override;
+  virtual void drawDelayed() override;
+  virtual void drawPick() override;
+  virtual void updateObjectSpaceBounds() override;
+  virtual std::string typeName() override;
+  virtual void refresh() override;
+
+  // Build the imgui display
+  virtual void buildCustomUI() override;
+  virtual void buildPickUI(const PickResult& result) override;
+
+  // Misc data
+  static const std::string structureTypeName;
+
+  // === Geometry members
+
+  // The planes of the grid cube visualization for a single brick, in a reference [0,1]^3 brick. They are drawn once
+  // per occupied brick.
+  render::ManagedBuffer<glm::vec3> brickPlaneReferencePositions;
+  render::ManagedBuffer<glm::vec3> brickPlaneReferenceNormals;
+  render::ManagedBuffer<int32_t> brickPlaneAxisInds;
+
+  // For each occupied brick, the index of its first cell, and in w a bitmask of which of its neighbors are occupied
+  // (+x, -x, +y, -y, +z, -z from the lowest bit). Held in a 2D texture which the shaders read per brick.
+  render::ManagedBuffer<glm::vec4> brickInfo;
+
+
+  // === Quantity-related
+  // clang-format off
+
+  template <class T>
+  SparseVolumeGridNodeScalarQuantity* addNodeScalarQuantity(std::string name, const T& values, DataType dataType_ = DataType::STANDARD);
+
+  template <class T>
+  SparseVolumeGridCellScalarQuantity* addCellScalarQuantity(std::string name, const T& values, DataType dataType_ = DataType::STANDARD);
+
+
+  // Rendering helpers used by quantities
+  std::vector<std::string> addGridCubeRules(std::vector<std::string> initRules, bool withShade=true);
+  void setGridCubeUniforms(render::ShaderProgram& p, bool withShade=true);
+  void setGridCubeBuffers(render::ShaderProgram& p); // attributes, brick texture, and instance count
+
+  // == Helpers for computing with the grid
+
+  size_t nBricks() const;        // number of occupied bricks
+  uint64_t nNodes() const;       // number of node values, counting each brick separately
+  uint64_t nCells() const;       // number of cell values
+  uint64_t nNodesPerBrick() const;
+  uint64_t nCellsPerBrick() const;
+  glm::vec3 gridSpacing() const; // space between nodes/cells, in world units
+  glm::vec3 gridSpacingReference() const; // space between nodes/cells, on [0,1]^3
+
+  // Field data
+  glm::uvec3 getGridNodeDim() const;
+  glm::uvec3 getGridCellDim() const;
+  glm::uvec3 getGridBrickDim() const;
+  uint32_t getBrickSize() const;
+  glm::vec3 getBoundMin() const;
+  glm::vec3 getBoundMax() const;
+  const std::vector<glm::uvec3>& getOccupiedBricks() const;
+
+  // The index of a brick among the occupied bricks, or -1 if it is not occupied
+  int64_t findBrick(glm::uvec3 brick) const;
+
+  glm::vec3 positionOfNodeIndex(glm::uvec3 inds) const;
+  glm::vec3 positionOfCellIndex(glm::uvec3 inds) const;
+
+  // Choose a pool texture layout for bricks of slotSize^3 values, and copy per-brick values in to it
+  SparseVolumeGridBrickPool computeBrickPool(uint32_t slotSize) const;
+  std::vector<float> gatherToBrickPool(const SparseVolumeGridBrickPool& pool, const std::vector<float>& brickValues) const;
+
+  // Node values given brick-by-brick, with each node which is repeated in several bricks kept once
+  std::vector<float> distinctNodeValues(const std::vector<float>& brickValues) const;
+
+  // force the grid to act as if the specified elements are in use (aka enable them for picking, etc)
+  void markNodesAsUsed();
+  void markCellsAsUsed();
+
+  // get data related to picking/selection
+  SparseVolumeGridPickResult interpretPickResult(const PickResult& result);
+
+private:
+
+  // Field data
+  glm::uvec3 gridNodeDim;
+  glm::uvec3 gridCellDim;
+  glm::vec3 boundMin, boundMax;
+  uint32_t brickSize;
+  glm::uvec3 gridBrickDim;
+  std::vector<glm::uvec3> occupiedBricks;
+
+  // For looking up bricks: the flattened index of each occupied brick, sorted, and the brick it came from
+  std::vector<uint64_t> sortedBrickKeys;
+  std::vector<uint32_t> sortedBrickInds;
+  uint64_t brickKey(glm::uvec3 brick) const;
+
+  // === Storage for managed quantities
+  std::vector<glm::vec3> brickPlaneReferencePositionsData;
+  std::vector<glm::vec3> brickPlaneReferenceNormalsData;
+  std::vector<int32_t> brickPlaneAxisIndsData;
+  std::vector<glm::vec4> brickInfoData;
+
+  // == Compute indices & geometry data
+  void computeBrickPlaneReferenceGeometry();
+  void computeBrickInfo();
+
+  // Picking-related
+  // As with VolumeGrid, the whole structure is drawn with a single pick index, and the element is found CPU-side
+  size_t globalPickConstant = INVALID_IND_64;
+  glm::vec3 pickColor;
+  void buildNodeInfoGUI(const SparseVolumeGridPickResult& result);
+  void buildCellInfoGUI(const SparseVolumeGridPickResult& result);
+  bool nodesHaveBeenUsed = false;
+  bool cellsHaveBeenUsed = false;
+
+  // Drawing related things
+  // if nullptr, prepare() (resp. preparePick()) needs to be called
+  std::shared_ptr<render::ShaderProgram> program;
+  std::shared_ptr<render::ShaderProgram> pickProgram;
+
+  // === Helpers
+
+  // Do setup work related to drawing, including allocating openGL data
+  void ensureGridCubeRenderProgramPrepared();
+  void ensureGridCubePickProgramPrepared();
+
+  // === Quantity adder implementations
+
+  SparseVolumeGridNodeScalarQuantity* addNodeScalarQuantityImpl(std::string name, const std::vector<float>& data, DataType dataType_);
+  SparseVolumeGridCellScalarQuantity* addCellScalarQuantityImpl(std::string name, const std::vector<float>& data, DataType dataType_);
+
+  // clang-format on
+};
+
+
+SparseVolumeGrid* registerSparseVolumeGrid(std::string name, glm::uvec3 gridNodeDim, glm::vec3 boundMin,
+                                           glm::vec3 boundMax, uint32_t brickSize,
+                                           const std::vector<glm::uvec3>& occupiedBricks);
+
+// Shorthand to get a sparse volume grid from polyscope
+inline SparseVolumeGrid* getSparseVolumeGrid(std::string name = "");
+inline bool hasSparseVolumeGrid(std::string name = "");
+inline void removeSparseVolumeGrid(std::string name = "", bool errorIfAbsent = false);
+
+} // namespace polyscope
+
+#include "polyscope/sparse_volume_grid.ipp"
@@ -0,0 +1,75 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#pragma once
+
+namespace polyscope {
+
+inline size_t SparseVolumeGrid::nBricks() const { return occupiedBricks.size(); }
+inline uint64_t SparseVolumeGrid::nNodesPerBrick() const {
+  return static_cast<uint64_t>(brickSize + 1) * (brickSize + 1) * (brickSize + 1);
+}
+inline uint64_t SparseVolumeGrid::nCellsPerBrick() const {
+  return static_cast<uint64_t>(brickSize) * brickSize * brickSize;
+}
+inline uint64_t SparseVolumeGrid::nNodes() const { return nBricks() * nNodesPerBrick(); }
+inline uint64_t SparseVolumeGrid::nCells() const { return nBricks() * nCellsPerBrick(); }
+
+// Field data
+inline glm::uvec3 SparseVolumeGrid::getGridNodeDim() const { return gridNodeDim; }
+inline glm::uvec3 SparseVolumeGrid::getGridCellDim() const { return gridCellDim; }
+inline glm::uvec3 SparseVolumeGrid::getGridBrickDim() const { return gridBrickDim; }
+inline uint32_t SparseVolumeGrid::getBrickSize() const { return brickSize; }
+inline glm::vec3 SparseVolumeGrid::getBoundMin() const { return boundMin; }
+inline glm::vec3 SparseVolumeGrid::getBoundMax() const { return boundMax; }
+inline const std::vector<glm::uvec3>& SparseVolumeGrid::getOccupiedBricks() const { return occupiedBricks; }
+
+inline uint64_t SparseVolumeGrid::brickKey(glm::uvec3 brick) const {
+  return (static_cast<uint64_t>(brick.z) * gridBrickDim.y + brick.y) * gridBrickDim.x + brick.x;
+}
+
+inline glm::vec3 SparseVolumeGrid::positionOfNodeIndex(glm::uvec3 inds) const {
+  glm::vec3 tVals = glm::vec3(inds) / glm::vec3(gridCellDim);
+  return (1.f - tVals) * boundMin + tVals * boundMax;
+}
+
+inline glm::vec3 SparseVolumeGrid::positionOfCellIndex(glm::uvec3 inds) const {
+  return positionOfNodeIndex(inds) + gridSpacing() / 2.f;
+}
+
+inline glm::vec3 SparseVolumeGrid::gridSpacing() const { return (boundMax - boundMin) / glm::vec3(gridCellDim); }
+
+inline glm::vec3 SparseVolumeGrid::gridSpacingReference() const {
+  return glm::vec3{1.f / gridCellDim.x, 1.f / gridCellDim.y, 1.f / gridCellDim.z};
+}
+
+// Shorthand to get a sparse volume grid from polyscope
+inline SparseVolumeGrid* getSparseVolumeGrid(std::string name) {
+  return dynamic_cast<SparseVolumeGrid*>(getStructure(SparseVolumeGrid::structureTypeName, name));
+}
+inline bool hasSparseVolumeGrid(std::string name) {
+  return hasStructure(SparseVolumeGrid::structureTypeName, name);
+}
+inline void removeSparseVolumeGrid(std::string name, bool errorIfAbsent) {
+  removeStructure(SparseVolumeGrid::structureTypeName, name, errorIfAbsent);
+}
+
+
+// =====================================================
+// ============== Quantities
+// =====================================================
+
+template <class T>
+SparseVolumeGridNodeScalarQuantity* SparseVolumeGrid::addNodeScalarQuantity(std::string name, const T& values,
+                                                                            DataType dataType_) {
+  validateSize(values, nNodes(), "sparse grid node scalar quantity " + name);
+  return addNodeScalarQuantityImpl(name, standardizeArray<float, T>(values), dataType_);
+}
+
+template <class T>
+SparseVolumeGridCellScalarQuantity* SparseVolumeGrid::addCellScalarQuantity(std::string name, const T& values,
+                                                                            DataType dataType_) {
+  validateSize(values, nCells(), "sparse grid cell scalar quantity " + name);
+  return addCellScalarQuantityImpl(name, standardizeArray<float, T>(values), dataType_);
+}
+
+} // namespace polyscope
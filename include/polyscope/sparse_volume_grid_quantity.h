@@ -0,0 +1,52 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#pragma once
+
+#include "polyscope/quantity.h"
+#include "polyscope/structure.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+namespace polyscope {
+
+// Forward declare structure
+class SparseVolumeGrid;
+
+// Where the bricks of a quantity are stored in its pool texture. Each brick is a block of slotSize^3 texels, and the
+// blocks are laid out in order of the occupied bricks, with x fastest.
+struct SparseVolumeGridBrickPool {
+  uint32_t slotSize = 0;
+  glm::uvec3 slotDim{0, 0, 0}; // number of blocks along each axis of the texture
+
+  glm::uvec3 textureDim() const { return slotDim * slotSize; }
+
+  glm::uvec3 slotOrigin(size_t iBrick) const {
+    glm::uvec3 slot{static_cast<uint32_t>(iBrick % slotDim.x), static_cast<uint32_t>((iBrick / slotDim.x) % slotDim.y),
+                    static_cast<uint32_t>(iBrick / (static_cast<size_t>(slotDim.x) * slotDim.y))};
+    return slot * slotSize;
+  }
+
+  size_t texelIndex(size_t iBrick, glm::uvec3 local) const {
+    glm::uvec3 texel = slotOrigin(iBrick) + local;
+    glm::uvec3 texDim = textureDim();
+    return (static_cast<size_t>(texel.z) * texDim.y + texel.y) * texDim.x + texel.x;
+  }
+};
+
+// Extend Quantity<SparseVolumeGrid> to add a few extra functions
+class SparseVolumeGridQuantity : public QuantityS<SparseVolumeGrid> {
+public:
+  SparseVolumeGridQuantity(std::string name, SparseVolumeGrid& parentStructure, bool dominates = false);
+  ~SparseVolumeGridQuantity() {};
+
+  virtual bool isDrawingGridcubes() = 0;
+
+  // Build GUI info about an element, given as the index of an occupied brick and a node or cell within it
+  virtual void buildNodeInfoGUI(size_t iBrick, glm::uvec3 localNode);
+  virtual void buildCellInfoGUI(size_t iBrick, glm::uvec3 localCell);
+};
+
+} // namespace polyscope
@@ -0,0 +1,125 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#pragma once
+
+#include "polyscope/polyscope.h"
+
+#include "polyscope/affine_remapper.h"
+#include "polyscope/grid_brick_ranges.h"
+#include "polyscope/grid_scalar_quantity.h"
+#include "polyscope/histogram.h"
+#include "polyscope/marching_cubes.h"
+#include "polyscope/render/color_maps.h"
+#include "polyscope/scalar_quantity.h"
+#include "polyscope/sparse_volume_grid.h"
+#include "polyscope/surface_mesh.h"
+
+namespace polyscope {
+
+// Note that the `values` of these quantities are stored in the layout of a brick pool texture (see
+// SparseVolumeGridBrickPool), rather than brick-by-brick as they were given. Use getNodeValue() / getCellValue() to
+// look up values, and updateData() with values brick-by-brick to change them. The data range and histogram are built
+// from the values as they were given, with the nodes repeated between bricks counted once.
+
+// ========================================================
+// ==========            Node Scalar             ==========
+// ========================================================
+
+class SparseVolumeGridNodeScalarQuantity : public SparseVolumeGridQuantity,
+                                           public ScalarQuantity<SparseVolumeGridNodeScalarQuantity>,
+                                           public GridIsosurfaceQuantity<SparseVolumeGridNodeScalarQuantity> {
+
+public:
+  SparseVolumeGridNodeScalarQuantity(std::string name, SparseVolumeGrid& grid_, const SparseVolumeGridBrickPool& pool_,
+                                     const std::vector<float>& brickValues_, DataType dataType_);
+
+  virtual void draw() override;
+  virtual void buildCustomUI() override;
+  virtual void refresh() override;
+  virtual void buildNodeInfoGUI(size_t iBrick, glm::uvec3 localNode) override;
+
+  virtual std::string niceName() override;
+
+  virtual bool isDrawingGridcubes() override;
+
+  // Replace the values, given brick-by-brick as when the quantity was added
+  template <class V>
+  void updateData(const V& newValues);
+
+  float getNodeValue(size_t iBrick, glm::uvec3 localNode);
+
+  // The isosurface through all occupied bricks, with vertices on the faces between bricks welded
+  const IsosurfaceMesh& getIsosurfaceMesh();
+
+  // The range of values in each occupied brick (numbered as in the grid), refreshed as needed when the values change
+  const GridBrickRanges& getBrickRanges();
+
+protected:
+  const SparseVolumeGridBrickPool pool;
+  void updateBrickValues(const std::vector<float>& brickValues);
+
+  // Visualize as a grid of cubes
+  std::shared_ptr<render::ShaderProgram> gridcubeProgram;
+  void createGridcubeProgram();
+
+  // The extracted isosurface, kept until the level or the values change
+  IsosurfaceMesh isosurfaceMesh;
+  bool isosurfaceMeshValid = false;
+  float isosurfaceMeshLevel = 0.;
+  uint64_t isosurfaceMeshValuesVersion = 0;
+
+  // Used to extract just the bricks which the isosurface passes through
+  GridBrickRanges brickRanges;
+  uint64_t brickRangesValuesVersion = 0;
+  void readBrickValues(size_t iBrick, std::vector<float>& brickValues); // the brick's nodes, x fastest
+};
+
+
+// ========================================================
+// ==========            Cell Scalar             ==========
+// ========================================================
+
+class SparseVolumeGridCellScalarQuantity : public SparseVolumeGridQuantity,
+                                           public ScalarQuantity<SparseVolumeGridCellScalarQuantity>,
+                                           public GridScalarQuantity<SparseVolumeGridCellScalarQuantity> {
+
+public:
+  SparseVolumeGridCellScalarQuantity(std::string name, SparseVolumeGrid& grid_, const SparseVolumeGridBrickPool& pool_,
+                                     const std::vector<float>& brickValues_, DataType dataType_);
+
+  virtual void draw() override;
+  virtual void buildCustomUI() override;
+  virtual void refresh() override;
+  virtual void buildCellInfoGUI(size_t iBrick, glm::uvec3 localCell) override;
+
+  virtual std::string niceName() override;
+
+  virtual bool isDrawingGridcubes() override;
+
+  // Replace the values, given brick-by-brick as when the quantity was added
+  template <class V>
+  void updateData(const V& newValues);
+
+  float getCellValue(size_t iBrick, glm::uvec3 localCell);
+
+protected:
+  const SparseVolumeGridBrickPool pool;
+  void updateBrickValues(const std::vector<float>& brickValues);
+
+  // Visualize as a grid of cubes
+  std::shared_ptr<render::ShaderProgram> gridcubeProgram;
+  void createGridcubeProgram();
+};
+
+
+template <class V>
+void SparseVolumeGridNodeScalarQuantity::updateData(const V& newValues) {
+  updateBrickValues(standardizeArray<float, V>(newValues));
+}
+
+template <class V>
+void SparseVolumeGridCellScalarQuantity::updateData(const V& newValues) {
+  updateBrickValues(standardizeArray<float, V>(newValues));
+}
+
+} // namespace polyscope
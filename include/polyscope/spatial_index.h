@@ -0,0 +1,98 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace polyscope {
+
+// Acceleration structures for casting rays against geometry on the CPU. These are used to pick elements without
+// rendering (see rayPick() in pick.h), and are built lazily by the structures which use them.
+
+// Result of a ray query. The hit is at rayStart + t * rayDir.
+struct RayHit {
+  bool hit = false;
+  float t = std::numeric_limits<float>::infinity();
+  uint32_t index = 0;                      // which triangle or point was hit
+  glm::vec3 baryCoords = glm::vec3{-1.f}; // coordinates of the hit in the triangle (only for triangle queries)
+};
+
+// A node in the trees below. Nodes are stored in depth-first order, so the first child of an interior node is the one
+// right after it.
+struct SpatialIndexNode {
+  glm::vec3 boundMin;
+  glm::vec3 boundMax;
+  uint32_t start; // for a leaf, the first entry in its range of items. for an interior node, the second child
+  uint32_t count; // for a leaf, the number of items. 0 for an interior node
+};
+
+// A bounding volume hierarchy over triangles, split with the surface area heuristic
+class TriangleBVH {
+public:
+  // Build over the triangles (triangleVertexInds[3*i], triangleVertexInds[3*i+1], triangleVertexInds[3*i+2])
+  void build(const std::vector<glm::vec3>& vertexPositions, const std::vector<uint32_t>& triangleVertexInds);
+
+  // Update for new vertex positions, keeping the same tree. Much cheaper than a rebuild, though queries get slower if
+  // the triangles move a lot relative to each other.
+  void refit(const std::vector<glm::vec3>& vertexPositions);
+
+  bool isBuilt() const { return !nodes.empty(); }
+  size_t nTriangles() const { return triangleOrder.size(); }
+
+  // Find the nearest hit with t in [0, tMax). If cullBackfaces is true, triangles whose front (counter-clockwise) side
+  // faces away from the ray are skipped.
+  RayHit intersect(glm::vec3 rayStart, glm::vec3 rayDir,
+                   float tMax = std::numeric_limits<float>::infinity(), bool cullBackfaces = false) const;
+
+private:
+  std::vector<SpatialIndexNode> nodes;
+  std::vector<uint32_t> triangleVertexInds; // as passed to build()
+  std::vector<uint32_t> triangleOrder;      // original index of each triangle, in leaf order
+  std::vector<glm::vec3> triangleCorners;   // three corner positions of each triangle, in leaf order
+
+  void gatherCorners(const std::vector<glm::vec3>& vertexPositions);
+  void refitBounds();
+};
+
+// A k-d tree over points, which can be intersected with rays as spheres of a given radius around each point
+class PointKDTree {
+public:
+  void build(const glm::vec3* points, size_t nPoints);
+  void build(const std::vector<glm::vec3>& points) { build(points.data(), points.size()); }
+
+  // Update for new point positions (the number of points must not change), keeping the same tree
+  void refit(const glm::vec3* points, size_t nPoints);
+  void refit(const std::vector<glm::vec3>& points) { refit(points.data(), points.size()); }
+
+  bool isBuilt() const { return !nodes.empty(); }
+  size_t nPoints() const { return pointOrder.size(); }
+
+  // Give each point its own radius (one per point, in the order passed to build()). The largest radius under each node
+  // is stored along with it, so queries only pad each box by what it contains. Radii are kept across refit(), and
+  // cleared by build().
+  void setRadii(const float* radii, size_t nRadii);
+  void setRadii(const std::vector<float>& radii) { setRadii(radii.data(), radii.size()); }
+  void clearRadii();
+  bool hasRadii() const { return !orderedRadii.empty(); }
+
+  // Find the nearest hit with t in [0, tMax), treating each point as a sphere. If radii were set, point i has radius
+  // radiusScale * radii[i], otherwise all points have radius radiusScale.
+  RayHit intersectSpheres(glm::vec3 rayStart, glm::vec3 rayDir, float radiusScale,
+                          float tMax = std::numeric_limits<float>::infinity()) const;
+
+private:
+  std::vector<SpatialIndexNode> nodes;
+  std::vector<uint32_t> pointOrder;      // original index of each point, in leaf order
+  std::vector<glm::vec3> orderedPoints;  // point positions, in leaf order
+  std::vector<float> orderedRadii;       // point radii, in leaf order (empty if not set)
+  std::vector<float> nodeMaxRadius;      // largest radius under each node (empty if not set)
+
+  void refitBounds();
+};
+
+} // namespace polyscope
@@ -11,6 +11,7 @@
 
 #include "polyscope/persistent_value.h"
 #include "polyscope/pick.h"
+#include "polyscope/quantized_scalar_array.h"
 #include "polyscope/render/engine.h"
 #include "polyscope/transformation_gizmo.h"
 #include "polyscope/weak_handle.h"
@@ -22,6 +23,7 @@ namespace polyscope {
 
 // forward declarations
 class Group;
+class Quantity;
 
 
 // A 'structure' in Polyscope terms, is an object with which we can associate data in the UI, such as a point cloud,
@@ -45,6 +47,11 @@ public:
   virtual void drawDelayed() = 0;
   virtual void drawPick() = 0;
 
+  // == Intersect a world-space ray with the structure on the CPU, without rendering (see rayPick() in pick.h). On a hit,
+  // returns true and sets the ray parameter of the hit and the local pick index of the element. The default
+  // implementation never hits; structures which support CPU ray queries override it.
+  virtual bool rayPick(glm::vec3 rayStart, glm::vec3 rayDir, float& tHit, uint64_t& localIndex);
+
   // == Add rendering rules
   std::vector<std::string> addStructureRules(std::vector<std::string> initRules);
 
@@ -57,6 +64,9 @@ public:
   virtual void buildSharedStructureUI();  // Draw any UI elements shared between all instances of the structure
   virtual void buildPickUI(const PickResult& result) = 0; // Draw pick UI elements based on a selection result
 
+  // All quantities on the structure, including floating quantities. Overridden by QuantityStructure.
+  virtual std::vector<Quantity*> getAllQuantities();
+
   // = Identifying data
   const std::string name; // should be unique amongst registered structures with this type
   std::string uniquePrefix();
@@ -102,7 +112,7 @@ public:
 
 
   // Options
-  Structure* setTransparency(float newVal); // also enables transparency if <1 and transparency is not enabled
+  virtual Structure* setTransparency(float newVal); // also enables transparency if <1 and transparency is not enabled
   float getTransparency();
 
   Structure* setCullWholeElements(bool newVal);
@@ -185,6 +195,8 @@ public:
   // Re-perform any setup work, including refreshing all quantities
   virtual void refresh() override;
 
+  virtual std::vector<Quantity*> getAllQuantities() override;
+
   // = Manage quantities
 
   // Note: takes ownership of pointer after it is passed in
@@ -218,6 +230,13 @@ public:
                                               ImageOrigin imageOrigin = ImageOrigin::UpperLeft,
                                               DataType type = DataType::STANDARD);
 
+  // A scalar image stored quantized, as 8/16 bit integers or half floats, see QuantizedScalarArray
+  template <class T>
+  ScalarImageQuantity* addScalarImageQuantityQuantized(std::string name, size_t dimX, size_t dimY,
+                                                       const T& storedValues, ScalarQuantization quantization,
+                                                       ImageOrigin imageOrigin = ImageOrigin::UpperLeft,
+                                                       DataType type = DataType::STANDARD);
+
   template <class T>
   ColorImageQuantity* addColorImageQuantity(std::string name, size_t dimX, size_t dimY, const T& values_rgb,
                                             ImageOrigin imageOrigin = ImageOrigin::UpperLeft);
@@ -256,6 +275,8 @@ public:
   ScalarImageQuantity* addScalarImageQuantityImpl(std::string name, size_t dimX, size_t dimY,
                                                   const std::vector<float>& values, ImageOrigin imageOrigin,
                                                   DataType type);
+  ScalarImageQuantity* addScalarImageQuantityImpl(std::string name, size_t dimX, size_t dimY,
+                                                  QuantizedScalarArray values, ImageOrigin imageOrigin, DataType type);
 
   ColorImageQuantity* addColorImageQuantityImpl(std::string name, size_t dimX, size_t dimY,
                                                 const std::vector<glm::vec4>& values, ImageOrigin imageOrigin);
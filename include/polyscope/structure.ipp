@@ -85,6 +85,18 @@ void QuantityStructure<S>::refresh() {
   requestRedraw();
 }
 
+template <typename S>
+std::vector<Quantity*> QuantityStructure<S>::getAllQuantities() {
+  std::vector<Quantity*> allQuantities;
+  for (auto& qp : quantities) {
+    allQuantities.push_back(qp.second.get());
+  }
+  for (auto& qp : floatingQuantities) {
+    allQuantities.push_back(qp.second.get());
+  }
+  return allQuantities;
+}
+
 template <typename S>
 void QuantityStructure<S>::removeQuantity(std::string name, bool errorIfAbsent) {
 
@@ -193,6 +205,17 @@ ScalarImageQuantity* QuantityStructure<S>::addScalarImageQuantity(std::string na
   return this->addScalarImageQuantityImpl(name, dimX, dimY, standardizeArray<float, T>(values), imageOrigin, type);
 }
 
+template <typename S>
+template <class T>
+ScalarImageQuantity* QuantityStructure<S>::addScalarImageQuantityQuantized(std::string name, size_t dimX, size_t dimY,
+                                                                           const T& storedValues,
+                                                                           ScalarQuantization quantization,
+                                                                           ImageOrigin imageOrigin, DataType type) {
+  validateSize(storedValues, dimX * dimY, "floating scalar image " + name);
+  return this->addScalarImageQuantityImpl(name, dimX, dimY, makeQuantizedScalarArray(storedValues, quantization),
+                                          imageOrigin, type);
+}
+
 
 template <typename S>
 template <class T>
@@ -316,6 +339,8 @@ RawColorAlphaRenderImageQuantity* QuantityStructure<S>::addRawColorAlphaRenderIm
 ScalarImageQuantity* createScalarImageQuantity(Structure& parent, std::string name, size_t dimX, size_t dimY,
                                                const std::vector<float>& data, ImageOrigin imageOrigin,
                                                DataType dataType);
+ScalarImageQuantity* createScalarImageQuantity(Structure& parent, std::string name, size_t dimX, size_t dimY,
+                                               QuantizedScalarArray data, ImageOrigin imageOrigin, DataType dataType);
 ColorImageQuantity* createColorImageQuantity(Structure& parent, std::string name, size_t dimX, size_t dimY,
                                              const std::vector<glm::vec4>& data, ImageOrigin imageOrigin);
 DepthRenderImageQuantity* createDepthRenderImage(Structure& parent, std::string name, size_t dimX, size_t dimY,
@@ -355,6 +380,16 @@ ScalarImageQuantity* QuantityStructure<S>::addScalarImageQuantityImpl(std::strin
   return q;
 }
 
+template <typename S>
+ScalarImageQuantity* QuantityStructure<S>::addScalarImageQuantityImpl(std::string name, size_t dimX, size_t dimY,
+                                                                      QuantizedScalarArray values,
+                                                                      ImageOrigin imageOrigin, DataType type) {
+  checkForQuantityWithNameAndDeleteOrError(name);
+  ScalarImageQuantity* q = createScalarImageQuantity(*this, name, dimX, dimY, std::move(values), imageOrigin, type);
+  addQuantity(q);
+  return q;
+}
+
 template <typename S>
 ColorImageQuantity* QuantityStructure<S>::addColorImageQuantityImpl(std::string name, size_t dimX, size_t dimY,
                                                                     const std::vector<glm::vec4>& values,
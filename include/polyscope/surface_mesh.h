@@ -11,6 +11,7 @@
 #include "polyscope/polyscope.h"
 #include "polyscope/render/engine.h"
 #include "polyscope/render/managed_buffer.h"
+#include "polyscope/spatial_index.h"
 #include "polyscope/standardize_data_array.h"
 #include "polyscope/structure.h"
 #include "polyscope/surface_mesh_quantity.h"
@@ -86,6 +87,7 @@ public:
   virtual void draw() override;
   virtual void drawDelayed() override;
   virtual void drawPick() override;
+  virtual bool rayPick(glm::vec3 rayStart, glm::vec3 rayDir, float& tHit, uint64_t& localIndex) override;
   virtual void updateObjectSpaceBounds() override;
   virtual std::string typeName() override;
   virtual void refresh() override;
@@ -173,6 +175,7 @@ public:
 
   // get data related to picking/selection
   SurfaceMeshPickResult interpretPickResult(const PickResult& result);
+  std::vector<SurfaceMeshPickResult> interpretPickResult(const RegionPickResult& result); // one per picked element
 
   // Make a one-time selection
   long long int selectVertex();
@@ -257,6 +260,17 @@ public:
   // (note that this may not match the halfedge perm that the user specifies)
   std::vector<size_t> twinHalfedge; // for halfedge i, the index of a twin halfedge
 
+  // For each halfedge of the triangulated mesh, the index of its edge in Polyscope's canonical edge ordering, which
+  // numbers edges in the order they are first encountered walking the faces (before applying edgePerm). Populated
+  // along with twinHalfedge and nEdgesCount by ensureHaveHalfedgeConnectivity().
+  std::vector<uint32_t> halfedgeCanonicalEdge;
+
+  // For each vertex, the faces containing it (once per corner, in increasing face order), in the same compressed
+  // format as faceIndsStart/faceIndsEntries. Lets per-vertex sums over faces be computed in parallel, always adding in
+  // the same order. Populated by ensureHaveVertexFaceAdjacency().
+  std::vector<uint32_t> vertexFaceAdjStart;
+  std::vector<uint32_t> vertexFaceAdjEntries;
+
   static const std::string structureTypeName;
 
   // === Getters and setters for visualization settings
@@ -303,6 +317,13 @@ public:
   void setMeshPickAttributes(render::ShaderProgram& p);
   void setSurfaceMeshUniforms(render::ShaderProgram& p);
 
+  // True when programs for this mesh can draw from the compact per-vertex buffers using triangleVertexInds as an index
+  // buffer, rather than expanding every attribute to the corners of the triangulation. This requires that nothing
+  // about the mesh's appearance varies per-face or per-corner: no wireframe, no per-polygon flat normals, no whole-face
+  // slice plane culling, and no transparency quantity. Quantities with vertex-valued data use the "INDEXED_MESH" shader
+  // when this is true; setMeshGeometryAttributes() handles either kind of program.
+  bool canDrawIndexed();
+
 
   // === ~DANGER~ experimental/unsupported functions
 
@@ -314,6 +335,13 @@ public:
 
 
 private:
+  // Map a local pick index to an element (corner indices are left in the permuted order the pick buffer uses)
+  SurfaceMeshPickResult interpretPickIndex(uint64_t localIndex, glm::vec3 position);
+
+  // For CPU ray queries, built on the first call to rayPick() and refit when the geometry changes
+  TriangleBVH triangleBVH;
+  uint64_t triangleBVHPositionsVersion = 0; // data version of the positions the BVH was built or refit from
+
   // == Mesh geometry buffers
   // Storage for the managed buffers above. You should generally interact with these through the managed buffers, not
   // these members.
@@ -387,11 +415,23 @@ private:
   void computeDefaultFaceTangentBasisY();
   void countEdges();
 
+  // Builds the shared halfedge connectivity (halfedgeCanonicalEdge, twinHalfedge, nEdgesCount) in one pass, by
+  // radix-sorting the halfedges by their endpoints. Cached after the first call.
+  void ensureHaveHalfedgeConnectivity();
+  void ensureHaveVertexFaceAdjacency();
+
+  // Shade with per-triangle normals computed from positions in the shader, rather than from the faceNormals buffer.
+  // This is the TriFlat style, and also Flat style whenever drawing indexed (where the two agree, on triangle meshes).
+  bool shadesNormalsFromPosition();
+
   // Picking-related
   // Order of indexing: vertexPositions, faces, edges, halfedges
   // Within each set, uses the implicit ordering from the mesh data structure
   // These starts are LOCAL indices, indexing elements only with the mesh
   size_t facePickIndStart, edgePickIndStart, halfedgePickIndStart, cornerPickIndStart;
+  size_t computePickIndStarts(); // fills the above, returning the total number of pick indices
+  std::vector<size_t> cornerPermInverse; // lazily inverted cornerPerm, to map corner picks back; empty if not built
+  size_t unpermuteCornerIndex(size_t permInd);
   void buildVertexInfoGui(const SurfaceMeshPickResult& result);
   void buildFaceInfoGui(const SurfaceMeshPickResult& result);
   void buildEdgeInfoGui(const SurfaceMeshPickResult& result);
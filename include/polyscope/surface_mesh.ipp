@@ -180,6 +180,7 @@ void SurfaceMesh::setCornerPermutation(const T& perm, size_t expectedSize) {
 
   validateSize(perm, nCorners(), "corner permutation for " + name);
   cornerPerm = standardizeArray<size_t, T>(perm);
+  cornerPermInverse.clear();
 
   cornerDataSize = expectedSize;
   if (cornerDataSize == 0) {
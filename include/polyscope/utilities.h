@@ -3,6 +3,7 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
 #include <complex>
 #include <cstdint>
 #include <cstdio>
@@ -13,6 +14,7 @@
 #include <sstream>
 #include <string>
 #include <tuple>
+#include <vector>
 
 
 #include <glm/glm.hpp>
@@ -135,6 +137,26 @@ std::vector<T> gather(const std::vector<T>& input, const std::vector<uint32_t>&
   return result;
 }
 
+// Sort parallel arrays of (key, value) pairs by key, with a least-significant-digit radix sort. The sort is stable:
+// pairs with equal keys stay in the same relative order. Only the low `keyBits` bits of each key are considered, so
+// passing a tight bound makes the sort faster. Large inputs are sorted in parallel.
+void radixSortPairs(std::vector<uint64_t>& keys, std::vector<uint32_t>& values, int keyBits = 64);
+
+// Sort a list of half-open [start, end) index ranges, and merge any ranges which overlap or are adjacent. Empty ranges
+// are dropped.
+inline std::vector<std::array<size_t, 2>> mergeIndexRanges(std::vector<std::array<size_t, 2>> ranges) {
+  std::sort(ranges.begin(), ranges.end());
+  std::vector<std::array<size_t, 2>> merged;
+  for (const std::array<size_t, 2>& r : ranges) {
+    if (r[0] >= r[1]) continue;
+    if (!merged.empty() && r[0] <= merged.back()[1]) {
+      merged.back()[1] = std::max(merged.back()[1], r[1]);
+    } else {
+      merged.push_back(r);
+    }
+  }
+  return merged;
+}
 
 // === Random number generation
 extern std::random_device util_random_device;
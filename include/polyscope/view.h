@@ -87,6 +87,12 @@ glm::mat4 getCameraViewMatrix();
 void setCameraViewMatrix(glm::mat4 newMat);
 glm::mat4 getCameraPerspectiveMatrix();
 glm::vec3 getCameraWorldPosition();
+
+// Restrict rendering to a window (x, y, width, height) of the render buffer, in pixels from the bottom-left corner like
+// a GL viewport. While set, getCameraPerspectiveMatrix() returns the projection of just that part of the view frustum,
+// so rendering to a (width, height) target produces exactly those pixels of the full image. Used for picking.
+void setRenderSubWindow(glm::ivec4 window);
+void clearRenderSubWindow();
 void getCameraFrame(glm::vec3& lookDir, glm::vec3& upDir, glm::vec3& rightDir);
 glm::vec3 getUpVec();
 glm::vec3 getFrontVec();
@@ -4,7 +4,10 @@
 
 #include "polyscope/affine_remapper.h"
 #include "polyscope/color_management.h"
+#include "polyscope/grid_cube_structure.h"
 #include "polyscope/polyscope.h"
+#include "polyscope/quantized_scalar_array.h"
+#include "polyscope/raw_volume_file.h"
 #include "polyscope/render/engine.h"
 #include "polyscope/standardize_data_array.h"
 #include "polyscope/structure.h"
@@ -31,7 +34,7 @@ struct VolumeGridPickResult {
   int64_t index;                 // index of the clicked element
 };
 
-class VolumeGrid : public QuantityStructure<VolumeGrid> {
+class VolumeGrid : public GridCubeStructure<VolumeGrid> {
 public:
   // Construct a new volume grid structure
   VolumeGrid(std::string name, glm::uvec3 gridNodeDim_, glm::vec3 boundMin_, glm::vec3 boundMax_);
@@ -48,7 +51,6 @@ public:
 
   // Build the imgui display
   virtual void buildCustomUI() override;
-  virtual void buildCustomOptionsUI() override;
   virtual void buildPickUI(const PickResult& result) override;
 
   // Misc data
@@ -85,6 +87,19 @@ public:
   template <class Func>
   VolumeGridCellScalarQuantity* addCellScalarQuantityFromBatchCallable(std::string name, Func&& func, DataType dataType_ = DataType::STANDARD);
 
+  // Values which are streamed from a file as they are needed, rather than held in memory. The dimensions of the file
+  // must match the nodes (or cells) of the grid.
+  VolumeGridNodeScalarQuantity* addNodeScalarQuantityFromFile(std::string name, std::shared_ptr<RawVolumeFile> file, DataType dataType_ = DataType::STANDARD);
+  VolumeGridCellScalarQuantity* addCellScalarQuantityFromFile(std::string name, std::shared_ptr<RawVolumeFile> file, DataType dataType_ = DataType::STANDARD);
+
+  // Values which are stored quantized, as 8/16 bit integers or half floats, on both the host and the GPU. The stored
+  // values decode to quantization.scale * stored + quantization.offset. See QuantizedScalarArray.
+  template <class T>
+  VolumeGridNodeScalarQuantity* addNodeScalarQuantityQuantized(std::string name, const T& storedValues, ScalarQuantization quantization, DataType dataType_ = DataType::STANDARD);
+
+  template <class T>
+  VolumeGridCellScalarQuantity* addCellScalarQuantityQuantized(std::string name, const T& storedValues, ScalarQuantization quantization, DataType dataType_ = DataType::STANDARD);
+
   
   // Rendering helpers used by quantities
   // void populateGeometry();
@@ -125,29 +140,6 @@ public:
   // get data related to picking/selection
   VolumeGridPickResult interpretPickResult(const PickResult& result);
 
-  // === Getters and setters for visualization settings
-
-  // Color of the grid volume
-  VolumeGrid* setColor(glm::vec3 val);
-  glm::vec3 getColor();
-
-  // Color of edges
-  VolumeGrid* setEdgeColor(glm::vec3 val);
-  glm::vec3 getEdgeColor();
-
-  // Material
-  VolumeGrid* setMaterial(std::string name);
-  std::string getMaterial();
-
-  // Width of the edges. Scaled such that 1 is a reasonable weight for visible edges, but values  1 can be used for
-  // bigger edges. Use 0. to disable.
-  VolumeGrid* setEdgeWidth(double newVal);
-  double getEdgeWidth();
-
-  // Scaling factor for the size of the little cubes
-  VolumeGrid* setCubeSizeFactor(double newVal);
-  double getCubeSizeFactor();
-
 private:
   
   // Field data
@@ -160,13 +152,6 @@ private:
   std::vector<glm::vec3> gridPlaneReferenceNormalsData;
   std::vector<int32_t> gridPlaneAxisIndsData;
 
-  // === Visualization parameters
-  PersistentValue<glm::vec3> color;
-  PersistentValue<glm::vec3> edgeColor;
-  PersistentValue<std::string> material;
-  PersistentValue<float> edgeWidth;
-  PersistentValue<float> cubeSizeFactor;
-
   // == Compute indices & geometry data
   void computeGridPlaneReferenceGeometry();
   
@@ -198,6 +183,8 @@ private:
   
   VolumeGridNodeScalarQuantity* addNodeScalarQuantityImpl(std::string name, const std::vector<float>& data, DataType dataType_);
   VolumeGridCellScalarQuantity* addCellScalarQuantityImpl(std::string name, const std::vector<float>& data, DataType dataType_);
+  VolumeGridNodeScalarQuantity* addNodeScalarQuantityImpl(std::string name, QuantizedScalarArray data, DataType dataType_);
+  VolumeGridCellScalarQuantity* addCellScalarQuantityImpl(std::string name, QuantizedScalarArray data, DataType dataType_);
 
   // clang-format on
 };
@@ -185,5 +185,21 @@ VolumeGridCellScalarQuantity* VolumeGrid::addCellScalarQuantityFromBatchCallable
   return addCellScalarQuantity(name, result, dataType_);
 }
 
+template <class T>
+VolumeGridNodeScalarQuantity* VolumeGrid::addNodeScalarQuantityQuantized(std::string name, const T& storedValues,
+                                                                         ScalarQuantization quantization,
+                                                                         DataType dataType_) {
+  validateSize(storedValues, nNodes(), "grid node scalar quantity " + name);
+  return addNodeScalarQuantityImpl(name, makeQuantizedScalarArray(storedValues, quantization), dataType_);
+}
+
+template <class T>
+VolumeGridCellScalarQuantity* VolumeGrid::addCellScalarQuantityQuantized(std::string name, const T& storedValues,
+                                                                         ScalarQuantization quantization,
+                                                                         DataType dataType_) {
+  validateSize(storedValues, nCells(), "grid cell scalar quantity " + name);
+  return addCellScalarQuantityImpl(name, makeQuantizedScalarArray(storedValues, quantization), dataType_);
+}
+
 
 } // namespace polyscope
@@ -5,7 +5,11 @@
 #include "polyscope/polyscope.h"
 
 #include "polyscope/affine_remapper.h"
+#include "polyscope/grid_brick_ranges.h"
+#include "polyscope/grid_scalar_quantity.h"
 #include "polyscope/histogram.h"
+#include "polyscope/marching_cubes.h"
+#include "polyscope/raw_volume_file.h"
 #include "polyscope/render/color_maps.h"
 #include "polyscope/scalar_quantity.h"
 #include "polyscope/surface_mesh.h"
@@ -17,12 +21,24 @@ namespace polyscope {
 // ==========            Node Scalar             ==========
 // ========================================================
 
-class VolumeGridNodeScalarQuantity : public VolumeGridQuantity, public ScalarQuantity<VolumeGridNodeScalarQuantity> {
+class VolumeGridNodeScalarQuantity : public VolumeGridQuantity,
+                                     public ScalarQuantity<VolumeGridNodeScalarQuantity>,
+                                     public GridIsosurfaceQuantity<VolumeGridNodeScalarQuantity> {
 
 public:
   VolumeGridNodeScalarQuantity(std::string name, VolumeGrid& grid_, const std::vector<float>& values_,
                                DataType dataType_);
 
+  // Values streamed from a file, see VolumeGrid::addNodeScalarQuantityFromFile(). The data range and histogram are
+  // estimated from a sample of the values.
+  VolumeGridNodeScalarQuantity(std::string name, VolumeGrid& grid_, std::shared_ptr<RawVolumeFile> file_,
+                               DataType dataType_);
+
+  // Quantized values, see VolumeGrid::addNodeScalarQuantityQuantized(). The data range and histogram are estimated
+  // from a sample of the values.
+  VolumeGridNodeScalarQuantity(std::string name, VolumeGrid& grid_, QuantizedScalarArray values_,
+                               DataType dataType_);
+
   virtual void draw() override;
   virtual void buildCustomUI() override;
   virtual void refresh() override;
@@ -32,44 +48,30 @@ public:
 
   virtual bool isDrawingGridcubes() override;
 
-  // == Getters and setters
-
-  // Gridcube viz
-
-  VolumeGridNodeScalarQuantity* setGridcubeVizEnabled(bool val);
-  bool getGridcubeVizEnabled();
-
-
-  // Isosurface viz
-
-  VolumeGridNodeScalarQuantity* setIsosurfaceVizEnabled(bool val);
-  bool getIsosurfaceVizEnabled();
-
-  VolumeGridNodeScalarQuantity* setIsosurfaceLevel(float value);
-  float getIsosurfaceLevel();
-
-  VolumeGridNodeScalarQuantity* setIsosurfaceColor(glm::vec3 val);
-  glm::vec3 getIsosurfaceColor();
+  // The isosurface at the current level, shared between drawing and registerIsosurfaceAsMesh(). It is kept until the
+  // level or the values change.
+  const IsosurfaceMesh& getIsosurfaceMesh();
 
-  VolumeGridNodeScalarQuantity* setSlicePlanesAffectIsosurface(bool val);
-  bool getSlicePlanesAffectIsosurface();
-
-  SurfaceMesh* registerIsosurfaceAsMesh(std::string structureName = "");
+  // The range of values in each brick of the grid, refreshed as needed when the values change. Streamed values are
+  // read a slab at a time, and never all held in memory.
+  const GridBrickRanges& getBrickRanges();
 
 protected:
   // Visualize as a grid of cubes
-  PersistentValue<bool> gridcubeVizEnabled;
   std::shared_ptr<render::ShaderProgram> gridcubeProgram;
   void createGridcubeProgram();
 
-  // Visualize as isosurface
-  // TODO
-  PersistentValue<bool> isosurfaceVizEnabled;
-  PersistentValue<float> isosurfaceLevel;
-  PersistentValue<glm::vec3> isosurfaceColor;
-  PersistentValue<bool> slicePlanesAffectIsosurface;
-  std::shared_ptr<render::ShaderProgram> isosurfaceProgram;
-  void createIsosurfaceProgram();
+  // The extracted isosurface
+  IsosurfaceMesh isosurfaceMesh;
+  bool isosurfaceMeshValid = false;
+  float isosurfaceMeshLevel = 0.;
+  uint64_t isosurfaceMeshValuesVersion = 0;
+  void extractStreamedIsosurface(); // a slab of the grid at a time, for streamed values
+
+  // Used to skip the parts of the grid which the isosurface does not pass through. If the values were only partly
+  // updated since it was built, just the affected bricks are re-summarized.
+  GridBrickRanges brickRanges;
+  uint64_t brickRangesValuesVersion = 0;
 
   // Visualize as raymarched volume
   // TODO
@@ -80,12 +82,24 @@ protected:
 // ==========            Cell Scalar             ==========
 // ========================================================
 
-class VolumeGridCellScalarQuantity : public VolumeGridQuantity, public ScalarQuantity<VolumeGridCellScalarQuantity> {
+class VolumeGridCellScalarQuantity : public VolumeGridQuantity,
+                                     public ScalarQuantity<VolumeGridCellScalarQuantity>,
+                                     public GridScalarQuantity<VolumeGridCellScalarQuantity> {
 
 public:
   VolumeGridCellScalarQuantity(std::string name, VolumeGrid& grid_, const std::vector<float>& values_,
                                DataType dataType_);
 
+  // Values streamed from a file, see VolumeGrid::addCellScalarQuantityFromFile(). The data range and histogram are
+  // estimated from a sample of the values.
+  VolumeGridCellScalarQuantity(std::string name, VolumeGrid& grid_, std::shared_ptr<RawVolumeFile> file_,
+                               DataType dataType_);
+
+  // Quantized values, see VolumeGrid::addCellScalarQuantityQuantized(). The data range and histogram are estimated
+  // from a sample of the values.
+  VolumeGridCellScalarQuantity(std::string name, VolumeGrid& grid_, QuantizedScalarArray values_,
+                               DataType dataType_);
+
   virtual void draw() override;
   virtual void buildCustomUI() override;
   virtual void refresh() override;
@@ -95,19 +109,17 @@ public:
 
   virtual bool isDrawingGridcubes() override;
 
-  // == Getters and setters
-
-  // Gridcube viz
-
-  VolumeGridCellScalarQuantity* setGridcubeVizEnabled(bool val);
-  bool getGridcubeVizEnabled();
-
+  // The range of values in each brick of the grid, refreshed as needed when the values change. Streamed values are
+  // read a slab at a time, and never all held in memory.
+  const GridBrickRanges& getBrickRanges();
 
 protected:
   // Visualize as a grid of cubes
-  PersistentValue<bool> gridcubeVizEnabled;
   std::shared_ptr<render::ShaderProgram> gridcubeProgram;
   void createGridcubeProgram();
+
+  GridBrickRanges brickRanges;
+  uint64_t brickRangesValuesVersion = 0;
 };
 
 } // namespace polyscope
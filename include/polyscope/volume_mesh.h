@@ -14,7 +14,9 @@
 #include "polyscope/volume_mesh_scalar_quantity.h"
 #include "polyscope/volume_mesh_vector_quantity.h"
 
+#include <array>
 #include <cstdint>
+#include <future>
 #include <memory>
 #include <vector>
 
@@ -87,6 +89,11 @@ public:
   render::ManagedBuffer<glm::vec3> faceNormals;
   render::ManagedBuffer<glm::vec3> cellCenters;
 
+  // the tet decomposition, used for slicing (see tets below)
+  std::array<render::ManagedBuffer<uint32_t>, 4> tetCornerVertexInds; // the vertex at each corner of each tet [nTets]
+  render::ManagedBuffer<glm::uvec4> tetVertexInds;                    // all four vertices of each tet [nTets]
+  render::ManagedBuffer<glm::vec3> vertexPositionTexture;             // positions as a 2D texture, padded to fill it
+
   // === Quantity-related
   // clang-format off
 
@@ -125,9 +132,17 @@ public:
   size_t nFacesTriangulation() const { return nFacesTriangulationCount; }
   size_t nFaces() const { return nFacesCount; }
 
+  // The number of triangles currently in the draw buffers. Unless interior faces are being drawn (see setExteriorOnly()),
+  // this only counts exterior faces.
+  size_t nFacesTriangulationDrawn() const { return nFacesTriangulationDrawnCount; }
+
   // Derived geometric quantities
   std::vector<char> faceIsInterior; // a flat array whose order matches the iteration order of the mesh
 
+  // Connectivity between cells, populated by computeCounts(). Faces are indexed in the same flat order as above.
+  std::vector<size_t> cellFaceStart;      // the faces of cell i are [cellFaceStart[i], cellFaceStart[i+1])
+  std::vector<uint32_t> faceNeighborCell; // the cell on the other side of each face, or INVALID_IND_32 if exterior
+
   // = Mesh helpers
   VolumeCellType cellType(size_t i) const;
   void computeCounts();           // call to populate counts and indices
@@ -140,11 +155,13 @@ public:
   // TODO use a managed buffer for this
   std::vector<std::array<uint32_t, 4>> tets;
   size_t nTets();
-  void computeTets();    // fills tet buffer
-  void ensureHaveTets(); //  ensure the tet buffer is filled (but don't rebuild if already done)
+  void computeTets();             // fills tet buffer
+  void ensureHaveTets();          //  ensure the tet buffer is filled (but don't rebuild if already done)
+  void computeTetsInBackground(); // start filling the tet buffer on another thread (the above wait for it)
 
   // get data related to picking/selection
   VolumeMeshPickResult interpretPickResult(const PickResult& result);
+  std::vector<VolumeMeshPickResult> interpretPickResult(const RegionPickResult& result); // one per picked element
 
   // === Member variables ===
   static const std::string structureTypeName;
@@ -172,6 +189,21 @@ public:
   VolumeMesh* setEdgeWidth(double newVal);
   double getEdgeWidth();
 
+  // How slices get the positions of each tet. Attributes expands the positions out to each tet corner on the device,
+  // while PositionTexture uploads only the tet vertex indices and looks positions up in a texture, which takes much less
+  // memory for large meshes. Level sets always use Attributes.
+  VolumeMesh* setSliceMode(VolumeMeshSliceMode newMode);
+  VolumeMeshSliceMode getSliceMode();
+
+  // If true, only the exterior faces of the mesh are built and drawn, and interior faces are generated only while a
+  // slice plane cuts this mesh or the mesh is transparent (otherwise they can never be seen). If false, interior faces
+  // are always drawn.
+  VolumeMesh* setExteriorOnly(bool newVal);
+  bool getExteriorOnly();
+
+  // As Structure::setTransparency(), also building or dropping the interior faces (see setExteriorOnly())
+  virtual Structure* setTransparency(float newVal) override;
+
   VolumeMeshVertexScalarQuantity* getLevelSetQuantity();
   void setLevelSetQuantity(VolumeMeshVertexScalarQuantity* _levelSet);
 
@@ -179,6 +211,7 @@ public:
   void setVolumeMeshUniforms(render::ShaderProgram& p);
   void fillGeometryBuffers(render::ShaderProgram& p);
   void fillSliceGeometryBuffers(render::ShaderProgram& p);
+  std::string getSliceProgramName(); // the program to request for drawing slices, according to the slice mode
   static const std::vector<std::vector<std::array<size_t, 3>>>& cellStencil(VolumeCellType type);
 
   // Slice plane listeners
@@ -189,6 +222,8 @@ public:
 
 
 private:
+  VolumeMeshPickResult interpretPickIndex(uint64_t localIndex);
+
   // == Mesh geometry buffers
   // Storage for the managed buffers above. You should generally interact with these through the managed buffers, not
   // these members.
@@ -210,12 +245,19 @@ private:
   std::vector<glm::vec3> faceNormalsData;
   std::vector<glm::vec3> cellCentersData;
 
+  // tet decomposition
+  std::array<std::vector<uint32_t>, 4> tetCornerVertexIndsData;
+  std::vector<glm::uvec4> tetVertexIndsData;
+  std::vector<glm::vec3> vertexPositionTextureData;
+
   // Visualization settings
   PersistentValue<glm::vec3> color;
   PersistentValue<glm::vec3> interiorColor;
   PersistentValue<glm::vec3> edgeColor;
   PersistentValue<std::string> material;
   PersistentValue<float> edgeWidth;
+  PersistentValue<VolumeMeshSliceMode> sliceMode;
+  PersistentValue<bool> exteriorOnly;
 
   // Level sets
   // TODO: not currently really supported
@@ -228,6 +270,11 @@ private:
   void geometryChanged();
   void recomputeGeometryIfPopulated();
 
+  // Interior faces in the draw buffers
+  bool interiorFacesBuilt = false;
+  bool wantsInteriorFaces();             // true if interior faces could be visible right now
+  void ensureInteriorFacesMatchSlicing(); // rebuild the draw buffers if the above has changed
+
   // Picking-related
   // Order of indexing: vertices, cells
   // Within each set, uses the implicit ordering from the mesh data structure
@@ -239,6 +286,9 @@ private:
   /// == Compute indices & geometry data
   void computeFaceNormals();
   void computeCellCenters();
+  void computeTetCornerVertexInds(int iCorner);
+  void computeTetVertexInds();
+  void computeVertexPositionTexture();
 
   // Gui implementation details
 
@@ -248,8 +298,15 @@ private:
 
   // Internal members
   size_t nFacesTriangulationCount = 0;
+  size_t nFacesTriangulationDrawnCount = 0;
   size_t nFacesCount = 0;
 
+  // Tets built by computeTetsInBackground(), which are moved to the tet buffer once the task finishes. The task must be
+  // declared after everything it touches, so that it is destroyed (which waits for it) first.
+  std::vector<std::array<uint32_t, 4>> buildTets() const;
+  std::vector<std::array<uint32_t, 4>> backgroundTetsResult;
+  std::future<void> backgroundTetsTask;
+
   // === Helper functions
 
   // Initialization work
@@ -9,8 +9,12 @@
 #include "polyscope/render/color_maps.h"
 #include "polyscope/render/engine.h"
 #include "polyscope/scalar_quantity.h"
+#include "polyscope/surface_mesh.h"
 #include "polyscope/volume_mesh.h"
 
+#include <array>
+#include <list>
+
 namespace polyscope {
 
 class VolumeMeshScalarQuantity : public VolumeMeshQuantity, public ScalarQuantity<VolumeMeshScalarQuantity> {
@@ -36,6 +40,13 @@ protected:
 // ==========           Vertex Scalar            ==========
 // ========================================================
 
+// A level set of a vertex scalar quantity, extracted as a triangle mesh. Vertices which lie on the same edge of the tet
+// mesh are shared between triangles, and triangles face towards larger values.
+struct VolumeMeshLevelSetMesh {
+  std::vector<glm::vec3> vertices;
+  std::vector<std::array<uint32_t, 3>> triangles;
+};
+
 class VolumeMeshVertexScalarQuantity : public VolumeMeshScalarQuantity {
 public:
   VolumeMeshVertexScalarQuantity(std::string name, const std::vector<float>& values_, VolumeMesh& mesh_,
@@ -55,6 +66,14 @@ public:
 
   void fillSliceColorBuffers(render::ShaderProgram& p);
 
+  // Extract the level set at isoValue on the CPU, by marching over the tets of the mesh. This does not need any
+  // rendering, so it works in headless runs. The results for the last few isoValues are cached, until the values or
+  // the vertex positions change. The returned reference is only valid until the next call.
+  const VolumeMeshLevelSetMesh& computeLevelSetMesh(float isoValue);
+
+  // Register the level set at the current level set value (see setLevelSetValue()) as a surface mesh
+  SurfaceMesh* registerLevelSetAsMesh(std::string structureName = "");
+
   virtual void buildCustomUI() override;
   virtual void buildScalarOptionsUI() override;
   void buildVertexInfoGUI(size_t vInd) override;
@@ -65,6 +84,15 @@ public:
   float levelSetValue;
   bool isDrawingLevelSet;
   VolumeMeshVertexScalarQuantity* showQuantity;
+
+private:
+  std::shared_ptr<render::ShaderProgram> createLevelSetProgram();
+
+  // Level set meshes from computeLevelSetMesh(), most recently used first, along with the data versions they were
+  // computed from
+  std::list<std::pair<float, VolumeMeshLevelSetMesh>> levelSetMeshCache;
+  uint64_t levelSetMeshCacheValuesVersion = 0;
+  uint64_t levelSetMeshCachePositionsVersion = 0;
 };
 
 
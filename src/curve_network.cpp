@@ -534,21 +534,40 @@ CurveNetworkPickResult CurveNetwork::interpretPickResult(const PickResult& rawRe
     exception("called interpretPickResult(), but the pick result is not from this structure");
   }
 
+  return interpretPickIndex(rawResult.localIndex, rawResult.position);
+}
+
+std::vector<CurveNetworkPickResult> CurveNetwork::interpretPickResult(const RegionPickResult& rawResult) {
+
+  if (rawResult.structure != this) {
+    exception("called interpretPickResult(), but the pick result is not from this structure");
+  }
+
+  std::vector<CurveNetworkPickResult> results;
+  results.reserve(rawResult.localIndices.size());
+  for (size_t i = 0; i < rawResult.localIndices.size(); i++) {
+    results.push_back(interpretPickIndex(rawResult.localIndices[i], rawResult.positions[i]));
+  }
+  return results;
+}
+
+CurveNetworkPickResult CurveNetwork::interpretPickIndex(uint64_t localIndex, glm::vec3 position) {
+
   CurveNetworkPickResult result;
 
-  if (rawResult.localIndex < nNodes()) {
+  if (localIndex < nNodes()) {
     result.elementType = CurveNetworkElement::NODE;
-    result.index = rawResult.localIndex;
-  } else if (rawResult.localIndex < nNodes() + nEdges()) {
+    result.index = localIndex;
+  } else if (localIndex < nNodes() + nEdges()) {
     result.elementType = CurveNetworkElement::EDGE;
-    result.index = rawResult.localIndex - nNodes();
+    result.index = localIndex - nNodes();
 
     // compute the t \in [0,1] along the edge
     int32_t iStart = edgeTailInds.getValue(result.index);
     int32_t iEnd = edgeTipInds.getValue(result.index);
     glm::vec3 pStart = nodePositions.getValue(iStart);
     glm::vec3 pEnd = nodePositions.getValue(iEnd);
-    result.tEdge = computeTValAlongLine(rawResult.position, pStart, pEnd);
+    result.tEdge = computeTValAlongLine(position, pStart, pEnd);
   } else {
     exception("Bad pick index in curve network");
   }
@@ -0,0 +1,267 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#include "polyscope/grid_brick_ranges.h"
+
+#include "polyscope/messages.h"
+#include "polyscope/parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+
+namespace polyscope {
+
+const uint32_t GridBrickRanges::brickSize;
+
+namespace {
+
+// Widen [minVal, maxVal] to hold the values in the box [start, end) of a grid with valueDim values along each axis,
+// of which only the z layers from zOffset on are stored in `values`. A NaN value widens it to [-inf, inf].
+void extendRange(const float* values, glm::uvec3 valueDim, uint32_t zOffset, glm::uvec3 start, glm::uvec3 end,
+                 float& minVal, float& maxVal) {
+  for (uint32_t z = start.z; z < end.z; z++) {
+    for (uint32_t y = start.y; y < end.y; y++) {
+      size_t rowStart = (static_cast<size_t>(z - zOffset) * valueDim.y + y) * valueDim.x;
+      for (uint32_t x = start.x; x < end.x; x++) {
+        float v = values[rowStart + x];
+        if (std::isnan(v)) {
+          minVal = -std::numeric_limits<float>::infinity();
+          maxVal = std::numeric_limits<float>::infinity();
+          return;
+        }
+        minVal = std::min(minVal, v);
+        maxVal = std::max(maxVal, v);
+      }
+    }
+  }
+}
+
+} // namespace
+
+void GridBrickRanges::build(const std::vector<float>& values, glm::uvec3 valueDim_, bool valuesOnNodes_) {
+  if (values.size() != static_cast<size_t>(valueDim_.x) * valueDim_.y * valueDim_.z) {
+    exception("grid brick ranges built from " + std::to_string(values.size()) +
+              " values, which does not match the grid");
+  }
+
+  setLayout(valueDim_, valuesOnNodes_);
+  brickMin.resize(nBricks());
+  brickMax.resize(nBricks());
+  parallelFor(
+      nBricks(), [&](size_t iBrick) { summarizeBrick(values, iBrick); }, 1);
+  built = true;
+}
+
+void GridBrickRanges::update(const std::vector<float>& values,
+                             const std::vector<std::array<size_t, 2>>& changedRanges) {
+  if (!isBuilt() || values.size() != static_cast<size_t>(valueDim.x) * valueDim.y * valueDim.z) {
+    exception("grid brick ranges updated with values which do not match the grid they were built for");
+  }
+  if (nBricks() == 0) return;
+
+  // If most values changed, it is simpler to start over
+  size_t nChanged = 0;
+  for (const std::array<size_t, 2>& r : changedRanges) nChanged += r[1] - r[0];
+  if (nChanged > values.size() / 4) {
+    build(values, valueDim, valuesOnNodes);
+    return;
+  }
+
+  // The bricks which hold a value at coordinate c along an axis. A node on the boundary between two bricks belongs to
+  // both of them.
+  auto brickLo = [&](uint32_t c, int axis) {
+    if (valuesOnNodes && c > 0) c--;
+    return std::min(c / brickSize, brickDim[axis] - 1);
+  };
+  auto brickHi = [&](uint32_t c, int axis) { return std::min(c / brickSize, brickDim[axis] - 1); };
+
+  // Flag the bricks touched by each row of changed values
+  std::vector<char> brickChanged(nBricks(), false);
+  for (const std::array<size_t, 2>& r : changedRanges) {
+    if (r[0] >= r[1]) continue;
+    size_t rowFirst = r[0] / valueDim.x;
+    size_t rowLast = (r[1] - 1) / valueDim.x;
+    for (size_t row = rowFirst; row <= rowLast; row++) {
+      uint32_t y = static_cast<uint32_t>(row % valueDim.y);
+      uint32_t z = static_cast<uint32_t>(row / valueDim.y);
+      uint32_t xFirst = (row == rowFirst) ? static_cast<uint32_t>(r[0] % valueDim.x) : 0;
+      uint32_t xLast = (row == rowLast) ? static_cast<uint32_t>((r[1] - 1) % valueDim.x) : valueDim.x - 1;
+      for (uint32_t bz = brickLo(z, 2); bz <= brickHi(z, 2); bz++) {
+        for (uint32_t by = brickLo(y, 1); by <= brickHi(y, 1); by++) {
+          for (uint32_t bx = brickLo(xFirst, 0); bx <= brickHi(xLast, 0); bx++) {
+            brickChanged[brickIndex(glm::uvec3{bx, by, bz})] = true;
+          }
+        }
+      }
+    }
+  }
+
+  std::vector<size_t> changedBricks;
+  for (size_t iBrick = 0; iBrick < nBricks(); iBrick++) {
+    if (brickChanged[iBrick]) changedBricks.push_back(iBrick);
+  }
+  parallelFor(
+      changedBricks.size(), [&](size_t i) { summarizeBrick(values, changedBricks[i]); }, 1);
+}
+
+void GridBrickRanges::buildFromSlabs(glm::uvec3 valueDim_, bool valuesOnNodes_, size_t maxSlabValues,
+                                     const std::function<void(size_t, size_t, float*)>& readValues) {
+  setLayout(valueDim_, valuesOnNodes_);
+  brickMin.assign(nBricks(), std::numeric_limits<float>::infinity());
+  brickMax.assign(nBricks(), -std::numeric_limits<float>::infinity());
+  built = true;
+  if (nBricks() == 0) return;
+
+  const size_t layerSize = static_cast<size_t>(valueDim.x) * valueDim.y;
+  const uint32_t slabLayers = static_cast<uint32_t>(
+      std::min<size_t>(std::max<size_t>(maxSlabValues / layerSize, 1), valueDim.z));
+  const size_t bricksPerLayer = static_cast<size_t>(brickDim.x) * brickDim.y;
+
+  std::vector<float> slabValues;
+  for (uint32_t zStart = 0; zStart < valueDim.z; zStart += slabLayers) {
+    uint32_t zEnd = std::min(zStart + slabLayers, valueDim.z);
+    slabValues.resize(layerSize * (zEnd - zStart));
+    readValues(zStart * layerSize, slabValues.size(), slabValues.data());
+
+    // The layers of bricks which hold these values. A node on the boundary between two bricks belongs to both.
+    uint32_t zLo = (valuesOnNodes && zStart > 0) ? zStart - 1 : zStart;
+    uint32_t bzFirst = std::min(zLo / brickSize, brickDim.z - 1);
+    uint32_t bzLast = std::min((zEnd - 1) / brickSize, brickDim.z - 1);
+
+    // each brick is widened by just one thread
+    parallelFor(
+        (bzLast - bzFirst + 1) * bricksPerLayer,
+        [&](size_t i) {
+          size_t iBrick = bzFirst * bricksPerLayer + i;
+          glm::uvec3 start, end;
+          brickCellRange(iBrick, start, end);
+          if (valuesOnNodes) end += 1u;
+          start.z = std::max(start.z, zStart);
+          end.z = std::min(end.z, zEnd);
+          if (start.z >= end.z) return;
+          extendRange(slabValues.data(), valueDim, zStart, start, end, brickMin[iBrick], brickMax[iBrick]);
+        },
+        1);
+  }
+}
+
+GridBrickRanges GridBrickRanges::sliceZ(uint32_t cellZStart, uint32_t cellZEnd) const {
+  if (!isBuilt() || cellZStart > cellZEnd || cellZEnd > cellDim.z) {
+    exception("grid brick ranges sliced outside of the grid they were built for");
+  }
+
+  GridBrickRanges slice;
+  glm::uvec3 sliceValueDim = valueDim;
+  sliceValueDim.z = (cellZEnd - cellZStart) + (valuesOnNodes ? 1 : 0);
+  slice.setLayout(sliceValueDim, valuesOnNodes);
+  slice.brickMin.assign(slice.nBricks(), std::numeric_limits<float>::infinity());
+  slice.brickMax.assign(slice.nBricks(), -std::numeric_limits<float>::infinity());
+  slice.built = true;
+
+  for (size_t iSliceBrick = 0; iSliceBrick < slice.nBricks(); iSliceBrick++) {
+    glm::uvec3 b = slice.brickCoords(iSliceBrick);
+    glm::uvec3 cellStart, cellEnd;
+    slice.brickCellRange(iSliceBrick, cellStart, cellEnd);
+
+    // the bricks of this table holding the same cells, which hold all of the values of those cells
+    uint32_t bzFirst = (cellZStart + cellStart.z) / brickSize;
+    uint32_t bzLast = (cellZStart + cellEnd.z - 1) / brickSize;
+    for (uint32_t bz = bzFirst; bz <= bzLast; bz++) {
+      size_t iBrick = brickIndex(glm::uvec3{b.x, b.y, bz});
+      slice.brickMin[iSliceBrick] = std::min(slice.brickMin[iSliceBrick], brickMin[iBrick]);
+      slice.brickMax[iSliceBrick] = std::max(slice.brickMax[iSliceBrick], brickMax[iBrick]);
+    }
+  }
+
+  return slice;
+}
+
+void GridBrickRanges::buildFromBricks(size_t nBricks,
+                                      const std::function<void(size_t, std::vector<float>&)>& readBrick) {
+  valueDim = glm::uvec3{0, 0, 0};
+  cellDim = glm::uvec3{0, 0, 0};
+  brickDim = glm::uvec3{static_cast<uint32_t>(nBricks), 1, 1};
+
+  brickMin.resize(nBricks);
+  brickMax.resize(nBricks);
+  parallelFor(
+      nBricks,
+      [&](size_t iBrick) {
+        std::vector<float> brickValues;
+        readBrick(iBrick, brickValues);
+
+        float minVal = std::numeric_limits<float>::infinity();
+        float maxVal = -std::numeric_limits<float>::infinity();
+        for (float v : brickValues) {
+          if (std::isnan(v)) {
+            minVal = -std::numeric_limits<float>::infinity();
+            maxVal = std::numeric_limits<float>::infinity();
+            break;
+          }
+          minVal = std::min(minVal, v);
+          maxVal = std::max(maxVal, v);
+        }
+        brickMin[iBrick] = minVal;
+        brickMax[iBrick] = maxVal;
+      },
+      1);
+  built = true;
+}
+
+void GridBrickRanges::setLayout(glm::uvec3 valueDim_, bool valuesOnNodes_) {
+  valueDim = valueDim_;
+  valuesOnNodes = valuesOnNodes_;
+  for (int i = 0; i < 3; i++) {
+    cellDim[i] = (valuesOnNodes && valueDim[i] > 0) ? valueDim[i] - 1 : valueDim[i];
+  }
+  brickDim = (cellDim + (brickSize - 1)) / brickSize;
+}
+
+void GridBrickRanges::summarizeBrick(const std::vector<float>& values, size_t iBrick) {
+  glm::uvec3 start, end;
+  brickCellRange(iBrick, start, end);
+  if (valuesOnNodes) end += 1u;
+
+  float minVal = std::numeric_limits<float>::infinity();
+  float maxVal = -std::numeric_limits<float>::infinity();
+  extendRange(values.data(), valueDim, 0, start, end, minVal, maxVal);
+  brickMin[iBrick] = minVal;
+  brickMax[iBrick] = maxVal;
+}
+
+bool GridBrickRanges::isBuilt() const { return built; }
+
+glm::uvec3 GridBrickRanges::getBrickDim() const { return brickDim; }
+
+size_t GridBrickRanges::nBricks() const { return static_cast<size_t>(brickDim.x) * brickDim.y * brickDim.z; }
+
+glm::uvec3 GridBrickRanges::brickCoords(size_t iBrick) const {
+  return glm::uvec3{static_cast<uint32_t>(iBrick % brickDim.x),
+                    static_cast<uint32_t>((iBrick / brickDim.x) % brickDim.y),
+                    static_cast<uint32_t>(iBrick / (static_cast<size_t>(brickDim.x) * brickDim.y))};
+}
+
+size_t GridBrickRanges::brickIndex(glm::uvec3 brick) const {
+  return (static_cast<size_t>(brick.z) * brickDim.y + brick.y) * brickDim.x + brick.x;
+}
+
+void GridBrickRanges::brickCellRange(size_t iBrick, glm::uvec3& cellStart, glm::uvec3& cellEnd) const {
+  glm::uvec3 b = brickCoords(iBrick);
+  cellStart = b * brickSize;
+  for (int i = 0; i < 3; i++) cellEnd[i] = std::min(cellStart[i] + brickSize, cellDim[i]);
+}
+
+float GridBrickRanges::getBrickMin(size_t iBrick) const { return brickMin[iBrick]; }
+
+float GridBrickRanges::getBrickMax(size_t iBrick) const { return brickMax[iBrick]; }
+
+bool GridBrickRanges::brickStraddles(size_t iBrick, float level) const {
+  return brickMin[iBrick] < level && brickMax[iBrick] >= level;
+}
+
+bool GridBrickRanges::brickOverlaps(size_t iBrick, float low, float high) const {
+  return brickMin[iBrick] <= high && brickMax[iBrick] >= low;
+}
+
+} // namespace polyscope
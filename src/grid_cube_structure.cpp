@@ -0,0 +1,231 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#include "polyscope/grid_cube_structure.h"
+
+#include "polyscope/color_management.h"
+#include "polyscope/sparse_volume_grid.h"
+#include "polyscope/volume_grid.h"
+
+#include "imgui.h"
+
+#include <array>
+
+namespace polyscope {
+
+template <typename S>
+GridCubeStructure<S>::GridCubeStructure(std::string name, std::string subtypeName)
+    : QuantityStructure<S>(name, subtypeName),
+
+      // == persistent options
+      // (these spell out uniquePrefix(), which cannot be called before the derived structure is constructed)
+      // clang-format off
+      color(                  subtypeName + "#" + name + "#color",             getNextUniqueColor()),
+      edgeColor(              subtypeName + "#" + name + "#edgeColor",         glm::vec3{0., 0., 0.}),
+      material(               subtypeName + "#" + name + "#material",          "clay"),
+      edgeWidth(              subtypeName + "#" + name + "#edgeWidth",         0.f),
+      cubeSizeFactor(         subtypeName + "#" + name + "#cubeSizeFactor",    0.f)
+// clang-format on
+{}
+
+template <typename S>
+void GridCubeStructure<S>::buildColorAndEdgeUI() {
+
+  { // Colors
+    if (ImGui::ColorEdit3("Color", &color.get()[0], ImGuiColorEditFlags_NoInputs)) setColor(color.get());
+    ImGui::SameLine();
+  }
+
+
+  { // Edge options
+    ImGui::SameLine();
+    ImGui::PushItemWidth(100 * options::uiScale);
+    if (edgeWidth.get() == 0.) {
+      bool showEdges = false;
+      if (ImGui::Checkbox("Edges", &showEdges)) {
+        setEdgeWidth(1.);
+      }
+    } else {
+      bool showEdges = true;
+      if (ImGui::Checkbox("Edges", &showEdges)) {
+        setEdgeWidth(0.);
+      }
+
+      // Edge color
+      ImGui::PushItemWidth(100 * options::uiScale);
+      if (ImGui::ColorEdit3("Edge Color", &edgeColor.get()[0], ImGuiColorEditFlags_NoInputs))
+        setEdgeColor(edgeColor.get());
+      ImGui::PopItemWidth();
+
+      // Edge width
+      ImGui::SameLine();
+      ImGui::PushItemWidth(75 * options::uiScale);
+      if (ImGui::SliderFloat("Width", &edgeWidth.get(), 0.001, 2.)) {
+        // NOTE: this intentionally circumvents the setEdgeWidth() setter to avoid repopulating the buffer as the
+        // slider is dragged---otherwise we repopulate the buffer on every change, which mostly works fine. This is a
+        // lazy solution instead of better state/buffer management. setEdgeWidth(getEdgeWidth());
+        edgeWidth.manuallyChanged();
+        requestRedraw();
+      }
+      ImGui::PopItemWidth();
+    }
+    ImGui::PopItemWidth();
+  }
+}
+
+template <typename S>
+void GridCubeStructure<S>::buildCustomOptionsUI() {
+  if (render::buildMaterialOptionsGui(material.get())) {
+    material.manuallyChanged();
+    setMaterial(material.get()); // trigger the other updates that happen on set()
+  }
+
+  // Shrinky effect
+  if (ImGui::SliderFloat("Cell Shrink", &cubeSizeFactor.get(), 0.0, 1., "%.3f", ImGuiSliderFlags_Logarithmic)) {
+    cubeSizeFactor.manuallyChanged();
+    requestRedraw();
+  }
+}
+
+template <typename S>
+void GridCubeStructure<S>::fillGridPlaneReferenceGeometry(glm::uvec3 cellDim,
+                                                          render::ManagedBuffer<glm::vec3>& positions,
+                                                          render::ManagedBuffer<glm::vec3>& normals,
+                                                          render::ManagedBuffer<int32_t>& axisInds) {
+
+  // NOTE: This slightly abuses the ManagedBuffer 'compute()' func,
+  // by computing the data for multiple buffers with one function.
+  // For now at least, it will work fine.
+
+  // Geometry is defined in the reference [0,1] cube
+
+  positions.data.clear();
+  normals.data.clear();
+  axisInds.data.clear();
+
+  auto addPlane = [&](std::array<glm::vec3, 4> corners, glm::vec3 normal, uint32_t axInd) {
+    // first triangle
+    positions.data.push_back(corners[0]);
+    positions.data.push_back(corners[1]);
+    positions.data.push_back(corners[2]);
+    for (int32_t j = 0; j < 3; j++) normals.data.push_back(normal);
+    for (int32_t j = 0; j < 3; j++) axisInds.data.push_back(axInd);
+
+    // second triangle
+    positions.data.push_back(corners[1]);
+    positions.data.push_back(corners[3]);
+    positions.data.push_back(corners[2]);
+    for (int32_t j = 0; j < 3; j++) normals.data.push_back(normal);
+    for (int32_t j = 0; j < 3; j++) axisInds.data.push_back(axInd);
+  };
+
+  // The planes are intentionally added in order such that the outermost planes come first, and we don't massively
+  // overshade from back to front. Note that fthe first look runs backwards.
+
+  // Forward facing planes
+  for (uint32_t d = 0; d < 3; d++) { // x/y/z dimension (plane is perpendicular)
+    for (int32_t i = (int32_t)cellDim[d] - 1; i >= 0; i--) {
+
+      float t = (static_cast<float>(i) + 1) / (cellDim[d]);
+
+      // clang-format off
+      glm::vec3 ll{0.f, 0.f, 0.f}; ll[(d+1)%3] = 0.f; ll[(d+2)%3] = 0.f; ll[d] = t;
+      glm::vec3 lu{0.f, 0.f, 0.f}; lu[(d+1)%3] = 1.f; lu[(d+2)%3] = 0.f; lu[d] = t;
+      glm::vec3 ul{0.f, 0.f, 0.f}; ul[(d+1)%3] = 0.f; ul[(d+2)%3] = 1.f; ul[d] = t;
+      glm::vec3 uu{0.f, 0.f, 0.f}; uu[(d+1)%3] = 1.f; uu[(d+2)%3] = 1.f; uu[d] = t;
+
+      glm::vec3 n{0.f, 0.f, 0.f}; n[d] = 1.f;
+      // clang-format on
+
+      addPlane({ll, lu, ul, uu}, n, i);
+    }
+  }
+
+  // Backward facing planes
+  for (uint32_t d = 0; d < 3; d++) { // x/y/z dimension (plane is perpendicular)
+    for (int32_t i = 0; i < (int32_t)cellDim[d]; i++) {
+
+      float t = (static_cast<float>(i)) / (cellDim[d]);
+
+      // clang-format off
+      glm::vec3 ll{0.f, 0.f, 0.f}; ll[(d+1)%3] = 0.f; ll[(d+2)%3] = 0.f; ll[d] = t;
+      glm::vec3 lu{0.f, 0.f, 0.f}; lu[(d+1)%3] = 1.f; lu[(d+2)%3] = 0.f; lu[d] = t;
+      glm::vec3 ul{0.f, 0.f, 0.f}; ul[(d+1)%3] = 0.f; ul[(d+2)%3] = 1.f; ul[d] = t;
+      glm::vec3 uu{0.f, 0.f, 0.f}; uu[(d+1)%3] = 1.f; uu[(d+2)%3] = 1.f; uu[d] = t;
+
+      glm::vec3 n{0.f, 0.f, 0.f}; n[d] = -1.f;
+      // clang-format on
+
+      addPlane({ul, uu, ll, lu}, n, i); // winding is opposite here
+    }
+  }
+
+
+  positions.markHostBufferUpdated();
+  normals.markHostBufferUpdated();
+  axisInds.markHostBufferUpdated();
+}
+
+// === Option getters and setters
+
+template <typename S>
+S* GridCubeStructure<S>::setColor(glm::vec3 val) {
+  color = val;
+  requestRedraw();
+  return derived();
+}
+template <typename S>
+glm::vec3 GridCubeStructure<S>::getColor() {
+  return color.get();
+}
+
+template <typename S>
+S* GridCubeStructure<S>::setEdgeColor(glm::vec3 val) {
+  edgeColor = val;
+  requestRedraw();
+  return derived();
+}
+template <typename S>
+glm::vec3 GridCubeStructure<S>::getEdgeColor() {
+  return edgeColor.get();
+}
+
+template <typename S>
+S* GridCubeStructure<S>::setMaterial(std::string m) {
+  material = m;
+  this->refresh();
+  requestRedraw();
+  return derived();
+}
+template <typename S>
+std::string GridCubeStructure<S>::getMaterial() {
+  return material.get();
+}
+
+template <typename S>
+S* GridCubeStructure<S>::setEdgeWidth(double newVal) {
+  edgeWidth = newVal;
+  this->refresh();
+  requestRedraw();
+  return derived();
+}
+template <typename S>
+double GridCubeStructure<S>::getEdgeWidth() {
+  return edgeWidth.get();
+}
+
+template <typename S>
+S* GridCubeStructure<S>::setCubeSizeFactor(double newVal) {
+  cubeSizeFactor = newVal;
+  requestRedraw();
+  return derived();
+}
+template <typename S>
+double GridCubeStructure<S>::getCubeSizeFactor() {
+  return cubeSizeFactor.get();
+}
+
+// Explicit instantiations
+template class GridCubeStructure<VolumeGrid>;
+template class GridCubeStructure<SparseVolumeGrid>;
+
+} // namespace polyscope
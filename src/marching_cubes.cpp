@@ -1,2 +1,244 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
 #define MC_IMPLEM_ENABLE
 #include "MarchingCube/MC.h"
+
+#include "polyscope/marching_cubes.h"
+
+#include "polyscope/messages.h"
+#include "polyscope/parallel.h"
+#include "polyscope/utilities.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace polyscope {
+
+namespace {
+
+// Cells along each side of the bricks which are extracted in parallel, the same as the bricks of GridBrickRanges
+const uint32_t brickSize = GridBrickRanges::brickSize;
+
+// The cube conventions of the triangle table in MarchingCube/MC.h, in terms of our grid axes. That library indexes its
+// field with its last axis fastest, so its x and z axes are swapped relative to ours.
+const glm::uvec3 cubeCornerOffset[8] = {{0, 0, 0}, {0, 0, 1}, {0, 1, 0}, {0, 1, 1},
+                                        {1, 0, 0}, {1, 0, 1}, {1, 1, 0}, {1, 1, 1}};
+const glm::uvec3 cubeEdgeOffset[12] = {{0, 0, 0}, {0, 1, 0}, {1, 0, 0}, {1, 1, 0}, {0, 0, 0}, {0, 0, 1},
+                                       {1, 0, 0}, {1, 0, 1}, {0, 0, 0}, {0, 0, 1}, {0, 1, 0}, {0, 1, 1}};
+const int cubeEdgeAxis[12] = {2, 2, 2, 2, 1, 1, 1, 1, 0, 0, 0, 0};
+
+// The output of one brick. Each brick owns the vertices on the grid edges which start at its nodes, stored in order of
+// their keys (see below).
+struct IsosurfaceBrick {
+  std::vector<uint64_t> edgeKeys;
+  std::vector<glm::vec3> vertices;
+  std::vector<uint32_t> indices; // into the vertices of all bricks
+};
+
+} // namespace
+
+void marchingCubes(const std::vector<float>& values, glm::uvec3 gridNodeDim, glm::vec3 boundMin, glm::vec3 boundMax,
+                   float isoValue, IsosurfaceMesh& result, const GridBrickRanges* brickRanges,
+                   std::vector<uint64_t>* vertexEdgeKeys) {
+
+  result.vertices.clear();
+  result.indices.clear();
+  if (vertexEdgeKeys != nullptr) vertexEdgeKeys->clear();
+  if (gridNodeDim.x < 2 || gridNodeDim.y < 2 || gridNodeDim.z < 2) return;
+  if (values.size() != static_cast<size_t>(gridNodeDim.x) * gridNodeDim.y * gridNodeDim.z) {
+    exception("marching cubes values have size " + std::to_string(values.size()) + ", which does not match the grid");
+  }
+
+  const glm::uvec3 cellDim = gridNodeDim - 1u;
+  const glm::vec3 spacing = (boundMax - boundMin) / glm::vec3(cellDim);
+  const glm::uvec3 brickDim = (cellDim + (brickSize - 1)) / brickSize;
+  const size_t nBricks = static_cast<size_t>(brickDim.x) * brickDim.y * brickDim.z;
+  if (brickRanges != nullptr && (!brickRanges->isBuilt() || brickRanges->getBrickDim() != brickDim)) {
+    exception("marching cubes brick ranges do not match the grid");
+  }
+
+  // A brick which the isosurface does not pass through has no crossing edges among its nodes, so it neither owns any
+  // vertices nor emits any triangles
+  auto skipBrick = [&](size_t iBrick) {
+    return brickRanges != nullptr && !brickRanges->brickStraddles(iBrick, isoValue);
+  };
+
+  auto valueAt = [&](glm::uvec3 node) {
+    return values[static_cast<uint64_t>(gridNodeDim.x) * gridNodeDim.y * node.z +
+                  static_cast<uint64_t>(gridNodeDim.x) * node.y + node.x] -
+           isoValue;
+  };
+  auto brickCoords = [&](size_t iBrick) {
+    return glm::uvec3{static_cast<uint32_t>(iBrick % brickDim.x),
+                      static_cast<uint32_t>((iBrick / brickDim.x) % brickDim.y),
+                      static_cast<uint32_t>(iBrick / (static_cast<size_t>(brickDim.x) * brickDim.y))};
+  };
+
+  // Each node belongs to one brick, with the last brick along each axis also taking the final layer of nodes. Edges
+  // are keyed by their lower node relative to the start of its brick, and their axis.
+  auto ownerBrick = [&](glm::uvec3 node) {
+    glm::uvec3 b;
+    for (int i = 0; i < 3; i++) b[i] = std::min(node[i] / brickSize, brickDim[i] - 1);
+    return b;
+  };
+  auto edgeKey = [&](glm::uvec3 node, glm::uvec3 brick, int axis) {
+    const uint64_t stride = brickSize + 1;
+    glm::uvec3 local = node - brick * brickSize;
+    return ((local.z * stride + local.y) * stride + local.x) * 3 + axis;
+  };
+
+  std::vector<IsosurfaceBrick> bricks(nBricks);
+
+  // == Place a vertex on each edge crossing the isosurface, in the brick which owns it
+  parallelFor(
+      nBricks,
+      [&](size_t iBrick) {
+        if (skipBrick(iBrick)) return;
+        IsosurfaceBrick& brick = bricks[iBrick];
+        glm::uvec3 b = brickCoords(iBrick);
+        glm::uvec3 nodeStart = b * brickSize;
+        glm::uvec3 nodeEnd;
+        for (int i = 0; i < 3; i++) nodeEnd[i] = (b[i] + 1 == brickDim[i]) ? gridNodeDim[i] : (b[i] + 1) * brickSize;
+
+        for (uint32_t z = nodeStart.z; z < nodeEnd.z; z++) {
+          for (uint32_t y = nodeStart.y; y < nodeEnd.y; y++) {
+            for (uint32_t x = nodeStart.x; x < nodeEnd.x; x++) {
+              glm::uvec3 node{x, y, z};
+              float vA = valueAt(node);
+              for (int axis = 0; axis < 3; axis++) {
+                if (node[axis] + 1 == gridNodeDim[axis]) continue;
+                glm::uvec3 nodeB = node;
+                nodeB[axis]++;
+                float vB = valueAt(nodeB);
+                if ((vA < 0) == (vB < 0)) continue;
+
+                glm::vec3 pos = boundMin + glm::vec3(node) * spacing;
+                pos[axis] += spacing[axis] * vA / (vA - vB);
+                brick.edgeKeys.push_back(edgeKey(node, b, axis));
+                brick.vertices.push_back(pos);
+              }
+            }
+          }
+        }
+      },
+      1);
+
+  std::vector<size_t> brickVertStart(nBricks + 1, 0);
+  for (size_t iBrick = 0; iBrick < nBricks; iBrick++) {
+    brickVertStart[iBrick + 1] = brickVertStart[iBrick] + bricks[iBrick].vertices.size();
+  }
+  if (brickVertStart.back() > std::numeric_limits<uint32_t>::max()) {
+    exception("isosurface has too many vertices to index with 32-bit integers");
+  }
+
+  // == Emit the triangles of each cube, looking up the vertex on each edge from the brick which owns it
+  parallelFor(
+      nBricks,
+      [&](size_t iBrick) {
+        if (skipBrick(iBrick)) return;
+        IsosurfaceBrick& brick = bricks[iBrick];
+        glm::uvec3 b = brickCoords(iBrick);
+        glm::uvec3 cellStart = b * brickSize;
+        glm::uvec3 cellEnd;
+        for (int i = 0; i < 3; i++) cellEnd[i] = std::min(cellStart[i] + brickSize, cellDim[i]);
+
+        for (uint32_t z = cellStart.z; z < cellEnd.z; z++) {
+          for (uint32_t y = cellStart.y; y < cellEnd.y; y++) {
+            for (uint32_t x = cellStart.x; x < cellEnd.x; x++) {
+              glm::uvec3 cell{x, y, z};
+
+              int config = 0;
+              for (int c = 0; c < 8; c++) {
+                if (valueAt(cell + cubeCornerOffset[c]) < 0) config |= (1 << c);
+              }
+              if (config == 0 || config == 255) continue;
+
+              const uint64_t tris = MC::mc_internalMarching_cube_tris[config];
+              const size_t nIndices = 3 * (tris & 0xF);
+              for (size_t i = 0; i < nIndices; i++) {
+                int e = (tris >> (4 * (i + 1))) & 0xF;
+                glm::uvec3 node = cell + cubeEdgeOffset[e];
+                glm::uvec3 owner = ownerBrick(node);
+                size_t iOwner = (static_cast<size_t>(owner.z) * brickDim.y + owner.y) * brickDim.x + owner.x;
+                const std::vector<uint64_t>& ownerKeys = bricks[iOwner].edgeKeys;
+                std::vector<uint64_t>::const_iterator it =
+                    std::lower_bound(ownerKeys.begin(), ownerKeys.end(), edgeKey(node, owner, cubeEdgeAxis[e]));
+                brick.indices.push_back(static_cast<uint32_t>(brickVertStart[iOwner] + (it - ownerKeys.begin())));
+              }
+            }
+          }
+        }
+      },
+      1);
+
+  // == Gather the bricks in to one mesh
+  std::vector<size_t> brickIndexStart(nBricks + 1, 0);
+  for (size_t iBrick = 0; iBrick < nBricks; iBrick++) {
+    brickIndexStart[iBrick + 1] = brickIndexStart[iBrick] + bricks[iBrick].indices.size();
+  }
+  result.vertices.resize(brickVertStart.back());
+  result.indices.resize(brickIndexStart.back());
+  if (vertexEdgeKeys != nullptr) vertexEdgeKeys->resize(brickVertStart.back());
+  parallelFor(
+      nBricks,
+      [&](size_t iBrick) {
+        const IsosurfaceBrick& brick = bricks[iBrick];
+        std::copy(brick.vertices.begin(), brick.vertices.end(), result.vertices.begin() + brickVertStart[iBrick]);
+        std::copy(brick.indices.begin(), brick.indices.end(), result.indices.begin() + brickIndexStart[iBrick]);
+
+        if (vertexEdgeKeys != nullptr) {
+          // convert the brick-local keys to keys in the whole grid
+          const uint64_t stride = brickSize + 1;
+          glm::uvec3 brickStart = brickCoords(iBrick) * brickSize;
+          for (size_t i = 0; i < brick.edgeKeys.size(); i++) {
+            uint64_t key = brick.edgeKeys[i];
+            uint64_t axis = key % 3;
+            key /= 3;
+            glm::uvec3 node = brickStart + glm::uvec3{static_cast<uint32_t>(key % stride),
+                                                      static_cast<uint32_t>((key / stride) % stride),
+                                                      static_cast<uint32_t>(key / (stride * stride))};
+            uint64_t nodeInd = (static_cast<uint64_t>(node.z) * gridNodeDim.y + node.y) * gridNodeDim.x + node.x;
+            (*vertexEdgeKeys)[brickVertStart[iBrick] + i] = 3 * nodeInd + axis;
+          }
+        }
+      },
+      1);
+}
+
+void weldIsosurfacePieces(const std::vector<IsosurfaceMesh>& pieces,
+                          const std::vector<std::vector<uint64_t>>& pieceEdgeKeys, IsosurfaceMesh& result) {
+  if (pieces.size() != pieceEdgeKeys.size()) exception("weldIsosurfacePieces: need edge keys for each piece");
+
+  // Concatenate the pieces
+  result.vertices.clear();
+  result.indices.clear();
+  std::vector<uint64_t> edgeKeys;
+  for (size_t iP = 0; iP < pieces.size(); iP++) {
+    if (pieceEdgeKeys[iP].size() != pieces[iP].vertices.size()) {
+      exception("weldIsosurfacePieces: need an edge key for each vertex");
+    }
+    uint32_t vertexOffset = static_cast<uint32_t>(result.vertices.size());
+    result.vertices.insert(result.vertices.end(), pieces[iP].vertices.begin(), pieces[iP].vertices.end());
+    edgeKeys.insert(edgeKeys.end(), pieceEdgeKeys[iP].begin(), pieceEdgeKeys[iP].end());
+    for (uint32_t ind : pieces[iP].indices) result.indices.push_back(ind + vertexOffset);
+  }
+
+  // Weld vertices which lie on the same grid edge
+  std::vector<uint32_t> sortedVerts(edgeKeys.size());
+  for (size_t iV = 0; iV < sortedVerts.size(); iV++) sortedVerts[iV] = static_cast<uint32_t>(iV);
+  radixSortPairs(edgeKeys, sortedVerts);
+
+  std::vector<uint32_t> weldedIndex(edgeKeys.size());
+  std::vector<glm::vec3> weldedVertices;
+  weldedVertices.reserve(edgeKeys.size());
+  for (size_t i = 0; i < edgeKeys.size(); i++) {
+    if (i == 0 || edgeKeys[i] != edgeKeys[i - 1]) {
+      weldedVertices.push_back(result.vertices[sortedVerts[i]]);
+    }
+    weldedIndex[sortedVerts[i]] = static_cast<uint32_t>(weldedVertices.size() - 1);
+  }
+  result.vertices.swap(weldedVertices);
+  for (uint32_t& ind : result.indices) ind = weldedIndex[ind];
+}
+
+} // namespace polyscope
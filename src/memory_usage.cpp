@@ -0,0 +1,147 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#include "polyscope/memory_usage.h"
+
+#include "polyscope/polyscope.h"
+#include "polyscope/quantity.h"
+#include "polyscope/render/engine.h"
+#include "polyscope/structure.h"
+
+#include "imgui.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace polyscope {
+
+void MemoryUsageTally::addHostBytes(int64_t bytes) { usage.hostBytes += bytes; }
+
+void MemoryUsageTally::addDeviceBuffer(const render::AttributeBuffer* buffer) {
+  if (buffer == nullptr) return;
+  if (!seenDeviceBuffers.insert(buffer->getUniqueID()).second) return; // already counted
+  usage.deviceBytes += buffer->getAllocatedSizeInBytes();
+}
+
+void MemoryUsageTally::addDeviceBuffer(const render::TextureBuffer* buffer) {
+  if (buffer == nullptr) return;
+  if (!seenDeviceBuffers.insert(buffer->getUniqueID()).second) return; // already counted
+  usage.deviceBytes += buffer->getSizeInBytes();
+}
+
+void MemoryUsageTally::addShaderProgram(render::ShaderProgram* program) {
+  if (program == nullptr) return;
+  for (render::AttributeBuffer* b : program->getAttributeBuffers()) {
+    addDeviceBuffer(b);
+  }
+  for (render::TextureBuffer* b : program->getTextureBuffers()) {
+    addDeviceBuffer(b);
+  }
+}
+
+MemoryUsage getMemoryUsage(Structure* structure, bool includeQuantities) {
+  MemoryUsageTally tally;
+  structure->tallyMemoryUsage(tally);
+  if (includeQuantities) {
+    for (Quantity* q : structure->getAllQuantities()) {
+      q->tallyMemoryUsage(tally);
+    }
+  }
+  return tally.usage;
+}
+
+MemoryUsage getMemoryUsage(Quantity* quantity) {
+  MemoryUsageTally tally;
+  quantity->tallyMemoryUsage(tally);
+  return tally.usage;
+}
+
+std::vector<MemoryUsageEntry> getMemoryUsageReport() {
+  std::vector<MemoryUsageEntry> report;
+  for (auto& catMap : state::structures) {
+    for (auto& s : catMap.second) {
+      Structure* structure = s.second.get();
+      report.push_back(MemoryUsageEntry{catMap.first, structure->name, "", getMemoryUsage(structure, false)});
+      for (Quantity* q : structure->getAllQuantities()) {
+        report.push_back(MemoryUsageEntry{catMap.first, structure->name, q->name, getMemoryUsage(q)});
+      }
+    }
+  }
+  return report;
+}
+
+MemoryUsage getTotalMemoryUsage() {
+  MemoryUsage total;
+  for (MemoryUsageEntry& entry : getMemoryUsageReport()) {
+    total.hostBytes += entry.usage.hostBytes;
+  }
+  total.deviceBytes = render::getTotalDeviceBufferBytes();
+  return total;
+}
+
+std::string formatByteCount(int64_t bytes) {
+  const char* units[] = {"B", "KB", "MB", "GB", "TB"};
+  double val = static_cast<double>(bytes);
+  int iUnit = 0;
+  while (val >= 1024. && iUnit < 4) {
+    val /= 1024.;
+    iUnit++;
+  }
+  char buff[64];
+  if (iUnit == 0) {
+    std::snprintf(buff, sizeof(buff), "%lld %s", static_cast<long long>(bytes), units[iUnit]);
+  } else {
+    std::snprintf(buff, sizeof(buff), "%.1f %s", val, units[iUnit]);
+  }
+  return std::string(buff);
+}
+
+void buildMemoryUsageGui() {
+
+  std::vector<MemoryUsageEntry> report = getMemoryUsageReport();
+  MemoryUsage total = getTotalMemoryUsage();
+
+  ImGui::Text("Total: host %s, device %s", formatByteCount(total.hostBytes).c_str(),
+              formatByteCount(total.deviceBytes).c_str());
+
+  const render::UploadStats& uploads = render::engine->getUploadStats();
+  ImGui::Text("Uploads last frame: %zu (%s), %zu queued / %zu requested", uploads.uploadCount,
+              formatByteCount(static_cast<int64_t>(uploads.uploadBytes)).c_str(), uploads.queuedUploads,
+              uploads.queuedRequests);
+
+  ImGuiTableFlags flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp;
+  if (ImGui::BeginTable("memory usage", 3, flags)) {
+    ImGui::TableSetupColumn("Name");
+    ImGui::TableSetupColumn("Host");
+    ImGui::TableSetupColumn("Device");
+    ImGui::TableHeadersRow();
+
+    int64_t attributedDevice = 0;
+    for (MemoryUsageEntry& entry : report) {
+      attributedDevice += entry.usage.deviceBytes;
+
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn();
+      if (entry.quantityName.empty()) {
+        ImGui::Text("%s (%s)", entry.structureName.c_str(), entry.structureType.c_str());
+      } else {
+        ImGui::Text("  %s", entry.quantityName.c_str());
+      }
+      ImGui::TableNextColumn();
+      ImGui::TextUnformatted(formatByteCount(entry.usage.hostBytes).c_str());
+      ImGui::TableNextColumn();
+      ImGui::TextUnformatted(formatByteCount(entry.usage.deviceBytes).c_str());
+    }
+
+    // everything else, like the ground plane and shared textures
+    ImGui::TableNextRow();
+    ImGui::TableNextColumn();
+    ImGui::TextUnformatted("(other)");
+    ImGui::TableNextColumn();
+    ImGui::TableNextColumn();
+    ImGui::TextUnformatted(formatByteCount(std::max<int64_t>(0, total.deviceBytes - attributedDevice)).c_str());
+
+    ImGui::EndTable();
+  }
+}
+
+} // namespace polyscope
@@ -32,6 +32,12 @@ bool giveFocusOnShow = false;
 bool hideWindowAfterShow = true;
 bool warnForInvalidValues = true;
 bool displayMessagePopups = true;
+int64_t hostMemoryBudget = -1;
+bool deferRenderUploads = true;
+int64_t streamedUploadChunkBytes = 64 * 1024 * 1024;
+int maxThreads = -1;
+int pickWindowSize = 32;
+bool precomputeVolumeMeshTets = false;
 
 bool screenshotTransparency = true;
 bool screenshotWithImGuiUI = false;
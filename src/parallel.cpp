@@ -0,0 +1,196 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#include "polyscope/parallel.h"
+
+#include "polyscope/options.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace polyscope {
+
+namespace {
+
+// Set on the pool's worker threads (and on a caller while it is running a job), so nested parallel calls run serially
+// rather than waiting on the pool they are running in.
+thread_local bool insideParallelJob = false;
+
+class ThreadPool {
+public:
+  // Resize the pool to have nWorkers threads (plus the calling thread)
+  void resize(size_t nWorkers) {
+    if (nWorkers == workers.size()) return;
+    stopWorkers();
+    stopping = false;
+    for (size_t i = 0; i < nWorkers; i++) {
+      workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+  }
+
+  // Run task(i) for i in [0, nTasks), on the workers and the calling thread
+  void run(size_t nTasks, const std::function<void(size_t)>& task) {
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      currTask = &task;
+      currTaskCount = nTasks;
+      nextTask = 0;
+      tasksRemaining = nTasks;
+      firstException = nullptr;
+      generation++;
+    }
+    workAvailable.notify_all();
+
+    // help out
+    runTasks(task, nTasks);
+
+    // wait for the workers to finish, and to stop looking at this job
+    std::unique_lock<std::mutex> lock(mtx);
+    workDone.wait(lock, [&] { return tasksRemaining == 0 && activeWorkers == 0; });
+    currTask = nullptr;
+    if (firstException) {
+      std::exception_ptr e = firstException;
+      firstException = nullptr;
+      std::rethrow_exception(e);
+    }
+  }
+
+private:
+  std::vector<std::thread> workers;
+  std::mutex mtx;
+  std::condition_variable workAvailable;
+  std::condition_variable workDone;
+
+  // all guarded by mtx, except nextTask
+  bool stopping = false;
+  size_t generation = 0;
+  const std::function<void(size_t)>* currTask = nullptr;
+  size_t currTaskCount = 0;
+  size_t tasksRemaining = 0;
+  size_t activeWorkers = 0;
+  std::atomic<size_t> nextTask{0};
+  std::exception_ptr firstException;
+
+  void stopWorkers() {
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      stopping = true;
+    }
+    workAvailable.notify_all();
+    for (std::thread& t : workers) t.join();
+    workers.clear();
+  }
+
+  void runTasks(const std::function<void(size_t)>& task, size_t nTasks, bool isWorker = false) {
+    bool wasInside = insideParallelJob;
+    insideParallelJob = true;
+    size_t nFinished = 0;
+    while (true) {
+      size_t iTask = nextTask.fetch_add(1);
+      if (iTask >= nTasks) break;
+      try {
+        task(iTask);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!firstException) firstException = std::current_exception();
+      }
+      nFinished++;
+    }
+    insideParallelJob = wasInside;
+
+    std::lock_guard<std::mutex> lock(mtx);
+    tasksRemaining -= nFinished;
+    if (isWorker) activeWorkers--;
+    if (tasksRemaining == 0 && activeWorkers == 0) workDone.notify_all();
+  }
+
+  void workerLoop() {
+    size_t seenGeneration = 0;
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      seenGeneration = generation;
+    }
+    while (true) {
+      const std::function<void(size_t)>* task;
+      size_t nTasks;
+      {
+        std::unique_lock<std::mutex> lock(mtx);
+        workAvailable.wait(lock, [&] { return stopping || generation != seenGeneration; });
+        if (stopping) return;
+        seenGeneration = generation;
+        task = currTask;
+        nTasks = currTaskCount;
+        if (task == nullptr) continue;
+        activeWorkers++;
+      }
+      runTasks(*task, nTasks, true);
+    }
+  }
+};
+
+// Only one parallel job runs on the pool at a time
+std::mutex& poolMutex() {
+  static std::mutex* m = new std::mutex();
+  return *m;
+}
+
+ThreadPool& getPool() {
+  // intentionally leaked, to avoid joining threads during static destruction
+  static ThreadPool* pool = new ThreadPool();
+  return *pool;
+}
+
+} // namespace
+
+size_t getParallelThreadCount() {
+  if (options::maxThreads > 0) return static_cast<size_t>(options::maxThreads);
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+ParallelPartition getParallelPartition(size_t n, size_t minBlockSize) {
+  minBlockSize = std::max<size_t>(minBlockSize, 1);
+  ParallelPartition partition;
+  partition.n = n;
+  partition.nBlocks = std::max<size_t>(std::min(getParallelThreadCount(), n / minBlockSize), 1);
+  partition.blockSize = (n + partition.nBlocks - 1) / partition.nBlocks;
+  return partition;
+}
+
+void parallelForBlocks(const ParallelPartition& partition, const std::function<void(size_t, size_t, size_t)>& func) {
+  const size_t n = partition.n;
+  const size_t nBlocks = partition.nBlocks;
+  if (n == 0) return;
+
+  auto runBlock = [&](size_t iBlock) {
+    size_t start = std::min(n, iBlock * partition.blockSize);
+    size_t end = std::min(n, start + partition.blockSize);
+    func(iBlock, start, end);
+  };
+
+  if (nBlocks == 1 || insideParallelJob) {
+    for (size_t iBlock = 0; iBlock < nBlocks; iBlock++) runBlock(iBlock);
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(poolMutex());
+  ThreadPool& pool = getPool();
+  pool.resize(getParallelThreadCount() - 1);
+  pool.run(nBlocks, runBlock);
+}
+
+void parallelForBlocks(size_t n, size_t minBlockSize, const std::function<void(size_t, size_t, size_t)>& func) {
+  parallelForBlocks(getParallelPartition(n, minBlockSize), func);
+}
+
+std::future<void> runInBackground(std::function<void()> func) {
+  return std::async(std::launch::async, [func]() {
+    insideParallelJob = true;
+    func();
+  });
+}
+
+} // namespace polyscope
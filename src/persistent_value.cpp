@@ -23,6 +23,7 @@ PersistentCache<MeshShadeStyle> persistentCache_MeshNormalType;
 PersistentCache<FilterMode> persistentCache_FilterMode;
 PersistentCache<IsolineStyle> persistentCache_IsolineStyle;
 PersistentCache<MeshSelectionMode> persistentCache_MeshSelectionMode;
+PersistentCache<VolumeMeshSliceMode> persistentCache_VolumeMeshSliceMode;
 // clang-format on
 } // namespace detail
 } // namespace polyscope
@@ -4,7 +4,12 @@
 
 #include "polyscope/polyscope.h"
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
 #include <limits>
+#include <map>
 #include <tuple>
 #include <unordered_map>
 
@@ -19,13 +24,14 @@ PickResult pickAtScreenCoords(glm::vec2 screenCoords) {
 PickResult pickAtBufferInds(glm::ivec2 bufferInds) {
   PickResult result;
 
-  // Query the pick buffer
-  // (this necessarily renders to pickFrameBuffer)
-  std::pair<Structure*, size_t> rawPickResult = pick::pickAtBufferCoords(bufferInds.x, bufferInds.y);
-
-  // Query the depth buffer populated above
-  render::FrameBuffer* pickFramebuffer = render::engine->pickFramebuffer.get();
-  float clipDepth = pickFramebuffer->readDepth(bufferInds.x, view::bufferHeight - bufferInds.y);
+  // Query the pick buffer and its depth
+  // (this renders to pickFramebuffer, unless the scene has not changed since a nearby query)
+  std::pair<Structure*, uint64_t> rawPickResult = {nullptr, 0};
+  float clipDepth = 1.;
+  uint64_t globalInd;
+  if (pick::queryPickBuffer(bufferInds.x, bufferInds.y, globalInd, clipDepth)) {
+    rawPickResult = pick::globalIndexToLocal(globalInd);
+  }
 
   // Transcribe result into return tuple
   result.structure = rawPickResult.first;
@@ -51,6 +57,206 @@ PickResult pickAtBufferInds(glm::ivec2 bufferInds) {
   return result;
 }
 
+// == CPU ray queries
+
+PickResult rayPickAtScreenCoords(glm::vec2 screenCoords) {
+
+  // Ray from the near plane through the pixel (works for both perspective and orthographic projections)
+  glm::vec3 nearPos = view::screenCoordsAndDepthToWorldPosition(screenCoords, 0.);
+  glm::vec3 midPos = view::screenCoordsAndDepthToWorldPosition(screenCoords, 0.5);
+  glm::vec3 rayDir = glm::normalize(midPos - nearPos);
+
+  PickResult result = rayPick(nearPos, rayDir);
+  result.screenCoords = screenCoords;
+  result.bufferInds = view::screenCoordsToBufferIndsVec(screenCoords);
+  if (result.isHit) {
+    result.depth = glm::length(result.position - view::getCameraWorldPosition());
+  }
+  return result;
+}
+
+PickResult rayPick(glm::vec3 rayStart, glm::vec3 rayDir) {
+  PickResult result;
+
+  // Find the nearest hit among all enabled structures
+  Structure* hitStructure = nullptr;
+  float tBest = std::numeric_limits<float>::infinity();
+  uint64_t hitIndex = 0;
+  for (auto& cat : state::structures) {
+    for (auto& x : cat.second) {
+      Structure* s = x.second.get();
+      if (!s->isEnabled()) continue;
+      float t;
+      uint64_t localIndex;
+      if (s->rayPick(rayStart, rayDir, t, localIndex) && t < tBest) {
+        tBest = t;
+        hitStructure = s;
+        hitIndex = localIndex;
+      }
+    }
+  }
+
+  if (hitStructure == nullptr) {
+    result.isHit = false;
+    result.depth = std::numeric_limits<float>::infinity();
+    float inf = std::numeric_limits<float>::infinity();
+    result.position = glm::vec3{inf, inf, inf};
+    return result;
+  }
+
+  result.isHit = true;
+  result.structure = hitStructure;
+  result.structureHandle = hitStructure->getWeakHandle<Structure>();
+  std::tie(result.structureType, result.structureName) = lookUpStructure(hitStructure);
+  result.localIndex = hitIndex;
+  result.position = rayStart + tBest * rayDir;
+  result.depth = tBest * glm::length(rayDir);
+  return result;
+}
+
+// == Region queries
+
+namespace pick {
+
+std::vector<RegionPickResult> decodePickRegion(const std::vector<std::array<float, 4>>& colors,
+                                               const std::vector<float>& depths, glm::ivec2 minInds,
+                                               glm::ivec2 maxInds, const std::function<bool(int, int)>& inRegion,
+                                               float maxDepth) {
+
+  // The window's rows count from the bottom-left, as framebuffer pixels do (see queryPickBuffer())
+  auto pixelRow = [](int yInd) { return std::min(view::bufferHeight - yInd, view::bufferHeight - 1); };
+  int rowStart = pixelRow(maxInds.y);
+  size_t windowWidth = static_cast<size_t>(maxInds.x - minInds.x + 1);
+
+  // Find each distinct index in the region, and the nearest pixel where it appears
+  struct Hit {
+    float clipDepth;
+    glm::ivec2 bufferInds;
+  };
+  std::unordered_map<uint64_t, Hit> hits;
+  for (int yInd = minInds.y; yInd <= maxInds.y; yInd++) {
+    size_t rowOffset = static_cast<size_t>(pixelRow(yInd) - rowStart) * windowWidth;
+    for (int xInd = minInds.x; xInd <= maxInds.x; xInd++) {
+      if (!inRegion(xInd, yInd)) continue;
+      size_t iPixel = rowOffset + (xInd - minInds.x);
+      const std::array<float, 4>& color = colors[iPixel];
+      uint64_t globalInd = vecToInd(glm::vec3{color[0], color[1], color[2]});
+      if (globalInd == 0) continue; // background
+      float clipDepth = depths[iPixel];
+      std::unordered_map<uint64_t, Hit>::iterator it = hits.find(globalInd);
+      if (it == hits.end()) {
+        hits[globalInd] = Hit{clipDepth, glm::ivec2{xInd, yInd}};
+      } else if (clipDepth < it->second.clipDepth) {
+        it->second = Hit{clipDepth, glm::ivec2{xInd, yInd}};
+      }
+    }
+  }
+
+  // Sort the hits by global index, which also sorts the local indices within each structure
+  std::vector<std::pair<uint64_t, Hit>> sortedHits(hits.begin(), hits.end());
+  std::sort(sortedHits.begin(), sortedHits.end(),
+            [](const std::pair<uint64_t, Hit>& a, const std::pair<uint64_t, Hit>& b) { return a.first < b.first; });
+
+  // Group by structure
+  glm::vec3 cameraPos = view::getCameraWorldPosition();
+  std::unordered_map<Structure*, RegionPickResult> resultsByStructure;
+  for (const std::pair<uint64_t, Hit>& hit : sortedHits) {
+    std::pair<Structure*, uint64_t> localPick = globalIndexToLocal(hit.first);
+    if (localPick.first == nullptr) continue;
+
+    glm::vec2 screenCoords = view::bufferIndsToScreenCoords(hit.second.bufferInds);
+    glm::vec3 position = view::screenCoordsAndDepthToWorldPosition(screenCoords, hit.second.clipDepth);
+    float depth = glm::length(position - cameraPos);
+    if (maxDepth > 0. && depth > maxDepth) continue;
+
+    RegionPickResult& result = resultsByStructure[localPick.first];
+    result.localIndices.push_back(localPick.second);
+    result.positions.push_back(position);
+    result.depths.push_back(depth);
+  }
+
+  std::vector<RegionPickResult> results;
+  for (std::pair<Structure* const, RegionPickResult>& entry : resultsByStructure) {
+    RegionPickResult& result = entry.second;
+    result.structure = entry.first;
+    result.structureHandle = entry.first->getWeakHandle<Structure>();
+    std::tie(result.structureType, result.structureName) = lookUpStructure(entry.first);
+    results.push_back(std::move(result));
+  }
+  std::sort(results.begin(), results.end(), [](const RegionPickResult& a, const RegionPickResult& b) {
+    return std::tie(a.structureType, a.structureName) < std::tie(b.structureType, b.structureName);
+  });
+
+  return results;
+}
+
+} // namespace pick
+
+namespace {
+
+// Render and read back the pick buffer over the buffer index rectangle [minInds, maxInds] (inclusive), and collect
+// the hits at pixels for which inRegion(x, y) is true
+std::vector<RegionPickResult> pickInRegion(glm::ivec2 minInds, glm::ivec2 maxInds,
+                                           const std::function<bool(int, int)>& inRegion, float maxDepth) {
+
+  // Clamp to the buffer
+  minInds = glm::max(minInds, glm::ivec2(0, 0));
+  maxInds = glm::min(maxInds, glm::ivec2(view::bufferWidth - 1, view::bufferHeight - 1));
+  if (minInds.x > maxInds.x || minInds.y > maxInds.y) {
+    return {};
+  }
+
+  // The same window in framebuffer pixels, which count from the bottom-left (see pick::queryPickBuffer())
+  auto pixelRow = [](int yInd) { return std::min(view::bufferHeight - yInd, view::bufferHeight - 1); };
+  int rowStart = pixelRow(maxInds.y);
+  glm::ivec4 window{minInds.x, rowStart, maxInds.x - minInds.x + 1, pixelRow(minInds.y) - rowStart + 1};
+
+  if (!pick::renderPickWindow(window)) return {};
+  render::FrameBuffer* pickFramebuffer = render::engine->pickFramebuffer.get();
+  std::vector<std::array<float, 4>> colors = pickFramebuffer->readFloat4Region(0, 0, window[2], window[3]);
+  std::vector<float> depths = pickFramebuffer->readDepthRegion(0, 0, window[2], window[3]);
+
+  return pick::decodePickRegion(colors, depths, minInds, maxInds, inRegion, maxDepth);
+}
+
+} // namespace
+
+std::vector<RegionPickResult> pickInRectangle(glm::ivec2 cornerA, glm::ivec2 cornerB, float maxDepth) {
+  return pickInRegion(
+      glm::min(cornerA, cornerB), glm::max(cornerA, cornerB), [](int, int) { return true; }, maxDepth);
+}
+
+std::vector<RegionPickResult> pickInPolygon(const std::vector<glm::vec2>& polygon, float maxDepth) {
+  if (polygon.size() < 3) {
+    return {};
+  }
+
+  glm::vec2 boundMin = polygon[0];
+  glm::vec2 boundMax = polygon[0];
+  for (const glm::vec2& p : polygon) {
+    boundMin = glm::min(boundMin, p);
+    boundMax = glm::max(boundMax, p);
+  }
+  glm::ivec2 minInds{static_cast<int>(std::floor(boundMin.x)), static_cast<int>(std::floor(boundMin.y))};
+  glm::ivec2 maxInds{static_cast<int>(std::ceil(boundMax.x)), static_cast<int>(std::ceil(boundMax.y))};
+
+  // Even-odd test on the pixel center
+  auto inPolygon = [&](int xInd, int yInd) {
+    glm::vec2 q{xInd + 0.5f, yInd + 0.5f};
+    bool inside = false;
+    for (size_t i = 0, j = polygon.size() - 1; i < polygon.size(); j = i++) {
+      const glm::vec2& a = polygon[i];
+      const glm::vec2& b = polygon[j];
+      if ((a.y > q.y) != (b.y > q.y) && q.x < a.x + (q.y - a.y) / (b.y - a.y) * (b.x - a.x)) {
+        inside = !inside;
+      }
+    }
+    return inside;
+  };
+
+  return pickInRegion(minInds, maxInds, inPolygon, maxDepth);
+}
+
 // == Manage stateful picking
 
 void resetSelection() {
@@ -80,52 +286,138 @@ void setSelection(PickResult newPick) {
 
 namespace pick {
 
+namespace {
+
+// The released ranges are kept both by start (to merge neighbors) and by size (to find the best fit), these keep the two
+// in sync
+void addFreePickRange(uint64_t start, uint64_t end) {
+  state::globalContext.freePickRanges[start] = end;
+  state::globalContext.freePickRangesBySize.emplace(end - start, start);
+}
+
+void eraseFreePickRange(std::map<uint64_t, uint64_t>::iterator it) {
+  std::multimap<uint64_t, uint64_t>& bySize = state::globalContext.freePickRangesBySize;
+  std::pair<std::multimap<uint64_t, uint64_t>::iterator, std::multimap<uint64_t, uint64_t>::iterator> sameSize =
+      bySize.equal_range(it->second - it->first);
+  for (std::multimap<uint64_t, uint64_t>::iterator sizeIt = sameSize.first; sizeIt != sameSize.second; sizeIt++) {
+    if (sizeIt->second == it->first) {
+      bySize.erase(sizeIt);
+      break;
+    }
+  }
+  state::globalContext.freePickRanges.erase(it);
+}
+
+} // namespace
+
 // == Set up picking
 uint64_t requestPickBufferRange(Structure* requestingStructure, uint64_t count) {
 
-  // Check if we can satisfy the request
-  uint64_t maxPickInd = std::numeric_limits<uint64_t>::max();
+  // A structure only ever holds one range, give back the old one before allocating the new one
+  releasePickBufferRange(requestingStructure);
+
+  // Look for the smallest released range which can hold the request
+  std::map<uint64_t, uint64_t>& freeRanges = state::globalContext.freePickRanges;
+  std::multimap<uint64_t, uint64_t>::iterator bestFit = state::globalContext.freePickRangesBySize.lower_bound(count);
+
+  uint64_t ret;
+  if (count > 0 && bestFit != state::globalContext.freePickRangesBySize.end()) {
+
+    // Take the front of the released range, and keep the remainder free
+    ret = bestFit->second;
+    uint64_t freeEnd = ret + bestFit->first;
+    eraseFreePickRange(freeRanges.find(ret));
+    if (ret + count < freeEnd) {
+      addFreePickRange(ret + count, freeEnd);
+    }
+
+  } else {
+
+    // Check if we can satisfy the request
+    uint64_t maxPickInd = std::numeric_limits<uint64_t>::max();
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wshift-count-overflow"
-  if (bitsForPickPacking < 22) {
-    uint64_t bitMax = 1ULL << (bitsForPickPacking * 3);
-    if (bitMax < maxPickInd) {
-      maxPickInd = bitMax;
+    if (bitsForPickPacking < 22) {
+      uint64_t bitMax = 1ULL << (bitsForPickPacking * 3);
+      if (bitMax < maxPickInd) {
+        maxPickInd = bitMax;
+      }
     }
-  }
 #pragma GCC diagnostic pop
 
-  if (count > maxPickInd || maxPickInd - count < state::globalContext.nextPickBufferInd) {
-    exception("Wow, you sure do have a lot of stuff, Polyscope can't even count it all. (Ran out of indices while "
-              "enumerating structure elements for pick buffer.)");
+    if (count > maxPickInd || maxPickInd - count < state::globalContext.nextPickBufferInd) {
+      exception("Wow, you sure do have a lot of stuff, Polyscope can't even count it all. (Ran out of indices while "
+                "enumerating structure elements for pick buffer.)");
+    }
+
+    ret = state::globalContext.nextPickBufferInd;
+    state::globalContext.nextPickBufferInd += count;
   }
 
-  uint64_t ret = state::globalContext.nextPickBufferInd;
-  state::globalContext.nextPickBufferInd += count;
-  state::globalContext.structureRanges[requestingStructure] =
-      std::make_tuple(ret, state::globalContext.nextPickBufferInd);
+  uint64_t end = ret + count;
+  state::globalContext.structureRanges[requestingStructure] = std::make_tuple(ret, end);
+  if (count > 0) {
+    state::globalContext.pickRangesByStart[ret] = std::make_tuple(end, requestingStructure);
+  }
   return ret;
 }
 
-// == Helpers
+void releasePickBufferRange(Structure* requestingStructure) {
 
-std::pair<Structure*, uint64_t> globalIndexToLocal(uint64_t globalInd) {
+  std::unordered_map<Structure*, std::tuple<uint64_t, uint64_t>>::iterator rangeIt =
+      state::globalContext.structureRanges.find(requestingStructure);
+  if (rangeIt == state::globalContext.structureRanges.end()) return;
 
-  // ONEDAY: this could be asymptotically better if we cared
+  uint64_t start = std::get<0>(rangeIt->second);
+  uint64_t end = std::get<1>(rangeIt->second);
+  state::globalContext.structureRanges.erase(rangeIt);
+  if (start == end) return;
+  state::globalContext.pickRangesByStart.erase(start);
 
-  // Loop through the ranges that we have allocated to find the one correpsonding to this structure.
-  for (const auto& x : state::globalContext.structureRanges) {
+  // Merge with the neighboring released ranges, if they touch
+  std::map<uint64_t, uint64_t>& freeRanges = state::globalContext.freePickRanges;
+  std::map<uint64_t, uint64_t>::iterator after = freeRanges.find(end);
+  if (after != freeRanges.end()) {
+    end = after->second;
+    eraseFreePickRange(after);
+  }
+  std::map<uint64_t, uint64_t>::iterator before = freeRanges.lower_bound(start);
+  if (before != freeRanges.begin()) {
+    before--;
+    if (before->second == start) {
+      start = before->first;
+      eraseFreePickRange(before);
+    }
+  }
 
-    Structure* structure = x.first;
-    uint64_t rangeStart = std::get<0>(x.second);
-    uint64_t rangeEnd = std::get<1>(x.second);
+  // A released range at the end of the allocated indices just shrinks them, so re-registering structures does not
+  // grow nextPickBufferInd
+  if (end == state::globalContext.nextPickBufferInd) {
+    state::globalContext.nextPickBufferInd = start;
+  } else {
+    addFreePickRange(start, end);
+  }
+}
 
-    if (globalInd >= rangeStart && globalInd < rangeEnd) {
-      return {structure, globalInd - rangeStart};
-    }
+// == Helpers
+
+std::pair<Structure*, uint64_t> globalIndexToLocal(uint64_t globalInd) {
+
+  // Find the last range starting at or before this index, and check that it contains it
+  const std::map<uint64_t, std::tuple<uint64_t, Structure*>>& ranges = state::globalContext.pickRangesByStart;
+  std::map<uint64_t, std::tuple<uint64_t, Structure*>>::const_iterator it = ranges.upper_bound(globalInd);
+  if (it == ranges.begin()) {
+    return {nullptr, 0};
+  }
+  it--;
+
+  uint64_t rangeStart = it->first;
+  uint64_t rangeEnd = std::get<0>(it->second);
+  if (globalInd >= rangeEnd) {
+    return {nullptr, 0};
   }
 
-  return {nullptr, 0};
+  return {std::get<1>(it->second), globalInd - rangeStart};
 }
 
 uint64_t localIndexToGlobal(std::pair<Structure*, uint64_t> localPick) {
@@ -151,40 +443,114 @@ std::pair<Structure*, uint64_t> pickAtBufferCoords(int xPos, int yPos) { return
 
 std::pair<Structure*, uint64_t> evaluatePickQuery(int xPos, int yPos) {
 
-  // NOTE: hack used for debugging: if xPos == yPos == -1 we do a pick render but do not query the value.
+  // NOTE: hack used for debugging: if xPos == yPos == -1 we do a pick render of the whole buffer but do not query the
+  // value.
+  if (xPos == -1 && yPos == -1) {
+    renderPickWindow(glm::ivec4(0, 0, view::bufferWidth, view::bufferHeight));
+    return {nullptr, 0};
+  }
 
-  // Be sure not to pick outside of buffer
-  if (xPos < -1 || xPos >= view::bufferWidth || yPos < -1 || yPos >= view::bufferHeight) {
+  uint64_t globalInd;
+  float depth;
+  if (!queryPickBuffer(xPos, yPos, globalInd, depth)) {
     return {nullptr, 0};
   }
+  return pick::globalIndexToLocal(globalInd);
+}
+
+bool renderPickWindow(glm::ivec4 window) {
 
   render::FrameBuffer* pickFramebuffer = render::engine->pickFramebuffer.get();
 
   render::engine->setDepthMode(DepthMode::Less);
   render::engine->setBlendMode(BlendMode::Disable);
 
-  pickFramebuffer->resize(view::bufferWidth, view::bufferHeight);
-  pickFramebuffer->setViewport(0, 0, view::bufferWidth, view::bufferHeight);
+  pickFramebuffer->resize(window[2], window[3]);
+  pickFramebuffer->setViewport(0, 0, window[2], window[3]);
   pickFramebuffer->clearColor = glm::vec3{0., 0., 0.};
-  if (!pickFramebuffer->bindForRendering()) return {nullptr, 0};
+  if (!pickFramebuffer->bindForRendering()) return false;
   pickFramebuffer->clear();
 
-  // Render pick buffer
-  for (auto& cat : state::structures) {
-    for (auto& x : cat.second) {
-      x.second->drawPick();
+  // Make sure any pending data updates are on the device before rendering
+  render::engine->flushUploadQueue();
+
+  // Render pick buffer, with the projection narrowed to the window
+  bool wholeBuffer = window == glm::ivec4(0, 0, view::bufferWidth, view::bufferHeight);
+  if (!wholeBuffer) {
+    view::setRenderSubWindow(window);
+  }
+  try {
+    for (auto& cat : state::structures) {
+      for (auto& x : cat.second) {
+        x.second->drawPick();
+      }
     }
+  } catch (...) {
+    view::clearRenderSubWindow();
+    throw;
   }
+  view::clearRenderSubWindow();
 
-  if (xPos == -1 || yPos == -1) {
-    return {nullptr, 0};
+  return true;
+}
+
+bool queryPickBuffer(int xPos, int yPos, uint64_t& globalInd, float& depth) {
+
+  // Be sure not to pick outside of buffer
+  if (xPos < 0 || xPos >= view::bufferWidth || yPos < 0 || yPos >= view::bufferHeight) {
+    return false;
+  }
+
+  // Pixel in the framebuffer, which counts from the bottom-left
+  int pixelX = xPos;
+  int pixelY = std::min(view::bufferHeight - yPos, view::bufferHeight - 1);
+
+  // Old behavior: render and read from the whole buffer every time
+  if (options::pickWindowSize <= 0) {
+    if (!renderPickWindow(glm::ivec4(0, 0, view::bufferWidth, view::bufferHeight))) return false;
+    render::FrameBuffer* pickFramebuffer = render::engine->pickFramebuffer.get();
+    std::array<float, 4> result = pickFramebuffer->readFloat4(pixelX, pixelY);
+    globalInd = pick::vecToInd(glm::vec3{result[0], result[1], result[2]});
+    depth = pickFramebuffer->readDepth(pixelX, pixelY);
+    return true;
   }
 
-  // Read from the pick buffer
-  std::array<float, 4> result = pickFramebuffer->readFloat4(xPos, view::bufferHeight - yPos);
-  uint64_t globalInd = pick::vecToInd(glm::vec3{result[0], result[1], result[2]});
+  // Re-use the cached window if the scene has not changed, and it covers this pixel
+  Context& ctx = state::globalContext;
+  glm::ivec2 bufferSize{view::bufferWidth, view::bufferHeight};
+  glm::ivec4& window = ctx.pickCacheWindow;
+  bool cacheHit = ctx.pickCacheValid && !options::alwaysRedraw &&
+                  ctx.pickCacheSceneGeneration == ctx.sceneGeneration && ctx.pickCacheBufferSize == bufferSize &&
+                  pixelX >= window[0] && pixelX < window[0] + window[2] && pixelY >= window[1] &&
+                  pixelY < window[1] + window[3];
+
+  if (!cacheHit) {
+    ctx.pickCacheValid = false;
+
+    // A window centered on the pixel, shifted to stay inside the buffer
+    int sizeX = std::min(options::pickWindowSize, view::bufferWidth);
+    int sizeY = std::min(options::pickWindowSize, view::bufferHeight);
+    int startX = std::max(0, std::min(pixelX - sizeX / 2, view::bufferWidth - sizeX));
+    int startY = std::max(0, std::min(pixelY - sizeY / 2, view::bufferHeight - sizeY));
+    glm::ivec4 newWindow{startX, startY, sizeX, sizeY};
+
+    if (!renderPickWindow(newWindow)) return false;
+    render::FrameBuffer* pickFramebuffer = render::engine->pickFramebuffer.get();
+    ctx.pickCacheColors = pickFramebuffer->readFloat4Region(0, 0, sizeX, sizeY);
+    ctx.pickCacheDepths = pickFramebuffer->readDepthRegion(0, 0, sizeX, sizeY);
+
+    // (the generation is recorded after rendering, since drawing may lazily prepare data and request a redraw)
+    ctx.pickCacheValid = true;
+    ctx.pickCacheSceneGeneration = ctx.sceneGeneration;
+    ctx.pickCacheBufferSize = bufferSize;
+    window = newWindow;
+  }
 
-  return pick::globalIndexToLocal(globalInd);
+  size_t iPixel = static_cast<size_t>(pixelY - window[1]) * window[2] + (pixelX - window[0]);
+  const std::array<float, 4>& result = ctx.pickCacheColors[iPixel];
+  globalInd = pick::vecToInd(glm::vec3{result[0], result[1], result[2]});
+  depth = ctx.pickCacheDepths[iPixel];
+  return true;
 }
 
 } // namespace pick
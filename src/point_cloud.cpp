@@ -38,6 +38,13 @@ PointCloud::PointCloud(std::string name, std::vector<glm::vec3> points_)
   updateObjectSpaceBounds();
 }
 
+PointCloud::PointCloud(std::string name, const glm::vec3* points_, size_t nPoints_, std::shared_ptr<const void> owner)
+    : PointCloud(name, std::vector<glm::vec3>()) {
+  points.setExternalData(points_, nPoints_, owner);
+  points.checkInvalidValues();
+  updateObjectSpaceBounds();
+}
+
 // Helper to set uniforms
 void PointCloud::setPointCloudUniforms(render::ShaderProgram& p) {
   glm::mat4 P = view::getCameraPerspectiveMatrix();
@@ -192,6 +199,55 @@ void PointCloud::setPointProgramGeometryAttributes(render::ShaderProgram& p) {
   }
 }
 
+bool PointCloud::rayPick(glm::vec3 rayStart, glm::vec3 rayDir, float& tHit, uint64_t& localIndex) {
+
+  // Build or update the tree. The positions are only read when needed, so repeated picks neither copy caller-owned
+  // memory nor read an evicted host copy back from the device.
+  if (!pointKDTree.isBuilt() || pointKDTree.nPoints() != points.size()) {
+    const glm::vec3* pointData = points.getHostDataPtr();
+    pointKDTree.build(pointData, points.hostDataSize());
+  } else if (pointKDTreePositionsVersion != points.getDataVersion()) {
+    const glm::vec3* pointData = points.getHostDataPtr();
+    pointKDTree.refit(pointData, points.hostDataSize());
+  }
+  pointKDTreePositionsVersion = points.getDataVersion();
+
+  // Point radii, matching setPointCloudUniforms(). The tree keeps its own copy, so only pass them when they change.
+  float radiusScale = pointRadius.get().asAbsolute();
+  if (pointRadiusQuantityName != "") {
+    PointCloudScalarQuantity& radQ = resolvePointRadiusQuantity();
+    if (!pointKDTree.hasRadii() || pointKDTreeRadiiBufferID != radQ.values.uniqueID ||
+        pointKDTreeRadiiDataVersion != radQ.values.getDataVersion()) {
+      const float* radiusData = radQ.values.getHostDataPtr();
+      pointKDTree.setRadii(radiusData, radQ.values.hostDataSize());
+      pointKDTreeRadiiBufferID = radQ.values.uniqueID;
+      pointKDTreeRadiiDataVersion = radQ.values.getDataVersion();
+    }
+    if (pointRadiusQuantityAutoscale) {
+      radiusScale /= std::max(0., radQ.getDataRange().second);
+    } else {
+      radiusScale = 1.;
+    }
+  } else if (pointKDTree.hasRadii()) {
+    pointKDTree.clearRadii();
+  }
+
+  // Intersect in object space. Radii are in world units, so scale them by the (average) scaling of the transform.
+  glm::mat4 transform = objectTransform.get();
+  glm::mat4 invTransform = glm::inverse(transform);
+  glm::vec3 objRayStart = glm::vec3(invTransform * glm::vec4(rayStart, 1.));
+  glm::vec3 objRayDir = glm::vec3(invTransform * glm::vec4(rayDir, 0.));
+  float transformScale = std::cbrt(std::abs(glm::determinant(glm::mat3(transform))));
+  if (transformScale > 0.) radiusScale /= transformScale;
+
+  RayHit hit = pointKDTree.intersectSpheres(objRayStart, objRayDir, radiusScale);
+  if (!hit.hit) return false;
+
+  tHit = hit.t;
+  localIndex = hit.index;
+  return true;
+}
+
 std::string PointCloud::getShaderNameForRenderMode() {
   if (getPointRenderMode() == PointRenderMode::Sphere)
     return "RAYCAST_SPHERE";
@@ -223,6 +279,22 @@ PointCloudPickResult PointCloud::interpretPickResult(const PickResult& rawResult
   return result;
 }
 
+std::vector<PointCloudPickResult> PointCloud::interpretPickResult(const RegionPickResult& rawResult) {
+  if (rawResult.structure != this) {
+    exception("called interpretPickResult(), but the pick result is not from this structure");
+  }
+
+  std::vector<PointCloudPickResult> results(rawResult.localIndices.size());
+  for (size_t i = 0; i < rawResult.localIndices.size(); i++) {
+    if (rawResult.localIndices[i] >= nPoints()) {
+      exception("Bad pick index in point cloud");
+    }
+    results[i].index = rawResult.localIndices[i];
+  }
+
+  return results;
+}
+
 
 std::vector<std::string> PointCloud::addPointCloudRules(std::vector<std::string> initRules, bool withPointCloud) {
   initRules = addStructureRules(initRules);
@@ -358,23 +430,40 @@ void PointCloud::buildCustomOptionsUI() {
   }
 }
 
+void PointCloud::updatePointPositionsExternal(const glm::vec3* newPositions, size_t count,
+                                              std::shared_ptr<const void> owner) {
+  if (count != nPoints()) {
+    exception("point cloud updated positions " + name + " has " + std::to_string(count) + " points, but should have " +
+              std::to_string(nPoints()));
+  }
+  if (newPositions == points.getHostDataPtr() && !points.hasExternalData()) {
+    // the point cloud's own host buffer, modified in place
+    points.markHostBufferUpdated();
+  } else {
+    // (also when the same external memory was modified in place, so the new owner replaces the old one)
+    points.setExternalData(newPositions, count, owner);
+  }
+}
+
 void PointCloud::updateObjectSpaceBounds() {
-  points.ensureHostBufferPopulated();
+  // (read through the pointer, so that positions held in external memory do not get copied)
+  const glm::vec3* pointPtr = points.getHostDataPtr();
+  size_t nPts = points.size();
 
   // bounding box
   glm::vec3 min = glm::vec3{1, 1, 1} * std::numeric_limits<float>::infinity();
   glm::vec3 max = -glm::vec3{1, 1, 1} * std::numeric_limits<float>::infinity();
-  for (const glm::vec3& p : points.data) {
-    min = componentwiseMin(min, p);
-    max = componentwiseMax(max, p);
+  for (size_t i = 0; i < nPts; i++) {
+    min = componentwiseMin(min, pointPtr[i]);
+    max = componentwiseMax(max, pointPtr[i]);
   }
   objectSpaceBoundingBox = std::make_tuple(min, max);
 
   // length scale, as twice the radius from the center of the bounding box
   glm::vec3 center = 0.5f * (min + max);
   float lengthScale = 0.0;
-  for (const glm::vec3& p : points.data) {
-    lengthScale = std::max(lengthScale, glm::length2(p - center));
+  for (size_t i = 0; i < nPts; i++) {
+    lengthScale = std::max(lengthScale, glm::length2(pointPtr[i] - center));
   }
   objectSpaceLengthScale = 2 * std::sqrt(lengthScale);
 }
@@ -544,4 +633,16 @@ PointCloud* PointCloud::setPointRadius(double newVal, bool isRelative) {
 }
 double PointCloud::getPointRadius() { return pointRadius.get().asAbsolute(); }
 
+PointCloud* registerPointCloudExternal(std::string name, const glm::vec3* points, size_t nPoints,
+                                       std::shared_ptr<const void> owner) {
+  checkInitialized();
+
+  PointCloud* s = new PointCloud(name, points, nPoints, owner);
+  bool success = registerStructure(s);
+  if (!success) {
+    safeDelete(s);
+  }
+  return s;
+}
+
 } // namespace polyscope
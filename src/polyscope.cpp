@@ -10,9 +10,11 @@
 #include "imgui.h"
 #include "implot.h"
 
+#include "polyscope/memory_usage.h"
 #include "polyscope/options.h"
 #include "polyscope/pick.h"
 #include "polyscope/render/engine.h"
+#include "polyscope/render/managed_buffer.h"
 #include "polyscope/utilities.h"
 #include "polyscope/view.h"
 
@@ -311,7 +313,10 @@ void frameTick() {
   frameTickStack--;
 }
 
-void requestRedraw() { redrawNextFrame = true; }
+void requestRedraw() {
+  redrawNextFrame = true;
+  state::globalContext.sceneGeneration++;
+}
 bool redrawRequested() { return redrawNextFrame; }
 
 void drawStructures() {
@@ -718,6 +723,12 @@ void buildPolyscopeGui() {
     ImGui::TreePop();
   }
 
+  ImGui::SetNextItemOpen(false, ImGuiCond_FirstUseEver);
+  if (ImGui::TreeNode("Memory")) {
+    buildMemoryUsageGui();
+    ImGui::TreePop();
+  }
+
   ImGui::SetNextItemOpen(false, ImGuiCond_FirstUseEver);
   if (ImGui::TreeNode("Debug")) {
 
@@ -928,6 +939,9 @@ void draw(bool withUI, bool withContextCallback) {
 
   processLazyProperties();
 
+  // Send all data updates from this frame to the device at once
+  render::engine->flushUploadQueue();
+
   // Draw structures in the scene
   if (redrawNextFrame || options::alwaysRedraw) {
     renderScene();
@@ -949,6 +963,8 @@ void draw(bool withUI, bool withContextCallback) {
     render::engine->bindDisplay();
     render::engine->ImGuiRender();
   }
+
+  render::engine->endUploadStatsFrame();
 }
 
 
@@ -969,6 +985,9 @@ void mainLoopIteration() {
   // Rendering
   draw();
   render::engine->swapDisplayBuffers();
+
+  // Drop host copies of data which can be restored later, if over budget
+  render::enforceHostMemoryBudget();
 }
 
 void show(size_t forFrames) {
@@ -1184,6 +1203,7 @@ void removeStructure(std::string type, std::string name, bool errorIfAbsent) {
     g.second->removeChildStructure(*s);
   }
   resetSelectionIfStructure(s);
+  pick::releasePickBufferRange(s);
   sMap.erase(s->name);
   updateStructureExtents();
   return;
@@ -0,0 +1,198 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#include "polyscope/quantized_scalar_array.h"
+
+#include "polyscope/messages.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+
+#include <glm/gtc/packing.hpp>
+
+namespace polyscope {
+
+namespace {
+
+std::string quantizedTypeName(QuantizedScalarType type) {
+  switch (type) {
+  case QuantizedScalarType::UInt8:
+    return "UInt8";
+  case QuantizedScalarType::UInt16:
+    return "UInt16";
+  case QuantizedScalarType::Float16:
+    return "Float16";
+  }
+  return "";
+}
+
+void checkQuantization(const ScalarQuantization& quantization) {
+  if (!std::isfinite(quantization.scale) || quantization.scale == 0.f || !std::isfinite(quantization.offset)) {
+    exception("scalar quantization must have a finite, nonzero scale and a finite offset");
+  }
+}
+
+// Round a value in the stored units to the nearest representable integer
+template <typename S>
+S quantizeValue(float storedVal) {
+  if (!(storedVal > 0.f)) return 0; // also catches NaN
+  const float maxVal = static_cast<float>(std::numeric_limits<S>::max());
+  if (storedVal >= maxVal) return std::numeric_limits<S>::max();
+  return static_cast<S>(std::lround(storedVal));
+}
+
+} // namespace
+
+QuantizedScalarArray::QuantizedScalarArray(std::vector<uint8_t> storedValues, ScalarQuantization quantization_)
+    : quantization(quantization_), storedValues8(std::move(storedValues)) {
+  checkQuantization(quantization);
+  if (quantization.type != QuantizedScalarType::UInt8) {
+    exception("8 bit stored values cannot be quantized as " + quantizedTypeName(quantization.type));
+  }
+}
+
+QuantizedScalarArray::QuantizedScalarArray(std::vector<uint16_t> storedValues, ScalarQuantization quantization_)
+    : quantization(quantization_), storedValues16(std::move(storedValues)) {
+  checkQuantization(quantization);
+  if (quantization.type == QuantizedScalarType::UInt8) {
+    exception("16 bit stored values cannot be quantized as " + quantizedTypeName(quantization.type));
+  }
+}
+
+size_t QuantizedScalarArray::size() const {
+  return quantization.type == QuantizedScalarType::UInt8 ? storedValues8.size() : storedValues16.size();
+}
+
+size_t QuantizedScalarArray::sizeInBytes() const {
+  return storedValues8.size() * sizeof(uint8_t) + storedValues16.size() * sizeof(uint16_t);
+}
+
+const ScalarQuantization& QuantizedScalarArray::getQuantization() const { return quantization; }
+
+float QuantizedScalarArray::getValue(size_t ind) const {
+  float val;
+  readValues(ind, 1, &val);
+  return val;
+}
+
+void QuantizedScalarArray::readValues(size_t start, size_t count, float* out) const {
+  if (start + count > size()) {
+    exception("quantized scalar array read range [" + std::to_string(start) + "," + std::to_string(start + count) +
+              "), but it has " + std::to_string(size()) + " values");
+  }
+
+  const float scale = quantization.scale;
+  const float offset = quantization.offset;
+  switch (quantization.type) {
+  case QuantizedScalarType::UInt8:
+    for (size_t i = 0; i < count; i++) out[i] = scale * storedValues8[start + i] + offset;
+    break;
+  case QuantizedScalarType::UInt16:
+    for (size_t i = 0; i < count; i++) out[i] = scale * storedValues16[start + i] + offset;
+    break;
+  case QuantizedScalarType::Float16:
+    for (size_t i = 0; i < count; i++) out[i] = scale * glm::unpackHalf1x16(storedValues16[start + i]) + offset;
+    break;
+  }
+}
+
+void QuantizedScalarArray::readStoredValues(size_t start, size_t count, void* out) const {
+  if (start + count > size()) {
+    exception("quantized scalar array read range [" + std::to_string(start) + "," + std::to_string(start + count) +
+              "), but it has " + std::to_string(size()) + " values");
+  }
+
+  if (quantization.type == QuantizedScalarType::UInt8) {
+    std::copy(storedValues8.begin() + start, storedValues8.begin() + start + count, static_cast<uint8_t*>(out));
+  } else {
+    std::copy(storedValues16.begin() + start, storedValues16.begin() + start + count, static_cast<uint16_t*>(out));
+  }
+}
+
+void QuantizedScalarArray::writeValues(size_t start, size_t count, const float* values) {
+  if (start + count > size()) {
+    exception("quantized scalar array write range [" + std::to_string(start) + "," + std::to_string(start + count) +
+              "), but it has " + std::to_string(size()) + " values");
+  }
+
+  const float invScale = 1.f / quantization.scale;
+  const float offset = quantization.offset;
+  switch (quantization.type) {
+  case QuantizedScalarType::UInt8:
+    for (size_t i = 0; i < count; i++) {
+      storedValues8[start + i] = quantizeValue<uint8_t>((values[i] - offset) * invScale);
+    }
+    break;
+  case QuantizedScalarType::UInt16:
+    for (size_t i = 0; i < count; i++) {
+      storedValues16[start + i] = quantizeValue<uint16_t>((values[i] - offset) * invScale);
+    }
+    break;
+  case QuantizedScalarType::Float16:
+    for (size_t i = 0; i < count; i++) storedValues16[start + i] = glm::packHalf1x16((values[i] - offset) * invScale);
+    break;
+  }
+}
+
+std::pair<float, float> QuantizedScalarArray::getValueRange() const {
+  float minVal = std::numeric_limits<float>::infinity();
+  float maxVal = -std::numeric_limits<float>::infinity();
+  const float scale = quantization.scale;
+  const float offset = quantization.offset;
+
+  // decoding is monotonic for the integer types, so only the extreme stored values need to be decoded
+  auto decodeExtremes = [&](uint16_t minStored, uint16_t maxStored) {
+    float a = scale * minStored + offset;
+    float b = scale * maxStored + offset;
+    minVal = std::min(a, b);
+    maxVal = std::max(a, b);
+  };
+
+  switch (quantization.type) {
+  case QuantizedScalarType::UInt8:
+    if (!storedValues8.empty()) {
+      auto minMax = std::minmax_element(storedValues8.begin(), storedValues8.end());
+      decodeExtremes(*minMax.first, *minMax.second);
+    }
+    break;
+  case QuantizedScalarType::UInt16:
+    if (!storedValues16.empty()) {
+      auto minMax = std::minmax_element(storedValues16.begin(), storedValues16.end());
+      decodeExtremes(*minMax.first, *minMax.second);
+    }
+    break;
+  case QuantizedScalarType::Float16:
+    for (uint16_t stored : storedValues16) {
+      float val = scale * glm::unpackHalf1x16(stored) + offset;
+      if (!std::isfinite(val)) continue;
+      minVal = std::min(minVal, val);
+      maxVal = std::max(maxVal, val);
+    }
+    break;
+  }
+
+  return std::make_pair(minVal, maxVal);
+}
+
+std::vector<float> QuantizedScalarArray::sampleValues(size_t maxCount) const {
+  const size_t nRuns = 64;
+  const size_t runLength = std::max<size_t>(maxCount / nRuns, 1);
+  const size_t n = size();
+
+  if (n <= nRuns * runLength) {
+    std::vector<float> allValues(n);
+    readValues(0, n, allValues.data());
+    return allValues;
+  }
+
+  // runs spread evenly over the array, so structure along the array (e.g. the slices of a volume) is represented
+  std::vector<float> sample(nRuns * runLength);
+  for (size_t iRun = 0; iRun < nRuns; iRun++) {
+    size_t start = (n - runLength) * iRun / (nRuns - 1);
+    readValues(start, runLength, &sample[iRun * runLength]);
+  }
+  return sample;
+}
+
+} // namespace polyscope
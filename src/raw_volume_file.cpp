@@ -0,0 +1,366 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#include "polyscope/raw_volume_file.h"
+
+#include "polyscope/messages.h"
+#include "polyscope/parallel.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace polyscope {
+
+namespace {
+
+std::string trimWhitespace(const std::string& s) {
+  size_t start = s.find_first_not_of(" \t\r\n");
+  if (start == std::string::npos) return "";
+  size_t end = s.find_last_not_of(" \t\r\n");
+  return s.substr(start, end - start + 1);
+}
+
+std::string toLower(std::string s) {
+  std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return std::tolower(c); });
+  return s;
+}
+
+RawVolumeDataType parseNrrdType(const std::string& filename, std::string type) {
+  type = toLower(type);
+  // clang-format off
+  if (type == "uchar" || type == "unsigned char" || type == "uint8" || type == "uint8_t") return RawVolumeDataType::UInt8;
+  if (type == "signed char" || type == "int8" || type == "int8_t") return RawVolumeDataType::Int8;
+  if (type == "ushort" || type == "unsigned short" || type == "unsigned short int" || type == "uint16" || type == "uint16_t") return RawVolumeDataType::UInt16;
+  if (type == "short" || type == "short int" || type == "signed short" || type == "signed short int" || type == "int16" || type == "int16_t") return RawVolumeDataType::Int16;
+  if (type == "uint" || type == "unsigned int" || type == "uint32" || type == "uint32_t") return RawVolumeDataType::UInt32;
+  if (type == "int" || type == "signed int" || type == "int32" || type == "int32_t") return RawVolumeDataType::Int32;
+  if (type == "float") return RawVolumeDataType::Float32;
+  if (type == "double") return RawVolumeDataType::Float64;
+  // clang-format on
+  exception("raw volume file " + filename + " has unsupported type '" + type + "'");
+  return RawVolumeDataType::Float32; // dummy return
+}
+
+size_t bytesPerValue(RawVolumeDataType type) {
+  switch (type) {
+  case RawVolumeDataType::UInt8:
+  case RawVolumeDataType::Int8:
+    return 1;
+  case RawVolumeDataType::UInt16:
+  case RawVolumeDataType::Int16:
+    return 2;
+  case RawVolumeDataType::UInt32:
+  case RawVolumeDataType::Int32:
+  case RawVolumeDataType::Float32:
+    return 4;
+  case RawVolumeDataType::Float64:
+    return 8;
+  }
+  return 1; // dummy return
+}
+
+bool hostIsBigEndian() {
+  const uint16_t probe = 1;
+  unsigned char firstByte;
+  std::memcpy(&firstByte, &probe, 1);
+  return firstByte == 0;
+}
+
+template <typename S>
+void convertValues(const unsigned char* src, uint64_t count, bool swapBytes, float* out) {
+  unsigned char bytes[sizeof(S)];
+  S val;
+  for (uint64_t i = 0; i < count; i++) {
+    std::memcpy(bytes, src + i * sizeof(S), sizeof(S));
+    if (swapBytes) std::reverse(bytes, bytes + sizeof(S));
+    std::memcpy(&val, bytes, sizeof(S));
+    out[i] = static_cast<float>(val);
+  }
+}
+
+// Reading is split in to blocks of at least this many values, which are read concurrently. Each block touches
+// different pages of the mapped file, so the reads from disk overlap.
+const size_t readBlockSize = 1 << 16;
+
+} // namespace
+
+RawVolumeFile::RawVolumeFile(std::string filename_) : filename(filename_) {
+
+  std::ifstream in(filename, std::ios::binary);
+  if (!in) exception("could not open raw volume file " + filename);
+
+  std::string line;
+  std::getline(in, line);
+  if (line.compare(0, 4, "NRRD") != 0) {
+    exception("raw volume file " + filename + " does not start with a NRRD header");
+  }
+
+  // Parse the header fields, up to the blank line which ends it
+  std::string dataFilename;
+  bool haveType = false, haveSizes = false;
+  uint64_t byteSkip = 0;
+  while (std::getline(in, line)) {
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    if (line.empty()) break;
+    if (line[0] == '#') continue; // comment
+
+    // key/value pairs
+    size_t kvSep = line.find(":=");
+    if (kvSep != std::string::npos) {
+      if (trimWhitespace(line.substr(0, kvSep)) == "polyscope_brick_size") {
+        layout.brickSize = static_cast<uint32_t>(std::stoul(trimWhitespace(line.substr(kvSep + 2))));
+      }
+      continue;
+    }
+
+    // fields
+    size_t sep = line.find(": ");
+    if (sep == std::string::npos) {
+      exception("raw volume file " + filename + " has a bad header line '" + line + "'");
+    }
+    std::string field = toLower(trimWhitespace(line.substr(0, sep)));
+    std::string value = trimWhitespace(line.substr(sep + 2));
+
+    if (field == "type") {
+      layout.dataType = parseNrrdType(filename, value);
+      haveType = true;
+    } else if (field == "dimension") {
+      if (value != "3") exception("raw volume file " + filename + " must have dimension 3, has " + value);
+    } else if (field == "sizes") {
+      std::istringstream sizes(value);
+      if (!(sizes >> layout.dim.x >> layout.dim.y >> layout.dim.z)) {
+        exception("raw volume file " + filename + " has bad sizes '" + value + "'");
+      }
+      haveSizes = true;
+    } else if (field == "endian") {
+      layout.bigEndian = toLower(value) == "big";
+    } else if (field == "encoding") {
+      if (toLower(value) != "raw") {
+        exception("raw volume file " + filename + " has encoding " + value + ", only raw is supported");
+      }
+    } else if (field == "byte skip" || field == "byteskip") {
+      long long skip = std::stoll(value);
+      if (skip < 0) exception("raw volume file " + filename + " has a byte skip of -1, which is not supported");
+      byteSkip = static_cast<uint64_t>(skip);
+    } else if (field == "data file" || field == "datafile") {
+      dataFilename = value;
+    }
+    // other fields (spacings, space directions, etc) do not affect the layout of the values
+  }
+
+  if (!haveType || !haveSizes) {
+    exception("raw volume file " + filename + " header must give the type and sizes");
+  }
+
+  if (dataFilename.empty()) {
+    // the values follow the header
+    std::streamoff headerEnd = in.tellg();
+    if (headerEnd < 0) exception("raw volume file " + filename + " has no data after its header");
+    layout.headerBytes = static_cast<uint64_t>(headerEnd) + byteSkip;
+    in.close();
+    mapFile(filename);
+  } else {
+    // a detached header, the data file is relative to the header
+    if (dataFilename == "LIST" || dataFilename.find(' ') != std::string::npos) {
+      exception("raw volume file " + filename + " uses several data files, which is not supported");
+    }
+    size_t dirEnd = filename.find_last_of("/\\");
+    if (dirEnd != std::string::npos && dataFilename[0] != '/') {
+      dataFilename = filename.substr(0, dirEnd + 1) + dataFilename;
+    }
+    layout.headerBytes = byteSkip;
+    in.close();
+    mapFile(dataFilename);
+  }
+}
+
+RawVolumeFile::RawVolumeFile(std::string filename_, const RawVolumeLayout& layout_)
+    : filename(filename_), layout(layout_) {
+  mapFile(filename);
+}
+
+RawVolumeFile::~RawVolumeFile() { unmapFile(); }
+
+void RawVolumeFile::mapFile(std::string dataFilename) {
+
+  for (int i = 0; i < 3; i++) {
+    if (layout.dim[i] == 0) exception("raw volume file " + filename + " has size 0");
+  }
+
+#ifdef _WIN32
+  HANDLE file = CreateFileA(dataFilename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL, NULL);
+  if (file == INVALID_HANDLE_VALUE) exception("could not open raw volume file " + dataFilename);
+  LARGE_INTEGER fileSize;
+  if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+    CloseHandle(file);
+    exception("could not read the size of raw volume file " + dataFilename);
+  }
+  HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+  CloseHandle(file); // the mapping keeps the file open
+  if (mapping == NULL) exception("could not map raw volume file " + dataFilename);
+  void* ptr = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (ptr == NULL) {
+    CloseHandle(mapping);
+    exception("could not map raw volume file " + dataFilename);
+  }
+  mappingHandle = mapping;
+  mappedBytes = static_cast<uint64_t>(fileSize.QuadPart);
+#else
+  int fd = open(dataFilename.c_str(), O_RDONLY);
+  if (fd < 0) exception("could not open raw volume file " + dataFilename);
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0) {
+    close(fd);
+    exception("could not read the size of raw volume file " + dataFilename);
+  }
+  void* ptr = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd); // the mapping keeps the file open
+  if (ptr == MAP_FAILED) exception("could not map raw volume file " + dataFilename);
+  mappedBytes = static_cast<uint64_t>(fileStat.st_size);
+#endif
+  mappedData = static_cast<const unsigned char*>(ptr);
+
+  // Check that the file holds all of the values
+  uint64_t nStored = nValues();
+  if (layout.brickSize > 0) {
+    glm::uvec3 brickDim = (layout.dim + (layout.brickSize - 1)) / layout.brickSize;
+    nStored = static_cast<uint64_t>(brickDim.x) * brickDim.y * brickDim.z * layout.brickSize * layout.brickSize *
+              layout.brickSize;
+  }
+  uint64_t neededBytes = layout.headerBytes + nStored * bytesPerValue(layout.dataType);
+  if (mappedBytes < neededBytes) {
+    uint64_t haveBytes = mappedBytes;
+    unmapFile();
+    exception("raw volume file " + dataFilename + " has " + std::to_string(haveBytes) +
+              " bytes, but its layout needs " + std::to_string(neededBytes));
+  }
+}
+
+void RawVolumeFile::unmapFile() {
+  if (mappedData == nullptr) return;
+#ifdef _WIN32
+  UnmapViewOfFile(mappedData);
+  CloseHandle(static_cast<HANDLE>(mappingHandle));
+  mappingHandle = nullptr;
+#else
+  munmap(const_cast<unsigned char*>(mappedData), static_cast<size_t>(mappedBytes));
+#endif
+  mappedData = nullptr;
+  mappedBytes = 0;
+}
+
+const std::string& RawVolumeFile::getFilename() const { return filename; }
+
+const RawVolumeLayout& RawVolumeFile::getLayout() const { return layout; }
+
+glm::uvec3 RawVolumeFile::getDim() const { return layout.dim; }
+
+uint64_t RawVolumeFile::nValues() const {
+  return static_cast<uint64_t>(layout.dim.x) * layout.dim.y * layout.dim.z;
+}
+
+void RawVolumeFile::readStoredValues(uint64_t storedStart, uint64_t count, float* out) const {
+  size_t valueBytes = bytesPerValue(layout.dataType);
+  const unsigned char* src = mappedData + layout.headerBytes + storedStart * valueBytes;
+  bool swapBytes = valueBytes > 1 && layout.bigEndian != hostIsBigEndian();
+
+  switch (layout.dataType) {
+  case RawVolumeDataType::UInt8:
+    convertValues<uint8_t>(src, count, swapBytes, out);
+    break;
+  case RawVolumeDataType::Int8:
+    convertValues<int8_t>(src, count, swapBytes, out);
+    break;
+  case RawVolumeDataType::UInt16:
+    convertValues<uint16_t>(src, count, swapBytes, out);
+    break;
+  case RawVolumeDataType::Int16:
+    convertValues<int16_t>(src, count, swapBytes, out);
+    break;
+  case RawVolumeDataType::UInt32:
+    convertValues<uint32_t>(src, count, swapBytes, out);
+    break;
+  case RawVolumeDataType::Int32:
+    convertValues<int32_t>(src, count, swapBytes, out);
+    break;
+  case RawVolumeDataType::Float32:
+    if (swapBytes) {
+      convertValues<float>(src, count, swapBytes, out);
+    } else {
+      std::memcpy(out, src, count * sizeof(float));
+    }
+    break;
+  case RawVolumeDataType::Float64:
+    convertValues<double>(src, count, swapBytes, out);
+    break;
+  }
+}
+
+void RawVolumeFile::readValues(uint64_t start, uint64_t count, float* out) const {
+  if (start + count > nValues()) {
+    exception("raw volume file " + filename + " read range [" + std::to_string(start) + "," +
+              std::to_string(start + count) + "), but it has " + std::to_string(nValues()) + " values");
+  }
+
+  const glm::uvec3 dim = layout.dim;
+  const uint32_t B = layout.brickSize;
+  const glm::uvec3 brickDim = B > 0 ? (dim + (B - 1)) / B : glm::uvec3(1);
+
+  // Read [blockStart, blockEnd) of the requested range
+  auto readBlock = [&](size_t iBlock, size_t blockStart, size_t blockEnd) {
+    if (B == 0) {
+      readStoredValues(start + blockStart, blockEnd - blockStart, out + blockStart);
+      return;
+    }
+
+    // Bricked: each row of the volume is split in to runs which are contiguous within a brick
+    uint64_t i = start + blockStart;
+    uint64_t iEnd = start + blockEnd;
+    while (i < iEnd) {
+      uint32_t x = static_cast<uint32_t>(i % dim.x);
+      uint32_t y = static_cast<uint32_t>((i / dim.x) % dim.y);
+      uint32_t z = static_cast<uint32_t>(i / (static_cast<uint64_t>(dim.x) * dim.y));
+      uint64_t runLength = std::min<uint64_t>(B - x % B, iEnd - i);
+      runLength = std::min<uint64_t>(runLength, dim.x - x);
+
+      glm::uvec3 brick{x / B, y / B, z / B};
+      uint64_t brickInd = (static_cast<uint64_t>(brick.z) * brickDim.y + brick.y) * brickDim.x + brick.x;
+      uint64_t inBrick = (static_cast<uint64_t>(z % B) * B + y % B) * B + x % B;
+      readStoredValues(brickInd * B * B * B + inBrick, runLength, out + (i - start));
+      i += runLength;
+    }
+  };
+
+  parallelForBlocks(count, readBlockSize, readBlock);
+}
+
+float RawVolumeFile::getValue(glm::uvec3 ind) const {
+  float val;
+  readValues((static_cast<uint64_t>(ind.z) * layout.dim.y + ind.y) * layout.dim.x + ind.x, 1, &val);
+  return val;
+}
+
+std::shared_ptr<RawVolumeFile> openRawVolumeFile(std::string filename) {
+  return std::make_shared<RawVolumeFile>(filename);
+}
+
+std::shared_ptr<RawVolumeFile> openRawVolumeFile(std::string filename, const RawVolumeLayout& layout) {
+  return std::make_shared<RawVolumeFile>(filename, layout);
+}
+
+} // namespace polyscope
@@ -10,6 +10,9 @@
 #include "imgui.h"
 #include "stb_image.h"
 
+#include <algorithm>
+#include <unordered_set>
+
 namespace polyscope {
 
 int dimension(const TextureFormat& x) {
@@ -22,6 +25,8 @@ int dimension(const TextureFormat& x) {
     case TextureFormat::RGBA16F:  return 4;
     case TextureFormat::R32F:     return 1;
     case TextureFormat::R16F:     return 1;
+    case TextureFormat::R16:      return 1;
+    case TextureFormat::R8:       return 1;
     case TextureFormat::RGB32F:   return 3;
     case TextureFormat::RGBA32F:  return 4;
     case TextureFormat::DEPTH24:  return 1;
@@ -41,6 +46,8 @@ int sizeInBytes(const TextureFormat& f) {
     case TextureFormat::RGBA16F:  return 4*2;
     case TextureFormat::R32F:     return 1*4;
     case TextureFormat::R16F:     return 1*2;
+    case TextureFormat::R16:      return 1*2;
+    case TextureFormat::R8:       return 1*1;
     case TextureFormat::RGB32F:   return 3*4;
     case TextureFormat::RGBA32F:  return 4*4;
     case TextureFormat::DEPTH24:  return 1*3;
@@ -158,10 +165,41 @@ std::string deviceBufferTypeName(const DeviceBufferType& d) {
 
 namespace render {
 
+namespace {
+// All render buffers which currently exist, for memory accounting
+std::unordered_set<const AttributeBuffer*>& liveAttributeBuffers() {
+  static std::unordered_set<const AttributeBuffer*> buffers;
+  return buffers;
+}
+std::unordered_set<const TextureBuffer*>& liveTextureBuffers() {
+  static std::unordered_set<const TextureBuffer*> buffers;
+  return buffers;
+}
+} // namespace
+
+int64_t getTotalDeviceBufferBytes() {
+  int64_t total = 0;
+  for (const AttributeBuffer* b : liveAttributeBuffers()) {
+    total += b->getAllocatedSizeInBytes();
+  }
+  for (const TextureBuffer* b : liveTextureBuffers()) {
+    total += b->getSizeInBytes();
+  }
+  return total;
+}
+
+void convertToFloat(const double* data, size_t count, float* out) {
+  for (size_t i = 0; i < count; i++) {
+    out[i] = static_cast<float>(data[i]);
+  }
+}
+
 AttributeBuffer::AttributeBuffer(RenderDataType dataType_, int arrayCount_)
-    : dataType(dataType_), arrayCount(arrayCount_), uniqueID(render::engine->getNextUniqueID()) {}
+    : dataType(dataType_), arrayCount(arrayCount_), uniqueID(render::engine->getNextUniqueID()) {
+  liveAttributeBuffers().insert(this);
+}
 
-AttributeBuffer::~AttributeBuffer() {}
+AttributeBuffer::~AttributeBuffer() { liveAttributeBuffers().erase(this); }
 
 TextureBuffer::TextureBuffer(int dim_, TextureFormat format_, unsigned int sizeX_, unsigned int sizeY_,
                              unsigned int sizeZ_)
@@ -169,9 +207,10 @@ TextureBuffer::TextureBuffer(int dim_, TextureFormat format_, unsigned int sizeX
       uniqueID(render::engine->getNextUniqueID()) {
   if (sizeX > (1 << 22)) exception("OpenGL error: invalid texture dimensions");
   if (dim > 1 && sizeY > (1 << 22)) exception("OpenGL error: invalid texture dimensions");
+  liveTextureBuffers().insert(this);
 }
 
-TextureBuffer::~TextureBuffer() {}
+TextureBuffer::~TextureBuffer() { liveTextureBuffers().erase(this); }
 
 void TextureBuffer::setFilterMode(FilterMode newMode) {}
 
@@ -1181,5 +1220,48 @@ void Engine::preserveResourceUntilImguiFrameCompletes(std::shared_ptr<TextureBuf
 
 void Engine::clearResourcesPreservedForImguiFrame() { resourcesPreservedForImGuiFrame.clear(); }
 
+void Engine::queueUpload(uint64_t key, std::function<void()> uploadFunc) {
+  currFrameUploadStats.queuedRequests++;
+  if (!uploadQueueKeys.insert(key).second) return; // already pending
+  uploadQueue.emplace_back(key, uploadFunc);
+}
+
+void Engine::cancelQueuedUpload(uint64_t key) {
+  if (uploadQueueKeys.erase(key) == 0) return;
+  uploadQueue.erase(std::remove_if(uploadQueue.begin(), uploadQueue.end(),
+                                   [&](const std::tuple<uint64_t, std::function<void()>>& entry) {
+                                     return std::get<0>(entry) == key;
+                                   }),
+                    uploadQueue.end());
+}
+
+void Engine::flushUploadQueue() {
+  if (uploadQueue.empty()) return;
+
+  // swap out the queue first, in case an upload queues something else
+  std::vector<std::tuple<uint64_t, std::function<void()>>> currQueue;
+  currQueue.swap(uploadQueue);
+  uploadQueueKeys.clear();
+
+  for (std::tuple<uint64_t, std::function<void()>>& entry : currQueue) {
+    std::get<1>(entry)();
+    currFrameUploadStats.queuedUploads++;
+  }
+}
+
+size_t Engine::getUploadQueueSize() { return uploadQueue.size(); }
+
+void Engine::recordUpload(size_t nBytes) {
+  currFrameUploadStats.uploadCount++;
+  currFrameUploadStats.uploadBytes += nBytes;
+}
+
+void Engine::endUploadStatsFrame() {
+  lastFrameUploadStats = currFrameUploadStats;
+  currFrameUploadStats = UploadStats();
+}
+
+const UploadStats& Engine::getUploadStats() { return lastFrameUploadStats; }
+
 } // namespace render
 } // namespace polyscope
@@ -1,6 +1,11 @@
 // Copyright 2018-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
 
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+#include <unordered_set>
 #include <vector>
 
 #include "polyscope/render/managed_buffer.h"
@@ -12,9 +17,158 @@
 #include "polyscope/render/engine.h"
 #include "polyscope/render/templated_buffers.h"
 
+#include <glm/gtc/packing.hpp>
+
 namespace polyscope {
 namespace render {
 
+// === Global tracking of host copies, for the memory budget
+
+namespace {
+
+// All live managed buffers. Intentionally leaked, so that buffers which are destroyed during static destruction can
+// still unregister themselves.
+std::unordered_set<HostCopyEvictable*>& allHostCopyEvictables() {
+  static std::unordered_set<HostCopyEvictable*>* buffers = new std::unordered_set<HostCopyEvictable*>();
+  return *buffers;
+}
+
+uint64_t hostCopyUseCounter = 0;
+
+} // namespace
+
+void HostCopyEvictable::markHostCopyUsed() { lastHostCopyUse = ++hostCopyUseCounter; }
+
+int64_t getTotalManagedBufferHostBytes() {
+  int64_t total = 0;
+  for (HostCopyEvictable* b : allHostCopyEvictables()) {
+    total += static_cast<int64_t>(b->getHostCopyBytes());
+  }
+  return total;
+}
+
+int64_t enforceHostMemoryBudget() { return enforceHostMemoryBudget(options::hostMemoryBudget); }
+
+int64_t enforceHostMemoryBudget(int64_t budgetBytes) {
+  if (budgetBytes < 0) return 0; // no limit
+
+  int64_t totalBytes = getTotalManagedBufferHostBytes();
+  if (totalBytes <= budgetBytes) return 0;
+
+  std::vector<HostCopyEvictable*> candidates;
+  for (HostCopyEvictable* b : allHostCopyEvictables()) {
+    if (b->hostCopyIsEvictable()) candidates.push_back(b);
+  }
+
+  // recomputable buffers first, then least-recently used, then largest
+  std::sort(candidates.begin(), candidates.end(), [](HostCopyEvictable* a, HostCopyEvictable* b) {
+    if (a->hostCopyIsRecomputable() != b->hostCopyIsRecomputable()) return a->hostCopyIsRecomputable();
+    if (a->lastHostCopyUse != b->lastHostCopyUse) return a->lastHostCopyUse < b->lastHostCopyUse;
+    return a->getHostCopyBytes() > b->getHostCopyBytes();
+  });
+
+  int64_t freedBytes = 0;
+  for (HostCopyEvictable* b : candidates) {
+    if (totalBytes - freedBytes <= budgetBytes) break;
+    int64_t bytes = static_cast<int64_t>(b->getHostCopyBytes());
+    b->evictHostCopy();
+    freedBytes += bytes;
+  }
+
+  return freedBytes;
+}
+
+// === Compact texture storage
+
+namespace {
+
+// Only scalar float textures can be encoded, see setTextureEncoding()
+template <typename T>
+void uploadEncodedTextureRegion(TextureBuffer& texture, const T* values, std::array<unsigned int, 3> offset,
+                                std::array<unsigned int, 3> size, TextureFormat format, float scale,
+                                float valueOffset) {
+  exception("only scalar float textures can be encoded");
+}
+
+template <typename S>
+std::vector<S> quantizeTextureValues(const float* values, size_t count, float scale, float valueOffset) {
+  const float maxStored = static_cast<float>(std::numeric_limits<S>::max());
+  std::vector<S> stored(count);
+  for (size_t i = 0; i < count; i++) {
+    float q = std::round((values[i] - valueOffset) / scale);
+    if (!(q > 0.f)) q = 0.f; // also catches NaN
+    stored[i] = static_cast<S>(std::min(q, maxStored));
+  }
+  return stored;
+}
+
+void uploadEncodedTextureRegion(TextureBuffer& texture, const float* values, std::array<unsigned int, 3> offset,
+                                std::array<unsigned int, 3> size, TextureFormat format, float scale,
+                                float valueOffset) {
+  size_t count = static_cast<size_t>(size[0]) * size[1] * size[2];
+  switch (format) {
+  case TextureFormat::R8: {
+    std::vector<uint8_t> stored = quantizeTextureValues<uint8_t>(values, count, scale, valueOffset);
+    texture.setDataRegion(stored.data(), offset, size);
+    break;
+  }
+  case TextureFormat::R16: {
+    std::vector<uint16_t> stored = quantizeTextureValues<uint16_t>(values, count, scale, valueOffset);
+    texture.setDataRegion(stored.data(), offset, size);
+    break;
+  }
+  case TextureFormat::R16F: {
+    std::vector<uint16_t> stored(count);
+    for (size_t i = 0; i < count; i++) {
+      stored[i] = static_cast<uint16_t>(glm::packHalf1x16((values[i] - valueOffset) / scale));
+    }
+    texture.setDataRegion(stored.data(), offset, size);
+    break;
+  }
+  default:
+    exception("bad texture encoding format");
+    break;
+  }
+}
+
+// Upload values which are already in the texture encoding, as read by readStored(start, count, out)
+void uploadStoredTextureRegion(TextureBuffer& texture, const std::function<void(size_t, size_t, void*)>& readStored,
+                               size_t start, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size,
+                               TextureFormat format) {
+  size_t count = static_cast<size_t>(size[0]) * size[1] * size[2];
+  switch (format) {
+  case TextureFormat::R8: {
+    std::vector<uint8_t> stored(count);
+    readStored(start, count, stored.data());
+    texture.setDataRegion(stored.data(), offset, size);
+    break;
+  }
+  case TextureFormat::R16:
+  case TextureFormat::R16F: {
+    std::vector<uint16_t> stored(count);
+    readStored(start, count, stored.data());
+    texture.setDataRegion(stored.data(), offset, size);
+    break;
+  }
+  default:
+    exception("bad texture encoding format");
+    break;
+  }
+}
+
+template <typename T>
+void decodeTextureValues(std::vector<T>& values, float decodeScale, float decodeOffset) {
+  exception("only scalar float textures can be encoded");
+}
+
+void decodeTextureValues(std::vector<float>& values, float decodeScale, float decodeOffset) {
+  for (float& v : values) v = decodeScale * v + decodeOffset;
+}
+
+} // namespace
+
+// === Managed buffer
+
 template <typename T>
 ManagedBuffer<T>::ManagedBuffer(ManagedBufferRegistry* registry_, const std::string& name_, std::vector<T>& data_)
     : name(name_), uniqueID(internal::getNextUniqueID()), registry(registry_), data(data_), dataGetsComputed(false),
@@ -23,6 +177,8 @@ ManagedBuffer<T>::ManagedBuffer(ManagedBufferRegistry* registry_, const std::str
   if (registry) {
     registry->addManagedBuffer<T>(this);
   }
+  allHostCopyEvictables().insert(this);
+  markHostCopyUsed();
 }
 
 
@@ -35,14 +191,22 @@ ManagedBuffer<T>::ManagedBuffer(ManagedBufferRegistry* registry_, const std::str
   if (registry) {
     registry->addManagedBuffer<T>(this);
   }
+  allHostCopyEvictables().insert(this);
 }
 
 template <typename T>
-ManagedBuffer<T>::~ManagedBuffer() {}
+ManagedBuffer<T>::~ManagedBuffer() {
+  cancelQueuedDeviceUpload();
+  allHostCopyEvictables().erase(this);
+}
 
 template <typename T>
 void ManagedBuffer<T>::checkInvalidValues() {
-  polyscope::checkInvalidValues(name, data);
+  if (hasExternalData()) {
+    polyscope::checkInvalidValues(name, externalData, externalDataSize);
+  } else {
+    polyscope::checkInvalidValues(name, data);
+  }
 }
 
 template <typename T>
@@ -81,6 +245,8 @@ std::array<uint32_t, 3> ManagedBuffer<T>::getTextureSize() const {
 template <typename T>
 void ManagedBuffer<T>::ensureHostBufferPopulated() {
 
+  markHostCopyUsed();
+
   switch (currentCanonicalDataSource()) {
   case CanonicalDataSource::HostData:
     // good to go, nothing needs to be done
@@ -93,28 +259,104 @@ void ManagedBuffer<T>::ensureHostBufferPopulated() {
 
     break;
 
+  case CanonicalDataSource::ExternalData:
+
+    // copy the values in to the host buffer
+    releaseExternalData();
+
+    break;
+
+  case CanonicalDataSource::StreamedData: {
+
+    // read all of the values in to the host buffer
+    data.resize(streamedDataSize);
+    streamedDataReadFunc(0, streamedDataSize, data.data());
+    hostBufferIsPopulated = true;
+    stopStreaming();
+
+    break;
+  }
+
   case CanonicalDataSource::RenderBuffer:
 
     if (deviceBufferTypeIsTexture()) {
       if (!renderTextureBuffer) exception("render buffer should be allocated but isn't");
 
-      // copy the data back from the renderBuffer
-      // TODO not implemented yet
-      exception("copy-back from texture not implemented yet");
+      // copy the data back from the render texture
+      if (pendingTextureReadback) {
+        // an asynchronous copy of the current values is already underway, just finish it
+        finishTextureReadback(pendingTextureReadback);
+      } else {
+        data = getTextureBufferData<T>(*renderTextureBuffer);
+        if (textureIsEncoded) decodeTextureValues(data, getTextureDecodeScale(), getTextureDecodeOffset());
+        hostBufferIsPopulated = true; // the copy stays valid until the render texture is written again
+      }
     } else {
       // sanity check
       if (!renderAttributeBuffer) exception("render buffer should be allocated but isn't");
 
       // copy the data back from the renderBuffer
       data = getAttributeBufferDataRange<T>(*renderAttributeBuffer, 0, renderAttributeBuffer->getDataSize());
+      hostBufferIsPopulated = true; // the copy stays valid until the render buffer is written again
     }
 
     break;
   };
 }
 
+template <typename T>
+ManagedBufferReadback<T> ManagedBuffer<T>::ensureHostBufferPopulatedAsync() {
+  ManagedBufferReadback<T> handle;
+  handle.buffer = getWeakHandle<ManagedBuffer<T>>(this);
+
+  // Only texture copy-back happens asynchronously, everything else is handled immediately. Encoded textures are read
+  // back synchronously too, so they can be decoded.
+  if (!deviceBufferTypeIsTexture() || currentCanonicalDataSource() != CanonicalDataSource::RenderBuffer ||
+      textureIsEncoded) {
+    ensureHostBufferPopulated();
+    return handle;
+  }
+
+  if (!pendingTextureReadback) {
+    pendingTextureReadback = renderTextureBuffer->getDataAsync();
+  }
+  handle.readback = pendingTextureReadback;
+  return handle;
+}
+
+template <typename T>
+void ManagedBuffer<T>::finishTextureReadback(const std::shared_ptr<render::TextureReadback>& readback) {
+
+  // If the readback is out of date (the values have changed since it started, or it was already used), fall back on
+  // the usual path
+  if (readback != pendingTextureReadback || currentCanonicalDataSource() != CanonicalDataSource::RenderBuffer) {
+    if (readback == pendingTextureReadback) pendingTextureReadback.reset();
+    ensureHostBufferPopulated();
+    return;
+  }
+
+  std::vector<T> readData = unpackTextureReadbackData<T>(readback->getData());
+  pendingTextureReadback.reset();
+  data = readData;
+  hostBufferIsPopulated = true;
+}
+
+template <typename T>
+bool ManagedBufferReadback<T>::isReady() {
+  if (!readback || !buffer.isValid()) return true;
+  return readback->isReady();
+}
+
+template <typename T>
+void ManagedBufferReadback<T>::wait() {
+  if (!readback || !buffer.isValid()) return;
+  buffer.get().finishTextureReadback(readback);
+}
+
 template <typename T>
 void ManagedBuffer<T>::ensureHostBufferAllocated() {
+  if (hasExternalData()) releaseExternalData();
+  if (hasStreamedData()) ensureHostBufferPopulated();
   data.resize(size());
 }
 
@@ -126,16 +368,46 @@ std::vector<T>& ManagedBuffer<T>::getPopulatedHostBufferRef() {
 
 template <typename T>
 void ManagedBuffer<T>::markHostBufferUpdated() {
-  hostBufferIsPopulated = true;
+  if (hasStreamedData() && data.size() == streamedDataSize) stopStreaming(); // new values were written to `data`
+  if (!hasExternalData() && !hasStreamedData()) hostBufferIsPopulated = true;
+  markHostCopyUsed();
+  dirtyHostRanges.clear(); // everything gets sent below
+  invalidateInverseIndexMap();
+  recordFullUpdate();
+  pendingTextureReadback.reset(); // would hold old values
+
+  if (shouldQueueDeviceUpload()) {
+    queueDeviceUpload(true);
+    return;
+  }
+
+  uploadHostBufferToDevice();
+}
+
+template <typename T>
+void ManagedBuffer<T>::uploadHostBufferToDevice() {
 
   // If the data is stored in the device-side buffers, update it as needed
   if (renderAttributeBuffer) {
-    renderAttributeBuffer->setData(data);
+    if (hasExternalData()) {
+      renderAttributeBuffer->setData(externalData, externalDataSize);
+    } else {
+      renderAttributeBuffer->setData(data);
+    }
     requestRedraw();
   }
 
   if (renderTextureBuffer) {
-    renderTextureBuffer->setData(data);
+    if (hasStreamedData()) {
+      uploadStreamedTextureToDevice();
+    } else if (textureIsEncoded) {
+      setWholeTexture(hasExternalData() ? externalData : data.data());
+    } else if (hasExternalData()) {
+      // textures can only be set from a vector, this is a temporary copy
+      renderTextureBuffer->setData(std::vector<T>(externalData, externalData + externalDataSize));
+    } else {
+      renderTextureBuffer->setData(data);
+    }
     requestRedraw();
   }
 
@@ -145,11 +417,397 @@ void ManagedBuffer<T>::markHostBufferUpdated() {
   }
 }
 
+template <typename T>
+void ManagedBuffer<T>::markHostBufferUpdated(size_t start, size_t count) {
+  markHostBufferRangeDirty(start, count);
+  markHostBufferDirtyRangesUpdated();
+}
+
+template <typename T>
+void ManagedBuffer<T>::markHostBufferRangeDirty(size_t start, size_t count) {
+  if (start + count > hostDataSize()) {
+    exception("ManagedBuffer " + name + " marked range [" + std::to_string(start) + "," +
+              std::to_string(start + count) + ") as updated, but host buffer has size " +
+              std::to_string(hostDataSize()));
+  }
+  if (count == 0) return;
+  dirtyHostRanges.push_back({start, start + count});
+}
+
+template <typename T>
+void ManagedBuffer<T>::markHostBufferDirtyRangesUpdated() {
+  if (dirtyHostRanges.empty()) return;
+
+  if (hasExternalData() && renderTextureBuffer) {
+    // texture regions can only be set from a full vector, just re-send everything
+    markHostBufferUpdated();
+    return;
+  }
+
+  if (!hasExternalData()) hostBufferIsPopulated = true;
+  markHostCopyUsed();
+  invalidateInverseIndexMap();
+  recordPartialUpdate(dirtyHostRanges);
+  pendingTextureReadback.reset(); // would hold old values
+
+  if (shouldQueueDeviceUpload()) {
+    // the ranges stay in dirtyHostRanges until the queue is flushed
+    queueDeviceUpload(false);
+    return;
+  }
+
+  uploadDirtyHostRangesToDevice();
+}
+
+template <typename T>
+void ManagedBuffer<T>::uploadDirtyHostRangesToDevice() {
+  if (dirtyHostRanges.empty()) return;
+
+  std::vector<std::array<size_t, 2>> ranges = mergeIndexRanges(dirtyHostRanges);
+  dirtyHostRanges.clear();
+
+  // If the data is stored in the device-side buffers, update just the dirty ranges
+  if (renderAttributeBuffer) {
+    for (const std::array<size_t, 2>& r : ranges) {
+      if (hasExternalData()) {
+        std::vector<T> rangeData(externalData + r[0], externalData + r[1]);
+        renderAttributeBuffer->setDataRange(rangeData, 0, rangeData.size(), r[0]);
+      } else {
+        renderAttributeBuffer->setDataRange(data, r[0], r[1], r[0]);
+      }
+    }
+  }
+
+  if (renderTextureBuffer) {
+    for (const std::array<size_t, 2>& r : ranges) {
+      uploadTextureRange(r[0], r[1]);
+    }
+  }
+
+  if (deviceBufferType == DeviceBufferType::Attribute) {
+    updateIndexedViews(ranges);
+  }
+
+  requestRedraw();
+}
+
+template <typename T>
+bool ManagedBuffer<T>::shouldQueueDeviceUpload() {
+  if (!options::deferRenderUploads || render::engine == nullptr) return false;
+
+  // nothing lives on the device yet, so there is nothing to defer
+  return renderAttributeBuffer || renderTextureBuffer || !existingIndexedViews.empty();
+}
+
+template <typename T>
+void ManagedBuffer<T>::queueDeviceUpload(bool full) {
+  if (full) deviceUploadQueuedIsFull = true;
+  deviceUploadQueued = true;
+  render::engine->queueUpload(uniqueID, [this]() { flushQueuedDeviceUpload(); });
+  requestRedraw();
+}
+
+template <typename T>
+void ManagedBuffer<T>::cancelQueuedDeviceUpload() {
+  if (!deviceUploadQueued) return;
+  if (render::engine) render::engine->cancelQueuedUpload(uniqueID);
+  deviceUploadQueued = false;
+  deviceUploadQueuedIsFull = false;
+}
+
+template <typename T>
+void ManagedBuffer<T>::flushQueuedDeviceUpload() {
+  if (!deviceUploadQueued) return;
+  bool full = deviceUploadQueuedIsFull;
+  cancelQueuedDeviceUpload();
+
+  if (full) {
+    dirtyHostRanges.clear(); // covered by the full upload
+    uploadHostBufferToDevice();
+  } else {
+    uploadDirtyHostRangesToDevice();
+  }
+}
+
+template <typename T>
+bool ManagedBuffer<T>::hasQueuedDeviceUpload() const {
+  return deviceUploadQueued;
+}
+
+template <typename T>
+void ManagedBuffer<T>::setExternalData(const T* ptr, size_t count, std::shared_ptr<const void> owner) {
+  if (dataGetsComputed) {
+    exception("ManagedBuffer " + name + " is computed internally, cannot set external data");
+  }
+  if (ptr == nullptr) {
+    exception("ManagedBuffer " + name + " external data cannot be null");
+  }
+  if (deviceBufferTypeIsTexture() && count != size()) {
+    exception("ManagedBuffer " + name + " external data has size " + std::to_string(count) + ", but texture has size " +
+              std::to_string(size()));
+  }
+
+  // drop the host copy, the external memory is canonical now
+  data.clear();
+  data.shrink_to_fit();
+  hostBufferIsPopulated = false;
+  dirtyHostRanges.clear();
+  stopStreaming();
+
+  externalData = ptr;
+  externalDataSize = count;
+  externalDataOwner = owner;
+
+  markHostBufferUpdated(); // update any render buffers
+}
+
+template <typename T>
+void ManagedBuffer<T>::releaseExternalData() {
+  if (!hasExternalData()) return;
+
+  data.assign(externalData, externalData + externalDataSize);
+  hostBufferIsPopulated = true;
+
+  externalData = nullptr;
+  externalDataSize = 0;
+  externalDataOwner.reset();
+}
+
+template <typename T>
+bool ManagedBuffer<T>::hasExternalData() const {
+  return externalData != nullptr;
+}
+
+template <typename T>
+const T* ManagedBuffer<T>::getHostDataPtr() {
+  if (hasExternalData()) return externalData;
+  ensureHostBufferPopulated();
+  return data.data();
+}
+
+template <typename T>
+size_t ManagedBuffer<T>::hostDataSize() {
+  return hasExternalData() ? externalDataSize : data.size();
+}
+
+template <typename T>
+void ManagedBuffer<T>::setStreamedData(size_t count, std::function<void(size_t, size_t, T*)> readFunc,
+                                       std::function<void(size_t, size_t, void*)> readEncodedFunc) {
+  if (dataGetsComputed) {
+    exception("ManagedBuffer " + name + " is computed internally, cannot set streamed data");
+  }
+  if (!deviceBufferTypeIsTexture()) {
+    exception("ManagedBuffer " + name + " is not a texture, only textures can be streamed");
+  }
+  if (!readFunc) {
+    exception("ManagedBuffer " + name + " streamed data needs a read function");
+  }
+  size_t texSize = static_cast<size_t>(std::max(sizeX, 1u)) * std::max(sizeY, 1u) * std::max(sizeZ, 1u);
+  if (count != texSize) {
+    exception("ManagedBuffer " + name + " streamed data has size " + std::to_string(count) + ", but texture has size " +
+              std::to_string(texSize));
+  }
+
+  // drop any other copy of the values, the read function is canonical now
+  data.clear();
+  data.shrink_to_fit();
+  hostBufferIsPopulated = false;
+  dirtyHostRanges.clear();
+  externalData = nullptr;
+  externalDataSize = 0;
+  externalDataOwner.reset();
+
+  streamedDataReadFunc = readFunc;
+  streamedEncodedDataReadFunc = readEncodedFunc;
+  streamedDataSize = count;
+
+  markHostBufferUpdated(); // update any render buffers
+}
+
+template <typename T>
+bool ManagedBuffer<T>::hasStreamedData() const {
+  return static_cast<bool>(streamedDataReadFunc);
+}
+
+template <typename T>
+void ManagedBuffer<T>::stopStreaming() {
+  streamedDataReadFunc = nullptr;
+  streamedEncodedDataReadFunc = nullptr;
+  streamedDataSize = 0;
+}
+
+template <typename T>
+void ManagedBuffer<T>::readValues(size_t start, size_t count, T* out) {
+  if (!hasStreamedData() && !hasExternalData()) {
+    ensureHostBufferPopulated();
+  }
+  if (start + count > size()) {
+    exception("ManagedBuffer " + name + " read range [" + std::to_string(start) + "," + std::to_string(start + count) +
+              "), but it has size " + std::to_string(size()));
+  }
+  if (count == 0) return;
+
+  if (hasStreamedData()) {
+    streamedDataReadFunc(start, count, out);
+  } else if (hasExternalData()) {
+    std::copy(externalData + start, externalData + start + count, out);
+  } else {
+    std::copy(data.begin() + start, data.begin() + start + count, out);
+  }
+}
+
+template <typename T>
+void ManagedBuffer<T>::uploadStreamedTextureToDevice() {
+
+  // Read and send whole slices (or rows, for 2D textures) at a time, as many as fit in one chunk, so only one chunk of
+  // values is ever held on the host
+  size_t nX = std::max(sizeX, 1u);
+  size_t nY = std::max(sizeY, 1u);
+  size_t nZ = std::max(sizeZ, 1u);
+  size_t unitSize = 1;
+  size_t nUnits = nX;
+  if (deviceBufferType == DeviceBufferType::Texture2d) {
+    unitSize = nX;
+    nUnits = nY;
+  } else if (deviceBufferType == DeviceBufferType::Texture3d) {
+    unitSize = nX * nY;
+    nUnits = nZ;
+  }
+
+  size_t chunkValues = static_cast<size_t>(std::max<int64_t>(options::streamedUploadChunkBytes, 1)) / sizeof(T);
+  size_t unitsPerChunk = std::max<size_t>(1, chunkValues / unitSize);
+
+  std::vector<T> chunk;
+  for (size_t u0 = 0; u0 < nUnits; u0 += unitsPerChunk) {
+    size_t nU = std::min(unitsPerChunk, nUnits - u0);
+
+    std::array<unsigned int, 3> offset{0, 0, 0};
+    std::array<unsigned int, 3> count{static_cast<unsigned int>(nX), 1, 1};
+    switch (deviceBufferType) {
+    case DeviceBufferType::Attribute:
+      exception("bad call");
+      break;
+    case DeviceBufferType::Texture1d:
+      offset[0] = static_cast<unsigned int>(u0);
+      count[0] = static_cast<unsigned int>(nU);
+      break;
+    case DeviceBufferType::Texture2d:
+      offset[1] = static_cast<unsigned int>(u0);
+      count[1] = static_cast<unsigned int>(nU);
+      break;
+    case DeviceBufferType::Texture3d:
+      offset[2] = static_cast<unsigned int>(u0);
+      count[1] = static_cast<unsigned int>(nY);
+      count[2] = static_cast<unsigned int>(nU);
+      break;
+    }
+
+    if (textureIsEncoded && streamedEncodedDataReadFunc) {
+      uploadStoredTextureRegion(*renderTextureBuffer, streamedEncodedDataReadFunc, u0 * unitSize, offset, count,
+                                textureEncodingFormat);
+    } else {
+      chunk.resize(nU * unitSize);
+      streamedDataReadFunc(u0 * unitSize, chunk.size(), chunk.data());
+      setTextureRegion(chunk.data(), offset, count);
+    }
+  }
+}
+
+template <typename T>
+void ManagedBuffer<T>::setTextureEncoding(TextureFormat format, float scale, float offset) {
+  if (!std::is_same<T, float>::value) {
+    exception("ManagedBuffer " + name + " does not hold scalar floats, its texture cannot be encoded");
+  }
+  if (!deviceBufferTypeIsTexture()) {
+    exception("ManagedBuffer " + name + " is not a texture, it cannot be encoded");
+  }
+  if (renderTextureBuffer) {
+    exception("ManagedBuffer " + name + " texture has already been created, its encoding cannot be changed");
+  }
+  if (format != TextureFormat::R8 && format != TextureFormat::R16 && format != TextureFormat::R16F) {
+    exception("ManagedBuffer " + name + " texture encoding must be R8, R16 or R16F");
+  }
+  if (!(scale != 0.f) || !std::isfinite(scale) || !std::isfinite(offset)) {
+    exception("ManagedBuffer " + name + " texture encoding must have a finite, nonzero scale and a finite offset");
+  }
+
+  textureIsEncoded = true;
+  textureEncodingFormat = format;
+  textureEncodingScale = scale;
+  textureEncodingOffset = offset;
+}
+
+template <typename T>
+bool ManagedBuffer<T>::hasTextureEncoding() const {
+  return textureIsEncoded;
+}
+
+template <typename T>
+TextureFormat ManagedBuffer<T>::getTextureEncodingFormat() const {
+  return textureIsEncoded ? textureEncodingFormat : TextureFormat::R32F;
+}
+
+template <typename T>
+float ManagedBuffer<T>::getTextureDecodeScale() const {
+  if (!textureIsEncoded) return 1.;
+  switch (textureEncodingFormat) {
+  case TextureFormat::R8:
+    return textureEncodingScale * std::numeric_limits<uint8_t>::max();
+  case TextureFormat::R16:
+    return textureEncodingScale * std::numeric_limits<uint16_t>::max();
+  default:
+    return textureEncodingScale;
+  }
+}
+
+template <typename T>
+float ManagedBuffer<T>::getTextureDecodeOffset() const {
+  return textureIsEncoded ? textureEncodingOffset : 0.f;
+}
+
+template <typename T>
+void ManagedBuffer<T>::setTextureRegion(const T* values, std::array<unsigned int, 3> offset,
+                                        std::array<unsigned int, 3> size) {
+  if (textureIsEncoded) {
+    uploadEncodedTextureRegion(*renderTextureBuffer, values, offset, size, textureEncodingFormat, textureEncodingScale,
+                               textureEncodingOffset);
+  } else {
+    renderTextureBuffer->setDataRegion(values, offset, size);
+  }
+}
+
+template <typename T>
+void ManagedBuffer<T>::setWholeTexture(const T* values) {
+  // unused dimensions have size 1
+  std::array<unsigned int, 3> size{sizeX, 1u, 1u};
+  if (deviceBufferType != DeviceBufferType::Texture1d) size[1] = sizeY;
+  if (deviceBufferType == DeviceBufferType::Texture3d) size[2] = sizeZ;
+  setTextureRegion(values, {0, 0, 0}, size);
+}
+
+template <typename T>
+std::vector<T> ManagedBuffer<T>::gatherHostValues(const std::vector<uint32_t>& indices) {
+  if (!hasExternalData()) {
+    ensureHostBufferPopulated();
+    return gather(data, indices);
+  }
+
+  // same as gather(), but reading from the external memory
+  if (indices.size() == 0) {
+    return std::vector<T>(externalData, externalData + externalDataSize);
+  }
+  std::vector<T> result(indices.size());
+  for (size_t i = 0; i < indices.size(); i++) {
+    result[i] = externalData[indices[i]];
+  }
+  return result;
+}
+
 template <typename T>
 T ManagedBuffer<T>::getValue(size_t ind) {
 
   // For the texture case, always copy to the host and pull from there
-  if (deviceBufferTypeIsTexture()) {
+  if (deviceBufferTypeIsTexture() && !hasExternalData() && !hasStreamedData()) {
     ensureHostBufferPopulated();
   }
 
@@ -157,6 +815,7 @@ T ManagedBuffer<T>::getValue(size_t ind) {
   case CanonicalDataSource::HostData:
     if (ind >= data.size())
       exception("out of bounds access in ManagedBuffer " + name + " getValue(" + std::to_string(ind) + ")");
+    markHostCopyUsed();
     return data[ind];
     break;
 
@@ -167,6 +826,21 @@ T ManagedBuffer<T>::getValue(size_t ind) {
     return data[ind];
     break;
 
+  case CanonicalDataSource::ExternalData:
+    if (ind >= externalDataSize)
+      exception("out of bounds access in ManagedBuffer " + name + " getValue(" + std::to_string(ind) + ")");
+    return externalData[ind];
+    break;
+
+  case CanonicalDataSource::StreamedData: {
+    if (ind >= streamedDataSize)
+      exception("out of bounds access in ManagedBuffer " + name + " getValue(" + std::to_string(ind) + ")");
+    T val;
+    streamedDataReadFunc(ind, 1, &val);
+    return val;
+    break;
+  }
+
   case CanonicalDataSource::RenderBuffer:
 
     // NOTE: right now this case should never happen unless deviceBufferType == DeviceBufferType::Attribute.
@@ -212,6 +886,14 @@ size_t ManagedBuffer<T>::size() {
     return 0;
     break;
 
+  case CanonicalDataSource::ExternalData:
+    return externalDataSize;
+    break;
+
+  case CanonicalDataSource::StreamedData:
+    return streamedDataSize;
+    break;
+
   case CanonicalDataSource::RenderBuffer:
     if (deviceBufferType == DeviceBufferType::Attribute) {
       return renderAttributeBuffer->getDataSize();
@@ -232,6 +914,8 @@ template <typename T>
 bool ManagedBuffer<T>::hasData() {
 
   if (hostBufferIsPopulated) return true;
+  if (hasExternalData()) return true;
+  if (hasStreamedData()) return true;
   if (deviceBufferType == DeviceBufferType::Attribute && renderAttributeBuffer) return true;
   if (deviceBufferType == DeviceBufferType::Texture1d && renderTextureBuffer) return true;
   if (deviceBufferType == DeviceBufferType::Texture2d && renderTextureBuffer) return true;
@@ -261,6 +945,12 @@ std::string ManagedBuffer<T>::summaryString() {
   case CanonicalDataSource::RenderBuffer:
     str += "Renderbuffer";
     break;
+  case CanonicalDataSource::ExternalData:
+    str += "ExternalData";
+    break;
+  case CanonicalDataSource::StreamedData:
+    str += "StreamedData";
+    break;
   };
   str += " size: " + std::to_string(size());
   str += " device type: ";
@@ -302,11 +992,17 @@ void ManagedBuffer<T>::recomputeIfPopulated() {
 template <typename T>
 std::shared_ptr<render::AttributeBuffer> ManagedBuffer<T>::getRenderAttributeBuffer() {
   checkDeviceBufferTypeIs(DeviceBufferType::Attribute);
+  flushQueuedDeviceUpload(); // the caller is about to use the buffer, so it must not hold stale values
 
   if (!renderAttributeBuffer) {
-    ensureHostBufferPopulated(); // warning: the order of these matters because of how hostBufferPopulated works
-    renderAttributeBuffer = generateAttributeBuffer<T>(render::engine);
-    renderAttributeBuffer->setData(data);
+    if (hasExternalData()) {
+      renderAttributeBuffer = generateAttributeBuffer<T>(render::engine);
+      renderAttributeBuffer->setData(externalData, externalDataSize);
+    } else {
+      ensureHostBufferPopulated(); // warning: the order of these matters because of how hostBufferPopulated works
+      renderAttributeBuffer = generateAttributeBuffer<T>(render::engine);
+      renderAttributeBuffer->setData(data);
+    }
   }
   return renderAttributeBuffer;
 }
@@ -314,11 +1010,33 @@ std::shared_ptr<render::AttributeBuffer> ManagedBuffer<T>::getRenderAttributeBuf
 template <typename T>
 std::shared_ptr<render::TextureBuffer> ManagedBuffer<T>::getRenderTextureBuffer() {
   checkDeviceBufferTypeIsTexture();
+  flushQueuedDeviceUpload(); // the caller is about to use the buffer, so it must not hold stale values
 
   if (!renderTextureBuffer) {
-    ensureHostBufferPopulated(); // warning: the order of these matters because of how hostBufferPopulated works
+    if (!hasExternalData() && !hasStreamedData()) {
+      ensureHostBufferPopulated(); // warning: the order of these matters because of how hostBufferPopulated works
+    }
 
-    renderTextureBuffer = generateTextureBuffer<T>(deviceBufferType, render::engine);
+    if (textureIsEncoded) {
+      switch (deviceBufferType) {
+      case DeviceBufferType::Attribute:
+        exception("bad call");
+        break;
+      case DeviceBufferType::Texture1d:
+        renderTextureBuffer = render::engine->generateTextureBuffer(textureEncodingFormat, 0u);
+        break;
+      case DeviceBufferType::Texture2d:
+        renderTextureBuffer = render::engine->generateTextureBuffer(textureEncodingFormat, 0u, 0u,
+                                                                    static_cast<const unsigned char*>(nullptr));
+        break;
+      case DeviceBufferType::Texture3d:
+        renderTextureBuffer = render::engine->generateTextureBuffer(textureEncodingFormat, 0u, 0u, 0u,
+                                                                    static_cast<const unsigned char*>(nullptr));
+        break;
+      }
+    } else {
+      renderTextureBuffer = generateTextureBuffer<T>(deviceBufferType, render::engine);
+    }
 
     // templatize this?
     switch (deviceBufferType) {
@@ -336,7 +1054,16 @@ std::shared_ptr<render::TextureBuffer> ManagedBuffer<T>::getRenderTextureBuffer(
       break;
     }
 
-    renderTextureBuffer->setData(data);
+    if (hasStreamedData()) {
+      uploadStreamedTextureToDevice();
+    } else if (textureIsEncoded) {
+      setWholeTexture(hasExternalData() ? externalData : data.data());
+    } else if (hasExternalData()) {
+      // textures can only be set from a vector, this is a temporary copy
+      renderTextureBuffer->setData(std::vector<T>(externalData, externalData + externalDataSize));
+    } else {
+      renderTextureBuffer->setData(data);
+    }
   }
   return renderTextureBuffer;
 }
@@ -362,6 +1089,7 @@ template <typename T>
 std::shared_ptr<render::AttributeBuffer>
 ManagedBuffer<T>::getIndexedRenderAttributeBuffer(ManagedBuffer<uint32_t>& indices) {
   checkDeviceBufferTypeIs(DeviceBufferType::Attribute);
+  flushQueuedDeviceUpload(); // also re-gathers the existing indexed views
 
   removeDeletedIndexedViews(); // periodic filtering
 
@@ -382,10 +1110,9 @@ ManagedBuffer<T>::getIndexedRenderAttributeBuffer(ManagedBuffer<uint32_t>& indic
   }
 
   // We don't have it. Create a new one and return that.
-  ensureHostBufferPopulated();
   std::shared_ptr<render::AttributeBuffer> newBuffer = generateAttributeBuffer<T>(render::engine);
   indices.ensureHostBufferPopulated();
-  std::vector<T> expandData = gather(data, indices.data);
+  std::vector<T> expandData = gatherHostValues(indices.data);
   newBuffer->setData(expandData); // initially populate
   existingIndexedViews.emplace_back(&indices, newBuffer);
 
@@ -411,11 +1138,80 @@ void ManagedBuffer<T>::updateIndexedViews() {
 
     // apply the indexing and set the data
     indices.ensureHostBufferPopulated();
-    std::vector<T> expandData = gather(data, indices.data);
+    std::vector<T> expandData = gatherHostValues(indices.data);
     viewBuffer.setData(expandData);
 
     // TODO fornow, only CPU-side updating is supported. Add direct GPU-side support using the bufferIndexCopyProgram
-    // below.
+    // below. (When only some entries change, updateIndexedViews(sourceRanges) below avoids the full gather.)
+  }
+
+  requestRedraw();
+}
+
+template <typename T>
+void ManagedBuffer<T>::updateIndexedViews(const std::vector<std::array<size_t, 2>>& sourceRanges) {
+  checkDeviceBufferTypeIs(DeviceBufferType::Attribute);
+
+  removeDeletedIndexedViews(); // periodic filtering
+
+  // Expanded slots which are this close together get uploaded as one range, re-gathering the unchanged slots between
+  // them. This is cheaper than issuing many tiny uploads.
+  const size_t mergeGap = 32;
+
+  for (std::tuple<render::ManagedBuffer<uint32_t>*, std::weak_ptr<render::AttributeBuffer>>& existingViewTup :
+       existingIndexedViews) {
+
+    std::shared_ptr<render::AttributeBuffer> viewBufferPtr = std::get<1>(existingViewTup).lock();
+    if (!viewBufferPtr) continue; // skip if it has been deleted (will be removed eventually)
+
+    // note: index buffer must still be alive here. we can't check it, you will just get memory errors
+    // if it has been deleted
+    render::ManagedBuffer<uint32_t>& indices = *std::get<0>(existingViewTup);
+    render::AttributeBuffer& viewBuffer = *viewBufferPtr;
+
+    indices.ensureHostBufferPopulated();
+    const std::vector<uint32_t>& indData = indices.data;
+    size_t nSlots = indData.size();
+
+    // Gather the list of expanded slots which read from the changed source entries
+    const IndexInverseMap& inverse = indices.getInverseIndexMap();
+    size_t nSource = inverse.start.size() - 1;
+    std::vector<uint32_t> changedSlots;
+    for (const std::array<size_t, 2>& r : sourceRanges) {
+      size_t rEnd = std::min(r[1], nSource);
+      for (size_t iS = r[0]; iS < rEnd; iS++) {
+        changedSlots.insert(changedSlots.end(), inverse.slots.begin() + inverse.start[iS],
+                            inverse.slots.begin() + inverse.start[iS + 1]);
+      }
+    }
+
+    // If most of the view changed anyway (or the view is not the expected size), just re-gather the whole thing
+    const T* hostData = getHostDataPtr();
+    if (changedSlots.size() * 2 > nSlots || static_cast<size_t>(viewBuffer.getDataSize()) != nSlots) {
+      std::vector<T> expandData = gatherHostValues(indData);
+      viewBuffer.setData(expandData);
+      continue;
+    }
+
+    // Coalesce the slots in to ranges, and upload each
+    std::sort(changedSlots.begin(), changedSlots.end());
+    std::vector<T> expandData;
+    size_t iC = 0;
+    while (iC < changedSlots.size()) {
+      size_t rangeStart = changedSlots[iC];
+      size_t rangeEnd = rangeStart + 1;
+      iC++;
+      while (iC < changedSlots.size() && changedSlots[iC] <= rangeEnd + mergeGap) {
+        rangeEnd = changedSlots[iC] + 1;
+        iC++;
+      }
+
+      expandData.resize(rangeEnd - rangeStart);
+      for (size_t i = rangeStart; i < rangeEnd; i++) {
+        expandData[i - rangeStart] = hostData[indData[i]];
+      }
+      viewBuffer.setDataRange(expandData, 0, expandData.size(), rangeStart);
+    }
   }
 
   requestRedraw();
@@ -435,10 +1231,226 @@ void ManagedBuffer<T>::removeDeletedIndexedViews() {
       existingIndexedViews.end());
 }
 
+template <typename T>
+const IndexInverseMap& ManagedBuffer<T>::getInverseIndexMap() {
+  exception("ManagedBuffer " + name + " is not an index buffer, cannot get inverse index map");
+  return inverseIndexMap; // dummy return
+}
+
+template <>
+const IndexInverseMap& ManagedBuffer<uint32_t>::getInverseIndexMap() {
+
+  if (!inverseIndexMap.start.empty()) return inverseIndexMap; // already built
+
+  ensureHostBufferPopulated();
+
+  size_t nSource = 0;
+  for (uint32_t ind : data) {
+    nSource = std::max(nSource, static_cast<size_t>(ind) + 1);
+  }
+
+  // Count the slots for each source entry, then prefix-sum to get the offsets
+  std::vector<uint32_t>& start = inverseIndexMap.start;
+  std::vector<uint32_t>& slots = inverseIndexMap.slots;
+  start.assign(nSource + 1, 0);
+  for (uint32_t ind : data) {
+    start[ind + 1]++;
+  }
+  for (size_t iS = 0; iS < nSource; iS++) {
+    start[iS + 1] += start[iS];
+  }
+
+  // Fill the slots
+  std::vector<uint32_t> fillPos(start.begin(), start.end() - 1);
+  slots.resize(data.size());
+  for (size_t i = 0; i < data.size(); i++) {
+    slots[fillPos[data[i]]++] = static_cast<uint32_t>(i);
+  }
+
+  return inverseIndexMap;
+}
+
+template <typename T>
+void ManagedBuffer<T>::invalidateInverseIndexMap() {
+  inverseIndexMap.start.clear();
+  inverseIndexMap.slots.clear();
+}
+
+template <typename T>
+void ManagedBuffer<T>::uploadTextureRange(size_t start, size_t end) {
+
+  // Texture data is laid out with X varying fastest. A contiguous range of entries generally does not correspond to a
+  // box in the texture, so we upload the smallest box of whole rows (or whole slices) which covers it. If the range
+  // lies within a single row, just that part of the row is sent.
+
+  size_t nX = std::max(sizeX, 1u);
+  size_t nY = std::max(sizeY, 1u);
+  size_t sliceSize = nX * nY;
+
+  size_t offX = 0, offY = 0, offZ = 0;
+  size_t cntX = 1, cntY = 1, cntZ = 1;
+
+  // helper for a range that lies within a single slice, in slice-local coordinates
+  auto coverWithinSlice = [&](size_t s, size_t e) {
+    size_t y0 = s / nX;
+    size_t y1 = (e - 1) / nX + 1;
+    if (y1 - y0 == 1) {
+      offX = s % nX;
+      cntX = e - s;
+    } else {
+      offX = 0;
+      cntX = nX;
+    }
+    offY = y0;
+    cntY = y1 - y0;
+  };
+
+  switch (deviceBufferType) {
+  case DeviceBufferType::Attribute:
+    exception("bad call");
+    break;
+  case DeviceBufferType::Texture1d:
+    offX = start;
+    cntX = end - start;
+    break;
+  case DeviceBufferType::Texture2d:
+    coverWithinSlice(start, end);
+    break;
+  case DeviceBufferType::Texture3d: {
+    size_t z0 = start / sliceSize;
+    size_t z1 = (end - 1) / sliceSize + 1;
+    if (z1 - z0 == 1) {
+      coverWithinSlice(start - z0 * sliceSize, end - z0 * sliceSize);
+    } else {
+      cntX = nX;
+      cntY = nY;
+    }
+    offZ = z0;
+    cntZ = z1 - z0;
+    break;
+  }
+  }
+
+  std::array<unsigned int, 3> offset{static_cast<unsigned int>(offX), static_cast<unsigned int>(offY),
+                                     static_cast<unsigned int>(offZ)};
+  std::array<unsigned int, 3> count{static_cast<unsigned int>(cntX), static_cast<unsigned int>(cntY),
+                                    static_cast<unsigned int>(cntZ)};
+  if (textureIsEncoded) {
+    // the box of values, packed
+    std::vector<T> boxValues;
+    boxValues.reserve(cntX * cntY * cntZ);
+    for (size_t z = offZ; z < offZ + cntZ; z++) {
+      for (size_t y = offY; y < offY + cntY; y++) {
+        size_t rowStart = z * sliceSize + y * nX + offX;
+        boxValues.insert(boxValues.end(), data.begin() + rowStart, data.begin() + rowStart + cntX);
+      }
+    }
+    setTextureRegion(boxValues.data(), offset, count);
+  } else {
+    renderTextureBuffer->setDataRegion(data, offset, count);
+  }
+}
+
+template <typename T>
+void ManagedBuffer<T>::recordFullUpdate() {
+  dataVersion++;
+  recentUpdateRanges.clear();
+  updateHistoryBaseVersion = dataVersion;
+}
+
+template <typename T>
+void ManagedBuffer<T>::recordPartialUpdate(const std::vector<std::array<size_t, 2>>& ranges) {
+  // Note that while uploads are deferred, `ranges` may still hold ranges from earlier updates which have not been
+  // sent yet. Recording them again is harmless.
+  const size_t maxRecordedUpdates = 16;
+  dataVersion++;
+  recentUpdateRanges.emplace_back(dataVersion, ranges);
+  if (recentUpdateRanges.size() > maxRecordedUpdates) {
+    updateHistoryBaseVersion = std::get<0>(recentUpdateRanges.front());
+    recentUpdateRanges.erase(recentUpdateRanges.begin());
+  }
+}
+
+template <typename T>
+bool ManagedBuffer<T>::getRangesUpdatedSince(uint64_t version, std::vector<std::array<size_t, 2>>& ranges) const {
+  ranges.clear();
+  if (version < updateHistoryBaseVersion || version > dataVersion) return false;
+  for (const std::tuple<uint64_t, std::vector<std::array<size_t, 2>>>& update : recentUpdateRanges) {
+    if (std::get<0>(update) <= version) continue;
+    ranges.insert(ranges.end(), std::get<1>(update).begin(), std::get<1>(update).end());
+  }
+  ranges = mergeIndexRanges(ranges);
+  return true;
+}
+
 template <typename T>
 void ManagedBuffer<T>::invalidateHostBuffer() {
   hostBufferIsPopulated = false;
   data.clear();
+  dirtyHostRanges.clear();
+  cancelQueuedDeviceUpload(); // the device values are newer than anything which was waiting to be sent
+  pendingTextureReadback.reset();
+  invalidateInverseIndexMap();
+  recordFullUpdate();
+
+  // the render buffer now holds the canonical values, stop referencing any external memory or streamed values
+  externalData = nullptr;
+  externalDataSize = 0;
+  externalDataOwner.reset();
+  stopStreaming();
+}
+
+template <typename T>
+void ManagedBuffer<T>::tallyMemoryUsage(MemoryUsageTally& tally) {
+  tally.addHostBytes(static_cast<int64_t>(data.capacity() * sizeof(T)));
+
+  if (renderAttributeBuffer) tally.addDeviceBuffer(renderAttributeBuffer.get());
+  if (renderTextureBuffer) tally.addDeviceBuffer(renderTextureBuffer.get());
+
+  if (deviceBufferType == DeviceBufferType::Attribute) {
+    for (std::tuple<render::ManagedBuffer<uint32_t>*, std::weak_ptr<render::AttributeBuffer>>& existingViewTup :
+         existingIndexedViews) {
+      std::shared_ptr<render::AttributeBuffer> viewBufferPtr = std::get<1>(existingViewTup).lock();
+      if (viewBufferPtr) tally.addDeviceBuffer(viewBufferPtr.get());
+    }
+  }
+}
+
+template <typename T>
+size_t ManagedBuffer<T>::getHostCopyBytes() {
+  return data.capacity() * sizeof(T);
+}
+
+template <typename T>
+bool ManagedBuffer<T>::hostCopyIsEvictable() {
+  if (hostCopyIsPinned || !hostBufferIsPopulated || hasExternalData() || data.empty()) return false;
+  if (!dirtyHostRanges.empty() || deviceUploadQueued) return false; // has writes which have not been sent yet
+
+  // Once evicted, the values are restored from the render buffer if there is one, so it must be possible to read
+  // them back exactly. Textures can only be read back for the types they can hold.
+  if (renderTextureBuffer) {
+    if (textureIsEncoded) return false; // encoding may lose precision
+    return std::is_same<T, float>::value || std::is_same<T, glm::vec2>::value || std::is_same<T, glm::vec3>::value ||
+           std::is_same<T, glm::vec4>::value;
+  }
+  if (renderAttributeBuffer) return !std::is_same<T, double>::value;
+
+  return dataGetsComputed;
+}
+
+template <typename T>
+bool ManagedBuffer<T>::hostCopyIsRecomputable() const {
+  return dataGetsComputed;
+}
+
+template <typename T>
+void ManagedBuffer<T>::evictHostCopy() {
+  if (!hostCopyIsEvictable()) exception("ManagedBuffer " + name + " host copy cannot be evicted");
+
+  data.clear();
+  data.shrink_to_fit();
+  hostBufferIsPopulated = false;
+  invalidateInverseIndexMap();
 }
 
 template <typename T>
@@ -466,6 +1478,16 @@ void ManagedBuffer<T>::checkDeviceBufferTypeIsTexture() {
 template <typename T>
 typename ManagedBuffer<T>::CanonicalDataSource ManagedBuffer<T>::currentCanonicalDataSource() {
 
+  // Caller-owned memory always holds the current values when it is set
+  if (hasExternalData()) {
+    return CanonicalDataSource::ExternalData;
+  }
+
+  // Likewise for streamed values
+  if (hasStreamedData()) {
+    return CanonicalDataSource::StreamedData;
+  }
+
   // Always prefer the host data if it is up to date
   if (hostBufferIsPopulated) {
     return CanonicalDataSource::HostData;
@@ -505,6 +1527,45 @@ void ManagedBuffer<T>::invokeBufferIndexCopyProgram() {
 
 // === Interact with the buffer registry
 
+void ManagedBufferRegistry::tallyMemoryUsage(MemoryUsageTally& tally) {
+
+  // clang-format off
+  managedBufferMap_float.tallyMemoryUsage(tally);
+  managedBufferMap_double.tallyMemoryUsage(tally);
+  managedBufferMap_vec2.tallyMemoryUsage(tally);
+  managedBufferMap_vec3.tallyMemoryUsage(tally);
+  managedBufferMap_vec4.tallyMemoryUsage(tally);
+  managedBufferMap_arr2vec3.tallyMemoryUsage(tally);
+  managedBufferMap_arr3vec3.tallyMemoryUsage(tally);
+  managedBufferMap_arr4vec3.tallyMemoryUsage(tally);
+  managedBufferMap_uint32.tallyMemoryUsage(tally);
+  managedBufferMap_int32.tallyMemoryUsage(tally);
+  managedBufferMap_uvec2.tallyMemoryUsage(tally);
+  managedBufferMap_uvec3.tallyMemoryUsage(tally);
+  managedBufferMap_uvec4.tallyMemoryUsage(tally);
+  // clang-format on
+
+  for (std::weak_ptr<render::ShaderProgram>& programWeak : memoryTrackedPrograms) {
+    std::shared_ptr<render::ShaderProgram> program = programWeak.lock();
+    if (program) tally.addShaderProgram(program.get());
+  }
+}
+
+void ManagedBufferRegistry::trackProgramMemoryUsage(const std::shared_ptr<render::ShaderProgram>& program) {
+
+  // drop any programs which have been deleted, and skip if already tracked
+  memoryTrackedPrograms.erase(std::remove_if(memoryTrackedPrograms.begin(), memoryTrackedPrograms.end(),
+                                             [](const std::weak_ptr<render::ShaderProgram>& p) -> bool {
+                                               return p.expired();
+                                             }),
+                              memoryTrackedPrograms.end());
+  for (std::weak_ptr<render::ShaderProgram>& p : memoryTrackedPrograms) {
+    if (p.lock() == program) return;
+  }
+
+  memoryTrackedPrograms.push_back(program);
+}
+
 std::tuple<bool, ManagedBufferType> ManagedBufferRegistry::hasManagedBufferType(std::string name) {
 
   // clang-format off
@@ -554,6 +1615,24 @@ template class ManagedBuffer<glm::uvec2>;
 template class ManagedBuffer<glm::uvec3>;
 template class ManagedBuffer<glm::uvec4>;
 
+template class ManagedBufferReadback<float>;
+template class ManagedBufferReadback<double>;
+
+template class ManagedBufferReadback<glm::vec2>;
+template class ManagedBufferReadback<glm::vec3>;
+template class ManagedBufferReadback<glm::vec4>;
+
+template class ManagedBufferReadback<std::array<glm::vec3, 2>>;
+template class ManagedBufferReadback<std::array<glm::vec3, 3>>;
+template class ManagedBufferReadback<std::array<glm::vec3, 4>>;
+
+template class ManagedBufferReadback<uint32_t>;
+template class ManagedBufferReadback<int32_t>;
+
+template class ManagedBufferReadback<glm::uvec2>;
+template class ManagedBufferReadback<glm::uvec3>;
+template class ManagedBufferReadback<glm::uvec4>;
+
 // Buffer maps
 
 template struct ManagedBufferMap<float>;
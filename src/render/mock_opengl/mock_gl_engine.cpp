@@ -71,59 +71,61 @@ void GLAttributeBuffer::checkArray(int testArrayCount) {
 
 
 template <typename T>
-void GLAttributeBuffer::setData_helper(const std::vector<T>& data) {
+void GLAttributeBuffer::setData_helper(const T* data, size_t count) {
   bind();
 
   // allocate if needed
-  if (!isSet() || data.size() > bufferSize) {
+  if (!isSet() || count > bufferSize) {
     setFlag = true;
-    uint64_t newSize = data.size();
+    uint64_t newSize = count;
     newSize = std::max(newSize, 2 * bufferSize); // if we're expanding, at-least double
     bufferSize = newSize;
   }
 
   // do the actual copy
-  dataSize = data.size();
+  dataSize = count;
+
+  render::engine->recordUpload(dataSize * sizeof(T));
 
   checkGLError();
 }
 
 void GLAttributeBuffer::setData(const std::vector<glm::vec2>& data) {
   checkType(RenderDataType::Vector2Float);
-  setData_helper(data);
+  setData_helper(data.data(), data.size());
 }
 
 void GLAttributeBuffer::setData(const std::vector<glm::vec3>& data) {
   checkType(RenderDataType::Vector3Float);
-  setData_helper(data);
+  setData_helper(data.data(), data.size());
 }
 
 void GLAttributeBuffer::setData(const std::vector<std::array<glm::vec3, 2>>& data) {
   checkType(RenderDataType::Vector3Float);
   checkArray(2);
-  setData_helper(data);
+  setData_helper(data.data(), data.size());
 }
 
 void GLAttributeBuffer::setData(const std::vector<std::array<glm::vec3, 3>>& data) {
   checkType(RenderDataType::Vector3Float);
   checkArray(3);
-  setData_helper(data);
+  setData_helper(data.data(), data.size());
 }
 
 void GLAttributeBuffer::setData(const std::vector<std::array<glm::vec3, 4>>& data) {
   checkType(RenderDataType::Vector3Float);
   checkArray(4);
-  setData_helper(data);
+  setData_helper(data.data(), data.size());
 }
 
 void GLAttributeBuffer::setData(const std::vector<glm::vec4>& data) {
   checkType(RenderDataType::Vector4Float);
-  setData_helper(data);
+  setData_helper(data.data(), data.size());
 }
 
 void GLAttributeBuffer::setData(const std::vector<float>& data) {
   checkType(RenderDataType::Float);
-  setData_helper(data);
+  setData_helper(data.data(), data.size());
 }
 
 void GLAttributeBuffer::setData(const std::vector<double>& data) {
@@ -131,35 +133,205 @@ void GLAttributeBuffer::setData(const std::vector<double>& data) {
 
   // Convert input data to floats
   std::vector<float> floatData(data.size());
-  for (unsigned int i = 0; i < data.size(); i++) {
-    floatData[i] = static_cast<float>(data[i]);
-  }
+  convertToFloat(data.data(), data.size(), floatData.data());
 
-  setData_helper(floatData);
+  setData_helper(floatData.data(), floatData.size());
 }
 
 void GLAttributeBuffer::setData(const std::vector<int32_t>& data) {
   checkType(RenderDataType::Int);
-  setData_helper(data);
+  setData_helper(data.data(), data.size());
 }
 
 void GLAttributeBuffer::setData(const std::vector<uint32_t>& data) {
   checkType(RenderDataType::UInt);
-  setData_helper(data);
+  setData_helper(data.data(), data.size());
 }
 
 void GLAttributeBuffer::setData(const std::vector<glm::uvec2>& data) {
   checkType(RenderDataType::Vector2UInt);
-  setData_helper(data);
+  setData_helper(data.data(), data.size());
 }
 void GLAttributeBuffer::setData(const std::vector<glm::uvec3>& data) {
   checkType(RenderDataType::Vector3UInt);
-  setData_helper(data);
+  setData_helper(data.data(), data.size());
 }
 
 void GLAttributeBuffer::setData(const std::vector<glm::uvec4>& data) {
   checkType(RenderDataType::Vector4UInt);
-  setData_helper(data);
+  setData_helper(data.data(), data.size());
+}
+
+// === set values from contiguous memory
+
+void GLAttributeBuffer::setData(const glm::vec2* data, size_t count) {
+  checkType(RenderDataType::Vector2Float);
+  setData_helper(data, count);
+}
+
+void GLAttributeBuffer::setData(const glm::vec3* data, size_t count) {
+  checkType(RenderDataType::Vector3Float);
+  setData_helper(data, count);
+}
+
+void GLAttributeBuffer::setData(const std::array<glm::vec3, 2>* data, size_t count) {
+  checkType(RenderDataType::Vector3Float);
+  checkArray(2);
+  setData_helper(data, count);
+}
+
+void GLAttributeBuffer::setData(const std::array<glm::vec3, 3>* data, size_t count) {
+  checkType(RenderDataType::Vector3Float);
+  checkArray(3);
+  setData_helper(data, count);
+}
+
+void GLAttributeBuffer::setData(const std::array<glm::vec3, 4>* data, size_t count) {
+  checkType(RenderDataType::Vector3Float);
+  checkArray(4);
+  setData_helper(data, count);
+}
+
+void GLAttributeBuffer::setData(const glm::vec4* data, size_t count) {
+  checkType(RenderDataType::Vector4Float);
+  setData_helper(data, count);
+}
+
+void GLAttributeBuffer::setData(const float* data, size_t count) {
+  checkType(RenderDataType::Float);
+  setData_helper(data, count);
+}
+
+void GLAttributeBuffer::setData(const double* data, size_t count) {
+  checkType(RenderDataType::Float);
+
+  // Convert input data to floats
+  std::vector<float> floatData(count);
+  convertToFloat(data, count, floatData.data());
+
+  setData_helper(floatData.data(), floatData.size());
+}
+
+void GLAttributeBuffer::setData(const int32_t* data, size_t count) {
+  checkType(RenderDataType::Int);
+  setData_helper(data, count);
+}
+
+void GLAttributeBuffer::setData(const uint32_t* data, size_t count) {
+  checkType(RenderDataType::UInt);
+  setData_helper(data, count);
+}
+
+void GLAttributeBuffer::setData(const glm::uvec2* data, size_t count) {
+  checkType(RenderDataType::Vector2UInt);
+  setData_helper(data, count);
+}
+void GLAttributeBuffer::setData(const glm::uvec3* data, size_t count) {
+  checkType(RenderDataType::Vector3UInt);
+  setData_helper(data, count);
+}
+
+void GLAttributeBuffer::setData(const glm::uvec4* data, size_t count) {
+  checkType(RenderDataType::Vector4UInt);
+  setData_helper(data, count);
+}
+
+// === set ranges of values
+
+template <typename T>
+void GLAttributeBuffer::setDataRange_helper(const std::vector<T>& data, size_t dataStart, size_t dataEnd,
+                                            size_t bufferStart) {
+  if (!isSet()) exception("called setDataRange() on attribute buffer which has not been allocated");
+  if (dataStart > dataEnd || dataEnd > data.size()) exception("bad setDataRange source range");
+  size_t count = dataEnd - dataStart;
+  if (bufferStart + count > static_cast<size_t>(getDataSize())) exception("setDataRange out of bounds of buffer");
+  if (count == 0) return;
+
+  bind();
+  render::engine->recordUpload(count * sizeof(T));
+
+  checkGLError();
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<glm::vec2>& data, size_t dataStart, size_t dataEnd,
+                                     size_t bufferStart) {
+  checkType(RenderDataType::Vector2Float);
+  setDataRange_helper(data, dataStart, dataEnd, bufferStart);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<glm::vec3>& data, size_t dataStart, size_t dataEnd,
+                                     size_t bufferStart) {
+  checkType(RenderDataType::Vector3Float);
+  setDataRange_helper(data, dataStart, dataEnd, bufferStart);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<std::array<glm::vec3, 2>>& data, size_t dataStart, size_t dataEnd,
+                                     size_t bufferStart) {
+  checkType(RenderDataType::Vector3Float);
+  checkArray(2);
+  setDataRange_helper(data, dataStart, dataEnd, bufferStart);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<std::array<glm::vec3, 3>>& data, size_t dataStart, size_t dataEnd,
+                                     size_t bufferStart) {
+  checkType(RenderDataType::Vector3Float);
+  checkArray(3);
+  setDataRange_helper(data, dataStart, dataEnd, bufferStart);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<std::array<glm::vec3, 4>>& data, size_t dataStart, size_t dataEnd,
+                                     size_t bufferStart) {
+  checkType(RenderDataType::Vector3Float);
+  checkArray(4);
+  setDataRange_helper(data, dataStart, dataEnd, bufferStart);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<glm::vec4>& data, size_t dataStart, size_t dataEnd,
+                                     size_t bufferStart) {
+  checkType(RenderDataType::Vector4Float);
+  setDataRange_helper(data, dataStart, dataEnd, bufferStart);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<float>& data, size_t dataStart, size_t dataEnd,
+                                     size_t bufferStart) {
+  checkType(RenderDataType::Float);
+  setDataRange_helper(data, dataStart, dataEnd, bufferStart);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<double>& data, size_t dataStart, size_t dataEnd,
+                                     size_t bufferStart) {
+  checkType(RenderDataType::Float);
+  setDataRange_helper(data, dataStart, dataEnd, bufferStart);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<int32_t>& data, size_t dataStart, size_t dataEnd,
+                                     size_t bufferStart) {
+  checkType(RenderDataType::Int);
+  setDataRange_helper(data, dataStart, dataEnd, bufferStart);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<uint32_t>& data, size_t dataStart, size_t dataEnd,
+                                     size_t bufferStart) {
+  checkType(RenderDataType::UInt);
+  setDataRange_helper(data, dataStart, dataEnd, bufferStart);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<glm::uvec2>& data, size_t dataStart, size_t dataEnd,
+                                     size_t bufferStart) {
+  checkType(RenderDataType::Vector2UInt);
+  setDataRange_helper(data, dataStart, dataEnd, bufferStart);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<glm::uvec3>& data, size_t dataStart, size_t dataEnd,
+                                     size_t bufferStart) {
+  checkType(RenderDataType::Vector3UInt);
+  setDataRange_helper(data, dataStart, dataEnd, bufferStart);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<glm::uvec4>& data, size_t dataStart, size_t dataEnd,
+                                     size_t bufferStart) {
+  checkType(RenderDataType::Vector4UInt);
+  setDataRange_helper(data, dataStart, dataEnd, bufferStart);
 }
 
 
@@ -389,6 +561,8 @@ void GLTextureBuffer::setData(const std::vector<glm::vec3>& data) {
     break;
   }
 
+  render::engine->recordUpload(data.size() * sizeof(glm::vec3));
+
   checkGLError();
 }
 
@@ -409,6 +583,8 @@ void GLTextureBuffer::setData(const std::vector<glm::vec4>& data) {
     break;
   }
 
+  render::engine->recordUpload(data.size() * sizeof(glm::vec4));
+
   checkGLError();
 }
 
@@ -428,6 +604,8 @@ void GLTextureBuffer::setData(const std::vector<float>& data) {
     break;
   }
 
+  render::engine->recordUpload(data.size() * sizeof(float));
+
   checkGLError();
 }
 
@@ -447,6 +625,8 @@ void GLTextureBuffer::setData(const std::vector<double>& data) {
     break;
   }
 
+  render::engine->recordUpload(data.size() * sizeof(float));
+
   checkGLError();
 };
 void GLTextureBuffer::setData(const std::vector<int32_t>& data) { exception("not implemented"); };
@@ -458,6 +638,74 @@ void GLTextureBuffer::setData(const std::vector<std::array<glm::vec3, 2>>& data)
 void GLTextureBuffer::setData(const std::vector<std::array<glm::vec3, 3>>& data) { exception("not implemented"); };
 void GLTextureBuffer::setData(const std::vector<std::array<glm::vec3, 4>>& data) { exception("not implemented"); };
 
+template <typename T>
+void GLTextureBuffer::setDataRegion_helper(const std::vector<T>& data, std::array<unsigned int, 3> offset,
+                                           std::array<unsigned int, 3> size) {
+  bind();
+
+  if (data.size() != getTotalSize()) {
+    exception("OpenGL error: texture buffer data is not the right size.");
+  }
+
+  std::array<unsigned int, 3> texSize{sizeX, dim >= 2 ? sizeY : 1u, dim >= 3 ? sizeZ : 1u};
+  for (int i = 0; i < 3; i++) {
+    if (offset[i] + size[i] > texSize[i]) exception("OpenGL error: texture region is out of bounds.");
+  }
+
+  render::engine->recordUpload(static_cast<size_t>(size[0]) * size[1] * size[2] * sizeof(T));
+
+  checkGLError();
+}
+
+// clang-format off
+void GLTextureBuffer::setDataRegion(const std::vector<glm::vec2>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { exception("not implemented"); }
+void GLTextureBuffer::setDataRegion(const std::vector<glm::vec3>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { setDataRegion_helper(data, offset, size); }
+void GLTextureBuffer::setDataRegion(const std::vector<glm::vec4>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { setDataRegion_helper(data, offset, size); }
+void GLTextureBuffer::setDataRegion(const std::vector<float>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { setDataRegion_helper(data, offset, size); }
+void GLTextureBuffer::setDataRegion(const std::vector<double>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { setDataRegion_helper(data, offset, size); }
+void GLTextureBuffer::setDataRegion(const std::vector<int32_t>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { exception("not implemented"); }
+void GLTextureBuffer::setDataRegion(const std::vector<uint32_t>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { exception("not implemented"); }
+void GLTextureBuffer::setDataRegion(const std::vector<glm::uvec2>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { exception("not implemented"); }
+void GLTextureBuffer::setDataRegion(const std::vector<glm::uvec3>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { exception("not implemented"); }
+void GLTextureBuffer::setDataRegion(const std::vector<glm::uvec4>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { exception("not implemented"); }
+void GLTextureBuffer::setDataRegion(const std::vector<std::array<glm::vec3, 2>>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { exception("not implemented"); }
+void GLTextureBuffer::setDataRegion(const std::vector<std::array<glm::vec3, 3>>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { exception("not implemented"); }
+void GLTextureBuffer::setDataRegion(const std::vector<std::array<glm::vec3, 4>>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { exception("not implemented"); }
+// clang-format on
+
+template <typename T>
+void GLTextureBuffer::setDataRegionPacked_helper(const T* data, std::array<unsigned int, 3> offset,
+                                                 std::array<unsigned int, 3> size) {
+  bind();
+
+  std::array<unsigned int, 3> texSize{sizeX, dim >= 2 ? sizeY : 1u, dim >= 3 ? sizeZ : 1u};
+  for (int i = 0; i < 3; i++) {
+    if (offset[i] + size[i] > texSize[i]) exception("OpenGL error: texture region is out of bounds.");
+  }
+
+  render::engine->recordUpload(static_cast<size_t>(size[0]) * size[1] * size[2] * sizeof(T));
+
+  checkGLError();
+}
+
+// clang-format off
+void GLTextureBuffer::setDataRegion(const glm::vec2* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { exception("not implemented"); }
+void GLTextureBuffer::setDataRegion(const glm::vec3* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { setDataRegionPacked_helper(data, offset, size); }
+void GLTextureBuffer::setDataRegion(const glm::vec4* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { setDataRegionPacked_helper(data, offset, size); }
+void GLTextureBuffer::setDataRegion(const float* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { setDataRegionPacked_helper(data, offset, size); }
+void GLTextureBuffer::setDataRegion(const double* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { setDataRegionPacked_helper(data, offset, size); }
+void GLTextureBuffer::setDataRegion(const int32_t* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { exception("not implemented"); }
+void GLTextureBuffer::setDataRegion(const uint32_t* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { exception("not implemented"); }
+void GLTextureBuffer::setDataRegion(const glm::uvec2* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { exception("not implemented"); }
+void GLTextureBuffer::setDataRegion(const glm::uvec3* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { exception("not implemented"); }
+void GLTextureBuffer::setDataRegion(const glm::uvec4* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { exception("not implemented"); }
+void GLTextureBuffer::setDataRegion(const std::array<glm::vec3, 2>* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { exception("not implemented"); }
+void GLTextureBuffer::setDataRegion(const std::array<glm::vec3, 3>* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { exception("not implemented"); }
+void GLTextureBuffer::setDataRegion(const std::array<glm::vec3, 4>* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { exception("not implemented"); }
+void GLTextureBuffer::setDataRegion(const uint8_t* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { setDataRegionPacked_helper(data, offset, size); }
+void GLTextureBuffer::setDataRegion(const uint16_t* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { setDataRegionPacked_helper(data, offset, size); }
+// clang-format on
+
 void GLTextureBuffer::setFilterMode(FilterMode newMode) {
 
   bind();
@@ -488,7 +736,7 @@ uint32_t GLTextureBuffer::getNativeBufferID() { return 77; };
 std::vector<float> GLTextureBuffer::getDataScalar() {
   if (dimension(format) != 1) exception("called getDataScalar on texture which does not have a 1 dimensional format");
   std::vector<float> outData;
-  outData.resize(getSizeX() * getSizeY());
+  outData.resize(getTotalSize());
 
   return outData;
 }
@@ -497,20 +745,40 @@ std::vector<glm::vec2> GLTextureBuffer::getDataVector2() {
   if (dimension(format) != 2) exception("called getDataVector2 on texture which does not have a 2 dimensional format");
 
   std::vector<glm::vec2> outData;
-  outData.resize(getSizeX() * getSizeY());
+  outData.resize(getTotalSize());
 
   return outData;
 }
 
 std::vector<glm::vec3> GLTextureBuffer::getDataVector3() {
   if (dimension(format) != 3) exception("called getDataVector3 on texture which does not have a 3 dimensional format");
-  exception("not implemented");
 
   std::vector<glm::vec3> outData;
-  outData.resize(getSizeX() * getSizeY());
+  outData.resize(getTotalSize());
 
   return outData;
 }
+
+std::vector<glm::vec4> GLTextureBuffer::getDataVector4() {
+  if (dimension(format) != 4) exception("called getDataVector4 on texture which does not have a 4 dimensional format");
+
+  std::vector<glm::vec4> outData;
+  outData.resize(getTotalSize());
+
+  return outData;
+}
+
+std::shared_ptr<TextureReadback> GLTextureBuffer::getDataAsync() {
+  std::vector<float> outData(static_cast<size_t>(getTotalSize()) * dimension(format));
+  return std::shared_ptr<TextureReadback>(new GLTextureReadback(outData));
+}
+
+GLTextureReadback::GLTextureReadback(std::vector<float> data_) : data(data_) {}
+
+bool GLTextureReadback::isReady() { return true; }
+
+std::vector<float> GLTextureReadback::getData() { return data; }
+
 void GLTextureBuffer::bind() {
   if (dim == 1) {
   }
@@ -655,6 +923,16 @@ float GLFrameBuffer::readDepth(int xPos, int yPos) {
   return result;
 }
 
+std::vector<std::array<float, 4>> GLFrameBuffer::readFloat4Region(int xPos, int yPos, int sizeX, int sizeY) {
+  std::vector<std::array<float, 4>> result(static_cast<size_t>(sizeX) * sizeY, std::array<float, 4>{1., 2., 3., 4.});
+  return result;
+}
+
+std::vector<float> GLFrameBuffer::readDepthRegion(int xPos, int yPos, int sizeX, int sizeY) {
+  std::vector<float> result(static_cast<size_t>(sizeX) * sizeY, 0.5);
+  return result;
+}
+
 std::vector<unsigned char> GLFrameBuffer::readBuffer() {
   bind();
 
@@ -1424,6 +1702,24 @@ void GLShaderProgram::setIndex(std::shared_ptr<AttributeBuffer> externalBuffer)
   checkGLError();
 }
 
+// Buffers and textures currently attached to the program (used for memory accounting)
+std::vector<AttributeBuffer*> GLShaderProgram::getAttributeBuffers() {
+  std::vector<AttributeBuffer*> buffers;
+  for (GLShaderAttribute& a : attributes) {
+    if (a.buff) buffers.push_back(a.buff.get());
+  }
+  if (indexBuffer) buffers.push_back(indexBuffer.get());
+  return buffers;
+}
+
+std::vector<TextureBuffer*> GLShaderProgram::getTextureBuffers() {
+  std::vector<TextureBuffer*> buffers;
+  for (GLShaderTexture& t : textures) {
+    if (t.isSet && t.textureBuffer) buffers.push_back(t.textureBuffer);
+  }
+  return buffers;
+}
+
 // Check that uniforms and attributes are all set and of consistent size
 void GLShaderProgram::validateData() {
   // Check uniforms
@@ -1915,10 +2211,12 @@ void MockGLEngine::populateDefaultShadersAndRules() {
   registerShaderProgram("INDEXED_MESH", {FLEX_MESH_VERT_SHADER, FLEX_MESH_FRAG_SHADER}, DrawMode::IndexedTriangles);
   registerShaderProgram("SIMPLE_MESH", {SIMPLE_MESH_VERT_SHADER, SIMPLE_MESH_FRAG_SHADER}, DrawMode::IndexedTriangles);
   registerShaderProgram("SLICE_TETS", {SLICE_TETS_VERT_SHADER, SLICE_TETS_GEOM_SHADER, SLICE_TETS_FRAG_SHADER}, DrawMode::Points);
+  registerShaderProgram("SLICE_TETS_TEXTURE", {SLICE_TETS_TEXTURE_VERT_SHADER, SLICE_TETS_GEOM_SHADER, SLICE_TETS_FRAG_SHADER}, DrawMode::Points);
   registerShaderProgram("RAYCAST_SPHERE", {FLEX_SPHERE_VERT_SHADER, FLEX_SPHERE_GEOM_SHADER, FLEX_SPHERE_FRAG_SHADER}, DrawMode::Points);
   registerShaderProgram("POINT_QUAD", {FLEX_POINTQUAD_VERT_SHADER, FLEX_POINTQUAD_GEOM_SHADER, FLEX_POINTQUAD_FRAG_SHADER}, DrawMode::Points);
   registerShaderProgram("GRIDCUBE", {FLEX_GRIDCUBE_VERT_SHADER, FLEX_GRIDCUBE_GEOM_SHADER, FLEX_GRIDCUBE_FRAG_SHADER}, DrawMode::Points);
   registerShaderProgram("GRIDCUBE_PLANE", {FLEX_GRIDCUBE_PLANE_VERT_SHADER, FLEX_GRIDCUBE_PLANE_FRAG_SHADER}, DrawMode::Triangles);
+  registerShaderProgram("SPARSE_GRIDCUBE_PLANE", {SPARSE_GRIDCUBE_PLANE_VERT_SHADER, FLEX_GRIDCUBE_PLANE_FRAG_SHADER}, DrawMode::TrianglesInstanced);
   registerShaderProgram("RAYCAST_VECTOR", {FLEX_VECTOR_VERT_SHADER, FLEX_VECTOR_GEOM_SHADER, FLEX_VECTOR_FRAG_SHADER}, DrawMode::Points);
   registerShaderProgram("RAYCAST_TANGENT_VECTOR", {FLEX_TANGENT_VECTOR_VERT_SHADER, FLEX_VECTOR_GEOM_SHADER, FLEX_VECTOR_FRAG_SHADER}, DrawMode::Points);
   registerShaderProgram("RAYCAST_CYLINDER", {FLEX_CYLINDER_VERT_SHADER, FLEX_CYLINDER_GEOM_SHADER, FLEX_CYLINDER_FRAG_SHADER}, DrawMode::Points);
@@ -2016,6 +2314,7 @@ void MockGLEngine::populateDefaultShadersAndRules() {
   registerShaderRule("MESH_PROPAGATE_TYPE_AND_BASECOLOR2_SHADE", MESH_PROPAGATE_TYPE_AND_BASECOLOR2_SHADE);
   registerShaderRule("MESH_PROPAGATE_PICK", MESH_PROPAGATE_PICK);
   registerShaderRule("MESH_PROPAGATE_PICK_SIMPLE", MESH_PROPAGATE_PICK_SIMPLE);
+  registerShaderRule("MESH_PROPAGATE_PICK_SIMPLE_FROM_INDS", MESH_PROPAGATE_PICK_SIMPLE_FROM_INDS);
   
   // volume gridcube things
   registerShaderRule("GRIDCUBE_PROPAGATE_NODE_VALUE", GRIDCUBE_PROPAGATE_NODE_VALUE);
@@ -2023,6 +2322,9 @@ void MockGLEngine::populateDefaultShadersAndRules() {
   registerShaderRule("GRIDCUBE_WIREFRAME", GRIDCUBE_WIREFRAME);
   registerShaderRule("GRIDCUBE_CONSTANT_PICK", GRIDCUBE_CONSTANT_PICK);
   registerShaderRule("GRIDCUBE_CULLPOS_FROM_CENTER", GRIDCUBE_CULLPOS_FROM_CENTER);
+  registerShaderRule("SPARSE_GRIDCUBE_BRICK", SPARSE_GRIDCUBE_BRICK);
+  registerShaderRule("SPARSE_GRIDCUBE_PROPAGATE_NODE_VALUE", SPARSE_GRIDCUBE_PROPAGATE_NODE_VALUE);
+  registerShaderRule("SPARSE_GRIDCUBE_PROPAGATE_CELL_VALUE", SPARSE_GRIDCUBE_PROPAGATE_CELL_VALUE);
 
   // sphere things
   registerShaderRule("SPHERE_PROPAGATE_VALUE", SPHERE_PROPAGATE_VALUE);
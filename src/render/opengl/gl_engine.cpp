@@ -51,6 +51,8 @@ inline GLenum internalFormat(const TextureFormat& x) {
     case TextureFormat::RGBA16F:    return GL_RGBA16F;
     case TextureFormat::R32F:       return GL_R32F;
     case TextureFormat::R16F:       return GL_R16F;
+    case TextureFormat::R16:        return GL_R16;
+    case TextureFormat::R8:         return GL_R8;
     case TextureFormat::RGB32F:     return GL_RGBA32F;
     case TextureFormat::RGBA32F:    return GL_RGBA32F;
     case TextureFormat::DEPTH24:    return GL_DEPTH_COMPONENT24;
@@ -68,6 +70,8 @@ inline GLenum formatF(const TextureFormat& x) {
     case TextureFormat::RGBA16F:    return GL_RGBA;
     case TextureFormat::R32F:       return GL_RED;
     case TextureFormat::R16F:       return GL_RED;
+    case TextureFormat::R16:        return GL_RED;
+    case TextureFormat::R8:         return GL_RED;
     case TextureFormat::RGB32F:     return GL_RGB;
     case TextureFormat::RGBA32F:    return GL_RGBA;
     case TextureFormat::DEPTH24:    return GL_DEPTH_COMPONENT;
@@ -85,6 +89,8 @@ inline GLenum type(const TextureFormat& x) {
     case TextureFormat::RGBA16F:    return GL_HALF_FLOAT;
     case TextureFormat::R32F:       return GL_FLOAT;
     case TextureFormat::R16F:       return GL_FLOAT;
+    case TextureFormat::R16:        return GL_UNSIGNED_SHORT;
+    case TextureFormat::R8:         return GL_UNSIGNED_BYTE;
     case TextureFormat::RGB32F:     return GL_FLOAT;
     case TextureFormat::RGBA32F:    return GL_FLOAT;
     case TextureFormat::DEPTH24:    return GL_FLOAT;
@@ -248,61 +254,63 @@ GLenum GLAttributeBuffer::getTarget() { return GL_ARRAY_BUFFER; }
 
 
 template <typename T>
-void GLAttributeBuffer::setData_helper(const std::vector<T>& data) {
+void GLAttributeBuffer::setData_helper(const T* data, size_t count) {
   bind();
 
   // allocate if needed
-  if (!isSet() || data.size() > bufferSize) {
+  if (!isSet() || count > bufferSize) {
     setFlag = true;
-    uint64_t newSize = data.size();
+    uint64_t newSize = count;
     newSize = std::max(newSize, 2 * bufferSize); // if we're expanding, at-least double
     glBufferData(getTarget(), newSize * sizeof(T), NULL, GL_STATIC_DRAW);
     bufferSize = newSize;
   }
 
   // do the actual copy
-  dataSize = data.size();
-  glBufferSubData(getTarget(), 0, dataSize * sizeof(T), data.data());
+  dataSize = count;
+  glBufferSubData(getTarget(), 0, dataSize * sizeof(T), data);
+
+  render::engine->recordUpload(dataSize * sizeof(T));
 
   checkGLError();
 }
 
 void GLAttributeBuffer::setData(const std::vector<glm::vec2>& data) {
   checkType(RenderDataType::Vector2Float);
-  setData_helper(data);
+  setData_helper(data.data(), data.size());
 }
 
 void GLAttributeBuffer::setData(const std::vector<glm::vec3>& data) {
   checkType(RenderDataType::Vector3Float);
-  setData_helper(data);
+  setData_helper(data.data(), data.size());
 }
 
 void GLAttributeBuffer::setData(const std::vector<std::array<glm::vec3, 2>>& data) {
   checkType(RenderDataType::Vector3Float);
   checkArray(2);
-  setData_helper(data);
+  setData_helper(data.data(), data.size());
 }
 
 void GLAttributeBuffer::setData(const std::vector<std::array<glm::vec3, 3>>& data) {
   checkType(RenderDataType::Vector3Float);
   checkArray(3);
-  setData_helper(data);
+  setData_helper(data.data(), data.size());
 }
 
 void GLAttributeBuffer::setData(const std::vector<std::array<glm::vec3, 4>>& data) {
   checkType(RenderDataType::Vector3Float);
   checkArray(4);
-  setData_helper(data);
+  setData_helper(data.data(), data.size());
 }
 
 void GLAttributeBuffer::setData(const std::vector<glm::vec4>& data) {
   checkType(RenderDataType::Vector4Float);
-  setData_helper(data);
+  setData_helper(data.data(), data.size());
 }
 
 void GLAttributeBuffer::setData(const std::vector<float>& data) {
   checkType(RenderDataType::Float);
-  setData_helper(data);
+  setData_helper(data.data(), data.size());
 }
 
 void GLAttributeBuffer::setData(const std::vector<double>& data) {
@@ -310,35 +318,213 @@ void GLAttributeBuffer::setData(const std::vector<double>& data) {
 
   // Convert input data to floats
   std::vector<float> floatData(data.size());
-  for (unsigned int i = 0; i < data.size(); i++) {
-    floatData[i] = static_cast<float>(data[i]);
-  }
+  convertToFloat(data.data(), data.size(), floatData.data());
 
-  setData_helper(floatData);
+  setData_helper(floatData.data(), floatData.size());
 }
 
 void GLAttributeBuffer::setData(const std::vector<int32_t>& data) {
   checkType(RenderDataType::Int);
-  setData_helper(data);
+  setData_helper(data.data(), data.size());
 }
 
 void GLAttributeBuffer::setData(const std::vector<uint32_t>& data) {
   checkType(RenderDataType::UInt);
-  setData_helper(data);
+  setData_helper(data.data(), data.size());
 }
 
 void GLAttributeBuffer::setData(const std::vector<glm::uvec2>& data) {
   checkType(RenderDataType::Vector2UInt);
-  setData_helper(data);
+  setData_helper(data.data(), data.size());
 }
 void GLAttributeBuffer::setData(const std::vector<glm::uvec3>& data) {
   checkType(RenderDataType::Vector3UInt);
-  setData_helper(data);
+  setData_helper(data.data(), data.size());
 }
 
 void GLAttributeBuffer::setData(const std::vector<glm::uvec4>& data) {
   checkType(RenderDataType::Vector4UInt);
-  setData_helper(data);
+  setData_helper(data.data(), data.size());
+}
+
+// === set values from contiguous memory
+
+void GLAttributeBuffer::setData(const glm::vec2* data, size_t count) {
+  checkType(RenderDataType::Vector2Float);
+  setData_helper(data, count);
+}
+
+void GLAttributeBuffer::setData(const glm::vec3* data, size_t count) {
+  checkType(RenderDataType::Vector3Float);
+  setData_helper(data, count);
+}
+
+void GLAttributeBuffer::setData(const std::array<glm::vec3, 2>* data, size_t count) {
+  checkType(RenderDataType::Vector3Float);
+  checkArray(2);
+  setData_helper(data, count);
+}
+
+void GLAttributeBuffer::setData(const std::array<glm::vec3, 3>* data, size_t count) {
+  checkType(RenderDataType::Vector3Float);
+  checkArray(3);
+  setData_helper(data, count);
+}
+
+void GLAttributeBuffer::setData(const std::array<glm::vec3, 4>* data, size_t count) {
+  checkType(RenderDataType::Vector3Float);
+  checkArray(4);
+  setData_helper(data, count);
+}
+
+void GLAttributeBuffer::setData(const glm::vec4* data, size_t count) {
+  checkType(RenderDataType::Vector4Float);
+  setData_helper(data, count);
+}
+
+void GLAttributeBuffer::setData(const float* data, size_t count) {
+  checkType(RenderDataType::Float);
+  setData_helper(data, count);
+}
+
+void GLAttributeBuffer::setData(const double* data, size_t count) {
+  checkType(RenderDataType::Float);
+
+  // Convert input data to floats
+  std::vector<float> floatData(count);
+  convertToFloat(data, count, floatData.data());
+
+  setData_helper(floatData.data(), floatData.size());
+}
+
+void GLAttributeBuffer::setData(const int32_t* data, size_t count) {
+  checkType(RenderDataType::Int);
+  setData_helper(data, count);
+}
+
+void GLAttributeBuffer::setData(const uint32_t* data, size_t count) {
+  checkType(RenderDataType::UInt);
+  setData_helper(data, count);
+}
+
+void GLAttributeBuffer::setData(const glm::uvec2* data, size_t count) {
+  checkType(RenderDataType::Vector2UInt);
+  setData_helper(data, count);
+}
+void GLAttributeBuffer::setData(const glm::uvec3* data, size_t count) {
+  checkType(RenderDataType::Vector3UInt);
+  setData_helper(data, count);
+}
+
+void GLAttributeBuffer::setData(const glm::uvec4* data, size_t count) {
+  checkType(RenderDataType::Vector4UInt);
+  setData_helper(data, count);
+}
+
+// === set ranges of values
+
+template <typename T>
+void GLAttributeBuffer::setDataRange_helper(const std::vector<T>& data, size_t dataStart, size_t dataEnd,
+                                            size_t bufferStart) {
+  if (!isSet()) exception("called setDataRange() on attribute buffer which has not been allocated");
+  if (dataStart > dataEnd || dataEnd > data.size()) exception("bad setDataRange source range");
+  size_t count = dataEnd - dataStart;
+  if (bufferStart + count > static_cast<size_t>(getDataSize())) exception("setDataRange out of bounds of buffer");
+  if (count == 0) return;
+
+  bind();
+  glBufferSubData(getTarget(), bufferStart * sizeof(T), count * sizeof(T), &data[dataStart]);
+
+  render::engine->recordUpload(count * sizeof(T));
+
+  checkGLError();
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<glm::vec2>& data, size_t dataStart, size_t dataEnd,
+                                     size_t bufferStart) {
+  checkType(RenderDataType::Vector2Float);
+  setDataRange_helper(data, dataStart, dataEnd, bufferStart);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<glm::vec3>& data, size_t dataStart, size_t dataEnd,
+                                     size_t bufferStart) {
+  checkType(RenderDataType::Vector3Float);
+  setDataRange_helper(data, dataStart, dataEnd, bufferStart);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<std::array<glm::vec3, 2>>& data, size_t dataStart,
+                                     size_t dataEnd, size_t bufferStart) {
+  checkType(RenderDataType::Vector3Float);
+  checkArray(2);
+  setDataRange_helper(data, dataStart, dataEnd, bufferStart);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<std::array<glm::vec3, 3>>& data, size_t dataStart,
+                                     size_t dataEnd, size_t bufferStart) {
+  checkType(RenderDataType::Vector3Float);
+  checkArray(3);
+  setDataRange_helper(data, dataStart, dataEnd, bufferStart);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<std::array<glm::vec3, 4>>& data, size_t dataStart,
+                                     size_t dataEnd, size_t bufferStart) {
+  checkType(RenderDataType::Vector3Float);
+  checkArray(4);
+  setDataRange_helper(data, dataStart, dataEnd, bufferStart);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<glm::vec4>& data, size_t dataStart, size_t dataEnd,
+                                     size_t bufferStart) {
+  checkType(RenderDataType::Vector4Float);
+  setDataRange_helper(data, dataStart, dataEnd, bufferStart);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<float>& data, size_t dataStart, size_t dataEnd,
+                                     size_t bufferStart) {
+  checkType(RenderDataType::Float);
+  setDataRange_helper(data, dataStart, dataEnd, bufferStart);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<double>& data, size_t dataStart, size_t dataEnd,
+                                     size_t bufferStart) {
+  checkType(RenderDataType::Float);
+  if (dataStart > dataEnd || dataEnd > data.size()) exception("bad setDataRange source range");
+
+  // Convert the input range to floats
+  std::vector<float> floatData(dataEnd - dataStart);
+  convertToFloat(data.data() + dataStart, floatData.size(), floatData.data());
+
+  setDataRange_helper(floatData, 0, floatData.size(), bufferStart);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<int32_t>& data, size_t dataStart, size_t dataEnd,
+                                     size_t bufferStart) {
+  checkType(RenderDataType::Int);
+  setDataRange_helper(data, dataStart, dataEnd, bufferStart);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<uint32_t>& data, size_t dataStart, size_t dataEnd,
+                                     size_t bufferStart) {
+  checkType(RenderDataType::UInt);
+  setDataRange_helper(data, dataStart, dataEnd, bufferStart);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<glm::uvec2>& data, size_t dataStart, size_t dataEnd,
+                                     size_t bufferStart) {
+  checkType(RenderDataType::Vector2UInt);
+  setDataRange_helper(data, dataStart, dataEnd, bufferStart);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<glm::uvec3>& data, size_t dataStart, size_t dataEnd,
+                                     size_t bufferStart) {
+  checkType(RenderDataType::Vector3UInt);
+  setDataRange_helper(data, dataStart, dataEnd, bufferStart);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<glm::uvec4>& data, size_t dataStart, size_t dataEnd,
+                                     size_t bufferStart) {
+  checkType(RenderDataType::Vector4UInt);
+  setDataRange_helper(data, dataStart, dataEnd, bufferStart);
 }
 
 // === get single data values
@@ -458,6 +644,54 @@ uint32_t GLAttributeBuffer::getNativeBufferID() { return static_cast<uint32_t>(V
 // ==================== Texture buffer =========================
 // =============================================================
 
+GLTextureReadback::GLTextureReadback(GLuint packBuffer_, GLsync fence_, size_t nFloats_)
+    : packBuffer(packBuffer_), fence(fence_), nFloats(nFloats_) {}
+
+GLTextureReadback::~GLTextureReadback() { release(); }
+
+bool GLTextureReadback::isReady() {
+  if (haveData) return true;
+  GLenum status = glClientWaitSync(fence, 0, 0);
+  return status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED;
+}
+
+std::vector<float> GLTextureReadback::getData() {
+  if (haveData) return data;
+
+  // wait for the copy to finish (this is immediate if isReady() == true)
+  GLenum status = GL_TIMEOUT_EXPIRED;
+  while (status == GL_TIMEOUT_EXPIRED) {
+    status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000); // (timeout in nanoseconds)
+  }
+  if (status == GL_WAIT_FAILED) exception("OpenGL error: waiting for texture readback failed");
+
+  data.resize(nFloats);
+  if (nFloats > 0) {
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, packBuffer);
+    void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, nFloats * sizeof(float), GL_MAP_READ_BIT);
+    if (mapped == nullptr) exception("OpenGL error: could not map texture readback buffer");
+    std::copy(static_cast<const float*>(mapped), static_cast<const float*>(mapped) + nFloats, data.begin());
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  }
+  checkGLError();
+
+  release();
+  haveData = true;
+  return data;
+}
+
+void GLTextureReadback::release() {
+  if (fence) {
+    glDeleteSync(fence);
+    fence = nullptr;
+  }
+  if (packBuffer) {
+    glDeleteBuffers(1, &packBuffer);
+    packBuffer = 0;
+  }
+}
+
 
 // create a 1D texture from data
 GLTextureBuffer::GLTextureBuffer(TextureFormat format_, unsigned int size1D, const unsigned char* data)
@@ -597,6 +831,8 @@ void GLTextureBuffer::setData(const std::vector<glm::vec3>& data) {
     break;
   }
 
+  render::engine->recordUpload(data.size() * sizeof(glm::vec3));
+
   checkGLError();
 };
 
@@ -620,6 +856,8 @@ void GLTextureBuffer::setData(const std::vector<glm::vec4>& data) {
     break;
   }
 
+  render::engine->recordUpload(data.size() * sizeof(glm::vec4));
+
   checkGLError();
 };
 
@@ -642,6 +880,8 @@ void GLTextureBuffer::setData(const std::vector<float>& data) {
     break;
   }
 
+  render::engine->recordUpload(data.size() * sizeof(float));
+
   checkGLError();
 };
 
@@ -650,9 +890,7 @@ void GLTextureBuffer::setData(const std::vector<double>& data) {
 
   // Convert to float
   std::vector<float> dataFloat(data.size());
-  for (size_t i = 0; i < data.size(); i++) {
-    dataFloat[i] = static_cast<float>(data[i]);
-  }
+  convertToFloat(data.data(), data.size(), dataFloat.data());
 
   bind();
 
@@ -672,6 +910,8 @@ void GLTextureBuffer::setData(const std::vector<double>& data) {
     break;
   }
 
+  render::engine->recordUpload(data.size() * sizeof(float));
+
   checkGLError();
 };
 void GLTextureBuffer::setData(const std::vector<int32_t>& data) { exception("not implemented"); };
@@ -683,6 +923,156 @@ void GLTextureBuffer::setData(const std::vector<std::array<glm::vec3, 2>>& data)
 void GLTextureBuffer::setData(const std::vector<std::array<glm::vec3, 3>>& data) { exception("not implemented"); };
 void GLTextureBuffer::setData(const std::vector<std::array<glm::vec3, 4>>& data) { exception("not implemented"); };
 
+template <typename T>
+void GLTextureBuffer::setDataRegion_helper(const std::vector<T>& data, std::array<unsigned int, 3> offset,
+                                           std::array<unsigned int, 3> size) {
+
+  if (data.size() != getTotalSize()) {
+    exception("OpenGL error: texture buffer data is not the right size.");
+  }
+
+  // unused dimensions are treated as having size 1
+  std::array<unsigned int, 3> texSize{sizeX, dim >= 2 ? sizeY : 1u, dim >= 3 ? sizeZ : 1u};
+  for (int i = 0; i < 3; i++) {
+    if (offset[i] + size[i] > texSize[i]) exception("OpenGL error: texture region is out of bounds.");
+  }
+  if (size[0] == 0 || size[1] == 0 || size[2] == 0) return;
+
+  bind();
+
+  // Describe the layout of the full source array, so the region can be read directly out of it without a copy
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, texSize[0]);
+  glPixelStorei(GL_UNPACK_IMAGE_HEIGHT, texSize[1]);
+  glPixelStorei(GL_UNPACK_SKIP_PIXELS, offset[0]);
+  glPixelStorei(GL_UNPACK_SKIP_ROWS, offset[1]);
+  glPixelStorei(GL_UNPACK_SKIP_IMAGES, offset[2]);
+
+  switch (dim) {
+  case 1:
+    glTexSubImage1D(GL_TEXTURE_1D, 0, offset[0], size[0], formatF(format), type(format), &data.front());
+    break;
+  case 2:
+    glTexSubImage2D(GL_TEXTURE_2D, 0, offset[0], offset[1], size[0], size[1], formatF(format), type(format),
+                    &data.front());
+    break;
+  case 3:
+    glTexSubImage3D(GL_TEXTURE_3D, 0, offset[0], offset[1], offset[2], size[0], size[1], size[2], formatF(format),
+                    type(format), &data.front());
+    break;
+  }
+
+  // restore the default unpack state
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+  glPixelStorei(GL_UNPACK_IMAGE_HEIGHT, 0);
+  glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+  glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+  glPixelStorei(GL_UNPACK_SKIP_IMAGES, 0);
+
+  render::engine->recordUpload(static_cast<size_t>(size[0]) * size[1] * size[2] * sizeof(T));
+
+  checkGLError();
+}
+
+// clang-format off
+void GLTextureBuffer::setDataRegion(const std::vector<glm::vec2>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { exception("not implemented"); }
+void GLTextureBuffer::setDataRegion(const std::vector<glm::vec3>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { setDataRegion_helper(data, offset, size); }
+void GLTextureBuffer::setDataRegion(const std::vector<glm::vec4>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { setDataRegion_helper(data, offset, size); }
+void GLTextureBuffer::setDataRegion(const std::vector<float>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { setDataRegion_helper(data, offset, size); }
+void GLTextureBuffer::setDataRegion(const std::vector<double>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) {
+  if (data.size() != getTotalSize()) {
+    exception("OpenGL error: texture buffer data is not the right size.");
+  }
+
+  // unused dimensions are treated as having size 1
+  std::array<unsigned int, 3> texSize{sizeX, dim >= 2 ? sizeY : 1u, dim >= 3 ? sizeZ : 1u};
+  for (int i = 0; i < 3; i++) {
+    if (offset[i] + size[i] > texSize[i]) exception("OpenGL error: texture region is out of bounds.");
+  }
+
+  // Convert just the region to float, packed, rather than the whole texture
+  std::vector<float> dataFloat(static_cast<size_t>(size[0]) * size[1] * size[2]);
+  size_t iOut = 0;
+  for (size_t k = offset[2]; k < offset[2] + size[2]; k++) {
+    for (size_t j = offset[1]; j < offset[1] + size[1]; j++) {
+      size_t iRow = (k * texSize[1] + j) * texSize[0] + offset[0];
+      convertToFloat(data.data() + iRow, size[0], dataFloat.data() + iOut);
+      iOut += size[0];
+    }
+  }
+  setDataRegionPacked_helper(dataFloat.data(), offset, size, type(format));
+}
+void GLTextureBuffer::setDataRegion(const std::vector<int32_t>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { exception("not implemented"); }
+void GLTextureBuffer::setDataRegion(const std::vector<uint32_t>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { exception("not implemented"); }
+void GLTextureBuffer::setDataRegion(const std::vector<glm::uvec2>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { exception("not implemented"); }
+void GLTextureBuffer::setDataRegion(const std::vector<glm::uvec3>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { exception("not implemented"); }
+void GLTextureBuffer::setDataRegion(const std::vector<glm::uvec4>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { exception("not implemented"); }
+void GLTextureBuffer::setDataRegion(const std::vector<std::array<glm::vec3, 2>>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { exception("not implemented"); }
+void GLTextureBuffer::setDataRegion(const std::vector<std::array<glm::vec3, 3>>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { exception("not implemented"); }
+void GLTextureBuffer::setDataRegion(const std::vector<std::array<glm::vec3, 4>>& data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { exception("not implemented"); }
+// clang-format on
+
+template <typename T>
+void GLTextureBuffer::setDataRegionPacked_helper(const T* data, std::array<unsigned int, 3> offset,
+                                                 std::array<unsigned int, 3> size, GLenum dataType) {
+
+  // unused dimensions are treated as having size 1
+  std::array<unsigned int, 3> texSize{sizeX, dim >= 2 ? sizeY : 1u, dim >= 3 ? sizeZ : 1u};
+  for (int i = 0; i < 3; i++) {
+    if (offset[i] + size[i] > texSize[i]) exception("OpenGL error: texture region is out of bounds.");
+  }
+  if (size[0] == 0 || size[1] == 0 || size[2] == 0) return;
+
+  bind();
+
+  // the data is tightly packed; rows of 8 and 16 bit values need not be 4-byte aligned, as the default unpack state
+  // expects
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  switch (dim) {
+  case 1:
+    glTexSubImage1D(GL_TEXTURE_1D, 0, offset[0], size[0], formatF(format), dataType, data);
+    break;
+  case 2:
+    glTexSubImage2D(GL_TEXTURE_2D, 0, offset[0], offset[1], size[0], size[1], formatF(format), dataType, data);
+    break;
+  case 3:
+    glTexSubImage3D(GL_TEXTURE_3D, 0, offset[0], offset[1], offset[2], size[0], size[1], size[2], formatF(format),
+                    dataType, data);
+    break;
+  }
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+  render::engine->recordUpload(static_cast<size_t>(size[0]) * size[1] * size[2] * sizeof(T));
+
+  checkGLError();
+}
+
+// clang-format off
+void GLTextureBuffer::setDataRegion(const glm::vec2* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { exception("not implemented"); }
+void GLTextureBuffer::setDataRegion(const glm::vec3* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { setDataRegionPacked_helper(data, offset, size, type(format)); }
+void GLTextureBuffer::setDataRegion(const glm::vec4* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { setDataRegionPacked_helper(data, offset, size, type(format)); }
+void GLTextureBuffer::setDataRegion(const float* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { setDataRegionPacked_helper(data, offset, size, type(format)); }
+void GLTextureBuffer::setDataRegion(const double* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) {
+  // Convert to float
+  size_t count = static_cast<size_t>(size[0]) * size[1] * size[2];
+  std::vector<float> dataFloat(count);
+  convertToFloat(data, count, dataFloat.data());
+  setDataRegionPacked_helper(dataFloat.data(), offset, size, type(format));
+}
+void GLTextureBuffer::setDataRegion(const int32_t* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { exception("not implemented"); }
+void GLTextureBuffer::setDataRegion(const uint32_t* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { exception("not implemented"); }
+void GLTextureBuffer::setDataRegion(const glm::uvec2* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { exception("not implemented"); }
+void GLTextureBuffer::setDataRegion(const glm::uvec3* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { exception("not implemented"); }
+void GLTextureBuffer::setDataRegion(const glm::uvec4* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { exception("not implemented"); }
+void GLTextureBuffer::setDataRegion(const std::array<glm::vec3, 2>* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { exception("not implemented"); }
+void GLTextureBuffer::setDataRegion(const std::array<glm::vec3, 3>* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { exception("not implemented"); }
+void GLTextureBuffer::setDataRegion(const std::array<glm::vec3, 4>* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { exception("not implemented"); }
+void GLTextureBuffer::setDataRegion(const uint8_t* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) { setDataRegionPacked_helper(data, offset, size, GL_UNSIGNED_BYTE); }
+void GLTextureBuffer::setDataRegion(const uint16_t* data, std::array<unsigned int, 3> offset, std::array<unsigned int, 3> size) {
+  // half floats for the 16 bit float format, otherwise integers
+  setDataRegionPacked_helper(data, offset, size, format == TextureFormat::R16F ? GL_HALF_FLOAT : GL_UNSIGNED_SHORT);
+}
+// clang-format on
+
 
 void GLTextureBuffer::setFilterMode(FilterMode newMode) {
 
@@ -741,7 +1131,6 @@ std::vector<glm::vec2> GLTextureBuffer::getDataVector2() {
 
 std::vector<glm::vec3> GLTextureBuffer::getDataVector3() {
   if (dimension(format) != 3) exception("called getDataVector3 on texture which does not have a 3 dimensional format");
-  exception("not implemented");
 
   std::vector<glm::vec3> outData;
   outData.resize(getTotalSize());
@@ -753,6 +1142,39 @@ std::vector<glm::vec3> GLTextureBuffer::getDataVector3() {
   return outData;
 }
 
+std::vector<glm::vec4> GLTextureBuffer::getDataVector4() {
+  if (dimension(format) != 4) exception("called getDataVector4 on texture which does not have a 4 dimensional format");
+
+  std::vector<glm::vec4> outData;
+  outData.resize(getTotalSize());
+
+  bind();
+  glGetTexImage(textureType(), 0, formatF(format), GL_FLOAT, static_cast<void*>(&outData.front()));
+  checkGLError();
+
+  return outData;
+}
+
+std::shared_ptr<TextureReadback> GLTextureBuffer::getDataAsync() {
+  size_t nFloats = static_cast<size_t>(getTotalSize()) * dimension(format);
+
+  // Copy the texture in to a pack buffer. This is queued on the device, and does not wait for the data.
+  GLuint packBuffer;
+  glGenBuffers(1, &packBuffer);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, packBuffer);
+  glBufferData(GL_PIXEL_PACK_BUFFER, nFloats * sizeof(float), nullptr, GL_STREAM_READ);
+
+  bind();
+  glGetTexImage(textureType(), 0, formatF(format), GL_FLOAT, nullptr);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+  GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  glFlush(); // make sure the commands actually get submitted, so the fence eventually signals
+  checkGLError();
+
+  return std::shared_ptr<TextureReadback>(new GLTextureReadback(packBuffer, fence, nFloats));
+}
+
 GLenum GLTextureBuffer::textureType() {
   if (dim == 1) {
     return GL_TEXTURE_1D;
@@ -983,6 +1405,34 @@ float GLFrameBuffer::readDepth(int xPos, int yPos) {
   return result;
 }
 
+std::vector<std::array<float, 4>> GLFrameBuffer::readFloat4Region(int xPos, int yPos, int sizeX, int sizeY) {
+
+  glFlush();
+  glFinish();
+  bind();
+
+  // Read from the buffer
+  std::vector<std::array<float, 4>> result(static_cast<size_t>(sizeX) * sizeY);
+  if (result.empty()) return result;
+  glReadPixels(xPos, yPos, sizeX, sizeY, GL_RGBA, GL_FLOAT, &result.front());
+
+  return result;
+}
+
+std::vector<float> GLFrameBuffer::readDepthRegion(int xPos, int yPos, int sizeX, int sizeY) {
+
+  glFlush();
+  glFinish();
+  bind();
+
+  // Read from the buffer
+  std::vector<float> result(static_cast<size_t>(sizeX) * sizeY, 1.);
+  if (result.empty()) return result;
+  glReadPixels(xPos, yPos, sizeX, sizeY, GL_DEPTH_COMPONENT, GL_FLOAT, &result.front());
+
+  return result;
+}
+
 std::vector<unsigned char> GLFrameBuffer::readBuffer() {
 
   glFlush();
@@ -1288,7 +1738,8 @@ void GLShaderProgram::assignBufferToVAO(GLShaderAttribute& a) {
   a.buff->bind();
   checkGLError();
 
-  // Choose the correct type for the buffer
+  // Choose the correct type for the buffer. Integer types use the I-variant, so the shader sees integers rather than
+  // values converted to float.
   for (int iArrInd = 0; iArrInd < a.arrayCount; iArrInd++) {
 
     glEnableVertexAttribArray(a.location + iArrInd);
@@ -1299,12 +1750,12 @@ void GLShaderProgram::assignBufferToVAO(GLShaderAttribute& a) {
                             reinterpret_cast<void*>(sizeof(float) * 1 * iArrInd));
       break;
     case RenderDataType::Int:
-      glVertexAttribPointer(a.location + iArrInd, 1, GL_INT, GL_FALSE, sizeof(int) * 1 * a.arrayCount,
-                            reinterpret_cast<void*>(sizeof(int) * 1 * iArrInd));
+      glVertexAttribIPointer(a.location + iArrInd, 1, GL_INT, sizeof(int) * 1 * a.arrayCount,
+                             reinterpret_cast<void*>(sizeof(int) * 1 * iArrInd));
       break;
     case RenderDataType::UInt:
-      glVertexAttribPointer(a.location + iArrInd, 1, GL_UNSIGNED_INT, GL_FALSE, sizeof(uint32_t) * 1 * a.arrayCount,
-                            reinterpret_cast<void*>(sizeof(uint32_t) * 1 * iArrInd));
+      glVertexAttribIPointer(a.location + iArrInd, 1, GL_UNSIGNED_INT, sizeof(uint32_t) * 1 * a.arrayCount,
+                             reinterpret_cast<void*>(sizeof(uint32_t) * 1 * iArrInd));
       break;
     case RenderDataType::Vector2Float:
       glVertexAttribPointer(a.location + iArrInd, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 2 * a.arrayCount,
@@ -1319,16 +1770,16 @@ void GLShaderProgram::assignBufferToVAO(GLShaderAttribute& a) {
                             reinterpret_cast<void*>(sizeof(float) * 4 * iArrInd));
       break;
     case RenderDataType::Vector2UInt:
-      glVertexAttribPointer(a.location + iArrInd, 2, GL_UNSIGNED_INT, GL_FALSE, sizeof(uint32_t) * 2 * a.arrayCount,
-                            reinterpret_cast<void*>(sizeof(uint32_t) * 2 * iArrInd));
+      glVertexAttribIPointer(a.location + iArrInd, 2, GL_UNSIGNED_INT, sizeof(uint32_t) * 2 * a.arrayCount,
+                             reinterpret_cast<void*>(sizeof(uint32_t) * 2 * iArrInd));
       break;
     case RenderDataType::Vector3UInt:
-      glVertexAttribPointer(a.location + iArrInd, 3, GL_UNSIGNED_INT, GL_FALSE, sizeof(uint32_t) * 3 * a.arrayCount,
-                            reinterpret_cast<void*>(sizeof(uint32_t) * 3 * iArrInd));
+      glVertexAttribIPointer(a.location + iArrInd, 3, GL_UNSIGNED_INT, sizeof(uint32_t) * 3 * a.arrayCount,
+                             reinterpret_cast<void*>(sizeof(uint32_t) * 3 * iArrInd));
       break;
     case RenderDataType::Vector4UInt:
-      glVertexAttribPointer(a.location + iArrInd, 4, GL_UNSIGNED_INT, GL_FALSE, sizeof(uint32_t) * 4 * a.arrayCount,
-                            reinterpret_cast<void*>(sizeof(uint32_t) * 4 * iArrInd));
+      glVertexAttribIPointer(a.location + iArrInd, 4, GL_UNSIGNED_INT, sizeof(uint32_t) * 4 * a.arrayCount,
+                             reinterpret_cast<void*>(sizeof(uint32_t) * 4 * iArrInd));
       break;
     default:
       throw std::invalid_argument("Unrecognized GLShaderAttribute type");
@@ -1957,6 +2408,24 @@ void GLShaderProgram::setIndex(std::shared_ptr<AttributeBuffer> externalBuffer)
   checkGLError();
 }
 
+// Buffers and textures currently attached to the program (used for memory accounting)
+std::vector<AttributeBuffer*> GLShaderProgram::getAttributeBuffers() {
+  std::vector<AttributeBuffer*> buffers;
+  for (GLShaderAttribute& a : attributes) {
+    if (a.buff) buffers.push_back(a.buff.get());
+  }
+  if (indexBuffer) buffers.push_back(indexBuffer.get());
+  return buffers;
+}
+
+std::vector<TextureBuffer*> GLShaderProgram::getTextureBuffers() {
+  std::vector<TextureBuffer*> buffers;
+  for (GLShaderTexture& t : textures) {
+    if (t.isSet && t.textureBuffer) buffers.push_back(t.textureBuffer);
+  }
+  return buffers;
+}
+
 // Check that uniforms and attributes are all set and of consistent size
 void GLShaderProgram::validateData() {
 
@@ -2451,10 +2920,12 @@ void GLEngine::populateDefaultShadersAndRules() {
   registerShaderProgram("INDEXED_MESH", {FLEX_MESH_VERT_SHADER, FLEX_MESH_FRAG_SHADER}, DrawMode::IndexedTriangles);
   registerShaderProgram("SIMPLE_MESH", {SIMPLE_MESH_VERT_SHADER, SIMPLE_MESH_FRAG_SHADER}, DrawMode::IndexedTriangles);
   registerShaderProgram("SLICE_TETS", {SLICE_TETS_VERT_SHADER, SLICE_TETS_GEOM_SHADER, SLICE_TETS_FRAG_SHADER}, DrawMode::Points);
+  registerShaderProgram("SLICE_TETS_TEXTURE", {SLICE_TETS_TEXTURE_VERT_SHADER, SLICE_TETS_GEOM_SHADER, SLICE_TETS_FRAG_SHADER}, DrawMode::Points);
   registerShaderProgram("RAYCAST_SPHERE", {FLEX_SPHERE_VERT_SHADER, FLEX_SPHERE_GEOM_SHADER, FLEX_SPHERE_FRAG_SHADER}, DrawMode::Points);
   registerShaderProgram("POINT_QUAD", {FLEX_POINTQUAD_VERT_SHADER, FLEX_POINTQUAD_GEOM_SHADER, FLEX_POINTQUAD_FRAG_SHADER}, DrawMode::Points);
   registerShaderProgram("GRIDCUBE", {FLEX_GRIDCUBE_VERT_SHADER, FLEX_GRIDCUBE_GEOM_SHADER, FLEX_GRIDCUBE_FRAG_SHADER}, DrawMode::Points);
   registerShaderProgram("GRIDCUBE_PLANE", {FLEX_GRIDCUBE_PLANE_VERT_SHADER, FLEX_GRIDCUBE_PLANE_FRAG_SHADER}, DrawMode::Triangles);
+  registerShaderProgram("SPARSE_GRIDCUBE_PLANE", {SPARSE_GRIDCUBE_PLANE_VERT_SHADER, FLEX_GRIDCUBE_PLANE_FRAG_SHADER}, DrawMode::TrianglesInstanced);
   registerShaderProgram("RAYCAST_VECTOR", {FLEX_VECTOR_VERT_SHADER, FLEX_VECTOR_GEOM_SHADER, FLEX_VECTOR_FRAG_SHADER}, DrawMode::Points);
   registerShaderProgram("RAYCAST_TANGENT_VECTOR", {FLEX_TANGENT_VECTOR_VERT_SHADER, FLEX_VECTOR_GEOM_SHADER, FLEX_VECTOR_FRAG_SHADER}, DrawMode::Points);
   registerShaderProgram("RAYCAST_CYLINDER", {FLEX_CYLINDER_VERT_SHADER, FLEX_CYLINDER_GEOM_SHADER, FLEX_CYLINDER_FRAG_SHADER}, DrawMode::Points);
@@ -2552,6 +3023,7 @@ void GLEngine::populateDefaultShadersAndRules() {
   registerShaderRule("MESH_PROPAGATE_TYPE_AND_BASECOLOR2_SHADE", MESH_PROPAGATE_TYPE_AND_BASECOLOR2_SHADE);
   registerShaderRule("MESH_PROPAGATE_PICK", MESH_PROPAGATE_PICK);
   registerShaderRule("MESH_PROPAGATE_PICK_SIMPLE", MESH_PROPAGATE_PICK_SIMPLE);
+  registerShaderRule("MESH_PROPAGATE_PICK_SIMPLE_FROM_INDS", MESH_PROPAGATE_PICK_SIMPLE_FROM_INDS);
 
   // volume gridcube things
   registerShaderRule("GRIDCUBE_PROPAGATE_NODE_VALUE", GRIDCUBE_PROPAGATE_NODE_VALUE);
@@ -2559,6 +3031,9 @@ void GLEngine::populateDefaultShadersAndRules() {
   registerShaderRule("GRIDCUBE_WIREFRAME", GRIDCUBE_WIREFRAME);
   registerShaderRule("GRIDCUBE_CONSTANT_PICK", GRIDCUBE_CONSTANT_PICK);
   registerShaderRule("GRIDCUBE_CULLPOS_FROM_CENTER", GRIDCUBE_CULLPOS_FROM_CENTER);
+  registerShaderRule("SPARSE_GRIDCUBE_BRICK", SPARSE_GRIDCUBE_BRICK);
+  registerShaderRule("SPARSE_GRIDCUBE_PROPAGATE_NODE_VALUE", SPARSE_GRIDCUBE_PROPAGATE_NODE_VALUE);
+  registerShaderRule("SPARSE_GRIDCUBE_PROPAGATE_CELL_VALUE", SPARSE_GRIDCUBE_PROPAGATE_CELL_VALUE);
 
   // sphere things
   registerShaderRule("SPHERE_PROPAGATE_VALUE", SPHERE_PROPAGATE_VALUE);
@@ -163,6 +163,16 @@ float intToDistinctReal(float start, int index) {
   return clamp(val, 0.f, 1.f);
 }
 
+// Encode a pick index as a color, exactly as pick::indToVec() does on the host: 22 bits of the index in each channel.
+// The index is rangeStart + ind, where rangeStart is a 64-bit value passed as (low word, high word).
+vec3 pickIndToColor(uvec2 rangeStart, uint ind) {
+  uint low = rangeStart.x + ind;
+  uint high = rangeStart.y + uint(low < ind); // carry
+  uint mask = (1u << 22) - 1u;
+  uvec3 packed = uvec3(low & mask, (low >> 22) | ((high << 10) & mask), high >> 12);
+  return vec3(packed) / float(1u << 22);
+}
+
 
 // Two useful references:
 //   - https://stackoverflow.com/questions/38938498/how-do-i-convert-gl-fragcoord-to-a-world-space-point-in-a-fragment-shader
@@ -261,6 +261,90 @@ R"(
 )"
 };
 
+// Like FLEX_GRIDCUBE_PLANE_VERT_SHADER, but for a sparse grid. The planes of a single reference brick are drawn once per
+// occupied brick, with the placement of each instance read from a texture. Used with FLEX_GRIDCUBE_PLANE_FRAG_SHADER
+// and the SPARSE_GRIDCUBE_BRICK rule.
+const ShaderStageSpecification SPARSE_GRIDCUBE_PLANE_VERT_SHADER = {
+
+    ShaderStageType::Vertex,
+
+    // uniforms
+    {
+        {"u_modelView", RenderDataType::Matrix44Float},
+        {"u_projMatrix", RenderDataType::Matrix44Float},
+        {"u_boundMin", RenderDataType::Vector3Float},
+        {"u_boundMax", RenderDataType::Vector3Float},
+        {"u_cubeSizeFactor", RenderDataType::Float},
+        {"u_gridSpacingReference", RenderDataType::Vector3Float},
+        {"u_brickSize", RenderDataType::Float},
+    }, 
+
+    // attributes
+    {
+        {"a_referencePosition", RenderDataType::Vector3Float},
+        {"a_referenceNormal", RenderDataType::Vector3Float},
+        {"a_axisInd", RenderDataType::Int},
+    },
+
+    // textures
+    {
+        {"t_brickInfo", 2},
+    },
+
+    // source
+R"(
+        ${ GLSL_VERSION }$
+        
+        uniform mat4 u_modelView;
+        uniform mat4 u_projMatrix;
+        uniform vec3 u_boundMin;
+        uniform vec3 u_boundMax;
+        uniform float u_cubeSizeFactor;
+        uniform vec3 u_gridSpacingReference;
+        uniform float u_brickSize;
+        uniform sampler2D t_brickInfo;
+
+        in vec3 a_referencePosition;
+        in vec3 a_referenceNormal;
+        in int a_axisInd;
+        
+        out vec3 a_coordToFrag;
+        out vec3 a_normalToFrag;
+        out vec3 a_refNormalToFrag;
+        flat out int a_axisIndToFrag;
+        flat out vec3 a_brickCellOriginToFrag;
+        flat out int a_brickIndToFrag;
+        flat out int a_brickNeighborMaskToFrag;
+        
+        ${ VERT_DECLARATIONS }$
+        
+        void main()
+        {
+            // look up the brick for this instance: its first cell, and which of its neighbors are occupied
+            int width = textureSize(t_brickInfo, 0).x;
+            vec4 brickInfo = texelFetch(t_brickInfo, ivec2(gl_InstanceID % width, gl_InstanceID / width), 0);
+
+            // place the reference brick in the grid, then apply any scale shrinking 
+            vec3 gridPosition = (brickInfo.xyz + a_referencePosition * u_brickSize) * u_gridSpacingReference;
+            vec3 adjPosition = gridPosition - a_referenceNormal * (1.f - (0.5 + u_cubeSizeFactor/2.)) * u_gridSpacingReference;
+
+            // apply box shift
+            vec3 boxPos = mix(u_boundMin, u_boundMax, adjPosition);
+
+            a_coordToFrag = adjPosition;
+            a_normalToFrag = mat3(u_modelView) * a_referenceNormal;
+            a_refNormalToFrag = a_referenceNormal;
+            a_axisIndToFrag = a_axisInd;
+            a_brickCellOriginToFrag = brickInfo.xyz;
+            a_brickIndToFrag = gl_InstanceID;
+            a_brickNeighborMaskToFrag = int(brickInfo.w + 0.5);
+            gl_Position = u_projMatrix * u_modelView * vec4(boxPos,1.);
+
+            ${ VERT_ASSIGNMENTS }$
+        }
+)"
+};
+
 const ShaderStageSpecification FLEX_GRIDCUBE_PLANE_FRAG_SHADER = {
     
     ShaderStageType::Fragment,
@@ -396,6 +480,87 @@ const ShaderReplacementRule GRIDCUBE_PROPAGATE_CELL_VALUE (
     }
 );
 
+const ShaderReplacementRule SPARSE_GRIDCUBE_BRICK (
+    /* rule name */ "SPARSE_GRIDCUBE_BRICK",
+    { /* replacement sources */
+      {"FRAG_DECLARATIONS", R"(
+          flat in vec3 a_brickCellOriginToFrag;
+          flat in int a_brickIndToFrag;
+          flat in int a_brickNeighborMaskToFrag;
+          uniform float u_brickSize;
+        )"},
+      {"GRID_PLANE_NEIGHBOR_FILTER", R"(
+          // a neighbor in another brick is only drawn if that brick is occupied
+          vec3 neighCellLocal = cellInd3f + a_refNormalToFrag - a_brickCellOriginToFrag;
+          if(any(lessThan(neighCellLocal, vec3(-0.5))) || any(greaterThan(neighCellLocal, vec3(u_brickSize - 0.5)))) {
+            int neighAxis = abs(a_refNormalToFrag.x) > 0.5 ? 0 : (abs(a_refNormalToFrag.y) > 0.5 ? 1 : 2);
+            int neighBit = 2 * neighAxis + (dot(a_refNormalToFrag, vec3(1.)) > 0. ? 0 : 1);
+            if(((a_brickNeighborMaskToFrag >> neighBit) & 1) == 0) {
+              neighIsVisible = false;
+            }
+          }
+        )"},
+    },
+    /* uniforms */ {
+      {"u_brickSize", RenderDataType::Float},
+    },
+    /* attributes */ { },
+    /* textures */ { }
+);
+
+const ShaderReplacementRule SPARSE_GRIDCUBE_PROPAGATE_NODE_VALUE (
+    /* rule name */ "SPARSE_GRIDCUBE_PROPAGATE_NODE_VALUE",
+    { /* replacement sources */
+      {"FRAG_DECLARATIONS", R"(
+          uniform sampler3D t_value;
+          uniform vec3 u_poolSlotDim;
+          uniform float u_poolSlotSize;
+        )"},
+      {"GENERATE_SHADE_VALUE", R"(
+          // each brick's nodes are a block of the pool texture, interpolate within that block
+          ivec3 poolSlotDim = ivec3(u_poolSlotDim + 0.5);
+          ivec3 poolSlot = ivec3(a_brickIndToFrag % poolSlotDim.x, (a_brickIndToFrag / poolSlotDim.x) % poolSlotDim.y, a_brickIndToFrag / (poolSlotDim.x * poolSlotDim.y));
+          vec3 nodeCoordLocal = clamp(coordUnit - a_brickCellOriginToFrag, vec3(0.), vec3(u_brickSize));
+          vec3 poolCoord = vec3(poolSlot) * u_poolSlotSize + nodeCoordLocal + 0.5;
+          float shadeValue = texture(t_value, poolCoord / (u_poolSlotDim * u_poolSlotSize)).r;
+        )"},
+    },
+    /* uniforms */ {
+      {"u_poolSlotDim", RenderDataType::Vector3Float},
+      {"u_poolSlotSize", RenderDataType::Float},
+    },
+    /* attributes */ { },
+    /* textures */ {
+      {"t_value", 3},
+    }
+);
+
+const ShaderReplacementRule SPARSE_GRIDCUBE_PROPAGATE_CELL_VALUE (
+    /* rule name */ "SPARSE_GRIDCUBE_PROPAGATE_CELL_VALUE",
+    { /* replacement sources */
+      {"FRAG_DECLARATIONS", R"(
+          uniform sampler3D t_value;
+          uniform vec3 u_poolSlotDim;
+          uniform float u_poolSlotSize;
+        )"},
+      {"GENERATE_SHADE_VALUE", R"(
+          // each brick's cells are a block of the pool texture
+          ivec3 poolSlotDim = ivec3(u_poolSlotDim + 0.5);
+          ivec3 poolSlot = ivec3(a_brickIndToFrag % poolSlotDim.x, (a_brickIndToFrag / poolSlotDim.x) % poolSlotDim.y, a_brickIndToFrag / (poolSlotDim.x * poolSlotDim.y));
+          ivec3 cellIndLocal = clamp(ivec3(cellInd3f - a_brickCellOriginToFrag + 0.5), ivec3(0), ivec3(int(u_brickSize + 0.5) - 1));
+          float shadeValue = texelFetch(t_value, poolSlot * int(u_poolSlotSize + 0.5) + cellIndLocal, 0).r;
+        )"},
+    },
+    /* uniforms */ {
+      {"u_poolSlotDim", RenderDataType::Vector3Float},
+      {"u_poolSlotSize", RenderDataType::Float},
+    },
+    /* attributes */ { },
+    /* textures */ {
+      {"t_value", 3},
+    }
+);
+
 const ShaderReplacementRule GRIDCUBE_WIREFRAME (
     /* rule name */ "GRIDCUBE_WIREFRAME",
     {
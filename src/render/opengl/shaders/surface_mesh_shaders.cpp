@@ -615,26 +615,43 @@ const ShaderReplacementRule MESH_BACKFACE_DIFFERENT (
 
 
 // data for picking
+// Pick colors are computed from element indices and the start of each element type's pick range
 const ShaderReplacementRule MESH_PROPAGATE_PICK (
     /* rule name */ "MESH_PROPAGATE_PICK",
     { /* replacement sources */
       {"VERT_DECLARATIONS", R"(
-          in vec3 a_vertexColors[3];
-          in vec3 a_halfedgeColors[3];
-          in vec3 a_cornerColors[3];
-          in vec3 a_faceColor;
+          in uvec3 a_vertexInds;
+          in uvec3 a_halfedgeInds;
+          in uvec3 a_cornerInds;
+          in vec3 a_edgeIsReal;
+          uniform uvec2 u_vertexPickStart;
+          uniform uvec2 u_facePickStart;
+          uniform uvec2 u_halfedgePickStart;
+          uniform uvec2 u_cornerPickStart;
+          uniform int u_pickHalfedges;
+          uniform int u_pickCorners;
           flat out vec3 vertexColors[3];
           flat out vec3 halfedgeColors[3];
           flat out vec3 cornerColors[3];
           flat out vec3 faceColor;
+          vec3 pickIndToColor(uvec2 rangeStart, uint ind);
         )"},
       {"VERT_ASSIGNMENTS", R"(
+          faceColor = pickIndToColor(u_facePickStart, a_faceInds);
           for(int i = 0; i < 3; i++) {
-              vertexColors[i] = a_vertexColors[i];
-              halfedgeColors[i] = a_halfedgeColors[i];
-              cornerColors[i] = a_cornerColors[i];
+              vertexColors[i] = pickIndToColor(u_vertexPickStart, a_vertexInds[i]);
+
+              // internal edges of triangulated polygons pick the face
+              halfedgeColors[i] = faceColor;
+              if(u_pickHalfedges != 0 && a_edgeIsReal[i] > 0.5) {
+                halfedgeColors[i] = pickIndToColor(u_halfedgePickStart, a_halfedgeInds[i]);
+              }
+
+              cornerColors[i] = vertexColors[i];
+              if(u_pickCorners != 0) {
+                cornerColors[i] = pickIndToColor(u_cornerPickStart, a_cornerInds[i]);
+              }
           }
-          faceColor = a_faceColor;
         )"},
       {"FRAG_DECLARATIONS", R"(
           flat in vec3 vertexColors[3];
@@ -675,12 +692,20 @@ const ShaderReplacementRule MESH_PROPAGATE_PICK (
           }
         )"},
     },
-    /* uniforms */ {},
+    /* uniforms */ {
+      {"u_vertexPickStart", RenderDataType::Vector2UInt},
+      {"u_facePickStart", RenderDataType::Vector2UInt},
+      {"u_halfedgePickStart", RenderDataType::Vector2UInt},
+      {"u_cornerPickStart", RenderDataType::Vector2UInt},
+      {"u_pickHalfedges", RenderDataType::Int},
+      {"u_pickCorners", RenderDataType::Int},
+    },
     /* attributes */ {
-      {"a_vertexColors", RenderDataType::Vector3Float, 3},
-      {"a_halfedgeColors", RenderDataType::Vector3Float, 3},
-      {"a_cornerColors", RenderDataType::Vector3Float, 3},
-      {"a_faceColor", RenderDataType::Vector3Float},
+      {"a_faceInds", RenderDataType::UInt},
+      {"a_vertexInds", RenderDataType::Vector3UInt},
+      {"a_halfedgeInds", RenderDataType::Vector3UInt},
+      {"a_cornerInds", RenderDataType::Vector3UInt},
+      {"a_edgeIsReal", RenderDataType::Vector3Float},
     },
     /* textures */ {}
 );
@@ -730,6 +755,55 @@ const ShaderReplacementRule MESH_PROPAGATE_PICK_SIMPLE ( // this one does faces
     /* textures */ {}
 );
 
+const ShaderReplacementRule MESH_PROPAGATE_PICK_SIMPLE_FROM_INDS ( // faces and verts only, like MESH_PROPAGATE_PICK_SIMPLE
+    /* rule name */ "MESH_PROPAGATE_PICK_SIMPLE_FROM_INDS",
+    { /* replacement sources */
+      {"VERT_DECLARATIONS", R"(
+          in uvec3 a_vertexInds;
+          uniform uvec2 u_vertexPickStart;
+          uniform uvec2 u_facePickStart;
+          flat out vec3 vertexColors[3];
+          flat out vec3 faceColor;
+          vec3 pickIndToColor(uvec2 rangeStart, uint ind);
+        )"},
+      {"VERT_ASSIGNMENTS", R"(
+          for(int i = 0; i < 3; i++) {
+              vertexColors[i] = pickIndToColor(u_vertexPickStart, a_vertexInds[i]);
+          }
+          faceColor = pickIndToColor(u_facePickStart, a_faceInds);
+        )"},
+      {"FRAG_DECLARATIONS", R"(
+          flat in vec3 vertexColors[3];
+          flat in vec3 faceColor;
+          uniform float u_vertPickRadius;
+        )"},
+      {"GENERATE_SHADE_VALUE", R"(
+          // Parameters defining the pick shape (in barycentric 0-1 units)
+          
+          vec3 shadeColor = faceColor;
+
+          // Test vertices and corners
+          float nearestRad = 1.0-u_vertPickRadius;
+          for(int i = 0; i < 3; i++) {
+              if(a_barycoordToFrag[i] > nearestRad) {
+                nearestRad = a_barycoordToFrag[i];
+                shadeColor = vertexColors[i];
+              }
+          }
+        )"},
+    },
+    /* uniforms */ {
+      {"u_vertPickRadius", RenderDataType::Float},
+      {"u_vertexPickStart", RenderDataType::Vector2UInt},
+      {"u_facePickStart", RenderDataType::Vector2UInt},
+    },
+    /* attributes */ {
+      {"a_faceInds", RenderDataType::UInt},
+      {"a_vertexInds", RenderDataType::Vector3UInt},
+    },
+    /* textures */ {}
+);
+
 
 // clang-format on
 
@@ -64,6 +64,60 @@ const ShaderStageSpecification SLICE_TETS_VERT_SHADER = {
 )"};
 
 
+// Same outputs as above, but only takes the vertex indices of each tet, and looks up positions in a texture
+const ShaderStageSpecification SLICE_TETS_TEXTURE_VERT_SHADER = {
+
+    ShaderStageType::Vertex,
+
+    // uniforms
+    {},
+
+    // attributes
+    {
+        {"a_tetVertexInds", RenderDataType::Vector4UInt},
+    },
+
+    // textures
+    {
+        {"t_vertexPositions", 2},
+    },
+
+    // source
+    R"(
+        ${ GLSL_VERSION }$
+        ${ VERT_DECLARATIONS }$
+
+        in uvec4 a_tetVertexInds;
+        uniform sampler2D t_vertexPositions;
+        out vec3 point_1;
+        out vec3 point_2;
+        out vec3 point_3;
+        out vec3 point_4;
+        out vec3 slice_1;
+        out vec3 slice_2;
+        out vec3 slice_3;
+        out vec3 slice_4;
+
+        vec3 fetchVertexPosition(uint iV) {
+            int width = textureSize(t_vertexPositions, 0).x;
+            return texelFetch(t_vertexPositions, ivec2(int(iV) % width, int(iV) / width), 0).xyz;
+        }
+
+        void main()
+        {
+            point_1 = fetchVertexPosition(a_tetVertexInds.x);
+            point_2 = fetchVertexPosition(a_tetVertexInds.y);
+            point_3 = fetchVertexPosition(a_tetVertexInds.z);
+            point_4 = fetchVertexPosition(a_tetVertexInds.w);
+            slice_1 = point_1;
+            slice_2 = point_2;
+            slice_3 = point_3;
+            slice_4 = point_4;
+            ${ VERT_ASSIGNMENTS }$
+        }
+)"};
+
+
 const ShaderStageSpecification SLICE_TETS_GEOM_SHADER = {
 
     ShaderStageType::Geometry,
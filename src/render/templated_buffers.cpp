@@ -375,6 +375,106 @@ template std::shared_ptr<TextureBuffer> generateTextureBuffer<std::array<glm::ve
 
 // clang-format on
 
+// == Get texture data
+
+// default implementation, for types which textures cannot hold
+template <typename T>
+std::vector<T> getTextureBufferData(TextureBuffer& buff) {
+  exception("texture readback is not supported for this type");
+  return std::vector<T>();
+}
+
+template <>
+std::vector<float> getTextureBufferData<float>(TextureBuffer& buff) {
+  return buff.getDataScalar();
+}
+
+template <>
+std::vector<double> getTextureBufferData<double>(TextureBuffer& buff) {
+  std::vector<float> fetch = buff.getDataScalar();
+  return std::vector<double>(fetch.begin(), fetch.end());
+}
+
+template <>
+std::vector<glm::vec2> getTextureBufferData<glm::vec2>(TextureBuffer& buff) {
+  return buff.getDataVector2();
+}
+
+template <>
+std::vector<glm::vec3> getTextureBufferData<glm::vec3>(TextureBuffer& buff) {
+  return buff.getDataVector3();
+}
+
+template <>
+std::vector<glm::vec4> getTextureBufferData<glm::vec4>(TextureBuffer& buff) {
+  return buff.getDataVector4();
+}
+
+// default implementation, for types which textures cannot hold
+template <typename T>
+std::vector<T> unpackTextureReadbackData(const std::vector<float>& components) {
+  exception("texture readback is not supported for this type");
+  return std::vector<T>();
+}
+
+template <>
+std::vector<float> unpackTextureReadbackData<float>(const std::vector<float>& components) {
+  return components;
+}
+
+template <>
+std::vector<double> unpackTextureReadbackData<double>(const std::vector<float>& components) {
+  return std::vector<double>(components.begin(), components.end());
+}
+
+template <>
+std::vector<glm::vec2> unpackTextureReadbackData<glm::vec2>(const std::vector<float>& components) {
+  std::vector<glm::vec2> out(components.size() / 2);
+  for (size_t i = 0; i < out.size(); i++) {
+    out[i] = glm::vec2{components[2 * i + 0], components[2 * i + 1]};
+  }
+  return out;
+}
+
+template <>
+std::vector<glm::vec3> unpackTextureReadbackData<glm::vec3>(const std::vector<float>& components) {
+  std::vector<glm::vec3> out(components.size() / 3);
+  for (size_t i = 0; i < out.size(); i++) {
+    out[i] = glm::vec3{components[3 * i + 0], components[3 * i + 1], components[3 * i + 2]};
+  }
+  return out;
+}
+
+template <>
+std::vector<glm::vec4> unpackTextureReadbackData<glm::vec4>(const std::vector<float>& components) {
+  std::vector<glm::vec4> out(components.size() / 4);
+  for (size_t i = 0; i < out.size(); i++) {
+    out[i] = glm::vec4{components[4 * i + 0], components[4 * i + 1], components[4 * i + 2], components[4 * i + 3]};
+  }
+  return out;
+}
+
+// instantiations of the defaults for the remaining types
+// clang-format off
+template std::vector<int32_t   > getTextureBufferData<int32_t   >(TextureBuffer& buff);
+template std::vector<uint32_t  > getTextureBufferData<uint32_t  >(TextureBuffer& buff);
+template std::vector<glm::uvec2> getTextureBufferData<glm::uvec2>(TextureBuffer& buff);
+template std::vector<glm::uvec3> getTextureBufferData<glm::uvec3>(TextureBuffer& buff);
+template std::vector<glm::uvec4> getTextureBufferData<glm::uvec4>(TextureBuffer& buff);
+template std::vector<std::array<glm::vec3, 2>> getTextureBufferData<std::array<glm::vec3, 2>>(TextureBuffer& buff);
+template std::vector<std::array<glm::vec3, 3>> getTextureBufferData<std::array<glm::vec3, 3>>(TextureBuffer& buff);
+template std::vector<std::array<glm::vec3, 4>> getTextureBufferData<std::array<glm::vec3, 4>>(TextureBuffer& buff);
+
+template std::vector<int32_t   > unpackTextureReadbackData<int32_t   >(const std::vector<float>& components);
+template std::vector<uint32_t  > unpackTextureReadbackData<uint32_t  >(const std::vector<float>& components);
+template std::vector<glm::uvec2> unpackTextureReadbackData<glm::uvec2>(const std::vector<float>& components);
+template std::vector<glm::uvec3> unpackTextureReadbackData<glm::uvec3>(const std::vector<float>& components);
+template std::vector<glm::uvec4> unpackTextureReadbackData<glm::uvec4>(const std::vector<float>& components);
+template std::vector<std::array<glm::vec3, 2>> unpackTextureReadbackData<std::array<glm::vec3, 2>>(const std::vector<float>& components);
+template std::vector<std::array<glm::vec3, 3>> unpackTextureReadbackData<std::array<glm::vec3, 3>>(const std::vector<float>& components);
+template std::vector<std::array<glm::vec3, 4>> unpackTextureReadbackData<std::array<glm::vec3, 4>>(const std::vector<float>& components);
+// clang-format on
+
 
 } // namespace render
 } // namespace polyscope
@@ -16,6 +16,14 @@ ScalarImageQuantity::ScalarImageQuantity(Structure& parent_, std::string name, s
   values.setTextureSize(dimX, dimY);
 }
 
+ScalarImageQuantity::ScalarImageQuantity(Structure& parent_, std::string name, size_t dimX, size_t dimY,
+                                         QuantizedScalarArray data_, ImageOrigin imageOrigin_, DataType dataType_)
+    : ImageQuantity(parent_, name, dimX, dimY, imageOrigin_),
+      ScalarQuantity(*this, data_.sampleValues(1 << 20), dataType_) {
+  values.setTextureSize(dimX, dimY);
+  setQuantizedValues(std::move(data_));
+}
+
 
 void ScalarImageQuantity::buildCustomUI() {
   ImGui::SameLine();
@@ -172,4 +180,9 @@ ScalarImageQuantity* createScalarImageQuantity(Structure& parent, std::string na
   return new ScalarImageQuantity(parent, name, dimX, dimY, data, imageOrigin, dataType);
 }
 
+ScalarImageQuantity* createScalarImageQuantity(Structure& parent, std::string name, size_t dimX, size_t dimY,
+                                               QuantizedScalarArray data, ImageOrigin imageOrigin, DataType dataType) {
+  return new ScalarImageQuantity(parent, name, dimX, dimY, std::move(data), imageOrigin, dataType);
+}
+
 } // namespace polyscope
@@ -164,7 +164,7 @@ void SlicePlane::createVolumeSliceProgram() {
   VolumeMesh* meshToInspect = polyscope::getVolumeMesh(inspectedMeshName);
 
   // clang-format off
-  volumeInspectProgram = render::engine->requestShader( "SLICE_TETS",
+  volumeInspectProgram = render::engine->requestShader( meshToInspect->getSliceProgramName(),
       render::engine->addMaterialRules(meshToInspect->getMaterial(),
         meshToInspect->addVolumeMeshRules(
           {"SLICE_TETS_BASECOLOR_SHADE"},
@@ -175,6 +175,7 @@ void SlicePlane::createVolumeSliceProgram() {
 
   meshToInspect->fillSliceGeometryBuffers(*volumeInspectProgram);
   render::engine->setMaterial(*volumeInspectProgram, meshToInspect->getMaterial());
+  meshToInspect->trackProgramMemoryUsage(volumeInspectProgram);
 }
 
 void SlicePlane::resetVolumeSliceProgram() { volumeInspectProgram.reset(); }
@@ -0,0 +1,617 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#include "polyscope/sparse_volume_grid.h"
+
+#include "polyscope/parallel.h"
+#include "polyscope/pick.h"
+#include "polyscope/utilities.h"
+
+#include "imgui.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace polyscope {
+
+// Initialize statics
+const std::string SparseVolumeGrid::structureTypeName = "Sparse Volume Grid";
+
+namespace {
+// Largest side of the brick pool textures. 3D textures of this size are supported by essentially all GPUs.
+const uint32_t maxBrickPoolTextureDim = 2048;
+
+// Width of the texture which holds per-brick info
+const uint32_t brickInfoTextureWidth = 4096;
+} // namespace
+
+SparseVolumeGrid::SparseVolumeGrid(std::string name, glm::uvec3 gridNodeDim_, glm::vec3 boundMin_,
+                                   glm::vec3 boundMax_, uint32_t brickSize_,
+                                   const std::vector<glm::uvec3>& occupiedBricks_)
+    : GridCubeStructure<SparseVolumeGrid>(name, typeName()),
+
+      // clang-format off
+      // == managed quantities
+      brickPlaneReferencePositions(this, uniquePrefix() + "#brickPlaneReferencePositions", brickPlaneReferencePositionsData, std::bind(&SparseVolumeGrid::computeBrickPlaneReferenceGeometry, this)),
+      brickPlaneReferenceNormals(this, uniquePrefix() +   "#brickPlaneReferenceNormals",   brickPlaneReferenceNormalsData,   [](){/* do nothing, gets handled by position func */} ),
+      brickPlaneAxisInds(this, uniquePrefix() +           "#brickPlaneAxisInds",           brickPlaneAxisIndsData,           [](){/* do nothing, gets handled by position func */} ),
+      brickInfo(this, uniquePrefix() +                    "#brickInfo",                    brickInfoData,                    std::bind(&SparseVolumeGrid::computeBrickInfo, this)),
+
+      gridNodeDim(gridNodeDim_), gridCellDim(gridNodeDim_ - 1u), boundMin(boundMin_), boundMax(boundMax_),
+      brickSize(brickSize_), occupiedBricks(occupiedBricks_)
+// clang-format on
+{
+  if (brickSize == 0) exception("sparse volume grid " + name + " has brick size 0");
+  for (int i = 0; i < 3; i++) {
+    if (gridNodeDim[i] < 2 || gridCellDim[i] % brickSize != 0) {
+      exception("sparse volume grid " + name + " must have a whole number of bricks along each axis");
+    }
+  }
+  gridBrickDim = gridCellDim / brickSize;
+  if (nBricks() >= (1u << 24)) {
+    // the shaders look up each brick by gl_InstanceID in the brick info texture, which would need too many rows
+    exception("sparse volume grid " + name + " has too many occupied bricks");
+  }
+
+  // Sort the brick keys, for looking up bricks by coordinate
+  sortedBrickKeys.resize(nBricks());
+  sortedBrickInds.resize(nBricks());
+  for (size_t iB = 0; iB < nBricks(); iB++) {
+    const glm::uvec3& b = occupiedBricks[iB];
+    if (b.x >= gridBrickDim.x || b.y >= gridBrickDim.y || b.z >= gridBrickDim.z) {
+      exception("sparse volume grid " + name + " has an occupied brick outside of the grid");
+    }
+    sortedBrickKeys[iB] = brickKey(b);
+    sortedBrickInds[iB] = static_cast<uint32_t>(iB);
+  }
+  radixSortPairs(sortedBrickKeys, sortedBrickInds);
+  for (size_t i = 1; i < sortedBrickKeys.size(); i++) {
+    if (sortedBrickKeys[i] == sortedBrickKeys[i - 1]) {
+      exception("sparse volume grid " + name + " has a repeated brick");
+    }
+  }
+
+  // the brick info texture holds the bricks in rows of a fixed width
+  uint32_t texWidth = std::max<uint32_t>(1, std::min<uint32_t>(nBricks(), brickInfoTextureWidth));
+  uint32_t texHeight = std::max<uint32_t>(1, (nBricks() + texWidth - 1) / texWidth);
+  brickInfo.setTextureSize(texWidth, texHeight);
+
+  cullWholeElements.setPassive(true);
+  updateObjectSpaceBounds();
+}
+
+int64_t SparseVolumeGrid::findBrick(glm::uvec3 brick) const {
+  if (brick.x >= gridBrickDim.x || brick.y >= gridBrickDim.y || brick.z >= gridBrickDim.z) return -1;
+  uint64_t key = brickKey(brick);
+  std::vector<uint64_t>::const_iterator it = std::lower_bound(sortedBrickKeys.begin(), sortedBrickKeys.end(), key);
+  if (it == sortedBrickKeys.end() || *it != key) return -1;
+  return sortedBrickInds[it - sortedBrickKeys.begin()];
+}
+
+SparseVolumeGridBrickPool SparseVolumeGrid::computeBrickPool(uint32_t slotSize) const {
+  SparseVolumeGridBrickPool pool;
+  pool.slotSize = slotSize;
+
+  // Choose the slot counts along each axis which leave the fewest slots unused, preferring the most cube-like layout
+  // among those. Filling whole rows along x first can leave nearly a full layer empty.
+  size_t slotsPerAxis = std::max<size_t>(1, maxBrickPoolTextureDim / slotSize);
+  size_t n = std::max<size_t>(1, nBricks());
+  if (n > slotsPerAxis * slotsPerAxis * slotsPerAxis) {
+    exception("sparse volume grid " + name + " has too many occupied bricks to fit in a texture");
+  }
+  size_t bestUnused = std::numeric_limits<size_t>::max();
+  size_t bestLargestDim = std::numeric_limits<size_t>::max();
+  glm::uvec3 bestDim{1, 1, 1};
+  for (size_t sx = 1; sx <= std::min(n, slotsPerAxis); sx++) {
+    for (size_t sy = 1; sy <= std::min((n + sx - 1) / sx, slotsPerAxis); sy++) {
+      size_t sz = (n + sx * sy - 1) / (sx * sy);
+      if (sz > slotsPerAxis) continue;
+      size_t unused = sx * sy * sz - n;
+      size_t largestDim = std::max(sx, std::max(sy, sz));
+      if (unused < bestUnused || (unused == bestUnused && largestDim < bestLargestDim)) {
+        bestUnused = unused;
+        bestLargestDim = largestDim;
+        bestDim = glm::uvec3{sx, sy, sz};
+      }
+    }
+  }
+  pool.slotDim = bestDim;
+  return pool;
+}
+
+std::vector<float> SparseVolumeGrid::gatherToBrickPool(const SparseVolumeGridBrickPool& pool,
+                                                       const std::vector<float>& brickValues) const {
+  const uint32_t S = pool.slotSize;
+  const size_t valuesPerBrick = static_cast<size_t>(S) * S * S;
+  if (brickValues.size() != nBricks() * valuesPerBrick) {
+    exception("sparse volume grid " + name + " got " + std::to_string(brickValues.size()) +
+              " values, which does not match the occupied bricks");
+  }
+
+  // Unused slots at the end of the pool are filled with an existing value, so they do not affect the data range
+  glm::uvec3 texDim = pool.textureDim();
+  std::vector<float> poolValues(static_cast<size_t>(texDim.x) * texDim.y * texDim.z,
+                                brickValues.empty() ? 0.f : brickValues.front());
+
+  parallelFor(
+      nBricks(),
+      [&](size_t iB) {
+        const float* brickStart = &brickValues[iB * valuesPerBrick];
+        for (uint32_t z = 0; z < S; z++) {
+          for (uint32_t y = 0; y < S; y++) {
+            const float* row = brickStart + (static_cast<size_t>(z) * S + y) * S;
+            std::copy(row, row + S, poolValues.begin() + pool.texelIndex(iB, glm::uvec3{0, y, z}));
+          }
+        }
+      },
+      64);
+
+  return poolValues;
+}
+
+std::vector<float> SparseVolumeGrid::distinctNodeValues(const std::vector<float>& brickValues) const {
+  const uint32_t B = brickSize;
+  const size_t nodesPerBrick = nNodesPerBrick();
+  if (brickValues.size() != nBricks() * nodesPerBrick) {
+    exception("sparse volume grid " + name + " got " + std::to_string(brickValues.size()) +
+              " node values, which does not match the occupied bricks");
+  }
+
+  // A node on the faces between bricks is kept from the first of the occupied bricks which hold it. The other bricks
+  // are offset by -1 along the axes where the node is at the start of this brick, and +1 where it is at the end.
+  auto keptInBrick = [&](size_t iB, glm::uvec3 localNode) {
+    glm::ivec3 step{0, 0, 0};
+    for (int d = 0; d < 3; d++) {
+      step[d] = localNode[d] == 0 ? -1 : (localNode[d] == B ? 1 : 0);
+    }
+    for (int axes = 1; axes < 8; axes++) {
+      glm::ivec3 offset{0, 0, 0};
+      bool onAllAxes = true;
+      for (int d = 0; d < 3; d++) {
+        if (axes & (1 << d)) {
+          onAllAxes = onAllAxes && step[d] != 0;
+          offset[d] = step[d];
+        }
+      }
+      if (!onAllAxes) continue;
+      // (a brick before the start of the grid wraps around to a large index, which findBrick() does not find)
+      int64_t other = findBrick(glm::uvec3(glm::ivec3(occupiedBricks[iB]) + offset));
+      if (other != -1 && static_cast<size_t>(other) < iB) return false;
+    }
+    return true;
+  };
+
+  std::vector<float> distinctValues;
+  distinctValues.reserve(brickValues.size());
+  for (size_t iB = 0; iB < nBricks(); iB++) {
+    size_t i = iB * nodesPerBrick;
+    for (uint32_t z = 0; z <= B; z++) {
+      for (uint32_t y = 0; y <= B; y++) {
+        for (uint32_t x = 0; x <= B; x++) {
+          if (keptInBrick(iB, glm::uvec3{x, y, z})) distinctValues.push_back(brickValues[i]);
+          i++;
+        }
+      }
+    }
+  }
+  return distinctValues;
+}
+
+void SparseVolumeGrid::buildCustomUI() {
+  ImGui::Text("node dim (%lld, %lld, %lld)", static_cast<long long int>(gridNodeDim.x),
+              static_cast<long long int>(gridNodeDim.y), static_cast<long long int>(gridNodeDim.z));
+  ImGui::Text("%lld / %lld bricks of size %lld", static_cast<long long int>(nBricks()),
+              static_cast<long long int>(gridBrickDim.x) * gridBrickDim.y * gridBrickDim.z,
+              static_cast<long long int>(brickSize));
+
+  buildColorAndEdgeUI();
+}
+
+void SparseVolumeGrid::draw() {
+  if (!enabled.get()) return;
+
+  // Right now none of this class supports cullWholeElements = false, so just always force it to true
+  if (!getCullWholeElements()) {
+    setCullWholeElements(true);
+  }
+
+  // If there is no dominant quantity, then this class is responsible for the grid
+  if (dominantQuantity == nullptr && nBricks() > 0) {
+
+    // Ensure we have prepared buffers
+    ensureGridCubeRenderProgramPrepared();
+
+    // Set program uniforms
+    setStructureUniforms(*program);
+    setGridCubeUniforms(*program);
+    program->setUniform("u_baseColor", color.get());
+    render::engine->setMaterialUniforms(*program, material.get());
+
+    // Draw the actual grid
+    render::engine->setBackfaceCull(true);
+    program->draw();
+  }
+
+  // Draw the quantities
+  for (auto& x : quantities) {
+    x.second->draw();
+  }
+  for (auto& x : floatingQuantities) {
+    x.second->draw();
+  }
+}
+
+void SparseVolumeGrid::drawDelayed() {
+  if (!enabled.get()) return;
+
+  // Draw the quantities
+  for (auto& x : quantities) {
+    x.second->drawDelayed();
+  }
+  for (auto& x : floatingQuantities) {
+    x.second->drawDelayed();
+  }
+}
+
+void SparseVolumeGrid::drawPick() {
+  if (!isEnabled() || nBricks() == 0) {
+    return;
+  }
+
+  // only draw pick if the grid is actually being draw
+  if (dominantQuantity != nullptr) {
+    SparseVolumeGridQuantity* g = dynamic_cast<SparseVolumeGridQuantity*>(dominantQuantity);
+    if (g && !g->isDrawingGridcubes()) {
+      return;
+    }
+  }
+
+  ensureGridCubePickProgramPrepared();
+
+  // Set program uniforms
+  setStructureUniforms(*pickProgram);
+  setGridCubeUniforms(*pickProgram, false);
+  pickProgram->setUniform("u_pickColor", pickColor);
+
+  // Draw the actual grid
+  render::engine->setBackfaceCull(true);
+  pickProgram->draw();
+}
+
+std::vector<std::string> SparseVolumeGrid::addGridCubeRules(std::vector<std::string> initRules, bool withShade) {
+  initRules = addStructureRules(initRules);
+  initRules.push_back("SPARSE_GRIDCUBE_BRICK");
+
+  if (withShade) {
+    if (getEdgeWidth() > 0) {
+      initRules.push_back("GRIDCUBE_WIREFRAME");
+      initRules.push_back("MESH_WIREFRAME");
+    }
+  }
+
+  if (wantsCullPosition()) {
+    initRules.push_back("GRIDCUBE_CULLPOS_FROM_CENTER");
+  }
+
+  return initRules;
+}
+
+void SparseVolumeGrid::setGridCubeUniforms(render::ShaderProgram& p, bool withShade) {
+
+  p.setUniform("u_boundMin", boundMin);
+  p.setUniform("u_boundMax", boundMax);
+  p.setUniform("u_cubeSizeFactor", 1.f - cubeSizeFactor.get());
+  p.setUniform("u_gridSpacingReference", gridSpacingReference());
+  p.setUniform("u_brickSize", static_cast<float>(brickSize));
+
+  if (withShade) {
+    if (getEdgeWidth() > 0) {
+      p.setUniform("u_edgeWidth", getEdgeWidth() * render::engine->getCurrentPixelScaling());
+      p.setUniform("u_edgeColor", getEdgeColor());
+    }
+  }
+}
+
+void SparseVolumeGrid::setGridCubeBuffers(render::ShaderProgram& p) {
+  p.setAttribute("a_referencePosition", brickPlaneReferencePositions.getRenderAttributeBuffer());
+  p.setAttribute("a_referenceNormal", brickPlaneReferenceNormals.getRenderAttributeBuffer());
+  p.setAttribute("a_axisInd", brickPlaneAxisInds.getRenderAttributeBuffer());
+  p.setTextureFromBuffer("t_brickInfo", brickInfo.getRenderTextureBuffer().get());
+  p.setInstanceCount(static_cast<uint32_t>(nBricks()));
+}
+
+void SparseVolumeGrid::ensureGridCubeRenderProgramPrepared() {
+  // If already prepared, do nothing
+  if (program) return;
+
+  // clang-format off
+  program = render::engine->requestShader( "SPARSE_GRIDCUBE_PLANE",
+      render::engine->addMaterialRules(material.get(),
+        addGridCubeRules(
+          {"SHADE_BASECOLOR"},
+        true)
+      )
+  );
+  // clang-format on
+
+  setGridCubeBuffers(*program);
+  render::engine->setMaterial(*program, material.get());
+}
+
+void SparseVolumeGrid::ensureGridCubePickProgramPrepared() {
+
+  // If already prepared, do nothing
+  if (pickProgram) return;
+
+  // clang-format off
+  pickProgram = render::engine->requestShader(
+      "SPARSE_GRIDCUBE_PLANE",
+      addGridCubeRules({"GRIDCUBE_CONSTANT_PICK"}, false),
+      render::ShaderReplacementDefaults::Pick
+  );
+  // clang-format on
+
+  setGridCubeBuffers(*pickProgram);
+
+  if (globalPickConstant == INVALID_IND_64) {
+    // As in VolumeGrid, shade with a single constant pick index and work out which element was clicked CPU-side
+    globalPickConstant = pick::requestPickBufferRange(this, 1);
+    pickColor = pick::indToVec(static_cast<size_t>(globalPickConstant));
+  }
+}
+
+
+void SparseVolumeGrid::updateObjectSpaceBounds() {
+  objectSpaceBoundingBox = std::make_tuple(boundMin, boundMax);
+  objectSpaceLengthScale = glm::length(boundMax - boundMin);
+}
+
+std::string SparseVolumeGrid::typeName() { return structureTypeName; }
+
+void SparseVolumeGrid::refresh() {
+  QuantityStructure<SparseVolumeGrid>::refresh(); // call base class version, which refreshes quantities
+
+  program.reset();
+  pickProgram.reset();
+}
+
+
+void SparseVolumeGrid::computeBrickPlaneReferenceGeometry() {
+  // the planes of a single brick, drawn once per occupied brick
+  fillGridPlaneReferenceGeometry(glm::uvec3(brickSize), brickPlaneReferencePositions, brickPlaneReferenceNormals,
+                                 brickPlaneAxisInds);
+}
+
+void SparseVolumeGrid::computeBrickInfo() {
+
+  std::array<uint32_t, 3> texSize = brickInfo.getTextureSize();
+  brickInfo.data.resize(static_cast<size_t>(texSize[0]) * texSize[1]);
+
+  parallelFor(nBricks(), [&](size_t iB) {
+    glm::uvec3 b = occupiedBricks[iB];
+
+    // bits for the +x, -x, +y, -y, +z, -z neighbors
+    uint32_t neighborMask = 0;
+    for (int d = 0; d < 3; d++) {
+      glm::uvec3 bPlus = b;
+      bPlus[d]++;
+      if (findBrick(bPlus) != -1) neighborMask |= (1u << (2 * d));
+      if (b[d] > 0) {
+        glm::uvec3 bMinus = b;
+        bMinus[d]--;
+        if (findBrick(bMinus) != -1) neighborMask |= (1u << (2 * d + 1));
+      }
+    }
+
+    glm::vec3 cellOrigin = glm::vec3(b * brickSize);
+    brickInfo.data[iB] = glm::vec4{cellOrigin.x, cellOrigin.y, cellOrigin.z, static_cast<float>(neighborMask)};
+  });
+
+  brickInfo.markHostBufferUpdated();
+}
+
+// === Register functions
+
+
+SparseVolumeGridQuantity::SparseVolumeGridQuantity(std::string name_, SparseVolumeGrid& grid_, bool dominates_)
+    : QuantityS<SparseVolumeGrid>(name_, grid_, dominates_) {}
+
+
+SparseVolumeGridNodeScalarQuantity*
+SparseVolumeGrid::addNodeScalarQuantityImpl(std::string name, const std::vector<float>& data, DataType dataType_) {
+
+  checkForQuantityWithNameAndDeleteOrError(name);
+  SparseVolumeGridBrickPool pool = computeBrickPool(brickSize + 1);
+  SparseVolumeGridNodeScalarQuantity* q =
+      new SparseVolumeGridNodeScalarQuantity(name, *this, pool, data, dataType_);
+  addQuantity(q);
+  markNodesAsUsed();
+  return q;
+}
+
+SparseVolumeGridCellScalarQuantity*
+SparseVolumeGrid::addCellScalarQuantityImpl(std::string name, const std::vector<float>& data, DataType dataType_) {
+
+  checkForQuantityWithNameAndDeleteOrError(name);
+  SparseVolumeGridBrickPool pool = computeBrickPool(brickSize);
+  SparseVolumeGridCellScalarQuantity* q =
+      new SparseVolumeGridCellScalarQuantity(name, *this, pool, data, dataType_);
+  addQuantity(q);
+  markCellsAsUsed();
+  return q;
+}
+
+void SparseVolumeGrid::markNodesAsUsed() { nodesHaveBeenUsed = true; }
+
+void SparseVolumeGrid::markCellsAsUsed() { cellsHaveBeenUsed = true; }
+
+SparseVolumeGridPickResult SparseVolumeGrid::interpretPickResult(const PickResult& rawResult) {
+
+  if (rawResult.structure != this) {
+    // caller must ensure that the PickResult belongs to this structure
+    // by checking the structure pointer or name
+    exception("called interpretPickResult(), but the pick result is not from this structure");
+  }
+
+  SparseVolumeGridPickResult result;
+
+  // As in VolumeGrid, identify the element from the clicked position
+  float nodePickRad = 0.8; // measured in a [-1,1] cube
+
+  glm::vec3 localPickPos = (rawResult.position - boundMin) / (boundMax - boundMin);
+  localPickPos = clamp(localPickPos, glm::vec3(0.), glm::vec3(1.)); // on [0,1.]
+
+  glm::vec3 coordUnit = localPickPos / gridSpacingReference();
+  glm::vec3 coordMod = mod(coordUnit, 1.f);
+  glm::vec3 coordModShift = 2.f * coordMod - 1.f;
+  glm::vec3 coordLocal = coordModShift / (1.f - cubeSizeFactor.get()); // [-1,1] within each scaled cell
+  float distFromCorner = glm::length(1.f - abs(coordLocal));
+
+  // logic to only allow picking nodes/cells (e.g. if no cell data is registered, only pick nodes)
+  bool doPickNodes;
+  if (nodesHaveBeenUsed == cellsHaveBeenUsed) {
+    doPickNodes = distFromCorner < nodePickRad;
+  } else if (nodesHaveBeenUsed) {
+    doPickNodes = true;
+  } else /* cellsHaveBeenUsed == true */ {
+    doPickNodes = false;
+  }
+
+  // The clicked point is on the face of an occupied brick, but may round in to an empty neighbor. Try each of the
+  // candidate bricks along each axis.
+  std::array<std::vector<uint32_t>, 3> candidateBricks;
+  if (doPickNodes) {
+    glm::uvec3 nodeInd{std::round(coordUnit.x), std::round(coordUnit.y), std::round(coordUnit.z)};
+    nodeInd = glm::min(nodeInd, gridCellDim);
+    result.elementType = VolumeGridElement::NODE;
+    result.index = nodeInd;
+
+    // a node on the boundary between bricks is in both of them
+    for (int d = 0; d < 3; d++) {
+      if (nodeInd[d] / brickSize < gridBrickDim[d]) candidateBricks[d].push_back(nodeInd[d] / brickSize);
+      if (nodeInd[d] % brickSize == 0 && nodeInd[d] > 0) candidateBricks[d].push_back(nodeInd[d] / brickSize - 1);
+    }
+  } else {
+    const float faceEps = 1e-3;
+    glm::uvec3 cellInd{std::floor(coordUnit.x), std::floor(coordUnit.y), std::floor(coordUnit.z)};
+    cellInd = glm::min(cellInd, gridCellDim - 1u);
+    result.elementType = VolumeGridElement::CELL;
+    result.index = cellInd;
+
+    for (int d = 0; d < 3; d++) {
+      candidateBricks[d].push_back(cellInd[d] / brickSize);
+      float frac = coordUnit[d] - cellInd[d];
+      if (frac < faceEps && cellInd[d] % brickSize == 0 && cellInd[d] > 0) {
+        candidateBricks[d].push_back(cellInd[d] / brickSize - 1);
+      }
+      if (frac > 1.f - faceEps && (cellInd[d] + 1) % brickSize == 0 && cellInd[d] + 1 < gridCellDim[d]) {
+        candidateBricks[d].push_back(cellInd[d] / brickSize + 1);
+      }
+    }
+  }
+
+  result.brickIndex = -1;
+  for (uint32_t bx : candidateBricks[0]) {
+    for (uint32_t by : candidateBricks[1]) {
+      for (uint32_t bz : candidateBricks[2]) {
+        if (result.brickIndex != -1) continue;
+        result.brickIndex = findBrick(glm::uvec3{bx, by, bz});
+        if (result.brickIndex != -1 && result.elementType == VolumeGridElement::CELL) {
+          // move the cell in to the brick which was found
+          glm::uvec3 brickStart = glm::uvec3{bx, by, bz} * brickSize;
+          result.index = glm::clamp(result.index, brickStart, brickStart + (brickSize - 1));
+        }
+      }
+    }
+  }
+
+  return result;
+}
+
+void SparseVolumeGrid::buildPickUI(const PickResult& rawResult) {
+
+  SparseVolumeGridPickResult result = interpretPickResult(rawResult);
+  if (result.brickIndex == -1) return;
+
+  switch (result.elementType) {
+  case VolumeGridElement::NODE: {
+    buildNodeInfoGUI(result);
+    break;
+  }
+  case VolumeGridElement::CELL: {
+    buildCellInfoGUI(result);
+    break;
+  }
+  };
+}
+
+void SparseVolumeGrid::buildNodeInfoGUI(const SparseVolumeGridPickResult& result) {
+
+  glm::uvec3 nodeInd3 = result.index;
+  glm::uvec3 localNode = nodeInd3 - occupiedBricks[result.brickIndex] * brickSize;
+
+  ImGui::TextUnformatted(("Node index: (" + std::to_string(nodeInd3.x) + "," + std::to_string(nodeInd3.y) + "," +
+                          std::to_string(nodeInd3.z) + ")")
+                             .c_str());
+  ImGui::TextUnformatted(("Brick #" + std::to_string(result.brickIndex)).c_str());
+
+  std::stringstream buffer;
+  buffer << positionOfNodeIndex(nodeInd3);
+  ImGui::TextUnformatted(("Position: " + buffer.str()).c_str());
+
+  ImGui::Spacing();
+  ImGui::Spacing();
+  ImGui::Spacing();
+  ImGui::Indent(20.);
+
+  // Build GUI to show the quantities
+  ImGui::Columns(2);
+  ImGui::SetColumnWidth(0, ImGui::GetWindowWidth() / 3);
+  for (auto& x : quantities) {
+    x.second->buildNodeInfoGUI(result.brickIndex, localNode);
+  }
+
+  ImGui::Indent(-20.);
+}
+
+void SparseVolumeGrid::buildCellInfoGUI(const SparseVolumeGridPickResult& result) {
+
+  glm::uvec3 cellInd3 = result.index;
+  glm::uvec3 localCell = cellInd3 - occupiedBricks[result.brickIndex] * brickSize;
+
+  ImGui::TextUnformatted(("Cell index: (" + std::to_string(cellInd3.x) + "," + std::to_string(cellInd3.y) + "," +
+                          std::to_string(cellInd3.z) + ")")
+                             .c_str());
+  ImGui::TextUnformatted(("Brick #" + std::to_string(result.brickIndex)).c_str());
+
+  ImGui::Spacing();
+  ImGui::Spacing();
+  ImGui::Spacing();
+  ImGui::Indent(20.);
+
+  // Build GUI to show the quantities
+  ImGui::Columns(2);
+  ImGui::SetColumnWidth(0, ImGui::GetWindowWidth() / 3);
+  for (auto& x : quantities) {
+    x.second->buildCellInfoGUI(result.brickIndex, localCell);
+  }
+
+  ImGui::Indent(-20.);
+}
+
+SparseVolumeGrid* registerSparseVolumeGrid(std::string name, glm::uvec3 gridNodeDim, glm::vec3 boundMin,
+                                           glm::vec3 boundMax, uint32_t brickSize,
+                                           const std::vector<glm::uvec3>& occupiedBricks) {
+  SparseVolumeGrid* s = new SparseVolumeGrid(name, gridNodeDim, boundMin, boundMax, brickSize, occupiedBricks);
+  bool success = registerStructure(s);
+  if (!success) {
+    safeDelete(s);
+  }
+  return s;
+}
+
+// Default implementations
+void SparseVolumeGridQuantity::buildNodeInfoGUI(size_t iBrick, glm::uvec3 localNode) {}
+void SparseVolumeGridQuantity::buildCellInfoGUI(size_t iBrick, glm::uvec3 localCell) {}
+
+} // namespace polyscope
@@ -0,0 +1,275 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#include "polyscope/sparse_volume_grid_scalar_quantity.h"
+
+#include "polyscope/parallel.h"
+
+#include <cmath>
+#include <limits>
+
+namespace polyscope {
+
+// ========================================================
+// ==========            Node Scalar             ==========
+// ========================================================
+
+SparseVolumeGridNodeScalarQuantity::SparseVolumeGridNodeScalarQuantity(std::string name, SparseVolumeGrid& grid_,
+                                                                       const SparseVolumeGridBrickPool& pool_,
+                                                                       const std::vector<float>& brickValues_,
+                                                                       DataType dataType_)
+    : SparseVolumeGridQuantity(name, grid_, true),
+      ScalarQuantity(*this, grid_.distinctNodeValues(brickValues_), dataType_), GridIsosurfaceQuantity(*this),
+      pool(pool_) {
+
+  // the range and histogram came from the distinct values, the values are stored in the layout of the pool
+  values.data = parent.gatherToBrickPool(pool, brickValues_);
+  values.markHostBufferUpdated();
+  glm::uvec3 texDim = pool.textureDim();
+  values.setTextureSize(texDim.x, texDim.y, texDim.z);
+}
+
+void SparseVolumeGridNodeScalarQuantity::updateBrickValues(const std::vector<float>& brickValues) {
+  validateSize(brickValues, parent.nNodes(), "sparse grid node scalar quantity " + name);
+  ScalarQuantity<SparseVolumeGridNodeScalarQuantity>::updateData(parent.gatherToBrickPool(pool, brickValues));
+}
+
+void SparseVolumeGridNodeScalarQuantity::buildCustomUI() { buildGridScalarUI(); }
+
+std::string SparseVolumeGridNodeScalarQuantity::niceName() { return name + " (node scalar)"; }
+
+bool SparseVolumeGridNodeScalarQuantity::isDrawingGridcubes() { return isEnabled() && getGridcubeVizEnabled(); }
+
+void SparseVolumeGridNodeScalarQuantity::refresh() {
+  gridcubeProgram.reset();
+  isosurfaceProgram.reset();
+}
+
+void SparseVolumeGridNodeScalarQuantity::draw() {
+  if (!isEnabled() || parent.nBricks() == 0) return;
+
+  // Draw the point viz
+  if (gridcubeVizEnabled.get()) {
+    if (gridcubeProgram == nullptr) {
+      createGridcubeProgram();
+    }
+
+    // Set program uniforms
+    parent.setStructureUniforms(*gridcubeProgram);
+    parent.setGridCubeUniforms(*gridcubeProgram);
+    setScalarUniforms(*gridcubeProgram);
+    gridcubeProgram->setUniform("u_poolSlotDim", glm::vec3(pool.slotDim));
+    gridcubeProgram->setUniform("u_poolSlotSize", static_cast<float>(pool.slotSize));
+    render::engine->setMaterialUniforms(*gridcubeProgram, parent.getMaterial());
+
+    // Draw the actual grid
+    render::engine->setBackfaceCull(true);
+    gridcubeProgram->draw();
+  }
+
+  // Draw the isosurface program
+  drawIsosurface();
+}
+
+void SparseVolumeGridNodeScalarQuantity::createGridcubeProgram() {
+
+  // clang-format off
+  gridcubeProgram = render::engine->requestShader( "SPARSE_GRIDCUBE_PLANE",
+      render::engine->addMaterialRules(parent.getMaterial(),
+        parent.addGridCubeRules(
+          addScalarRules(
+            {"SPARSE_GRIDCUBE_PROPAGATE_NODE_VALUE"}
+          ),
+        true)
+      )
+    );
+  // clang-format on
+
+  parent.setGridCubeBuffers(*gridcubeProgram);
+
+  gridcubeProgram->setTextureFromColormap("t_colormap", cMap.get());
+  render::engine->setMaterial(*gridcubeProgram, parent.getMaterial());
+
+  gridcubeProgram->setTextureFromBuffer("t_value", values.getRenderTextureBuffer().get());
+  values.getRenderTextureBuffer().get()->setFilterMode(FilterMode::Linear);
+}
+
+const IsosurfaceMesh& SparseVolumeGridNodeScalarQuantity::getIsosurfaceMesh() {
+  if (isosurfaceMeshValid && isosurfaceMeshLevel == isosurfaceLevel.get() &&
+      isosurfaceMeshValuesVersion == values.getDataVersion()) {
+    return isosurfaceMesh;
+  }
+
+  const float level = isosurfaceLevel.get();
+  const uint32_t B = parent.getBrickSize();
+  const glm::uvec3 brickNodeDim{B + 1, B + 1, B + 1};
+  const glm::uvec3 gridNodeDim = parent.getGridNodeDim();
+  const std::vector<glm::uvec3>& bricks = parent.getOccupiedBricks();
+
+  // Only the bricks which the level passes through need to be visited
+  const GridBrickRanges& ranges = getBrickRanges();
+  std::vector<size_t> crossedBricks;
+  for (size_t iB = 0; iB < parent.nBricks(); iB++) {
+    if (ranges.brickStraddles(iB, level)) crossedBricks.push_back(iB);
+  }
+
+  // Extract each brick separately, keeping the grid edge of each vertex so the pieces can be welded together
+  values.ensureHostBufferPopulated();
+  std::vector<IsosurfaceMesh> brickMeshes(crossedBricks.size());
+  std::vector<std::vector<uint64_t>> brickEdgeKeys(crossedBricks.size());
+  parallelFor(crossedBricks.size(), [&](size_t iCrossed) {
+    size_t iB = crossedBricks[iCrossed];
+    std::vector<float> brickValues;
+    readBrickValues(iB, brickValues);
+
+    glm::uvec3 nodeStart = bricks[iB] * B;
+    std::vector<uint64_t> localKeys;
+    marchingCubes(brickValues, brickNodeDim, parent.positionOfNodeIndex(nodeStart),
+                  parent.positionOfNodeIndex(nodeStart + B), level, brickMeshes[iCrossed], nullptr, &localKeys);
+
+    // local edge keys to keys in the whole grid
+    std::vector<uint64_t>& keys = brickEdgeKeys[iCrossed];
+    keys.resize(localKeys.size());
+    for (size_t iV = 0; iV < localKeys.size(); iV++) {
+      uint64_t localNode = localKeys[iV] / 3;
+      glm::uvec3 node = nodeStart + glm::uvec3{static_cast<uint32_t>(localNode % (B + 1)),
+                                               static_cast<uint32_t>((localNode / (B + 1)) % (B + 1)),
+                                               static_cast<uint32_t>(localNode / ((B + 1) * (B + 1)))};
+      uint64_t globalNode = (static_cast<uint64_t>(node.z) * gridNodeDim.y + node.y) * gridNodeDim.x + node.x;
+      keys[iV] = 3 * globalNode + localKeys[iV] % 3;
+    }
+  });
+
+  // Weld vertices which lie on the same grid edge, on the faces between bricks
+  weldIsosurfacePieces(brickMeshes, brickEdgeKeys, isosurfaceMesh);
+
+  isosurfaceMeshValid = true;
+  isosurfaceMeshLevel = level;
+  isosurfaceMeshValuesVersion = values.getDataVersion();
+  return isosurfaceMesh;
+}
+
+const GridBrickRanges& SparseVolumeGridNodeScalarQuantity::getBrickRanges() {
+  if (brickRanges.isBuilt() && brickRangesValuesVersion == values.getDataVersion()) return brickRanges;
+
+  values.ensureHostBufferPopulated();
+  brickRanges.buildFromBricks(parent.nBricks(),
+                              [&](size_t iB, std::vector<float>& brickValues) { readBrickValues(iB, brickValues); });
+  brickRangesValuesVersion = values.getDataVersion();
+  return brickRanges;
+}
+
+void SparseVolumeGridNodeScalarQuantity::readBrickValues(size_t iBrick, std::vector<float>& brickValues) {
+  // (the host buffer must already be populated, this is called from several threads)
+  const uint32_t B = parent.getBrickSize();
+  brickValues.resize(parent.nNodesPerBrick());
+  size_t i = 0;
+  for (uint32_t z = 0; z <= B; z++) {
+    for (uint32_t y = 0; y <= B; y++) {
+      const float* row = &values.data[pool.texelIndex(iBrick, glm::uvec3{0, y, z})];
+      for (uint32_t x = 0; x <= B; x++) {
+        brickValues[i++] = row[x];
+      }
+    }
+  }
+}
+
+float SparseVolumeGridNodeScalarQuantity::getNodeValue(size_t iBrick, glm::uvec3 localNode) {
+  return values.getValue(pool.texelIndex(iBrick, localNode));
+}
+
+void SparseVolumeGridNodeScalarQuantity::buildNodeInfoGUI(size_t iBrick, glm::uvec3 localNode) {
+  ImGui::TextUnformatted(name.c_str());
+  ImGui::NextColumn();
+  ImGui::Text("%g", getNodeValue(iBrick, localNode));
+  ImGui::NextColumn();
+}
+
+// ========================================================
+// ==========            Cell Scalar             ==========
+// ========================================================
+
+SparseVolumeGridCellScalarQuantity::SparseVolumeGridCellScalarQuantity(std::string name, SparseVolumeGrid& grid_,
+                                                                       const SparseVolumeGridBrickPool& pool_,
+                                                                       const std::vector<float>& brickValues_,
+                                                                       DataType dataType_)
+    : SparseVolumeGridQuantity(name, grid_, true), ScalarQuantity(*this, brickValues_, dataType_),
+      GridScalarQuantity(*this), pool(pool_) {
+
+  // the range and histogram came from the values as given, the values are stored in the layout of the pool
+  values.data = parent.gatherToBrickPool(pool, brickValues_);
+  values.markHostBufferUpdated();
+  glm::uvec3 texDim = pool.textureDim();
+  values.setTextureSize(texDim.x, texDim.y, texDim.z);
+}
+
+void SparseVolumeGridCellScalarQuantity::updateBrickValues(const std::vector<float>& brickValues) {
+  validateSize(brickValues, parent.nCells(), "sparse grid cell scalar quantity " + name);
+  ScalarQuantity<SparseVolumeGridCellScalarQuantity>::updateData(parent.gatherToBrickPool(pool, brickValues));
+}
+
+void SparseVolumeGridCellScalarQuantity::buildCustomUI() { buildGridScalarUI(); }
+
+std::string SparseVolumeGridCellScalarQuantity::niceName() { return name + " (cell scalar)"; }
+
+bool SparseVolumeGridCellScalarQuantity::isDrawingGridcubes() { return isEnabled() && getGridcubeVizEnabled(); }
+
+void SparseVolumeGridCellScalarQuantity::refresh() { gridcubeProgram.reset(); }
+
+void SparseVolumeGridCellScalarQuantity::draw() {
+  if (!isEnabled() || parent.nBricks() == 0) return;
+
+  // Draw the point viz
+  if (gridcubeVizEnabled.get()) {
+    if (gridcubeProgram == nullptr) {
+      createGridcubeProgram();
+    }
+
+    // Set program uniforms
+    parent.setStructureUniforms(*gridcubeProgram);
+    parent.setGridCubeUniforms(*gridcubeProgram);
+    setScalarUniforms(*gridcubeProgram);
+    gridcubeProgram->setUniform("u_poolSlotDim", glm::vec3(pool.slotDim));
+    gridcubeProgram->setUniform("u_poolSlotSize", static_cast<float>(pool.slotSize));
+    render::engine->setMaterialUniforms(*gridcubeProgram, parent.getMaterial());
+
+    // Draw the actual grid
+    render::engine->setBackfaceCull(true);
+    gridcubeProgram->draw();
+  }
+}
+
+void SparseVolumeGridCellScalarQuantity::createGridcubeProgram() {
+
+  // clang-format off
+  gridcubeProgram = render::engine->requestShader("SPARSE_GRIDCUBE_PLANE",
+      render::engine->addMaterialRules(parent.getMaterial(),
+        parent.addGridCubeRules(
+          addScalarRules(
+            {"SPARSE_GRIDCUBE_PROPAGATE_CELL_VALUE"}
+          ),
+        true)
+      )
+  );
+  // clang-format on
+
+  parent.setGridCubeBuffers(*gridcubeProgram);
+
+  gridcubeProgram->setTextureFromColormap("t_colormap", cMap.get());
+  render::engine->setMaterial(*gridcubeProgram, parent.getMaterial());
+
+  // cells are fetched exactly, so the pool is never filtered across bricks
+  gridcubeProgram->setTextureFromBuffer("t_value", values.getRenderTextureBuffer().get());
+}
+
+float SparseVolumeGridCellScalarQuantity::getCellValue(size_t iBrick, glm::uvec3 localCell) {
+  return values.getValue(pool.texelIndex(iBrick, localCell));
+}
+
+void SparseVolumeGridCellScalarQuantity::buildCellInfoGUI(size_t iBrick, glm::uvec3 localCell) {
+  ImGui::TextUnformatted(name.c_str());
+  ImGui::NextColumn();
+  ImGui::Text("%g", getCellValue(iBrick, localCell));
+  ImGui::NextColumn();
+}
+
+} // namespace polyscope
@@ -0,0 +1,481 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#include "polyscope/spatial_index.h"
+
+#include "polyscope/messages.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numeric>
+
+namespace polyscope {
+
+namespace {
+
+const uint32_t NO_PARENT = std::numeric_limits<uint32_t>::max();
+const uint32_t maxTrianglesPerLeaf = 4;
+const uint32_t maxTrianglesPerForcedLeaf = 16; // leaves may be this big, if splitting them does not help
+const uint32_t maxPointsPerLeaf = 8;
+const size_t nSAHBins = 16;
+
+float surfaceArea(glm::vec3 boundMin, glm::vec3 boundMax) {
+  glm::vec3 d = glm::max(boundMax - boundMin, glm::vec3(0.f));
+  return 2.f * (d.x * d.y + d.y * d.z + d.z * d.x);
+}
+
+// Returns the ray parameter where the ray enters the node's box (padded by pad on all sides), or infinity if it misses
+// the box before tMax
+float intersectNodeBox(const SpatialIndexNode& node, glm::vec3 rayStart, glm::vec3 invDir, float tMax, float pad) {
+  glm::vec3 t0 = (node.boundMin - pad - rayStart) * invDir;
+  glm::vec3 t1 = (node.boundMax + pad - rayStart) * invDir;
+  glm::vec3 tNear = glm::min(t0, t1);
+  glm::vec3 tFar = glm::max(t0, t1);
+  float tEnter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.f));
+  float tExit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, tMax));
+  return tEnter <= tExit ? tEnter : std::numeric_limits<float>::infinity();
+}
+
+// Visit the leaves a ray passes through, nearest first, skipping any which start beyond the current best hit.
+// padOf(iNode) is how far the items under a node may reach outside its box. testLeaf(node, tBest) tests the leaf's
+// items, and lowers tBest if it finds a nearer hit.
+template <typename PadFunc, typename LeafFunc>
+void traverseNodes(const std::vector<SpatialIndexNode>& nodes, glm::vec3 rayStart, glm::vec3 rayDir, PadFunc&& padOf,
+                   float& tBest, LeafFunc&& testLeaf) {
+  if (nodes.empty()) return;
+
+  // (avoid 0 * inf in the slab test for axis-aligned rays)
+  glm::vec3 invDir;
+  for (int i = 0; i < 3; i++) {
+    invDir[i] = 1.f / (rayDir[i] == 0.f ? 1e-30f : rayDir[i]);
+  }
+
+  std::vector<std::pair<uint32_t, float>> stack;
+  stack.reserve(64);
+  float tRoot = intersectNodeBox(nodes[0], rayStart, invDir, tBest, padOf(0));
+  if (tRoot < tBest) stack.emplace_back(0, tRoot);
+
+  while (!stack.empty()) {
+    uint32_t iNode = stack.back().first;
+    float tEnter = stack.back().second;
+    stack.pop_back();
+    if (tEnter >= tBest) continue;
+
+    const SpatialIndexNode& node = nodes[iNode];
+    if (node.count > 0) {
+      testLeaf(node, tBest);
+      continue;
+    }
+
+    // Push the farther child first, so the nearer one is visited next
+    uint32_t iA = iNode + 1;
+    uint32_t iB = node.start;
+    float tA = intersectNodeBox(nodes[iA], rayStart, invDir, tBest, padOf(iA));
+    float tB = intersectNodeBox(nodes[iB], rayStart, invDir, tBest, padOf(iB));
+    if (tA > tB) {
+      std::swap(iA, iB);
+      std::swap(tA, tB);
+    }
+    if (tB < tBest) stack.emplace_back(iB, tB);
+    if (tA < tBest) stack.emplace_back(iA, tA);
+  }
+}
+
+} // namespace
+
+// ========================================================
+// ==========            Triangle BVH            ==========
+// ========================================================
+
+void TriangleBVH::build(const std::vector<glm::vec3>& vertexPositions,
+                        const std::vector<uint32_t>& newTriangleVertexInds) {
+
+  if (newTriangleVertexInds.size() % 3 != 0) {
+    exception("TriangleBVH: triangle vertex indices must come in groups of 3");
+  }
+  for (uint32_t iV : newTriangleVertexInds) {
+    if (iV >= vertexPositions.size()) {
+      exception("TriangleBVH: triangle vertex index out of bounds");
+    }
+  }
+
+  triangleVertexInds = newTriangleVertexInds;
+  uint32_t nTri = static_cast<uint32_t>(triangleVertexInds.size() / 3);
+  triangleOrder.resize(nTri);
+  std::iota(triangleOrder.begin(), triangleOrder.end(), 0);
+  nodes.clear();
+  if (nTri == 0) {
+    triangleCorners.clear();
+    return;
+  }
+
+  // Per-triangle bounds and centroids, used to choose splits
+  std::vector<glm::vec3> triMin(nTri), triMax(nTri), centroids(nTri);
+  for (uint32_t iT = 0; iT < nTri; iT++) {
+    glm::vec3 pA = vertexPositions[triangleVertexInds[3 * iT + 0]];
+    glm::vec3 pB = vertexPositions[triangleVertexInds[3 * iT + 1]];
+    glm::vec3 pC = vertexPositions[triangleVertexInds[3 * iT + 2]];
+    triMin[iT] = glm::min(pA, glm::min(pB, pC));
+    triMax[iT] = glm::max(pA, glm::max(pB, pC));
+    centroids[iT] = (pA + pB + pC) / 3.f;
+  }
+
+  struct BuildTask {
+    uint32_t start, end;
+    uint32_t parent; // set for the second child of a node, which needs to record where it lands
+  };
+  std::vector<BuildTask> tasks = {{0, nTri, NO_PARENT}};
+
+  while (!tasks.empty()) {
+    BuildTask task = tasks.back();
+    tasks.pop_back();
+
+    uint32_t iNode = static_cast<uint32_t>(nodes.size());
+    nodes.push_back(SpatialIndexNode{glm::vec3(0.f), glm::vec3(0.f), task.start, task.end - task.start});
+    if (task.parent != NO_PARENT) {
+      nodes[task.parent].start = iNode;
+    }
+
+    uint32_t count = task.end - task.start;
+    if (count <= maxTrianglesPerLeaf) continue;
+
+    // Bounds of the triangles and of their centroids
+    glm::vec3 boundMin(std::numeric_limits<float>::infinity());
+    glm::vec3 boundMax(-std::numeric_limits<float>::infinity());
+    glm::vec3 centroidMin = boundMin;
+    glm::vec3 centroidMax = boundMax;
+    for (uint32_t i = task.start; i < task.end; i++) {
+      uint32_t iT = triangleOrder[i];
+      boundMin = glm::min(boundMin, triMin[iT]);
+      boundMax = glm::max(boundMax, triMax[iT]);
+      centroidMin = glm::min(centroidMin, centroids[iT]);
+      centroidMax = glm::max(centroidMax, centroids[iT]);
+    }
+
+    // Split along the axis where the centroids are most spread out
+    glm::vec3 centroidExtent = centroidMax - centroidMin;
+    int axis = 0;
+    if (centroidExtent[1] > centroidExtent[axis]) axis = 1;
+    if (centroidExtent[2] > centroidExtent[axis]) axis = 2;
+    if (!(centroidExtent[axis] > 0.f)) continue; // all centroids coincide, nothing to split
+
+    // Bin the centroids, and evaluate the surface area heuristic for a split after each bin
+    float binScale = nSAHBins / centroidExtent[axis];
+    auto binOf = [&](uint32_t iT) {
+      size_t b = static_cast<size_t>((centroids[iT][axis] - centroidMin[axis]) * binScale);
+      return std::min(b, nSAHBins - 1);
+    };
+    std::array<uint32_t, nSAHBins> binCounts{};
+    std::array<glm::vec3, nSAHBins> binMin, binMax;
+    binMin.fill(glm::vec3(std::numeric_limits<float>::infinity()));
+    binMax.fill(glm::vec3(-std::numeric_limits<float>::infinity()));
+    for (uint32_t i = task.start; i < task.end; i++) {
+      uint32_t iT = triangleOrder[i];
+      size_t b = binOf(iT);
+      binCounts[b]++;
+      binMin[b] = glm::min(binMin[b], triMin[iT]);
+      binMax[b] = glm::max(binMax[b], triMax[iT]);
+    }
+
+    std::array<float, nSAHBins> costBelow{};
+    {
+      glm::vec3 accMin(std::numeric_limits<float>::infinity());
+      glm::vec3 accMax(-std::numeric_limits<float>::infinity());
+      uint32_t accCount = 0;
+      for (size_t b = 0; b + 1 < nSAHBins; b++) {
+        accMin = glm::min(accMin, binMin[b]);
+        accMax = glm::max(accMax, binMax[b]);
+        accCount += binCounts[b];
+        costBelow[b] = accCount * surfaceArea(accMin, accMax);
+      }
+    }
+    float bestCost = std::numeric_limits<float>::infinity();
+    size_t bestBin = 0;
+    {
+      glm::vec3 accMin(std::numeric_limits<float>::infinity());
+      glm::vec3 accMax(-std::numeric_limits<float>::infinity());
+      uint32_t accCount = 0;
+      for (size_t b = nSAHBins - 1; b > 0; b--) {
+        accMin = glm::min(accMin, binMin[b]);
+        accMax = glm::max(accMax, binMax[b]);
+        accCount += binCounts[b];
+        if (accCount == 0 || accCount == count) continue;
+        float cost = costBelow[b - 1] + accCount * surfaceArea(accMin, accMax);
+        if (cost < bestCost) {
+          bestCost = cost;
+          bestBin = b - 1;
+        }
+      }
+    }
+
+    // Compare against intersecting every triangle in a leaf, with a unit cost for traversing a node
+    float nodeArea = surfaceArea(boundMin, boundMax);
+    float splitCost = 1.f + (nodeArea > 0.f ? bestCost / nodeArea : 0.f);
+    if (splitCost >= count && count <= maxTrianglesPerForcedLeaf) continue;
+
+    uint32_t* first = &triangleOrder[task.start];
+    uint32_t* last = first + count;
+    uint32_t mid = task.start;
+    if (bestCost < std::numeric_limits<float>::infinity()) {
+      mid = static_cast<uint32_t>(std::partition(first, last, [&](uint32_t iT) { return binOf(iT) <= bestBin; }) -
+                                  &triangleOrder[0]);
+    }
+    if (mid == task.start || mid == task.end) {
+      // Binning did not separate anything, fall back on a median split
+      mid = task.start + count / 2;
+      std::nth_element(first, &triangleOrder[mid], last,
+                       [&](uint32_t iA, uint32_t iB) { return centroids[iA][axis] < centroids[iB][axis]; });
+    }
+
+    // Make this an interior node. The first child is processed next, so it lands right after this one.
+    nodes[iNode].count = 0;
+    tasks.push_back(BuildTask{mid, task.end, iNode});
+    tasks.push_back(BuildTask{task.start, mid, NO_PARENT});
+  }
+
+  gatherCorners(vertexPositions);
+  refitBounds();
+}
+
+void TriangleBVH::refit(const std::vector<glm::vec3>& vertexPositions) {
+  if (!isBuilt()) return;
+  for (uint32_t iV : triangleVertexInds) {
+    if (iV >= vertexPositions.size()) {
+      exception("TriangleBVH: triangle vertex index out of bounds");
+    }
+  }
+  gatherCorners(vertexPositions);
+  refitBounds();
+}
+
+void TriangleBVH::gatherCorners(const std::vector<glm::vec3>& vertexPositions) {
+  triangleCorners.resize(3 * triangleOrder.size());
+  for (size_t i = 0; i < triangleOrder.size(); i++) {
+    uint32_t iT = triangleOrder[i];
+    for (size_t j = 0; j < 3; j++) {
+      triangleCorners[3 * i + j] = vertexPositions[triangleVertexInds[3 * iT + j]];
+    }
+  }
+}
+
+void TriangleBVH::refitBounds() {
+  // Children always come after their parent, so a reverse sweep sees children first
+  for (size_t iNode = nodes.size(); iNode-- > 0;) {
+    SpatialIndexNode& node = nodes[iNode];
+    if (node.count > 0) {
+      node.boundMin = glm::vec3(std::numeric_limits<float>::infinity());
+      node.boundMax = glm::vec3(-std::numeric_limits<float>::infinity());
+      for (size_t i = 3 * node.start; i < 3 * (node.start + node.count); i++) {
+        node.boundMin = glm::min(node.boundMin, triangleCorners[i]);
+        node.boundMax = glm::max(node.boundMax, triangleCorners[i]);
+      }
+    } else {
+      const SpatialIndexNode& childA = nodes[iNode + 1];
+      const SpatialIndexNode& childB = nodes[node.start];
+      node.boundMin = glm::min(childA.boundMin, childB.boundMin);
+      node.boundMax = glm::max(childA.boundMax, childB.boundMax);
+    }
+  }
+}
+
+RayHit TriangleBVH::intersect(glm::vec3 rayStart, glm::vec3 rayDir, float tMax, bool cullBackfaces) const {
+  RayHit result;
+  float tBest = tMax;
+
+  auto noPad = [](uint32_t) { return 0.f; };
+  traverseNodes(nodes, rayStart, rayDir, noPad, tBest, [&](const SpatialIndexNode& leaf, float& tBestLeaf) {
+    for (uint32_t i = leaf.start; i < leaf.start + leaf.count; i++) {
+
+      // Moller-Trumbore
+      glm::vec3 p0 = triangleCorners[3 * i + 0];
+      glm::vec3 e1 = triangleCorners[3 * i + 1] - p0;
+      glm::vec3 e2 = triangleCorners[3 * i + 2] - p0;
+      glm::vec3 pVec = glm::cross(rayDir, e2);
+      float det = glm::dot(e1, pVec); // positive when the ray hits the front side
+      if (cullBackfaces ? !(det > 0.f) : !(std::abs(det) > 0.f)) continue;
+      float invDet = 1.f / det;
+
+      glm::vec3 sVec = rayStart - p0;
+      float u = glm::dot(sVec, pVec) * invDet;
+      if (u < 0.f || u > 1.f) continue;
+      glm::vec3 qVec = glm::cross(sVec, e1);
+      float v = glm::dot(rayDir, qVec) * invDet;
+      if (v < 0.f || u + v > 1.f) continue;
+      float t = glm::dot(e2, qVec) * invDet;
+      if (t < 0.f || t >= tBestLeaf) continue;
+
+      tBestLeaf = t;
+      result.hit = true;
+      result.t = t;
+      result.index = triangleOrder[i];
+      result.baryCoords = glm::vec3{1.f - u - v, u, v};
+    }
+  });
+
+  return result;
+}
+
+// ========================================================
+// ==========            Point k-d tree          ==========
+// ========================================================
+
+void PointKDTree::build(const glm::vec3* points, size_t nPoints) {
+
+  uint32_t nPts = static_cast<uint32_t>(nPoints);
+  pointOrder.resize(nPts);
+  std::iota(pointOrder.begin(), pointOrder.end(), 0);
+  nodes.clear();
+  clearRadii();
+  if (nPts == 0) {
+    orderedPoints.clear();
+    return;
+  }
+
+  struct BuildTask {
+    uint32_t start, end;
+    uint32_t parent; // set for the second child of a node, which needs to record where it lands
+  };
+  std::vector<BuildTask> tasks = {{0, nPts, NO_PARENT}};
+
+  while (!tasks.empty()) {
+    BuildTask task = tasks.back();
+    tasks.pop_back();
+
+    uint32_t iNode = static_cast<uint32_t>(nodes.size());
+    nodes.push_back(SpatialIndexNode{glm::vec3(0.f), glm::vec3(0.f), task.start, task.end - task.start});
+    if (task.parent != NO_PARENT) {
+      nodes[task.parent].start = iNode;
+    }
+
+    uint32_t count = task.end - task.start;
+    if (count <= maxPointsPerLeaf) continue;
+
+    // Split at the median along the widest axis
+    glm::vec3 boundMin(std::numeric_limits<float>::infinity());
+    glm::vec3 boundMax(-std::numeric_limits<float>::infinity());
+    for (uint32_t i = task.start; i < task.end; i++) {
+      boundMin = glm::min(boundMin, points[pointOrder[i]]);
+      boundMax = glm::max(boundMax, points[pointOrder[i]]);
+    }
+    glm::vec3 extent = boundMax - boundMin;
+    int axis = 0;
+    if (extent[1] > extent[axis]) axis = 1;
+    if (extent[2] > extent[axis]) axis = 2;
+    if (!(extent[axis] > 0.f)) continue; // all points coincide
+
+    uint32_t mid = task.start + count / 2;
+    std::nth_element(&pointOrder[task.start], &pointOrder[mid], &pointOrder[0] + task.end,
+                     [&](uint32_t iA, uint32_t iB) { return points[iA][axis] < points[iB][axis]; });
+
+    // Make this an interior node. The first child is processed next, so it lands right after this one.
+    nodes[iNode].count = 0;
+    tasks.push_back(BuildTask{mid, task.end, iNode});
+    tasks.push_back(BuildTask{task.start, mid, NO_PARENT});
+  }
+
+  orderedPoints.resize(nPts);
+  for (uint32_t i = 0; i < nPts; i++) {
+    orderedPoints[i] = points[pointOrder[i]];
+  }
+  refitBounds();
+}
+
+void PointKDTree::refit(const glm::vec3* points, size_t nPoints) {
+  if (nPoints != pointOrder.size()) {
+    exception("PointKDTree: number of points changed, rebuild instead of refitting");
+  }
+  for (size_t i = 0; i < pointOrder.size(); i++) {
+    orderedPoints[i] = points[pointOrder[i]];
+  }
+  refitBounds();
+}
+
+void PointKDTree::refitBounds() {
+  // Children always come after their parent, so a reverse sweep sees children first
+  for (size_t iNode = nodes.size(); iNode-- > 0;) {
+    SpatialIndexNode& node = nodes[iNode];
+    if (node.count > 0) {
+      node.boundMin = glm::vec3(std::numeric_limits<float>::infinity());
+      node.boundMax = glm::vec3(-std::numeric_limits<float>::infinity());
+      for (size_t i = node.start; i < node.start + node.count; i++) {
+        node.boundMin = glm::min(node.boundMin, orderedPoints[i]);
+        node.boundMax = glm::max(node.boundMax, orderedPoints[i]);
+      }
+    } else {
+      const SpatialIndexNode& childA = nodes[iNode + 1];
+      const SpatialIndexNode& childB = nodes[node.start];
+      node.boundMin = glm::min(childA.boundMin, childB.boundMin);
+      node.boundMax = glm::max(childA.boundMax, childB.boundMax);
+    }
+  }
+}
+
+void PointKDTree::setRadii(const float* radii, size_t nRadii) {
+  if (nRadii != pointOrder.size()) {
+    exception("PointKDTree: wrong number of radii");
+  }
+
+  orderedRadii.resize(pointOrder.size());
+  for (size_t i = 0; i < pointOrder.size(); i++) {
+    orderedRadii[i] = radii[pointOrder[i]];
+  }
+
+  // Children always come after their parent, so a reverse sweep sees children first
+  nodeMaxRadius.resize(nodes.size());
+  for (size_t iNode = nodes.size(); iNode-- > 0;) {
+    const SpatialIndexNode& node = nodes[iNode];
+    if (node.count > 0) {
+      float maxRadius = 0.f;
+      for (size_t i = node.start; i < node.start + node.count; i++) {
+        maxRadius = std::max(maxRadius, orderedRadii[i]);
+      }
+      nodeMaxRadius[iNode] = maxRadius;
+    } else {
+      nodeMaxRadius[iNode] = std::max(nodeMaxRadius[iNode + 1], nodeMaxRadius[node.start]);
+    }
+  }
+}
+
+void PointKDTree::clearRadii() {
+  orderedRadii.clear();
+  nodeMaxRadius.clear();
+}
+
+RayHit PointKDTree::intersectSpheres(glm::vec3 rayStart, glm::vec3 rayDir, float radiusScale, float tMax) const {
+
+  // Boxes are padded by the largest radius under them, so they contain every sphere
+  bool perPointRadii = hasRadii();
+  auto padOf = [&](uint32_t iNode) { return perPointRadii ? radiusScale * nodeMaxRadius[iNode] : radiusScale; };
+
+  RayHit result;
+  float tBest = tMax;
+  float dirNorm2 = glm::dot(rayDir, rayDir);
+  if (!(dirNorm2 > 0.f)) return result;
+
+  traverseNodes(nodes, rayStart, rayDir, padOf, tBest, [&](const SpatialIndexNode& leaf, float& tBestLeaf) {
+    for (uint32_t i = leaf.start; i < leaf.start + leaf.count; i++) {
+      uint32_t iP = pointOrder[i];
+      float r = perPointRadii ? radiusScale * orderedRadii[i] : radiusScale;
+
+      // Solve |rayStart + t * rayDir - p|^2 = r^2 for the first t >= 0
+      glm::vec3 offset = rayStart - orderedPoints[i];
+      float b = glm::dot(offset, rayDir);
+      float c = glm::dot(offset, offset) - r * r;
+      float disc = b * b - dirNorm2 * c;
+      if (disc < 0.f) continue;
+      float sqrtDisc = std::sqrt(disc);
+      float t = (-b - sqrtDisc) / dirNorm2;
+      if (t < 0.f) t = (-b + sqrtDisc) / dirNorm2; // started inside the sphere
+      if (t < 0.f || t >= tBestLeaf) continue;
+
+      tBestLeaf = t;
+      result.hit = true;
+      result.t = t;
+      result.index = iP;
+    }
+  });
+
+  return result;
+}
+
+} // namespace polyscope
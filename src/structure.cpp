@@ -23,6 +23,8 @@ Structure::Structure(std::string name_, std::string subtypeName)
 
 Structure::~Structure() {};
 
+bool Structure::rayPick(glm::vec3 rayStart, glm::vec3 rayDir, float& tHit, uint64_t& localIndex) { return false; }
+
 Structure* Structure::setEnabled(bool newEnabled) {
   if (newEnabled == isEnabled()) return this;
   enabled = newEnabled;
@@ -287,6 +289,8 @@ bool Structure::wantsCullPosition() { return render::engine->slicePlanesEnabled(
 
 std::string Structure::uniquePrefix() { return typeName() + "#" + name + "#"; }
 
+std::vector<Quantity*> Structure::getAllQuantities() { return {}; }
+
 void Structure::remove() { removeStructure(typeName(), name); }
 
 
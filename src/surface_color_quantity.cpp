@@ -58,7 +58,7 @@ SurfaceVertexColorQuantity::SurfaceVertexColorQuantity(std::string name, Surface
 void SurfaceVertexColorQuantity::createProgram() {
   // Create the program to draw this quantity
   // clang-format off
-  program = render::engine->requestShader("MESH", 
+  program = render::engine->requestShader(parent.canDrawIndexed() ? "INDEXED_MESH" : "MESH",
       render::engine->addMaterialRules(parent.getMaterial(),
         addColorRules(
           parent.addSurfaceMeshRules(
@@ -70,7 +70,11 @@ void SurfaceVertexColorQuantity::createProgram() {
   // clang-format on
 
   parent.setMeshGeometryAttributes(*program);
-  program->setAttribute("a_color", colors.getIndexedRenderAttributeBuffer(parent.triangleVertexInds));
+  if (program->usesIndex()) {
+    program->setAttribute("a_color", colors.getRenderAttributeBuffer());
+  } else {
+    program->setAttribute("a_color", colors.getIndexedRenderAttributeBuffer(parent.triangleVertexInds));
+  }
   render::engine->setMaterial(*program, parent.getMaterial());
 }
 
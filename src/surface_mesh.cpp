@@ -2,8 +2,8 @@
 
 #include "polyscope/surface_mesh.h"
 
-#include "polyscope/combining_hash_functions.h"
 #include "polyscope/elementary_geometry.h"
+#include "polyscope/parallel.h"
 #include "polyscope/pick.h"
 #include "polyscope/polyscope.h"
 #include "polyscope/render/engine.h"
@@ -12,7 +12,8 @@
 #include "polyscope/types.h"
 #include "polyscope/utilities.h"
 
-#include <unordered_map>
+#include <algorithm>
+#include <functional>
 #include <utility>
 
 namespace polyscope {
@@ -65,7 +66,11 @@ shadeStyle(             uniquePrefix() + "shadeStyle",      MeshShadeStyle::Flat
 selectionMode(          uniquePrefix() + "selectionMode",   MeshSelectionMode::Auto)
 
 // clang-format on
-{}
+{
+  // normals, areas, and picking all read the positions on the host, so keep them there even when they are also drawn
+  // from a render buffer
+  vertexPositions.hostCopyIsPinned = true;
+}
 
 SurfaceMesh::SurfaceMesh(std::string name_, const std::vector<glm::vec3>& vertexPositions_,
                          const std::vector<uint32_t>& faceIndsEntries_, const std::vector<uint32_t>& faceIndsStart_)
@@ -188,61 +193,33 @@ void SurfaceMesh::computeConnectivityData() {
 
 void SurfaceMesh::computeTriangleAllEdgeInds() {
 
-  // WARNING: logic duplicated in countEdges()
-
   if (edgePerm.empty())
     exception("SurfaceMesh " + name +
               " performed an operation which requires edge indices to be specified, but none have been set. "
               "Call setEdgePermutation().");
 
-  triangleVertexInds.ensureHostBufferPopulated();
-  triangleAllEdgeInds.data.resize(3 * 3 * nFacesTriangulation());
-  halfedgeEdgeCorrespondence.resize(nHalfedges());
-
-  // used to loop over edges
-  std::unordered_map<std::pair<size_t, size_t>, size_t, polyscope::hash_combine::hash<std::pair<size_t, size_t>>>
-      seenEdgeInds;
+  // TODO why can't we use edges on non triangular meshes? Implement it.
+  if (nFacesTriangulation() != nFaces()) {
+    exception("SurfaceMesh " + name +
+              " attempted to access triangle-edge indices, but it has non-triangular faces. These indices are "
+              "only well-defined on a pure-triangular mesh.");
+  }
 
-  auto createEdgeKey = [&](size_t a, size_t b) -> std::pair<size_t, size_t> {
-    return std::make_pair(std::min(a, b), std::max(a, b));
-  };
+  ensureHaveHalfedgeConnectivity();
 
-  size_t psEdgeInd = 0; // polyscope's edge index, iterated according to Polyscope's canonical ordering
-  for (size_t iF = 0; iF < nFaces(); iF++) {
-    size_t start = faceIndsStart[iF];
-    size_t D = faceIndsStart[iF + 1] - start;
-
-    // TODO why can't we use edges on non triangular meshes? Implement it.
+  if (nEdgesCount > edgePerm.size()) {
+    exception("SurfaceMesh " + name + " edge indexing out of bounds. Did you pass an edge ordering that is too short?");
+  }
 
-    if (D != 3) {
-      exception("SurfaceMesh " + name +
-                " attempted to access triangle-edge indices, but it has non-triangular faces. These indices are "
-                "only well-defined on a pure-triangular mesh.");
-    }
+  triangleAllEdgeInds.data.resize(3 * 3 * nFacesTriangulation());
+  halfedgeEdgeCorrespondence.resize(nHalfedges());
 
+  for (size_t iF = 0; iF < nFaces(); iF++) {
     glm::uvec3 thisTriInds{0, 0, 0};
     for (size_t j = 0; j < 3; j++) {
-      size_t vA = triangleVertexInds.data[3 * iF + j];
-      size_t vB = triangleVertexInds.data[3 * iF + ((j + 1) % 3)];
-
-      std::pair<size_t, size_t> key = createEdgeKey(vA, vB);
-
-      size_t thisEdgeInd;
-      if (seenEdgeInds.find(key) == seenEdgeInds.end()) {
-        // process a new edge in the canonical ordering
-        if (psEdgeInd >= edgePerm.size()) {
-          exception("SurfaceMesh " + name +
-                    " edge indexing out of bounds. Did you pass an edge ordering that is too short?");
-        }
-        thisEdgeInd = edgePerm[psEdgeInd];
-        seenEdgeInds[key] = thisEdgeInd;
-        psEdgeInd++;
-      } else {
-        // we've processed this edge before, retrieve its assigned index
-        thisEdgeInd = seenEdgeInds[key];
-      }
-
-      halfedgeEdgeCorrespondence[start + j] = thisEdgeInd;
+      size_t iHe = 3 * iF + j;
+      size_t thisEdgeInd = edgePerm[halfedgeCanonicalEdge[iHe]];
+      halfedgeEdgeCorrespondence[iHe] = thisEdgeInd;
       thisTriInds[j] = thisEdgeInd;
     }
 
@@ -253,48 +230,85 @@ void SurfaceMesh::computeTriangleAllEdgeInds() {
     }
   }
 
-  nEdgesCount = psEdgeInd;
   triangleAllEdgeInds.markHostBufferUpdated();
 }
 
 void SurfaceMesh::countEdges() {
 
-  // WARNING: logic duplicated in computeTriangleAllEdgeInds()
-
-  // used to loop over edges
-  std::unordered_map<std::pair<size_t, size_t>, size_t, polyscope::hash_combine::hash<std::pair<size_t, size_t>>>
-      seenEdgeInds;
+  if (nFacesTriangulation() != nFaces()) {
+    exception("SurfaceMesh " + name +
+              " attempted to count edges, but mesh has non-triangular faces. Edge functions are only implemented on "
+              "a pure-triangular mesh.");
+  }
 
-  auto createEdgeKey = [&](size_t a, size_t b) -> std::pair<size_t, size_t> {
-    return std::make_pair(std::min(a, b), std::max(a, b));
-  };
+  ensureHaveHalfedgeConnectivity();
+}
 
-  size_t psEdgeInd = 0; // polyscope's edge index, iterated according to Polyscope's canonical ordering
-  for (size_t iF = 0; iF < nFaces(); iF++) {
-    size_t start = faceIndsStart[iF];
-    size_t D = faceIndsStart[iF + 1] - start;
+void SurfaceMesh::ensureHaveHalfedgeConnectivity() {
+  if (halfedgeCanonicalEdge.size() == 3 * nFacesTriangulation() && nEdgesCount != INVALID_IND &&
+      twinHalfedge.size() == halfedgeCanonicalEdge.size()) {
+    return; // already populated
+  }
 
-    if (D != 3) {
-      exception("SurfaceMesh " + name +
-                " attempted to count edges, but mesh has non-triangular faces. Edge functions are only implemented on "
-                "a pure-triangular mesh.");
+  triangleVertexInds.ensureHostBufferPopulated();
+  const std::vector<uint32_t>& triInds = triangleVertexInds.data;
+  const size_t nHe = 3 * nFacesTriangulation();
+
+  // Key each halfedge by its unordered pair of endpoints, packed in to a 64-bit integer
+  const uint64_t nV = nVertices();
+  int vertBits = 0;
+  while (vertBits < 32 && (static_cast<uint64_t>(1) << vertBits) < nV) vertBits++;
+  std::vector<uint64_t> keys(nHe);
+  std::vector<uint32_t> sortedHalfedges(nHe);
+  for (size_t iHe = 0; iHe < nHe; iHe++) {
+    uint64_t vA = triInds[iHe];
+    uint64_t vB = triInds[3 * (iHe / 3) + ((iHe + 1) % 3)];
+    keys[iHe] = (std::min(vA, vB) << vertBits) | std::max(vA, vB);
+    sortedHalfedges[iHe] = static_cast<uint32_t>(iHe);
+  }
+
+  // Sort to bring the halfedges of each edge together. The sort is stable, so each run of equal keys lists its
+  // halfedges in increasing order.
+  radixSortPairs(keys, sortedHalfedges, 2 * vertBits);
+
+  auto forEachRun = [&](const std::function<void(size_t, size_t)>& func) {
+    size_t runStart = 0;
+    while (runStart < nHe) {
+      size_t runEnd = runStart + 1;
+      while (runEnd < nHe && keys[runEnd] == keys[runStart]) runEnd++;
+      func(runStart, runEnd);
+      runStart = runEnd;
     }
+  };
 
-    for (size_t j = 0; j < 3; j++) {
-      size_t vA = triangleVertexInds.data[3 * iF + j];
-      size_t vB = triangleVertexInds.data[3 * iF + ((j + 1) % 3)];
-
-      std::pair<size_t, size_t> key = createEdgeKey(vA, vB);
+  // Each run is one edge. Mark the first halfedge of each, and set twins: every halfedge is paired with the first
+  // other halfedge along its edge.
+  halfedgeCanonicalEdge.assign(nHe, INVALID_IND_32);
+  twinHalfedge.assign(nHe, INVALID_IND);
+  forEachRun([&](size_t runStart, size_t runEnd) {
+    uint32_t firstHe = sortedHalfedges[runStart];
+    halfedgeCanonicalEdge[firstHe] = 0; // marker, numbered below
+    if (runEnd - runStart > 1) twinHalfedge[firstHe] = sortedHalfedges[runStart + 1];
+    for (size_t i = runStart + 1; i < runEnd; i++) {
+      twinHalfedge[sortedHalfedges[i]] = firstHe;
+    }
+  });
 
-      if (seenEdgeInds.find(key) == seenEdgeInds.end()) {
-        size_t thisEdgeInd = psEdgeInd;
-        seenEdgeInds[key] = thisEdgeInd;
-        psEdgeInd++;
-      }
+  // Number the edges in the order their first halfedge appears, which is Polyscope's canonical ordering
+  uint32_t nEdgesFound = 0;
+  for (size_t iHe = 0; iHe < nHe; iHe++) {
+    if (halfedgeCanonicalEdge[iHe] != INVALID_IND_32) {
+      halfedgeCanonicalEdge[iHe] = nEdgesFound++;
     }
   }
+  forEachRun([&](size_t runStart, size_t runEnd) {
+    uint32_t edgeInd = halfedgeCanonicalEdge[sortedHalfedges[runStart]];
+    for (size_t i = runStart + 1; i < runEnd; i++) {
+      halfedgeCanonicalEdge[sortedHalfedges[i]] = edgeInd;
+    }
+  });
 
-  nEdgesCount = psEdgeInd;
+  nEdgesCount = nEdgesFound;
 }
 
 size_t SurfaceMesh::nEdges() {
@@ -442,7 +456,7 @@ void SurfaceMesh::computeFaceNormals() {
 
   faceNormals.data.resize(nFaces());
 
-  for (size_t iF = 0; iF < nFaces(); iF++) {
+  parallelFor(nFaces(), [&](size_t iF) {
     size_t iStart = faceIndsStart[iF];
     size_t D = faceIndsStart[iF + 1] - iStart;
 
@@ -462,7 +476,7 @@ void SurfaceMesh::computeFaceNormals() {
     }
     fN = glm::normalize(fN);
     faceNormals.data[iF] = fN;
-  }
+  });
 
   faceNormals.markHostBufferUpdated();
 }
@@ -473,7 +487,7 @@ void SurfaceMesh::computeFaceCenters() {
 
   faceCenters.data.resize(nFaces());
 
-  for (size_t iF = 0; iF < nFaces(); iF++) {
+  parallelFor(nFaces(), [&](size_t iF) {
     size_t start = faceIndsStart[iF];
     size_t D = faceIndsStart[iF + 1] - start;
     glm::vec3 faceCenter{0., 0., 0.};
@@ -483,7 +497,7 @@ void SurfaceMesh::computeFaceCenters() {
     }
     faceCenter /= D;
     faceCenters.data[iF] = faceCenter;
-  }
+  });
 
   faceCenters.markHostBufferUpdated();
 }
@@ -495,7 +509,7 @@ void SurfaceMesh::computeFaceAreas() {
   faceAreas.data.resize(nFaces());
 
   // Loop over faces to compute face-valued quantities
-  for (size_t iF = 0; iF < nFaces(); iF++) {
+  parallelFor(nFaces(), [&](size_t iF) {
     size_t start = faceIndsStart[iF];
     size_t D = faceIndsStart[iF + 1] - start;
 
@@ -518,37 +532,49 @@ void SurfaceMesh::computeFaceAreas() {
     }
 
     faceAreas.data[iF] = fA;
-  }
+  });
 
   faceAreas.markHostBufferUpdated();
 }
 
+void SurfaceMesh::ensureHaveVertexFaceAdjacency() {
+  if (vertexFaceAdjStart.size() == nVertices() + 1) return; // already populated
+
+  // Count the corners at each vertex, then fill in face order
+  vertexFaceAdjStart.assign(nVertices() + 1, 0);
+  for (uint32_t iV : faceIndsEntries) {
+    vertexFaceAdjStart[iV + 1]++;
+  }
+  for (size_t iV = 0; iV < nVertices(); iV++) {
+    vertexFaceAdjStart[iV + 1] += vertexFaceAdjStart[iV];
+  }
+
+  vertexFaceAdjEntries.resize(faceIndsEntries.size());
+  std::vector<uint32_t> fillPos(vertexFaceAdjStart.begin(), vertexFaceAdjStart.end() - 1);
+  for (size_t iF = 0; iF < nFaces(); iF++) {
+    for (size_t iC = faceIndsStart[iF]; iC < faceIndsStart[iF + 1]; iC++) {
+      vertexFaceAdjEntries[fillPos[faceIndsEntries[iC]]++] = static_cast<uint32_t>(iF);
+    }
+  }
+}
 
 void SurfaceMesh::computeVertexNormals() {
 
   faceNormals.ensureHostBufferPopulated();
   faceAreas.ensureHostBufferPopulated();
+  ensureHaveVertexFaceAdjacency();
 
   vertexNormals.data.resize(nVertices());
 
-  const glm::vec3 zero{0., 0., 0.};
-
-  std::fill(vertexNormals.data.begin(), vertexNormals.data.end(), zero);
-
-  // Accumulate quantities from each face
-  for (size_t iF = 0; iF < nFaces(); iF++) {
-    size_t start = faceIndsStart[iF];
-    size_t D = faceIndsStart[iF + 1] - start;
-    for (size_t j = 0; j < D; j++) {
-      size_t iV = faceIndsEntries[start + j];
-      vertexNormals.data[iV] += faceNormals.data[iF] * static_cast<float>(faceAreas.data[iF]);
+  // Gather quantities from each adjacent face, and normalize
+  parallelFor(nVertices(), [&](size_t iV) {
+    glm::vec3 N{0., 0., 0.};
+    for (size_t i = vertexFaceAdjStart[iV]; i < vertexFaceAdjStart[iV + 1]; i++) {
+      size_t iF = vertexFaceAdjEntries[i];
+      N += faceNormals.data[iF] * static_cast<float>(faceAreas.data[iF]);
     }
-  }
-
-  // Normalize
-  for (size_t iV = 0; iV < nVertices(); iV++) {
-    vertexNormals.data[iV] = glm::normalize(vertexNormals.data[iV]);
-  }
+    vertexNormals.data[iV] = glm::normalize(N);
+  });
 
   vertexNormals.markHostBufferUpdated();
 }
@@ -556,19 +582,20 @@ void SurfaceMesh::computeVertexNormals() {
 void SurfaceMesh::computeVertexAreas() {
 
   faceAreas.ensureHostBufferPopulated();
+  ensureHaveVertexFaceAdjacency();
 
   vertexAreas.data.resize(nVertices());
-  std::fill(vertexAreas.data.begin(), vertexAreas.data.end(), 0.);
 
-  // Accumulate quantities from each face
-  for (size_t iF = 0; iF < nFaces(); iF++) {
-    size_t D = faceIndsStart[iF + 1] - faceIndsStart[iF];
-    size_t start = faceIndsStart[iF];
-    for (size_t j = 0; j < D; j++) {
-      size_t iV = faceIndsEntries[start + j];
-      vertexAreas.data[iV] += faceAreas.data[iF] / D;
+  // Gather quantities from each adjacent face
+  parallelFor(nVertices(), [&](size_t iV) {
+    float A = 0.;
+    for (size_t i = vertexFaceAdjStart[iV]; i < vertexFaceAdjStart[iV + 1]; i++) {
+      size_t iF = vertexFaceAdjEntries[i];
+      size_t D = faceIndsStart[iF + 1] - faceIndsStart[iF];
+      A += faceAreas.data[iF] / D;
     }
-  }
+    vertexAreas.data[iV] = A;
+  });
 
   vertexAreas.markHostBufferUpdated();
 }
@@ -578,15 +605,15 @@ void SurfaceMesh::computeDefaultFaceTangentBasisX() {
   // NOTE: this function is weirdly duplicated into an 'X' and 'Y' paradigm to fit the compute-function-per-buffer
   // paradigm
 
+  if (nFacesTriangulation() != nFaces())
+    exception("Default face tangent spaces only available for pure-triangular meshes");
+
   vertexPositions.ensureHostBufferPopulated();
   faceNormals.ensureHostBufferPopulated();
 
   defaultFaceTangentBasisX.data.resize(nFaces());
 
-  for (size_t iF = 0; iF < nFaces(); iF++) {
-    size_t D = faceIndsStart[iF + 1] - faceIndsStart[iF];
-    if (D != 3) exception("Default face tangent spaces only available for pure-triangular meshes");
-
+  parallelFor(nFaces(), [&](size_t iF) {
     size_t start = faceIndsStart[iF];
 
     glm::vec3 pA = vertexPositions.data[faceIndsEntries[start + 0]];
@@ -596,10 +623,8 @@ void SurfaceMesh::computeDefaultFaceTangentBasisX() {
     glm::vec3 basisX = pB - pA;
     basisX = glm::normalize(basisX - N * glm::dot(N, basisX));
 
-    glm::vec3 basisY = glm::normalize(-glm::cross(basisX, N));
-
     defaultFaceTangentBasisX.data[iF] = basisX;
-  }
+  });
 
   defaultFaceTangentBasisX.markHostBufferUpdated();
 }
@@ -609,15 +634,15 @@ void SurfaceMesh::computeDefaultFaceTangentBasisY() {
   // NOTE: this function is weirdly duplicated into an 'X' and 'Y' paradigm to fit the compute-function-per-buffer
   // paradigm
 
+  if (nFacesTriangulation() != nFaces())
+    exception("Default face tangent spaces only available for pure-triangular meshes");
+
   vertexPositions.ensureHostBufferPopulated();
   faceNormals.ensureHostBufferPopulated();
 
   defaultFaceTangentBasisY.data.resize(nFaces());
 
-  for (size_t iF = 0; iF < nFaces(); iF++) {
-    size_t D = faceIndsStart[iF + 1] - faceIndsStart[iF];
-    if (D != 3) exception("Default face tangent spaces only available for pure-triangular meshes");
-
+  parallelFor(nFaces(), [&](size_t iF) {
     size_t start = faceIndsStart[iF];
 
     glm::vec3 pA = vertexPositions.data[faceIndsEntries[start + 0]];
@@ -630,7 +655,7 @@ void SurfaceMesh::computeDefaultFaceTangentBasisY() {
     glm::vec3 basisY = glm::normalize(-glm::cross(basisX, N));
 
     defaultFaceTangentBasisY.data[iF] = basisY;
-  }
+  });
 
   defaultFaceTangentBasisY.markHostBufferUpdated();
 }
@@ -666,60 +691,7 @@ void SurfaceMesh::checkTriangular() {
 }
 
 void SurfaceMesh::ensureHaveManifoldConnectivity() {
-  if (!twinHalfedge.empty()) return; // already populated
-
-  triangleVertexInds.ensureHostBufferPopulated();
-
-  twinHalfedge.resize(nHalfedges());
-
-  // Maps from edge (sorted) to all halfedges incident on that edge
-  std::unordered_map<std::pair<size_t, size_t>, std::vector<size_t>,
-                     polyscope::hash_combine::hash<std::pair<size_t, size_t>>>
-      edgeInds;
-
-  // Fill out faceForHalfedge and populate edge lookup map
-  for (size_t iF = 0; iF < nFacesTriangulation(); iF++) {
-    for (size_t j = 0; j < 3; j++) {
-      size_t iV = triangleVertexInds.data[3 * iF + j];
-      size_t iVNext = triangleVertexInds.data[3 * iF + ((j + 1) % 3)];
-      size_t iHe = 3 * iF + j;
-
-
-      std::pair<size_t, size_t> edgeKey(std::min(iV, iVNext), std::max(iV, iVNext));
-
-      // Make sure the key is populated
-      auto it = edgeInds.find(edgeKey);
-      if (it == edgeInds.end()) {
-        it = edgeInds.insert(it, {edgeKey, std::vector<size_t>()});
-      }
-
-      // Add this halfedge to the entry
-      it->second.push_back(iHe);
-    }
-  }
-
-  // Second walk through, setting twins
-  for (size_t iF = 0; iF < nFacesTriangulation(); iF++) {
-    for (size_t j = 0; j < 3; j++) {
-      size_t iV = triangleVertexInds.data[3 * iF + j];
-      size_t iVNext = triangleVertexInds.data[3 * iF + ((j + 1) % 3)];
-      size_t iHe = 3 * iF + j;
-
-      std::pair<size_t, size_t> edgeKey(std::min(iV, iVNext), std::max(iV, iVNext));
-      std::vector<size_t>& edgeHalfedges = edgeInds.find(edgeKey)->second;
-
-      // Pick the first halfedge we find which is not this one
-      size_t myTwin = INVALID_IND;
-      for (size_t t : edgeHalfedges) {
-        if (t != iHe) {
-          myTwin = t;
-          break;
-        }
-      }
-
-      twinHalfedge[iHe] = myTwin;
-    }
-  }
+  ensureHaveHalfedgeConnectivity(); // populates twinHalfedge
 }
 
 void SurfaceMesh::draw() {
@@ -813,9 +785,60 @@ void SurfaceMesh::drawPick() {
   render::engine->setBackfaceCull(); // return to default setting
 }
 
+bool SurfaceMesh::rayPick(glm::vec3 rayStart, glm::vec3 rayDir, float& tHit, uint64_t& localIndex) {
+
+  // Build or update the BVH over the triangulated faces
+  vertexPositions.ensureHostBufferPopulated();
+  triangleVertexInds.ensureHostBufferPopulated(); // also read below, and may have been evicted since the build
+  if (!triangleBVH.isBuilt()) {
+    triangleBVH.build(vertexPositions.data, triangleVertexInds.data);
+  } else if (triangleBVHPositionsVersion != vertexPositions.getDataVersion()) {
+    triangleBVH.refit(vertexPositions.data);
+  }
+  triangleBVHPositionsVersion = vertexPositions.getDataVersion();
+
+  // The mesh may not have been drawn for picking yet, which is where these are usually set
+  computePickIndStarts();
+
+  // Intersect in object space (t is unchanged by the transform)
+  glm::mat4 invTransform = glm::inverse(objectTransform.get());
+  glm::vec3 objRayStart = glm::vec3(invTransform * glm::vec4(rayStart, 1.));
+  glm::vec3 objRayDir = glm::vec3(invTransform * glm::vec4(rayDir, 0.));
+  RayHit hit = triangleBVH.intersect(objRayStart, objRayDir, std::numeric_limits<float>::infinity(),
+                                     backFacePolicy.get() == BackFacePolicy::Cull);
+  if (!hit.hit) return false;
+
+  // Choose between the face and its vertices, like the simple pick shader does
+  float vertPickRadius = 0.;
+  switch (selectionMode.get()) {
+  case MeshSelectionMode::Auto:
+    vertPickRadius = 0.2;
+    break;
+  case MeshSelectionMode::VerticesOnly:
+    vertPickRadius = 1.;
+    break;
+  case MeshSelectionMode::FacesOnly:
+    vertPickRadius = 0.;
+    break;
+  }
+  int iNearest = 0;
+  for (int i = 1; i < 3; i++) {
+    if (hit.baryCoords[i] > hit.baryCoords[iNearest]) iNearest = i;
+  }
+
+  tHit = hit.t;
+  if (hit.baryCoords[iNearest] > 1. - vertPickRadius) {
+    localIndex = triangleVertexInds.data[3 * hit.index + iNearest];
+  } else {
+    triangleFaceInds.ensureHostBufferPopulated();
+    localIndex = facePickIndStart + triangleFaceInds.data[3 * hit.index];
+  }
+  return true;
+}
+
 void SurfaceMesh::prepare() {
   // clang-format off
-  program = render::engine->requestShader( "MESH", 
+  program = render::engine->requestShader(canDrawIndexed() ? "INDEXED_MESH" : "MESH",
       render::engine->addMaterialRules(getMaterial(),
         addSurfaceMeshRules({"SHADE_BASECOLOR"})
       )
@@ -842,9 +865,9 @@ void SurfaceMesh::preparePick() {
   }
 
   if (usingSimplePick) {
-    pickProgram =
-        render::engine->requestShader("MESH", addSurfaceMeshRules({"MESH_PROPAGATE_PICK_SIMPLE"}, true, false),
-                                      render::ShaderReplacementDefaults::Pick);
+    pickProgram = render::engine->requestShader(
+        "MESH", addSurfaceMeshRules({"MESH_PROPAGATE_PICK_SIMPLE_FROM_INDS"}, true, false),
+        render::ShaderReplacementDefaults::Pick);
   } else {
     pickProgram = render::engine->requestShader("MESH", addSurfaceMeshRules({"MESH_PROPAGATE_PICK"}, true, false),
                                                 render::ShaderReplacementDefaults::Pick);
@@ -856,16 +879,29 @@ void SurfaceMesh::preparePick() {
 }
 
 void SurfaceMesh::setMeshGeometryAttributes(render::ShaderProgram& p) {
+
+  // Indexed programs draw straight from the per-vertex buffers. Otherwise, every attribute is expanded out to the
+  // corners of the triangulation.
+  bool indexed = p.usesIndex();
+  if (indexed) {
+    p.setIndex(triangleVertexInds.getRenderAttributeBuffer());
+  }
+  auto getVertexAttribute = [&](render::ManagedBuffer<glm::vec3>& buff) {
+    return indexed ? buff.getRenderAttributeBuffer() : buff.getIndexedRenderAttributeBuffer(triangleVertexInds);
+  };
+
   if (p.hasAttribute("a_vertexPositions")) {
-    p.setAttribute("a_vertexPositions", vertexPositions.getIndexedRenderAttributeBuffer(triangleVertexInds));
+    p.setAttribute("a_vertexPositions", getVertexAttribute(vertexPositions));
   }
   if (p.hasAttribute("a_vertexNormals")) {
 
     if (getShadeStyle() == MeshShadeStyle::Smooth) {
-      p.setAttribute("a_vertexNormals", vertexNormals.getIndexedRenderAttributeBuffer(triangleVertexInds));
+      p.setAttribute("a_vertexNormals", getVertexAttribute(vertexNormals));
+    } else if (shadesNormalsFromPosition()) {
+      // these aren't actually used when the normal is computed from positions, but the shader is set up in a lazy way
+      // so it is still needed. Bind the positions, which are already on the device.
+      p.setAttribute("a_vertexNormals", getVertexAttribute(vertexPositions));
     } else {
-      // these aren't actually used in in the automatically-generated case, but the shader is set up in a lazy way so
-      // it is still needed
       p.setAttribute("a_vertexNormals", faceNormals.getIndexedRenderAttributeBuffer(triangleFaceInds));
     }
   }
@@ -873,7 +909,12 @@ void SurfaceMesh::setMeshGeometryAttributes(render::ShaderProgram& p) {
     p.setAttribute("a_normal", faceNormals.getIndexedRenderAttributeBuffer(triangleFaceInds));
   }
   if (p.hasAttribute("a_barycoord")) {
-    p.setAttribute("a_barycoord", baryCoord.getRenderAttributeBuffer());
+    if (indexed) {
+      // only used for the wireframe, which is never drawn indexed; bind something of the right size
+      p.setAttribute("a_barycoord", vertexPositions.getRenderAttributeBuffer());
+    } else {
+      p.setAttribute("a_barycoord", baryCoord.getRenderAttributeBuffer());
+    }
   }
   if (p.hasAttribute("a_edgeIsReal")) {
     p.setAttribute("a_edgeIsReal", edgeIsReal.getRenderAttributeBuffer());
@@ -888,25 +929,34 @@ void SurfaceMesh::setMeshGeometryAttributes(render::ShaderProgram& p) {
   }
 }
 
-void SurfaceMesh::setMeshPickAttributes(render::ShaderProgram& p) {
+bool SurfaceMesh::canDrawIndexed() {
+  if (getEdgeWidth() > 0) return false;
+  if (getShadeStyle() == MeshShadeStyle::Flat && nFacesTriangulation() != nFaces()) return false;
+  if (wantsCullPosition()) return false;
+  if (transparencyQuantityName != "") return false;
+  return true;
+}
 
-  // TODO in principle all of the data this shader needs is already available on the GPU via the [...]Inds attribute
-  // buffers. We could move the encoding / offsetting logic to happen in a shader with some uniforms, and avoid any
-  // CPU-side processing. Maybe the solution is to directly render ints?
+bool SurfaceMesh::shadesNormalsFromPosition() {
+  switch (getShadeStyle()) {
+  case MeshShadeStyle::Smooth:
+    return false;
+  case MeshShadeStyle::Flat:
+    return canDrawIndexed();
+  case MeshShadeStyle::TriFlat:
+    return true;
+  }
+  return false;
+}
 
-  // make sure we have the relevant indexing data
-  triangleVertexInds.ensureHostBufferPopulated();
-  triangleFaceInds.ensureHostBufferPopulated();
-  if (edgesHaveBeenUsed) triangleAllEdgeInds.ensureHostBufferPopulated();
-  if (halfedgesHaveBeenUsed) triangleAllHalfedgeInds.ensureHostBufferPopulated();
-  if (cornersHaveBeenUsed) triangleCornerInds.ensureHostBufferPopulated();
+size_t SurfaceMesh::computePickIndStarts() {
 
   // nEdges() requires computing number of edges, which is expensive and might not even be implemented for polygonal
   // meshes. This way we only call it if actually needed, and use 0 otherwise.
   size_t nEdgesSafe = edgesHaveBeenUsed ? nEdges() : 0;
 
-  // Get element indices
-  size_t totalPickElements = nVertices() + nFaces() + nEdgesSafe + nHalfedges() + nCorners();
+  // the edge indices also fill halfedgeEdgeCorrespondence, used when interpreting halfedge picks
+  if (edgesHaveBeenUsed) triangleAllEdgeInds.ensureHostBufferPopulated();
 
   // In "local" indices, indexing elements only within this mesh, used for reading later
   facePickIndStart = nVertices();
@@ -914,133 +964,54 @@ void SurfaceMesh::setMeshPickAttributes(render::ShaderProgram& p) {
   halfedgePickIndStart = edgePickIndStart + nEdgesSafe;
   cornerPickIndStart = halfedgePickIndStart + nHalfedges();
 
-  // In "global" indices, indexing all elements in the scene, used to fill buffers for drawing here
-  size_t pickStart = pick::requestPickBufferRange(this, totalPickElements);
-  size_t vertexGlobalPickIndStart = pickStart;
-  size_t faceGlobalPickIndStart = pickStart + facePickIndStart;
-  size_t edgeGlobalPickIndStart = pickStart + edgePickIndStart;
-  size_t halfedgeGlobalPickIndStart = pickStart + halfedgePickIndStart;
-  size_t cornerGlobalPickIndStart = pickStart + cornerPickIndStart;
-
-  // == Fill buffers
-  std::vector<std::array<glm::vec3, 3>> vertexColors, halfedgeColors, cornerColors;
-  std::vector<glm::vec3> faceColor;
-
-  // Reserve space
-  vertexColors.reserve(3 * nFacesTriangulation());
-  faceColor.reserve(3 * nFacesTriangulation());
-  if (!usingSimplePick) {
-    halfedgeColors.reserve(3 * nFacesTriangulation());
-    cornerColors.reserve(3 * nFacesTriangulation());
-  }
-
-
-  // Build all quantities in each face
-  size_t iFTri = 0;
-  for (size_t iF = 0; iF < nFaces(); iF++) {
-    size_t D = faceIndsStart[iF + 1] - faceIndsStart[iF];
-
-    glm::vec3 fColor = pick::indToVec(iF + faceGlobalPickIndStart);
-
-    for (size_t j = 1; (j + 1) < D; j++) {
-
-      // == Build face & vertex index data
-
-      // clang-format off
-      std::array<glm::vec3, 3> vColor = {
-        pick::indToVec(triangleVertexInds.data[3*iFTri + 0] + vertexGlobalPickIndStart),
-        pick::indToVec(triangleVertexInds.data[3*iFTri + 1] + vertexGlobalPickIndStart),
-        pick::indToVec(triangleVertexInds.data[3*iFTri + 2] + vertexGlobalPickIndStart),
-      };
-      // clang-format on
-
-      for (int j = 0; j < 3; j++) {
-        faceColor.push_back(fColor);
-        vertexColors.push_back(vColor);
-      }
-
-      // Second half does halfedges/edges/corners, not used for simple mode
-      if (usingSimplePick) {
-        iFTri++;
-        continue;
-      }
-
-
-      // Fill the halfedge buffer with edge or halfedge data, depending on which are in use
-      // In the pick function we will use the halfedge to look up the edge if needed
-      // (this is an optimization to use one less array of values, because we hit implementation limits in the shader)
-
-      // == Build edge index data, if needed
-
-      if (!usingSimplePick) {
-        if (edgesHaveBeenUsed || halfedgesHaveBeenUsed) {
+  // Corner indices may be permuted (see interpretPickResult()), so leave room for them.
+  return cornerPickIndStart + std::max(nCorners(), cornerDataSize);
+}
 
-          const std::vector<uint32_t>& eDataVec =
-              (edgesHaveBeenUsed && !halfedgesHaveBeenUsed) ? triangleAllEdgeInds.data : triangleAllHalfedgeInds.data;
-          size_t offset =
-              (edgesHaveBeenUsed && !halfedgesHaveBeenUsed) ? edgeGlobalPickIndStart : halfedgeGlobalPickIndStart;
+void SurfaceMesh::setMeshPickAttributes(render::ShaderProgram& p) {
 
-          // clang-format off
-        std::array<glm::vec3, 3> eColor = { 
-          fColor, 
-          pick::indToVec(eDataVec[9*iFTri + 1] + offset), 
-          fColor
-        };
-          // clang-format on
-          if (j == 1) eColor[0] = pick::indToVec(eDataVec[9 * iFTri + 0] + offset);
-          if (j + 2 == D) eColor[2] = pick::indToVec(eDataVec[9 * iFTri + 2] + offset);
+  // The pick shaders compute the pick color for each element from its index and the start of its range of pick
+  // indices, so the only per-triangle data needed is the index buffers, which are shared with quantities.
 
-          for (int j = 0; j < 3; j++) halfedgeColors.push_back(eColor);
-        } else {
-          for (int j = 0; j < 3; j++) halfedgeColors.push_back({fColor, fColor, fColor});
-        }
-      }
+  size_t totalPickElements = computePickIndStarts();
 
-      // == Build corner index data, if needed
-
-      if (!usingSimplePick) {
-        if (cornersHaveBeenUsed) {
-          // clang-format off
-        std::array<glm::vec3, 3> cColor = { 
-          pick::indToVec(triangleCornerInds.data[3*iFTri + 0] + cornerGlobalPickIndStart), 
-          pick::indToVec(triangleCornerInds.data[3*iFTri + 1] + cornerGlobalPickIndStart), 
-          pick::indToVec(triangleCornerInds.data[3*iFTri + 2] + cornerGlobalPickIndStart), 
-        };
-          // clang-format on
-          for (int j = 0; j < 3; j++) cornerColors.push_back(cColor);
-        } else {
-          for (int j = 0; j < 3; j++) cornerColors.push_back({vColor[0], vColor[1], vColor[2]});
-        }
-      }
+  // In "global" indices, indexing all elements in the scene, passed to the shader as (low word, high word)
+  size_t pickStart = pick::requestPickBufferRange(this, totalPickElements);
+  auto splitPickStart = [&](size_t localStart) {
+    uint64_t globalStart = pickStart + localStart;
+    return glm::uvec2{static_cast<uint32_t>(globalStart & 0xFFFFFFFF), static_cast<uint32_t>(globalStart >> 32)};
+  };
 
-      iFTri++;
-    }
+  p.setAttribute("a_faceInds", triangleFaceInds.getRenderAttributeBuffer());
+  p.setAttribute("a_vertexInds", triangleAllVertexInds.getRenderAttributeBuffer());
+  p.setUniform("u_vertexPickStart", splitPickStart(0));
+  p.setUniform("u_facePickStart", splitPickStart(facePickIndStart));
+
+  if (usingSimplePick) return;
+
+  // The halfedge slots hold edge or halfedge data, depending on which are in use. In the pick function we will use
+  // the halfedge to look up the edge if needed (this is an optimization to use one less array of values, because we
+  // hit implementation limits in the shader). Unused slots are bound to any buffer of the right size. Internal edges of
+  // triangulated polygons are masked out with a_edgeIsReal, which setMeshGeometryAttributes() binds.
+  if (halfedgesHaveBeenUsed) {
+    p.setAttribute("a_halfedgeInds", triangleAllHalfedgeInds.getRenderAttributeBuffer());
+    p.setUniform("u_halfedgePickStart", splitPickStart(halfedgePickIndStart));
+  } else if (edgesHaveBeenUsed) {
+    p.setAttribute("a_halfedgeInds", triangleAllEdgeInds.getRenderAttributeBuffer());
+    p.setUniform("u_halfedgePickStart", splitPickStart(edgePickIndStart));
+  } else {
+    p.setAttribute("a_halfedgeInds", triangleAllVertexInds.getRenderAttributeBuffer());
+    p.setUniform("u_halfedgePickStart", splitPickStart(0));
   }
+  p.setUniform("u_pickHalfedges", static_cast<int>(edgesHaveBeenUsed || halfedgesHaveBeenUsed));
 
-  // == Store data in buffers
-
-  std::shared_ptr<render::AttributeBuffer> vertexColorsBuff =
-      render::engine->generateAttributeBuffer(RenderDataType::Vector3Float, 3);
-  vertexColorsBuff->setData(vertexColors);
-  pickProgram->setAttribute("a_vertexColors", vertexColorsBuff);
-
-  std::shared_ptr<render::AttributeBuffer> faceColorsBuff =
-      render::engine->generateAttributeBuffer(RenderDataType::Vector3Float);
-  faceColorsBuff->setData(faceColor);
-  pickProgram->setAttribute("a_faceColor", faceColorsBuff);
-
-  if (!usingSimplePick) {
-
-    std::shared_ptr<render::AttributeBuffer> halfedgeColorsBuff =
-        render::engine->generateAttributeBuffer(RenderDataType::Vector3Float, 3);
-    halfedgeColorsBuff->setData(halfedgeColors);
-    pickProgram->setAttribute("a_halfedgeColors", halfedgeColorsBuff);
-
-    std::shared_ptr<render::AttributeBuffer> cornerColorsBuff =
-        render::engine->generateAttributeBuffer(RenderDataType::Vector3Float, 3);
-    cornerColorsBuff->setData(cornerColors);
-    pickProgram->setAttribute("a_cornerColors", cornerColorsBuff);
+  if (cornersHaveBeenUsed) {
+    p.setAttribute("a_cornerInds", triangleAllCornerInds.getRenderAttributeBuffer());
+  } else {
+    p.setAttribute("a_cornerInds", triangleAllVertexInds.getRenderAttributeBuffer());
   }
+  p.setUniform("u_cornerPickStart", splitPickStart(cornerPickIndStart));
+  p.setUniform("u_pickCorners", static_cast<int>(cornersHaveBeenUsed));
 }
 
 
@@ -1057,7 +1028,7 @@ std::vector<std::string> SurfaceMesh::addSurfaceMeshRules(std::vector<std::strin
         initRules.push_back("MESH_WIREFRAME");
       }
 
-      if (shadeStyle.get() == MeshShadeStyle::TriFlat) {
+      if (shadesNormalsFromPosition()) {
         initRules.push_back("COMPUTE_SHADE_NORMAL_FROM_POSITION");
         initRules.push_back("PROJ_AND_INV_PROJ_MAT");
       }
@@ -1101,7 +1072,7 @@ void SurfaceMesh::setSurfaceMeshUniforms(render::ShaderProgram& p) {
   if (backFacePolicy.get() == BackFacePolicy::Custom) {
     p.setUniform("u_backfaceColor", getBackFaceColor());
   }
-  if (shadeStyle.get() == MeshShadeStyle::TriFlat) {
+  if (shadesNormalsFromPosition()) {
     glm::mat4 P = view::getCameraPerspectiveMatrix();
     glm::mat4 Pinv = glm::inverse(P);
     p.setUniform("u_invProjMatrix", glm::value_ptr(Pinv));
@@ -1500,16 +1471,65 @@ SurfaceMeshPickResult SurfaceMesh::interpretPickResult(const PickResult& rawResu
     exception("called interpretPickResult(), but the pick result is not from this structure");
   }
 
+  SurfaceMeshPickResult result = interpretPickIndex(rawResult.localIndex, rawResult.position);
+
+  // The pick shader sees corner indices after the permutation is applied; map back to the internal index
+  if (result.elementType == MeshElement::CORNER && !cornerPerm.empty()) {
+    result.index = unpermuteCornerIndex(result.index);
+  }
+
+  return result;
+}
+
+std::vector<SurfaceMeshPickResult> SurfaceMesh::interpretPickResult(const RegionPickResult& rawResult) {
+
+  if (rawResult.structure != this) {
+    exception("called interpretPickResult(), but the pick result is not from this structure");
+  }
+
+  std::vector<SurfaceMeshPickResult> results;
+  results.reserve(rawResult.localIndices.size());
+  for (size_t i = 0; i < rawResult.localIndices.size(); i++) {
+    SurfaceMeshPickResult result = interpretPickIndex(rawResult.localIndices[i], rawResult.positions[i]);
+
+    // Map permuted corners back, as above
+    if (result.elementType == MeshElement::CORNER && !cornerPerm.empty()) {
+      result.index = unpermuteCornerIndex(result.index);
+    }
+
+    results.push_back(result);
+  }
+
+  return results;
+}
+
+size_t SurfaceMesh::unpermuteCornerIndex(size_t permInd) {
+
+  // Invert the permutation once and keep it, rather than searching it on every pick
+  if (cornerPermInverse.empty()) {
+    cornerPermInverse.assign(std::max(nCorners(), cornerDataSize), INVALID_IND);
+    for (size_t iC = 0; iC < cornerPerm.size(); iC++) {
+      if (cornerPerm[iC] < cornerPermInverse.size()) cornerPermInverse[cornerPerm[iC]] = iC;
+    }
+  }
+
+  size_t ind = permInd < cornerPermInverse.size() ? cornerPermInverse[permInd] : INVALID_IND;
+  if (ind >= nCorners()) exception("Bad corner pick index in surface mesh");
+  return ind;
+}
+
+SurfaceMeshPickResult SurfaceMesh::interpretPickIndex(uint64_t localIndex, glm::vec3 position) {
+
   SurfaceMeshPickResult result;
 
-  if (rawResult.localIndex < facePickIndStart) {
+  if (localIndex < facePickIndStart) {
     // Vertex pick
     result.elementType = MeshElement::VERTEX;
-    result.index = rawResult.localIndex;
-  } else if (rawResult.localIndex < edgePickIndStart) {
+    result.index = localIndex;
+  } else if (localIndex < edgePickIndStart) {
     // Face pick
     result.elementType = MeshElement::FACE;
-    result.index = rawResult.localIndex - facePickIndStart;
+    result.index = localIndex - facePickIndStart;
 
     // TODO barycoords
     size_t D = faceIndsStart[result.index + 1] - faceIndsStart[result.index];
@@ -1524,7 +1544,7 @@ SurfaceMeshPickResult SurfaceMesh::interpretPickResult(const PickResult& rawResu
       glm::vec3 pB = vertexPositions.getValue(vB);
       glm::vec3 pC = vertexPositions.getValue(vC);
       glm::vec3 normal = glm::normalize(glm::cross(pB - pA, pC - pA));
-      glm::vec3 x = projectToPlane(rawResult.position, normal, pA);
+      glm::vec3 x = projectToPlane(position, normal, pA);
 
       // compute barycentric coordinates as ratio of signed areas
       float areaABC = signedTriangleArea(normal, pA, pB, pC);
@@ -1535,21 +1555,21 @@ SurfaceMeshPickResult SurfaceMesh::interpretPickResult(const PickResult& rawResu
       result.baryCoords = barycoord;
     }
 
-  } else if (rawResult.localIndex < halfedgePickIndStart) {
+  } else if (localIndex < halfedgePickIndStart) {
     // Edge pick
     result.elementType = MeshElement::EDGE;
-    result.index = rawResult.localIndex - edgePickIndStart;
+    result.index = localIndex - edgePickIndStart;
 
 
-  } else if (rawResult.localIndex < cornerPickIndStart) {
+  } else if (localIndex < cornerPickIndStart) {
     // Halfedge pick
     result.elementType = MeshElement::HALFEDGE;
-    result.index = rawResult.localIndex - halfedgePickIndStart;
+    result.index = localIndex - halfedgePickIndStart;
 
-  } else if (rawResult.localIndex < cornerPickIndStart + nCorners()) {
+  } else if (localIndex < cornerPickIndStart + std::max(nCorners(), cornerDataSize)) {
     // Corner pick
     result.elementType = MeshElement::CORNER;
-    result.index = rawResult.localIndex - cornerPickIndStart;
+    result.index = localIndex - cornerPickIndStart;
   } else {
     exception("Bad pick index in curve network");
   }
@@ -91,10 +91,10 @@ void SurfaceVertexScalarQuantity::createProgram() {
     program->setAttribute("a_value3", values.getIndexedRenderAttributeBuffer(parent.triangleAllVertexInds));
 
   } else {
-    // common case: linear interpolation within each triangle
+    // common case: linear interpolation within each triangle, which can draw straight from the per-vertex values
 
     // clang-format off
-    program = render::engine->requestShader("MESH",
+    program = render::engine->requestShader(parent.canDrawIndexed() ? "INDEXED_MESH" : "MESH",
         render::engine->addMaterialRules(parent.getMaterial(),
           parent.addSurfaceMeshRules(
             addScalarRules(
@@ -105,7 +105,11 @@ void SurfaceVertexScalarQuantity::createProgram() {
       );
     // clang-format on
 
-    program->setAttribute("a_value", values.getIndexedRenderAttributeBuffer(parent.triangleVertexInds));
+    if (program->usesIndex()) {
+      program->setAttribute("a_value", values.getRenderAttributeBuffer());
+    } else {
+      program->setAttribute("a_value", values.getIndexedRenderAttributeBuffer(parent.triangleVertexInds));
+    }
   }
 
   parent.setMeshGeometryAttributes(*program);
@@ -207,6 +207,7 @@ std::vector<glm::vec2> oneFormToFaceTangentVectors(SurfaceMesh& mesh, const std:
                                                    std::vector<char>& canonicalOrientation) {
 
   mesh.vertexPositions.ensureHostBufferPopulated();
+  mesh.triangleVertexInds.ensureHostBufferPopulated();
   mesh.faceAreas.ensureHostBufferPopulated();
   mesh.faceNormals.ensureHostBufferPopulated();
   mesh.defaultFaceTangentBasisX.ensureHostBufferPopulated();
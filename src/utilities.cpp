@@ -3,12 +3,14 @@
 #include "polyscope/utilities.h"
 
 
+#include <algorithm>
 #include <cmath>
 #include <vector>
 
 #include "imgui.h"
 
 #include "polyscope/messages.h"
+#include "polyscope/parallel.h"
 
 
 namespace polyscope {
@@ -17,6 +19,66 @@ namespace polyscope {
 std::random_device util_random_device;
 std::mt19937 util_mersenne_twister(util_random_device());
 
+void radixSortPairs(std::vector<uint64_t>& keys, std::vector<uint32_t>& values, int keyBits) {
+  if (keys.size() != values.size()) exception("radixSortPairs: keys and values must have the same size");
+
+  const size_t n = keys.size();
+  const int digitBits = 11;
+  const size_t nBuckets = static_cast<size_t>(1) << digitBits;
+  const uint64_t digitMask = nBuckets - 1;
+
+  // Split the input in to contiguous chunks, which are processed in parallel. Each pass histograms and scatters the
+  // chunks independently, and the chunk offsets are laid out in order so the result is the same as a serial sort. The
+  // chunks are fixed up front, so the histogram and scatter passes agree even if the thread count changes.
+  const ParallelPartition chunks = getParallelPartition(n, static_cast<size_t>(1) << 16);
+  const size_t nChunks = chunks.nBlocks;
+
+  std::vector<uint64_t> keysTmp(n);
+  std::vector<uint32_t> valuesTmp(n);
+  std::vector<size_t> offsets(nChunks * nBuckets);
+
+  for (int shift = 0; shift < keyBits && shift < 64; shift += digitBits) {
+
+    // Count the occurrences of each digit in each chunk
+    std::fill(offsets.begin(), offsets.end(), 0);
+    parallelForBlocks(chunks, [&](size_t iChunk, size_t start, size_t end) {
+      size_t* counts = &offsets[iChunk * nBuckets];
+      for (size_t i = start; i < end; i++) {
+        counts[(keys[i] >> shift) & digitMask]++;
+      }
+    });
+
+    // Convert counts to output offsets, ordered by digit, then by chunk. Skip the pass if every key has the same
+    // digit here.
+    size_t sum = 0;
+    bool allSameDigit = false;
+    for (size_t iB = 0; iB < nBuckets; iB++) {
+      size_t bucketTotal = 0;
+      for (size_t iChunk = 0; iChunk < nChunks; iChunk++) {
+        size_t count = offsets[iChunk * nBuckets + iB];
+        offsets[iChunk * nBuckets + iB] = sum;
+        sum += count;
+        bucketTotal += count;
+      }
+      if (bucketTotal == n) allSameDigit = true;
+    }
+    if (allSameDigit) continue;
+
+    // Scatter to the output
+    parallelForBlocks(chunks, [&](size_t iChunk, size_t start, size_t end) {
+      size_t* chunkOffsets = &offsets[iChunk * nBuckets];
+      for (size_t i = start; i < end; i++) {
+        size_t dest = chunkOffsets[(keys[i] >> shift) & digitMask]++;
+        keysTmp[dest] = keys[i];
+        valuesTmp[dest] = values[i];
+      }
+    });
+
+    keys.swap(keysTmp);
+    values.swap(valuesTmp);
+  }
+}
+
 std::string guessNiceNameFromPath(std::string fullname) {
   size_t startInd = 0;
   for (std::string sep : {"/", "\\"}) {
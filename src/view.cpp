@@ -631,21 +631,44 @@ glm::mat4 getCameraPerspectiveMatrix() {
   double nearClip = nearClipRatio * state::lengthScale;
   double fovRad = glm::radians(fov);
   double aspectRatio = (float)bufferWidth / bufferHeight;
+  glm::mat4 projMat(1.0f);
   switch (projectionMode) {
   case ProjectionMode::Perspective: {
-    return glm::perspective(fovRad, aspectRatio, nearClip, farClip);
+    projMat = glm::perspective(fovRad, aspectRatio, nearClip, farClip);
     break;
   }
   case ProjectionMode::Orthographic: {
     double vert = tan(fovRad / 2.) * state::lengthScale * 2.;
     double horiz = vert * aspectRatio;
-    return glm::ortho(-horiz, horiz, -vert, vert, nearClip, farClip);
+    projMat = glm::ortho(-horiz, horiz, -vert, vert, nearClip, farClip);
     break;
   }
   }
-  return glm::mat4(1.0f); // unreachable
+
+  if (state::globalContext.haveRenderSubWindow) {
+    // Scale and shift clip space so the window's pixels in NDC of the full buffer cover all of [-1, 1]
+    glm::ivec4 window = state::globalContext.renderSubWindow;
+    glm::mat4 windowMat(1.0f);
+    windowMat[0][0] = static_cast<float>(bufferWidth) / window[2];
+    windowMat[1][1] = static_cast<float>(bufferHeight) / window[3];
+    windowMat[3][0] = static_cast<float>(bufferWidth - 2 * window[0] - window[2]) / window[2];
+    windowMat[3][1] = static_cast<float>(bufferHeight - 2 * window[1] - window[3]) / window[3];
+    projMat = windowMat * projMat;
+  }
+
+  return projMat;
 }
 
+void setRenderSubWindow(glm::ivec4 window) {
+  if (window[2] <= 0 || window[3] <= 0) {
+    exception("render sub-window must have positive size");
+  }
+  state::globalContext.haveRenderSubWindow = true;
+  state::globalContext.renderSubWindow = window;
+}
+
+void clearRenderSubWindow() { state::globalContext.haveRenderSubWindow = false; }
+
 
 glm::vec3 getCameraWorldPosition() {
   // This will work no matter how the view matrix is constructed...
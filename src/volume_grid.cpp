@@ -12,7 +12,7 @@ namespace polyscope {
 const std::string VolumeGrid::structureTypeName = "Volume Grid";
 
 VolumeGrid::VolumeGrid(std::string name, glm::uvec3 gridNodeDim_, glm::vec3 boundMin_, glm::vec3 boundMax_)
-    : QuantityStructure<VolumeGrid>(name, typeName()),
+    : GridCubeStructure<VolumeGrid>(name, typeName()),
 
       // clang-format off
       // == managed quantities
@@ -20,14 +20,7 @@ VolumeGrid::VolumeGrid(std::string name, glm::uvec3 gridNodeDim_, glm::vec3 boun
       gridPlaneReferenceNormals(this, uniquePrefix() +    "#gridPlaneReferenceNormals",       gridPlaneReferenceNormalsData,      [](){/* do nothing, gets handled by position func */} ),
       gridPlaneAxisInds(this, uniquePrefix() +            "#gridPlaneAxisInds",               gridPlaneAxisIndsData,              [](){/* do nothing, gets handled by position func */} ),
 
-       gridNodeDim(gridNodeDim_), gridCellDim(gridNodeDim_ - 1u), boundMin(boundMin_), boundMax(boundMax_),
-
-      // == persistent options
-      color(                  uniquePrefix() + "color",             getNextUniqueColor()),
-      edgeColor(              uniquePrefix() + "edgeColor",         glm::vec3{0., 0., 0.}), 
-      material(               uniquePrefix() + "material",          "clay"),
-      edgeWidth(              uniquePrefix() + "edgeWidth",         0.f),
-      cubeSizeFactor(         uniquePrefix() + "cubeSizeFactor",    0.f)
+       gridNodeDim(gridNodeDim_), gridCellDim(gridNodeDim_ - 1u), boundMin(boundMin_), boundMax(boundMax_)
 // clang-format on
 {
   cullWholeElements.setPassive(true);
@@ -44,60 +37,7 @@ void VolumeGrid::buildCustomUI() {
   // ImGui::TextUnformatted(("max: " + to_string_short(boundMax)).c_str());
   // ImGui::TextUnformatted((to_string_short(boundMin) + " -- " + to_string_short(boundMax)).c_str());
 
-  { // Colors
-    if (ImGui::ColorEdit3("Color", &color.get()[0], ImGuiColorEditFlags_NoInputs)) setColor(color.get());
-    ImGui::SameLine();
-  }
-
-
-  { // Edge options
-    ImGui::SameLine();
-    ImGui::PushItemWidth(100 * options::uiScale);
-    if (edgeWidth.get() == 0.) {
-      bool showEdges = false;
-      if (ImGui::Checkbox("Edges", &showEdges)) {
-        setEdgeWidth(1.);
-      }
-    } else {
-      bool showEdges = true;
-      if (ImGui::Checkbox("Edges", &showEdges)) {
-        setEdgeWidth(0.);
-      }
-
-      // Edge color
-      ImGui::PushItemWidth(100 * options::uiScale);
-      if (ImGui::ColorEdit3("Edge Color", &edgeColor.get()[0], ImGuiColorEditFlags_NoInputs))
-        setEdgeColor(edgeColor.get());
-      ImGui::PopItemWidth();
-
-      // Edge width
-      ImGui::SameLine();
-      ImGui::PushItemWidth(75 * options::uiScale);
-      if (ImGui::SliderFloat("Width", &edgeWidth.get(), 0.001, 2.)) {
-        // NOTE: this intentionally circumvents the setEdgeWidth() setter to avoid repopulating the buffer as the
-        // slider is dragged---otherwise we repopulate the buffer on every change, which mostly works fine. This is a
-        // lazy solution instead of better state/buffer management. setEdgeWidth(getEdgeWidth());
-        edgeWidth.manuallyChanged();
-        requestRedraw();
-      }
-      ImGui::PopItemWidth();
-    }
-    ImGui::PopItemWidth();
-  }
-}
-
-
-void VolumeGrid::buildCustomOptionsUI() {
-  if (render::buildMaterialOptionsGui(material.get())) {
-    material.manuallyChanged();
-    setMaterial(material.get()); // trigger the other updates that happen on set()
-  }
-
-  // Shrinky effect
-  if (ImGui::SliderFloat("Cell Shrink", &cubeSizeFactor.get(), 0.0, 1., "%.3f", ImGuiSliderFlags_Logarithmic)) {
-    cubeSizeFactor.manuallyChanged();
-    requestRedraw();
-  }
+  buildColorAndEdgeUI();
 }
 
 void VolumeGrid::draw() {
@@ -283,141 +223,84 @@ void VolumeGrid::setVolumeGridUniforms(render::ShaderProgram& p) {}
 
 
 void VolumeGrid::computeGridPlaneReferenceGeometry() {
+  fillGridPlaneReferenceGeometry(gridCellDim, gridPlaneReferencePositions, gridPlaneReferenceNormals,
+                                 gridPlaneAxisInds);
+}
 
-  // NOTE: This slightly abuses the ManagedBuffer 'compute()' func,
-  // by computing the data for multiple buffers with one function.
-  // For now at least, it will work fine.
-
-  // Geometry is defined in the reference [0,1] cube
-
-  gridPlaneReferencePositions.data.clear();
-  gridPlaneReferenceNormals.data.clear();
-  gridPlaneAxisInds.data.clear();
-
-  auto addPlane = [&](std::array<glm::vec3, 4> corners, glm::vec3 normal, uint32_t axInd) {
-    // first triangle
-    gridPlaneReferencePositions.data.push_back(corners[0]);
-    gridPlaneReferencePositions.data.push_back(corners[1]);
-    gridPlaneReferencePositions.data.push_back(corners[2]);
-    for (int32_t j = 0; j < 3; j++) gridPlaneReferenceNormals.data.push_back(normal);
-    for (int32_t j = 0; j < 3; j++) gridPlaneAxisInds.data.push_back(axInd);
-
-    // second triangle
-    gridPlaneReferencePositions.data.push_back(corners[1]);
-    gridPlaneReferencePositions.data.push_back(corners[3]);
-    gridPlaneReferencePositions.data.push_back(corners[2]);
-    for (int32_t j = 0; j < 3; j++) gridPlaneReferenceNormals.data.push_back(normal);
-    for (int32_t j = 0; j < 3; j++) gridPlaneAxisInds.data.push_back(axInd);
-  };
-
-  // The planes are intentionally added in order such that the outermost planes come first, and we don't massively
-  // overshade from back to front. Note that fthe first look runs backwards.
-
-  // Forward facing planes
-  for (uint32_t d = 0; d < 3; d++) { // x/y/z dimension (plane is perpendicular)
-    for (int32_t i = (int32_t)gridCellDim[d] - 1; i >= 0; i--) {
-
-      float t = (static_cast<float>(i) + 1) / (gridCellDim[d]);
-
-      // clang-format off
-      glm::vec3 ll{0.f, 0.f, 0.f}; ll[(d+1)%3] = 0.f; ll[(d+2)%3] = 0.f; ll[d] = t;
-      glm::vec3 lu{0.f, 0.f, 0.f}; lu[(d+1)%3] = 1.f; lu[(d+2)%3] = 0.f; lu[d] = t;
-      glm::vec3 ul{0.f, 0.f, 0.f}; ul[(d+1)%3] = 0.f; ul[(d+2)%3] = 1.f; ul[d] = t;
-      glm::vec3 uu{0.f, 0.f, 0.f}; uu[(d+1)%3] = 1.f; uu[(d+2)%3] = 1.f; uu[d] = t;
-
-      glm::vec3 n{0.f, 0.f, 0.f}; n[d] = 1.f;
-      // clang-format on
-
-      addPlane({ll, lu, ul, uu}, n, i);
-    }
-  }
-
-  // Backward facing planes
-  for (uint32_t d = 0; d < 3; d++) { // x/y/z dimension (plane is perpendicular)
-    for (int32_t i = 0; i < (int32_t)gridCellDim[d]; i++) {
-
-      float t = (static_cast<float>(i)) / (gridCellDim[d]);
+// === Register functions
 
-      // clang-format off
-      glm::vec3 ll{0.f, 0.f, 0.f}; ll[(d+1)%3] = 0.f; ll[(d+2)%3] = 0.f; ll[d] = t;
-      glm::vec3 lu{0.f, 0.f, 0.f}; lu[(d+1)%3] = 1.f; lu[(d+2)%3] = 0.f; lu[d] = t;
-      glm::vec3 ul{0.f, 0.f, 0.f}; ul[(d+1)%3] = 0.f; ul[(d+2)%3] = 1.f; ul[d] = t;
-      glm::vec3 uu{0.f, 0.f, 0.f}; uu[(d+1)%3] = 1.f; uu[(d+2)%3] = 1.f; uu[d] = t;
 
-      glm::vec3 n{0.f, 0.f, 0.f}; n[d] = -1.f;
-      // clang-format on
+VolumeGridQuantity::VolumeGridQuantity(std::string name_, VolumeGrid& curveNetwork_, bool dominates_)
+    : QuantityS<VolumeGrid>(name_, curveNetwork_, dominates_) {}
 
-      addPlane({ul, uu, ll, lu}, n, i); // winding is opposite here
-    }
-  }
 
+VolumeGridNodeScalarQuantity* VolumeGrid::addNodeScalarQuantityImpl(std::string name, const std::vector<float>& data,
+                                                                    DataType dataType_) {
 
-  gridPlaneReferencePositions.markHostBufferUpdated();
-  gridPlaneReferenceNormals.markHostBufferUpdated();
-  gridPlaneAxisInds.markHostBufferUpdated();
+  checkForQuantityWithNameAndDeleteOrError(name);
+  VolumeGridNodeScalarQuantity* q = new VolumeGridNodeScalarQuantity(name, *this, data, dataType_);
+  addQuantity(q);
+  markNodesAsUsed();
+  return q;
 }
 
-// === Option getters and setters
+VolumeGridCellScalarQuantity* VolumeGrid::addCellScalarQuantityImpl(std::string name, const std::vector<float>& data,
+                                                                    DataType dataType_) {
 
-VolumeGrid* VolumeGrid::setColor(glm::vec3 val) {
-  color = val;
-  requestRedraw();
-  return this;
+  checkForQuantityWithNameAndDeleteOrError(name);
+  VolumeGridCellScalarQuantity* q = new VolumeGridCellScalarQuantity(name, *this, data, dataType_);
+  addQuantity(q);
+  markCellsAsUsed();
+  return q;
 }
-glm::vec3 VolumeGrid::getColor() { return color.get(); }
 
-VolumeGrid* VolumeGrid::setEdgeColor(glm::vec3 val) {
-  edgeColor = val;
-  requestRedraw();
-  return this;
-}
-glm::vec3 VolumeGrid::getEdgeColor() { return edgeColor.get(); }
+VolumeGridNodeScalarQuantity* VolumeGrid::addNodeScalarQuantityImpl(std::string name, QuantizedScalarArray data,
+                                                                    DataType dataType_) {
 
-VolumeGrid* VolumeGrid::setMaterial(std::string m) {
-  material = m;
-  refresh();
-  requestRedraw();
-  return this;
+  checkForQuantityWithNameAndDeleteOrError(name);
+  VolumeGridNodeScalarQuantity* q = new VolumeGridNodeScalarQuantity(name, *this, std::move(data), dataType_);
+  addQuantity(q);
+  markNodesAsUsed();
+  return q;
 }
-std::string VolumeGrid::getMaterial() { return material.get(); }
 
-VolumeGrid* VolumeGrid::setEdgeWidth(double newVal) {
-  edgeWidth = newVal;
-  refresh();
-  requestRedraw();
-  return this;
-}
-double VolumeGrid::getEdgeWidth() { return edgeWidth.get(); }
+VolumeGridCellScalarQuantity* VolumeGrid::addCellScalarQuantityImpl(std::string name, QuantizedScalarArray data,
+                                                                    DataType dataType_) {
 
-VolumeGrid* VolumeGrid::setCubeSizeFactor(double newVal) {
-  cubeSizeFactor = newVal;
-  requestRedraw();
-  return this;
+  checkForQuantityWithNameAndDeleteOrError(name);
+  VolumeGridCellScalarQuantity* q = new VolumeGridCellScalarQuantity(name, *this, std::move(data), dataType_);
+  addQuantity(q);
+  markCellsAsUsed();
+  return q;
 }
-double VolumeGrid::getCubeSizeFactor() { return cubeSizeFactor.get(); }
-
-// === Register functions
-
-
-VolumeGridQuantity::VolumeGridQuantity(std::string name_, VolumeGrid& curveNetwork_, bool dominates_)
-    : QuantityS<VolumeGrid>(name_, curveNetwork_, dominates_) {}
 
-
-VolumeGridNodeScalarQuantity* VolumeGrid::addNodeScalarQuantityImpl(std::string name, const std::vector<float>& data,
-                                                                    DataType dataType_) {
+VolumeGridNodeScalarQuantity* VolumeGrid::addNodeScalarQuantityFromFile(std::string name,
+                                                                        std::shared_ptr<RawVolumeFile> file,
+                                                                        DataType dataType_) {
+  if (file == nullptr) exception("VolumeGrid " + this->name + ": null file for node scalar quantity " + name);
+  if (file->getDim() != gridNodeDim) {
+    exception("VolumeGrid " + this->name + ": file " + file->getFilename() + " for node scalar quantity " + name +
+              " does not match the dimensions of the grid nodes");
+  }
 
   checkForQuantityWithNameAndDeleteOrError(name);
-  VolumeGridNodeScalarQuantity* q = new VolumeGridNodeScalarQuantity(name, *this, data, dataType_);
+  VolumeGridNodeScalarQuantity* q = new VolumeGridNodeScalarQuantity(name, *this, file, dataType_);
   addQuantity(q);
   markNodesAsUsed();
   return q;
 }
 
-VolumeGridCellScalarQuantity* VolumeGrid::addCellScalarQuantityImpl(std::string name, const std::vector<float>& data,
-                                                                    DataType dataType_) {
+VolumeGridCellScalarQuantity* VolumeGrid::addCellScalarQuantityFromFile(std::string name,
+                                                                        std::shared_ptr<RawVolumeFile> file,
+                                                                        DataType dataType_) {
+  if (file == nullptr) exception("VolumeGrid " + this->name + ": null file for cell scalar quantity " + name);
+  if (file->getDim() != getGridCellDim()) {
+    exception("VolumeGrid " + this->name + ": file " + file->getFilename() + " for cell scalar quantity " + name +
+              " does not match the dimensions of the grid cells");
+  }
 
   checkForQuantityWithNameAndDeleteOrError(name);
-  VolumeGridCellScalarQuantity* q = new VolumeGridCellScalarQuantity(name, *this, data, dataType_);
+  VolumeGridCellScalarQuantity* q = new VolumeGridCellScalarQuantity(name, *this, file, dataType_);
   addQuantity(q);
   markCellsAsUsed();
   return q;
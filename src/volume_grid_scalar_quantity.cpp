@@ -2,88 +2,97 @@
 
 #include "polyscope/volume_grid_scalar_quantity.h"
 
-#include "MarchingCube/MC.h"
+#include <algorithm>
 
 namespace polyscope {
 
-// ========================================================
-// ==========            Node Scalar             ==========
-// ========================================================
-
-VolumeGridNodeScalarQuantity::VolumeGridNodeScalarQuantity(std::string name, VolumeGrid& grid_,
-                                                           const std::vector<float>& values_, DataType dataType_)
-    : VolumeGridQuantity(name, grid_, true), ScalarQuantity(*this, values_, dataType_),
-      gridcubeVizEnabled(uniquePrefix() + "gridcubeVizEnabled", true),
-      isosurfaceVizEnabled(uniquePrefix() + "isosurfaceVizEnabled", false),
-      isosurfaceLevel(uniquePrefix() + "isosurfaceLevel", 0.f),
-      isosurfaceColor(uniquePrefix() + "isosurfaceColor", getNextUniqueColor()),
-      slicePlanesAffectIsosurface(uniquePrefix() + "slicePlanesAffectIsosurface", false) {
+namespace {
 
-  values.setTextureSize(parent.getGridNodeDim().x, parent.getGridNodeDim().y, parent.getGridNodeDim().z);
+// Values read at a time from streamed buffers, sized like the chunks of the streamed texture upload
+size_t streamedSlabValues() {
+  return static_cast<size_t>(std::max<int64_t>(options::streamedUploadChunkBytes, 0)) / sizeof(float);
 }
 
+// Bring a brick table up to date with the values, re-summarizing only the changed bricks when the buffer remembers
+// which ranges were written
+void refreshBrickRanges(GridBrickRanges& brickRanges, uint64_t& builtVersion, render::ManagedBuffer<float>& values,
+                        glm::uvec3 valueDim, bool valuesOnNodes) {
+  if (brickRanges.isBuilt() && builtVersion == values.getDataVersion()) return;
+
+  if (values.hasStreamedData()) {
+    // a slab at a time, without reading all of the values in to memory
+    brickRanges.buildFromSlabs(valueDim, valuesOnNodes, streamedSlabValues(),
+                               [&](size_t start, size_t count, float* out) { values.readValues(start, count, out); });
+    builtVersion = values.getDataVersion();
+    return;
+  }
 
-void VolumeGridNodeScalarQuantity::buildCustomUI() {
+  values.ensureHostBufferPopulated();
+  std::vector<std::array<size_t, 2>> changedRanges;
+  if (brickRanges.isBuilt() && values.getRangesUpdatedSince(builtVersion, changedRanges)) {
+    brickRanges.update(values.data, changedRanges);
+  } else {
+    brickRanges.build(values.data, valueDim, valuesOnNodes);
+  }
+  builtVersion = values.getDataVersion();
+}
 
-  // Select which viz to use
-  ImGui::SameLine();
-  if (ImGui::Button("Mode")) {
-    ImGui::OpenPopup("ModePopup");
+// Values spread over a file, from which the data range and histogram of a streamed quantity are estimated without
+// reading the whole file. Contiguous runs are read, which is much faster than scattered values.
+std::vector<float> sampleFileValues(const RawVolumeFile& file) {
+  const uint64_t nRuns = 64;
+  const uint64_t runLength = 1 << 14;
+  const uint64_t n = file.nValues();
+
+  if (n <= nRuns * runLength) {
+    std::vector<float> allValues(n);
+    file.readValues(0, n, allValues.data());
+    return allValues;
   }
-  if (ImGui::BeginPopup("ModePopup")) {
-    // show toggles for each
-    // ImGui::Indent(20);
-    if (ImGui::MenuItem("Gridcube", NULL, &gridcubeVizEnabled.get())) setGridcubeVizEnabled(getGridcubeVizEnabled());
-    if (ImGui::MenuItem("Isosurface", NULL, &isosurfaceVizEnabled.get()))
-      setIsosurfaceVizEnabled(getIsosurfaceVizEnabled());
-    // ImGui::Indent(-20);
-    ImGui::EndPopup();
+
+  std::vector<float> sample(nRuns * runLength);
+  for (uint64_t iRun = 0; iRun < nRuns; iRun++) {
+    uint64_t start = (n - runLength) * iRun / (nRuns - 1);
+    file.readValues(start, runLength, &sample[iRun * runLength]);
   }
+  return sample;
+}
 
+void streamValuesFromFile(render::ManagedBuffer<float>& values, std::shared_ptr<RawVolumeFile> file) {
+  // the read function holds on to the file, so it stays mapped as long as the values need it
+  values.setStreamedData(file->nValues(),
+                         [file](size_t start, size_t count, float* out) { file->readValues(start, count, out); });
+}
 
-  // == Options popup
-  ImGui::SameLine();
-  if (ImGui::Button("Options")) {
-    ImGui::OpenPopup("OptionsPopup");
-  }
-  if (ImGui::BeginPopup("OptionsPopup")) {
-    buildScalarOptionsUI();
+} // namespace
 
-    if (ImGui::MenuItem("Slice plane affects isosurface", NULL, &slicePlanesAffectIsosurface.get()))
-      setSlicePlanesAffectIsosurface(getSlicePlanesAffectIsosurface());
+// ========================================================
+// ==========            Node Scalar             ==========
+// ========================================================
 
-    if (ImGui::MenuItem("Register isosurface as mesh")) registerIsosurfaceAsMesh();
+VolumeGridNodeScalarQuantity::VolumeGridNodeScalarQuantity(std::string name, VolumeGrid& grid_,
+                                                           const std::vector<float>& values_, DataType dataType_)
+    : VolumeGridQuantity(name, grid_, true), ScalarQuantity(*this, values_, dataType_), GridIsosurfaceQuantity(*this) {
 
-    ImGui::EndPopup();
-  }
+  values.setTextureSize(parent.getGridNodeDim().x, parent.getGridNodeDim().y, parent.getGridNodeDim().z);
+}
 
-  if (gridcubeVizEnabled.get()) {
-    buildScalarUI();
-  }
+// The streamed and quantized values are set up from a sample of the values, which gives the data range and histogram
 
-  if (isosurfaceVizEnabled.get()) {
-    ImGui::TextUnformatted("Isosurface:");
-    // Color picker
-    if (ImGui::ColorEdit3("##Color", &isosurfaceColor.get()[0], ImGuiColorEditFlags_NoInputs)) {
-      setIsosurfaceColor(getIsosurfaceColor());
-    }
-    ImGui::SameLine();
-
-    // Set isovalue
-    ImGui::PushItemWidth(120 * options::uiScale);
-    if (ImGui::SliderFloat("##Radius", &isosurfaceLevel.get(), vizRangeMin.get(), vizRangeMax.get(), "%.4e")) {
-      // Note: we intentionally do this rather than calling setIsosurfaceLevel(), because that function immediately
-      // recomputes the levelset mesh, which is too expensive during user interaction
-      isosurfaceLevel.manuallyChanged();
-    }
-    ImGui::PopItemWidth();
-    ImGui::SameLine();
-    if (ImGui::Button("Refresh")) {
-      refresh();
-    }
-  }
+VolumeGridNodeScalarQuantity::VolumeGridNodeScalarQuantity(std::string name, VolumeGrid& grid_,
+                                                           std::shared_ptr<RawVolumeFile> file_, DataType dataType_)
+    : VolumeGridNodeScalarQuantity(name, grid_, sampleFileValues(*file_), dataType_) {
+  streamValuesFromFile(values, file_);
+}
+
+VolumeGridNodeScalarQuantity::VolumeGridNodeScalarQuantity(std::string name, VolumeGrid& grid_,
+                                                           QuantizedScalarArray values_, DataType dataType_)
+    : VolumeGridNodeScalarQuantity(name, grid_, values_.sampleValues(1 << 20), dataType_) {
+  setQuantizedValues(std::move(values_));
 }
 
+void VolumeGridNodeScalarQuantity::buildCustomUI() { buildGridScalarUI(); }
+
 std::string VolumeGridNodeScalarQuantity::niceName() { return name + " (node scalar)"; }
 
 bool VolumeGridNodeScalarQuantity::isDrawingGridcubes() { return isEnabled() && getGridcubeVizEnabled(); }
@@ -114,23 +123,7 @@ void VolumeGridNodeScalarQuantity::draw() {
   }
 
   // Draw the isosurface program
-  if (isosurfaceVizEnabled.get()) {
-    if (isosurfaceProgram == nullptr) {
-      createIsosurfaceProgram();
-    }
-    parent.setStructureUniforms(*isosurfaceProgram);
-    // setScalarUniforms(*isosurfaceProgram);
-    render::engine->setMaterialUniforms(*isosurfaceProgram, parent.getMaterial());
-    isosurfaceProgram->setUniform("u_baseColor", getIsosurfaceColor());
-
-    glm::mat4 P = view::getCameraPerspectiveMatrix();
-    glm::mat4 Pinv = glm::inverse(P);
-    isosurfaceProgram->setUniform("u_invProjMatrix", glm::value_ptr(Pinv));
-    isosurfaceProgram->setUniform("u_viewport", render::engine->getCurrentViewport());
-
-    render::engine->setBackfaceCull(false);
-    isosurfaceProgram->draw();
-  }
+  drawIsosurface();
 }
 
 void VolumeGridNodeScalarQuantity::createGridcubeProgram() {
@@ -159,72 +152,72 @@ void VolumeGridNodeScalarQuantity::createGridcubeProgram() {
   values.getRenderTextureBuffer().get()->setFilterMode(FilterMode::Linear);
 }
 
-void VolumeGridNodeScalarQuantity::createIsosurfaceProgram() {
-
-  values.ensureHostBufferPopulated();
-
-  // Extract the isosurface from the level set of the scalar field
-  MC::mcMesh isosurfaceMesh;
-  MC::marching_cube(&values.data.front(), isosurfaceLevel.get(), parent.getGridNodeDim().x, parent.getGridNodeDim().y,
-                    parent.getGridNodeDim().z, isosurfaceMesh);
-
-  // Transform the result to be aligned with our volume's spatial layout
-  glm::vec3 scale = parent.gridSpacing();
-  for (auto& p : isosurfaceMesh.vertices) {
-    // swizzle to account for change of coordinate/buffer ordering in the MC lib
-    p = glm::vec3{p.z, p.y, p.x} * scale + parent.getBoundMin();
+const IsosurfaceMesh& VolumeGridNodeScalarQuantity::getIsosurfaceMesh() {
+  if (isosurfaceMeshValid && isosurfaceMeshLevel == isosurfaceLevel.get() &&
+      isosurfaceMeshValuesVersion == values.getDataVersion()) {
+    return isosurfaceMesh;
   }
 
-  std::vector<std::string> isoProgramRules{"SHADE_BASECOLOR", "PROJ_AND_INV_PROJ_MAT",
-                                           "COMPUTE_SHADE_NORMAL_FROM_POSITION"};
-  if (getSlicePlanesAffectIsosurface() && render::engine->slicePlanesEnabled()) {
-    isoProgramRules.push_back("GENERATE_VIEW_POS");
-    isoProgramRules.push_back("CULL_POS_FROM_VIEW");
+  if (values.hasStreamedData()) {
+    extractStreamedIsosurface();
+  } else {
+    values.ensureHostBufferPopulated();
+    const GridBrickRanges& ranges = getBrickRanges();
+    marchingCubes(values.data, parent.getGridNodeDim(), parent.getBoundMin(), parent.getBoundMax(),
+                  isosurfaceLevel.get(), isosurfaceMesh, &ranges);
   }
+  isosurfaceMeshValid = true;
+  isosurfaceMeshLevel = isosurfaceLevel.get();
+  isosurfaceMeshValuesVersion = values.getDataVersion();
+  return isosurfaceMesh;
+}
 
-  // Create a render program to draw it
-  // clang-format off
-  isosurfaceProgram = render::engine->requestShader("SIMPLE_MESH",
-      render::engine->addMaterialRules(parent.getMaterial(), 
-        parent.addStructureRules(
-          isoProgramRules
-        )
-      ),
-    getSlicePlanesAffectIsosurface() ? 
-     render::ShaderReplacementDefaults::SceneObject :
-     render::ShaderReplacementDefaults::SceneObjectNoSlice
-    );
-  // clang-format on
-
-  // Populate the program buffers with the extracted mesh
-  isosurfaceProgram->setAttribute("a_vertexPositions", isosurfaceMesh.vertices);
-  std::shared_ptr<render::AttributeBuffer> indexBuff = render::engine->generateAttributeBuffer(RenderDataType::UInt);
-  indexBuff->setData(isosurfaceMesh.indices);
-  isosurfaceProgram->setIndex(indexBuff);
-
+void VolumeGridNodeScalarQuantity::extractStreamedIsosurface() {
+  const glm::uvec3 nodeDim = parent.getGridNodeDim();
+  const uint64_t nodesPerSlice = static_cast<uint64_t>(nodeDim.x) * nodeDim.y;
+
+  // Read slabs of node layers sized like the chunks of the streamed texture upload. Consecutive slabs share a layer of
+  // nodes, and the vertices on it are welded.
+  uint64_t slabCells = streamedSlabValues() / nodesPerSlice;
+  slabCells = std::min<uint64_t>(std::max<uint64_t>(slabCells, 2) - 1, nodeDim.z);
+
+  // The brick table is built from the stream too, and lets slabs and bricks which the level does not cross be skipped
+  const GridBrickRanges& ranges = getBrickRanges();
+  const float level = isosurfaceLevel.get();
+
+  std::vector<IsosurfaceMesh> slabMeshes;
+  std::vector<std::vector<uint64_t>> slabEdgeKeys;
+  std::vector<float> slabValues;
+  for (uint32_t zStart = 0; zStart + 1 < nodeDim.z; zStart += static_cast<uint32_t>(slabCells)) {
+    uint32_t zEnd = std::min(zStart + static_cast<uint32_t>(slabCells), nodeDim.z - 1);
+
+    GridBrickRanges slabRanges = ranges.sliceZ(zStart, zEnd);
+    bool slabCrossed = false;
+    for (size_t iBrick = 0; iBrick < slabRanges.nBricks() && !slabCrossed; iBrick++) {
+      slabCrossed = slabRanges.brickStraddles(iBrick, level);
+    }
+    if (!slabCrossed) continue;
 
-  render::engine->setMaterial(*isosurfaceProgram, parent.getMaterial());
-}
+    glm::uvec3 slabNodeDim{nodeDim.x, nodeDim.y, zEnd - zStart + 1};
+    slabValues.resize(nodesPerSlice * slabNodeDim.z);
+    values.readValues(zStart * nodesPerSlice, slabValues.size(), slabValues.data());
 
-SurfaceMesh* VolumeGridNodeScalarQuantity::registerIsosurfaceAsMesh(std::string structureName) {
+    slabMeshes.emplace_back();
+    slabEdgeKeys.emplace_back();
+    marchingCubes(slabValues, slabNodeDim, parent.positionOfNodeIndex(glm::uvec3{0, 0, zStart}),
+                  parent.positionOfNodeIndex(glm::uvec3{nodeDim.x - 1, nodeDim.y - 1, zEnd}), level,
+                  slabMeshes.back(), &slabRanges, &slabEdgeKeys.back());
 
-  // set the name to default
-  if (structureName == "") {
-    structureName = parent.name + " - " + name + " - isosurface";
+    // the slab spans whole node layers, so its keys are offset by the nodes before it
+    for (uint64_t& key : slabEdgeKeys.back()) key += 3 * zStart * nodesPerSlice;
   }
 
-  // extract the mesh
-  MC::mcMesh isosurfaceMesh;
-  MC::marching_cube(&values.data.front(), isosurfaceLevel.get(), parent.getGridNodeDim().x, parent.getGridNodeDim().y,
-                    parent.getGridNodeDim().z, isosurfaceMesh);
-  glm::vec3 scale = parent.gridSpacing();
-  for (auto& p : isosurfaceMesh.vertices) {
-    // swizzle to account for change of coordinate/buffer ordering in the MC lib
-    p = glm::vec3{p.z, p.y, p.x} * scale + parent.getBoundMin();
-  }
+  weldIsosurfacePieces(slabMeshes, slabEdgeKeys, isosurfaceMesh);
+}
 
-  return registerSurfaceMesh(structureName, isosurfaceMesh.vertices,
-                             std::make_tuple(isosurfaceMesh.indices.data(), isosurfaceMesh.indices.size() / 3, 3));
+const GridBrickRanges& VolumeGridNodeScalarQuantity::getBrickRanges() {
+  refreshBrickRanges(brickRanges, brickRangesValuesVersion, values, parent.getGridNodeDim(), true);
+  return brickRanges;
 }
 
 void VolumeGridNodeScalarQuantity::buildNodeInfoGUI(size_t ind) {
@@ -234,89 +227,31 @@ void VolumeGridNodeScalarQuantity::buildNodeInfoGUI(size_t ind) {
   ImGui::NextColumn();
 }
 
-// === Getters and setters
-
-VolumeGridNodeScalarQuantity* VolumeGridNodeScalarQuantity::setGridcubeVizEnabled(bool val) {
-  gridcubeVizEnabled = val;
-  requestRedraw();
-  return this;
-}
-bool VolumeGridNodeScalarQuantity::getGridcubeVizEnabled() { return gridcubeVizEnabled.get(); }
-
-VolumeGridNodeScalarQuantity* VolumeGridNodeScalarQuantity::setIsosurfaceVizEnabled(bool val) {
-  isosurfaceVizEnabled = val;
-  requestRedraw();
-  return this;
-}
-bool VolumeGridNodeScalarQuantity::getIsosurfaceVizEnabled() { return isosurfaceVizEnabled.get(); }
-
-VolumeGridNodeScalarQuantity* VolumeGridNodeScalarQuantity::setIsosurfaceLevel(float val) {
-  isosurfaceLevel = val;
-  isosurfaceProgram.reset(); // delete the program so it gets recreated with the new value
-  requestRedraw();
-  return this;
-}
-float VolumeGridNodeScalarQuantity::getIsosurfaceLevel() { return isosurfaceLevel.get(); }
-
-VolumeGridNodeScalarQuantity* VolumeGridNodeScalarQuantity::setIsosurfaceColor(glm::vec3 val) {
-  isosurfaceColor = val;
-  requestRedraw();
-  return this;
-}
-glm::vec3 VolumeGridNodeScalarQuantity::getIsosurfaceColor() { return isosurfaceColor.get(); }
-
-VolumeGridNodeScalarQuantity* VolumeGridNodeScalarQuantity::setSlicePlanesAffectIsosurface(bool val) {
-  slicePlanesAffectIsosurface = val;
-  isosurfaceProgram.reset(); // delete the program so it gets recreated with the new value
-  requestRedraw();
-  return this;
-}
-bool VolumeGridNodeScalarQuantity::getSlicePlanesAffectIsosurface() { return slicePlanesAffectIsosurface.get(); }
-
 // ========================================================
 // ==========            Cell Scalar             ==========
 // ========================================================
 
 VolumeGridCellScalarQuantity::VolumeGridCellScalarQuantity(std::string name, VolumeGrid& grid_,
                                                            const std::vector<float>& values_, DataType dataType_)
-    : VolumeGridQuantity(name, grid_, true), ScalarQuantity(*this, values_, dataType_),
-      gridcubeVizEnabled(parent.uniquePrefix() + "#" + name + "#gridcubeVizEnabled", true) {
+    : VolumeGridQuantity(name, grid_, true), ScalarQuantity(*this, values_, dataType_), GridScalarQuantity(*this) {
 
   values.setTextureSize(parent.getGridCellDim().x, parent.getGridCellDim().y, parent.getGridCellDim().z);
 }
 
+VolumeGridCellScalarQuantity::VolumeGridCellScalarQuantity(std::string name, VolumeGrid& grid_,
+                                                           std::shared_ptr<RawVolumeFile> file_, DataType dataType_)
+    : VolumeGridCellScalarQuantity(name, grid_, sampleFileValues(*file_), dataType_) {
+  streamValuesFromFile(values, file_);
+}
 
-void VolumeGridCellScalarQuantity::buildCustomUI() {
-
-  // Select which viz to use
-  ImGui::SameLine();
-  if (ImGui::Button("Mode")) {
-    ImGui::OpenPopup("ModePopup");
-  }
-  if (ImGui::BeginPopup("ModePopup")) {
-    // show toggles for each
-    // ImGui::Indent(20);
-    if (ImGui::MenuItem("Gridcube", NULL, &gridcubeVizEnabled.get())) setGridcubeVizEnabled(getGridcubeVizEnabled());
-    // ImGui::Indent(-20);
-    ImGui::EndPopup();
-  }
-
-
-  // == Options popup
-  ImGui::SameLine();
-  if (ImGui::Button("Options")) {
-    ImGui::OpenPopup("OptionsPopup");
-  }
-  if (ImGui::BeginPopup("OptionsPopup")) {
-    buildScalarOptionsUI();
-    ImGui::EndPopup();
-  }
-
-  if (gridcubeVizEnabled.get()) {
-    buildScalarUI();
-  }
+VolumeGridCellScalarQuantity::VolumeGridCellScalarQuantity(std::string name, VolumeGrid& grid_,
+                                                           QuantizedScalarArray values_, DataType dataType_)
+    : VolumeGridCellScalarQuantity(name, grid_, values_.sampleValues(1 << 20), dataType_) {
+  setQuantizedValues(std::move(values_));
 }
 
+void VolumeGridCellScalarQuantity::buildCustomUI() { buildGridScalarUI(); }
+
 std::string VolumeGridCellScalarQuantity::niceName() { return name + " (cell scalar)"; }
 
 bool VolumeGridCellScalarQuantity::isDrawingGridcubes() { return isEnabled() && getGridcubeVizEnabled(); }
@@ -370,6 +305,11 @@ void VolumeGridCellScalarQuantity::createGridcubeProgram() {
   values.getRenderTextureBuffer().get()->setFilterMode(FilterMode::Linear);
 }
 
+const GridBrickRanges& VolumeGridCellScalarQuantity::getBrickRanges() {
+  refreshBrickRanges(brickRanges, brickRangesValuesVersion, values, parent.getGridCellDim(), false);
+  return brickRanges;
+}
+
 void VolumeGridCellScalarQuantity::buildCellInfoGUI(size_t ind) {
   ImGui::TextUnformatted(name.c_str());
   ImGui::NextColumn();
@@ -377,14 +317,4 @@ void VolumeGridCellScalarQuantity::buildCellInfoGUI(size_t ind) {
   ImGui::NextColumn();
 }
 
-// === Getters and setters
-
-VolumeGridCellScalarQuantity* VolumeGridCellScalarQuantity::setGridcubeVizEnabled(bool val) {
-  gridcubeVizEnabled = val;
-  requestRedraw();
-  return this;
-}
-bool VolumeGridCellScalarQuantity::getGridcubeVizEnabled() { return gridcubeVizEnabled.get(); }
-
-
 } // namespace polyscope
@@ -3,7 +3,7 @@
 #include "polyscope/volume_mesh.h"
 
 #include "polyscope/color_management.h"
-#include "polyscope/combining_hash_functions.h"
+#include "polyscope/parallel.h"
 #include "polyscope/pick.h"
 #include "polyscope/polyscope.h"
 #include "polyscope/render/engine.h"
@@ -13,8 +13,8 @@
 #include "imgui.h"
 
 #include <algorithm>
+#include <limits>
 #include <numeric>
-#include <unordered_map>
 #include <utility>
 
 namespace polyscope {
@@ -22,6 +22,12 @@ namespace polyscope {
 // Initialize statics
 const std::string VolumeMesh::structureTypeName = "Volume Mesh";
 
+namespace {
+// Width of the texture which holds vertex positions for slicing. Well under the texture size limit of any GPU, and
+// allows for tens of millions of vertices.
+const uint32_t vertexPositionTextureWidth = 4096;
+} // namespace
+
 // clang-format off
 const std::vector<std::vector<std::array<size_t, 3>>> VolumeMesh::stencilTet = 
  {
@@ -119,6 +125,16 @@ faceType(               this, uniquePrefix() + "faceType",            faceTypeDa
 faceNormals(            this, uniquePrefix() + "faceNormals",         faceNormalsData,        std::bind(&VolumeMesh::computeFaceNormals, this)),
 cellCenters(            this, uniquePrefix() + "cellCenters",         cellCentersData,        std::bind(&VolumeMesh::computeCellCenters, this)),         
 
+// tet decomposition
+tetCornerVertexInds{{
+  {this, uniquePrefix() + "tetCornerVertexInds1", tetCornerVertexIndsData[0], std::bind(&VolumeMesh::computeTetCornerVertexInds, this, 0)},
+  {this, uniquePrefix() + "tetCornerVertexInds2", tetCornerVertexIndsData[1], std::bind(&VolumeMesh::computeTetCornerVertexInds, this, 1)},
+  {this, uniquePrefix() + "tetCornerVertexInds3", tetCornerVertexIndsData[2], std::bind(&VolumeMesh::computeTetCornerVertexInds, this, 2)},
+  {this, uniquePrefix() + "tetCornerVertexInds4", tetCornerVertexIndsData[3], std::bind(&VolumeMesh::computeTetCornerVertexInds, this, 3)},
+}},
+tetVertexInds(          this, uniquePrefix() + "tetVertexInds",       tetVertexIndsData,      std::bind(&VolumeMesh::computeTetVertexInds, this)),
+vertexPositionTexture(  this, uniquePrefix() + "vertexPositionTexture", vertexPositionTextureData, std::bind(&VolumeMesh::computeVertexPositionTexture, this)),
+
 
 // == core input data
 cells(cellIndices_),
@@ -130,6 +146,8 @@ interiorColor(uniquePrefix() + "interiorColor", color.get()),
 edgeColor(uniquePrefix() + "edgeColor", glm::vec3{0., 0., 0.}), 
 material(uniquePrefix() + "material", "clay"),
 edgeWidth(uniquePrefix() + "edgeWidth", 0.), 
+sliceMode(uniquePrefix() + "sliceMode", VolumeMeshSliceMode::Attributes),
+exteriorOnly(uniquePrefix() + "exteriorOnly", true),
 
 // == misc values
 activeLevelSetQuantity(nullptr) 
@@ -147,202 +165,275 @@ activeLevelSetQuantity(nullptr)
   computeCounts();
   computeConnectivityData();
   updateObjectSpaceBounds();
+
+  // the position texture for slicing holds the vertices in rows of a fixed width
+  uint32_t texWidth = std::max<uint32_t>(1, std::min<uint32_t>(nVertices(), vertexPositionTextureWidth));
+  uint32_t texHeight = std::max<uint32_t>(1, (nVertices() + texWidth - 1) / texWidth);
+  vertexPositionTexture.setTextureSize(texWidth, texHeight);
+
+  if (options::precomputeVolumeMeshTets) {
+    computeTetsInBackground();
+  }
 }
 
 void VolumeMesh::computeCounts() {
 
   // == Populate counts
-  nFacesCount = 0;
+  cellFaceStart.resize(nCells() + 1);
+  cellFaceStart[0] = 0;
   nFacesTriangulationCount = 0;
-
-  // == Populate interior/exterior faces
   for (size_t iC = 0; iC < nCells(); iC++) {
-    const std::array<uint32_t, 8>& cell = cells[iC];
-    VolumeCellType cellT = cellType(iC);
-    // Iterate over faces
-    for (const std::vector<std::array<size_t, 3>>& face : cellStencil(cellT)) {
-      nFacesCount++;
+    const std::vector<std::vector<std::array<size_t, 3>>>& stencil = cellStencil(cellType(iC));
+    cellFaceStart[iC + 1] = cellFaceStart[iC] + stencil.size();
+    for (const std::vector<std::array<size_t, 3>>& face : stencil) {
       nFacesTriangulationCount += face.size();
     }
   }
+  nFacesCount = cellFaceStart.back();
+  if (nFacesCount > std::numeric_limits<uint32_t>::max() || nVertices() >= std::numeric_limits<uint32_t>::max()) {
+    exception("VolumeMesh " + name + " has too many faces or vertices to index with 32-bit integers");
+  }
 
-  // == Step 1: count occurences of each face
-  std::unordered_map<std::array<uint32_t, 4>, int, polyscope::hash_combine::hash<std::array<uint32_t, 4>>> faceCounts;
-
-  std::set<size_t> faceInds; // Scratch map
-
-  // Build a sorted list of the indices of this face
+  // == Match up faces between cells
+  // Each face is identified by its sorted vertex indices, padded with nV for triangles. Sorting the faces by these
+  // identifiers brings all copies of a face together, so each run of equal identifiers is one shared face.
 
-  // Helper to build a sorted-index array for a face
-  auto generateSortedFace = [&](const std::array<uint32_t, 8>& cell, const std::vector<std::array<size_t, 3>>& face) {
-    faceInds.clear();
+  const uint32_t nV = static_cast<uint32_t>(nVertices());
+  auto sortedFaceVerts = [&](size_t iF, size_t iC) {
+    const std::array<uint32_t, 8>& cell = cells[iC];
+    const std::vector<std::array<size_t, 3>>& face = cellStencil(cellType(iC))[iF - cellFaceStart[iC]];
+    std::array<uint32_t, 4> verts{nV, nV, nV, nV};
+    int nFound = 0;
     for (const std::array<size_t, 3>& tri : face) {
       for (int j = 0; j < 3; j++) {
-        faceInds.insert(cell[tri[j]]);
+        uint32_t v = cell[tri[j]];
+        if (std::find(verts.begin(), verts.begin() + nFound, v) == verts.begin() + nFound) {
+          verts[nFound] = v;
+          nFound++;
+        }
       }
     }
-    std::array<uint32_t, 4> sortedFace{7777, 7777, 7777, 7777};
-    int j = 0;
-    for (size_t ind : faceInds) {
-      sortedFace[j] = ind;
-      j++;
-    }
-    return sortedFace;
+    std::sort(verts.begin(), verts.begin() + nFound);
+    return verts;
   };
 
-  // Iterate over cells
-  for (size_t iC = 0; iC < nCells(); iC++) {
-    const std::array<uint32_t, 8>& cell = cells[iC];
-    VolumeCellType cellT = cellType(iC);
+  // Pack pairs of vertex indices (including the nV padding) in to 64-bit keys
+  int vertBits = 0;
+  while ((static_cast<uint64_t>(1) << vertBits) <= nV) vertBits++;
+  auto packKey = [&](uint32_t vA, uint32_t vB) { return (static_cast<uint64_t>(vA) << vertBits) | vB; };
 
-    // Iterate over faces
-    for (const std::vector<std::array<size_t, 3>>& face : cellStencil(cellT)) {
-      std::array<uint32_t, 4> sortedFace = generateSortedFace(cell, face);
-      // Add to the count
-      if (faceCounts.find(sortedFace) == faceCounts.end()) {
-        faceCounts[sortedFace] = 0;
-      }
-      faceCounts[sortedFace]++;
+  // Which cell each face belongs to
+  std::vector<uint32_t> faceCell(nFacesCount);
+  parallelFor(nCells(), [&](size_t iC) {
+    for (size_t iF = cellFaceStart[iC]; iF < cellFaceStart[iC + 1]; iF++) {
+      faceCell[iF] = static_cast<uint32_t>(iC);
     }
-  }
-
-  // Iterate a second time; all faces which were seen more than once are inteior
-  faceIsInterior.clear();
-  for (size_t iC = 0; iC < nCells(); iC++) {
-    const std::array<uint32_t, 8>& cell = cells[iC];
-    VolumeCellType cellT = cellType(iC);
+  });
+
+  // Sort lexicographically, with one stable radix sort on the last two vertices of each face followed by another on the
+  // first two. Since the sorts are stable, faces with the same vertices stay in increasing order.
+  std::vector<uint64_t> keys(nFacesCount);
+  std::vector<uint32_t> sortedFaces(nFacesCount);
+  parallelFor(nFacesCount, [&](size_t iF) {
+    std::array<uint32_t, 4> verts = sortedFaceVerts(iF, faceCell[iF]);
+    keys[iF] = packKey(verts[2], verts[3]);
+    sortedFaces[iF] = static_cast<uint32_t>(iF);
+  });
+  radixSortPairs(keys, sortedFaces, 2 * vertBits);
+  parallelFor(nFacesCount, [&](size_t i) {
+    uint32_t iF = sortedFaces[i];
+    std::array<uint32_t, 4> verts = sortedFaceVerts(iF, faceCell[iF]);
+    keys[i] = packKey(verts[0], verts[1]);
+  });
+  radixSortPairs(keys, sortedFaces, 2 * vertBits);
+
+  // Find where each run of equal faces starts
+  std::vector<char> isRunStart(nFacesCount);
+  parallelFor(nFacesCount, [&](size_t i) {
+    if (i == 0 || keys[i] != keys[i - 1]) {
+      isRunStart[i] = true;
+      return;
+    }
+    uint32_t iF = sortedFaces[i];
+    uint32_t iFPrev = sortedFaces[i - 1];
+    isRunStart[i] = sortedFaceVerts(iF, faceCell[iF]) != sortedFaceVerts(iFPrev, faceCell[iFPrev]);
+  });
+
+  // Faces which appear more than once are interior. Each is adjacent to the cell of the first other copy of the face.
+  faceIsInterior.resize(nFacesCount);
+  faceNeighborCell.resize(nFacesCount);
+  parallelForBlocks(nFacesCount, 1024, [&](size_t, size_t blockStart, size_t blockEnd) {
+    // process the runs which start in this block
+    size_t runStart = blockStart;
+    while (runStart < blockEnd && !isRunStart[runStart]) runStart++;
+    while (runStart < blockEnd) {
+      size_t runEnd = runStart + 1;
+      while (runEnd < nFacesCount && !isRunStart[runEnd]) runEnd++;
+
+      bool interior = runEnd - runStart > 1;
+      uint32_t firstF = sortedFaces[runStart];
+      faceIsInterior[firstF] = interior;
+      faceNeighborCell[firstF] = interior ? faceCell[sortedFaces[runStart + 1]] : INVALID_IND_32;
+      for (size_t i = runStart + 1; i < runEnd; i++) {
+        faceIsInterior[sortedFaces[i]] = true;
+        faceNeighborCell[sortedFaces[i]] = faceCell[firstF];
+      }
 
-    // Iterate over faces
-    for (const std::vector<std::array<size_t, 3>>& face : cellStencil(cellT)) {
-      std::array<uint32_t, 4> sortedFace = generateSortedFace(cell, face);
-      faceIsInterior.push_back(faceCounts[sortedFace] > 1);
+      runStart = runEnd;
     }
-  }
+  });
 }
 
 
-void VolumeMesh::computeTets() {
+std::vector<std::array<uint32_t, 4>> VolumeMesh::buildTets() const {
   // Algorithm from
   // https://www.researchgate.net/profile/Julien-Dompierre/publication/221561839_How_to_Subdivide_Pyramids_Prisms_and_Hexahedra_into_Tetrahedra/links/0912f509c0b7294059000000/How-to-Subdivide-Pyramids-Prisms-and-Hexahedra-into-Tetrahedra.pdf?origin=publication_detail
   // It's a bit hard to look at but it works
   // Uses vertex numberings to ensure consistent diagonals between faces, and keeps tet counts to 5 or 6 per hex
-  size_t tetCount = 0;
-  // Get number of tets first
-  for (size_t iC = 0; iC < nCells(); iC++) {
-    switch (cellType(iC)) {
-    case VolumeCellType::HEX: {
-      std::array<size_t, 8> sortedNumbering;
-      std::iota(sortedNumbering.begin(), sortedNumbering.end(), 0);
-      std::sort(sortedNumbering.begin(), sortedNumbering.end(),
-                [this, iC](size_t a, size_t b) -> bool { return cells[iC][a] < cells[iC][b]; });
-      std::array<size_t, 8> rotatedNumbering;
-      std::copy(rotationMap[sortedNumbering[0]].begin(), rotationMap[sortedNumbering[0]].end(),
-                rotatedNumbering.begin());
-      size_t diagCount = 0;
-      auto checkDiagonal = [this, rotatedNumbering, iC](size_t a1, size_t a2, size_t b1, size_t b2) {
-        return (cells[iC][rotatedNumbering[a1]] < cells[iC][rotatedNumbering[b1]] &&
-                cells[iC][rotatedNumbering[a1]] < cells[iC][rotatedNumbering[b2]]) ||
-               (cells[iC][rotatedNumbering[a2]] < cells[iC][rotatedNumbering[b1]] &&
-                cells[iC][rotatedNumbering[a2]] < cells[iC][rotatedNumbering[b2]]);
-      };
-      if (checkDiagonal(1, 7, 2, 5)) {
-        diagCount++;
-      }
-      if (checkDiagonal(3, 7, 2, 6)) {
-        diagCount++;
-      }
-      if (checkDiagonal(4, 7, 5, 6)) {
-        diagCount++;
-      }
-      if (diagCount == 0) {
-        tetCount += 5;
-      } else {
-        tetCount += 6;
-      }
-      break;
+
+  // How a hex gets split: its vertex numbering, rotated such that the tets can be read off from diagonalMap, and the
+  // number of diagonals not incident to V_0
+  struct HexSplit {
+    std::array<uint8_t, 8> numbering;
+    uint8_t diagCount;
+  };
+
+  auto classifyHex = [this](size_t iC) {
+    const std::array<uint32_t, 8>& cell = cells[iC];
+    std::array<size_t, 8> sortedNumbering;
+    std::iota(sortedNumbering.begin(), sortedNumbering.end(), 0);
+    std::sort(sortedNumbering.begin(), sortedNumbering.end(),
+              [&cell](size_t a, size_t b) -> bool { return cell[a] < cell[b]; });
+    std::array<size_t, 8> rotatedNumbering;
+    std::copy(rotationMap[sortedNumbering[0]].begin(), rotationMap[sortedNumbering[0]].end(),
+              rotatedNumbering.begin());
+    size_t n = 0;
+    size_t diagCount = 0;
+    // Diagonal exists on the pair of vertices which contain the minimum vertex number
+    auto checkDiagonal = [&cell, &rotatedNumbering](size_t a1, size_t a2, size_t b1, size_t b2) {
+      return (cell[rotatedNumbering[a1]] < cell[rotatedNumbering[b1]] &&
+              cell[rotatedNumbering[a1]] < cell[rotatedNumbering[b2]]) ||
+             (cell[rotatedNumbering[a2]] < cell[rotatedNumbering[b1]] &&
+              cell[rotatedNumbering[a2]] < cell[rotatedNumbering[b2]]);
+    };
+    // Minimum vertex will always have 3 diagonals, check other three faces
+    if (checkDiagonal(1, 7, 2, 5)) {
+      n += 4;
+      diagCount++;
     }
-    case VolumeCellType::TET:
-      tetCount += 1;
-      break;
+    if (checkDiagonal(3, 7, 2, 6)) {
+      n += 2;
+      diagCount++;
     }
-  }
-  // Mark each edge as real or not (in the original mesh)
-  std::vector<std::array<bool, 6>> realEdges;
-  // Each hex can make up to 6 tets
-  tets.resize(tetCount);
-  realEdges.resize(tetCount);
-  size_t tetIdx = 0;
-  for (size_t iC = 0; iC < nCells(); iC++) {
-    switch (cellType(iC)) {
-    case VolumeCellType::HEX: {
-      std::array<size_t, 8> sortedNumbering;
-      std::iota(sortedNumbering.begin(), sortedNumbering.end(), 0);
-      std::sort(sortedNumbering.begin(), sortedNumbering.end(),
-                [this, iC](size_t a, size_t b) -> bool { return cells[iC][a] < cells[iC][b]; });
-      std::array<size_t, 8> rotatedNumbering;
-      std::copy(rotationMap[sortedNumbering[0]].begin(), rotationMap[sortedNumbering[0]].end(),
-                rotatedNumbering.begin());
-      size_t n = 0;
-      size_t diagCount = 0;
-      // Diagonal exists on the pair of vertices which contain the minimum vertex number
-      auto checkDiagonal = [this, rotatedNumbering, iC](size_t a1, size_t a2, size_t b1, size_t b2) {
-        return (cells[iC][rotatedNumbering[a1]] < cells[iC][rotatedNumbering[b1]] &&
-                cells[iC][rotatedNumbering[a1]] < cells[iC][rotatedNumbering[b2]]) ||
-               (cells[iC][rotatedNumbering[a2]] < cells[iC][rotatedNumbering[b1]] &&
-                cells[iC][rotatedNumbering[a2]] < cells[iC][rotatedNumbering[b2]]);
-      };
-      // Minimum vertex will always have 3 diagonals, check other three faces
-      if (checkDiagonal(1, 7, 2, 5)) {
-        n += 4;
-        diagCount++;
-      }
-      if (checkDiagonal(3, 7, 2, 6)) {
-        n += 2;
-        diagCount++;
-      }
-      if (checkDiagonal(4, 7, 5, 6)) {
-        n += 1;
-        diagCount++;
-      }
-      // Rotate by 120 or 240 degrees depending on diagonal positions
-      if (n == 1 || n == 6) {
-        size_t temp = rotatedNumbering[1];
-        rotatedNumbering[1] = rotatedNumbering[4];
-        rotatedNumbering[4] = rotatedNumbering[3];
-        rotatedNumbering[3] = temp;
-        temp = rotatedNumbering[5];
-        rotatedNumbering[5] = rotatedNumbering[6];
-        rotatedNumbering[6] = rotatedNumbering[2];
-        rotatedNumbering[2] = temp;
-      } else if (n == 2 || n == 5) {
-        size_t temp = rotatedNumbering[1];
-        rotatedNumbering[1] = rotatedNumbering[3];
-        rotatedNumbering[3] = rotatedNumbering[4];
-        rotatedNumbering[4] = temp;
-        temp = rotatedNumbering[5];
-        rotatedNumbering[5] = rotatedNumbering[2];
-        rotatedNumbering[2] = rotatedNumbering[6];
-        rotatedNumbering[6] = temp;
+    if (checkDiagonal(4, 7, 5, 6)) {
+      n += 1;
+      diagCount++;
+    }
+    // Rotate by 120 or 240 degrees depending on diagonal positions
+    if (n == 1 || n == 6) {
+      size_t temp = rotatedNumbering[1];
+      rotatedNumbering[1] = rotatedNumbering[4];
+      rotatedNumbering[4] = rotatedNumbering[3];
+      rotatedNumbering[3] = temp;
+      temp = rotatedNumbering[5];
+      rotatedNumbering[5] = rotatedNumbering[6];
+      rotatedNumbering[6] = rotatedNumbering[2];
+      rotatedNumbering[2] = temp;
+    } else if (n == 2 || n == 5) {
+      size_t temp = rotatedNumbering[1];
+      rotatedNumbering[1] = rotatedNumbering[3];
+      rotatedNumbering[3] = rotatedNumbering[4];
+      rotatedNumbering[4] = temp;
+      temp = rotatedNumbering[5];
+      rotatedNumbering[5] = rotatedNumbering[2];
+      rotatedNumbering[2] = rotatedNumbering[6];
+      rotatedNumbering[6] = temp;
+    }
+
+    HexSplit split;
+    for (size_t i = 0; i < 8; i++) split.numbering[i] = static_cast<uint8_t>(rotatedNumbering[i]);
+    split.diagCount = static_cast<uint8_t>(diagCount);
+    return split;
+  };
+
+  // Classify each cell once, and count the tets it becomes in each block of cells. Both passes use the same blocks,
+  // even if the thread count changes in between (this may run in the background).
+  const size_t nC = cells.size();
+  const ParallelPartition cellBlocks = getParallelPartition(nC, 1024);
+  std::vector<HexSplit> hexSplits(nC);
+  std::vector<size_t> blockTetStart(cellBlocks.nBlocks + 1, 0);
+  parallelForBlocks(cellBlocks, [&](size_t iBlock, size_t blockStart, size_t blockEnd) {
+    size_t count = 0;
+    for (size_t iC = blockStart; iC < blockEnd; iC++) {
+      switch (cellType(iC)) {
+      case VolumeCellType::HEX:
+        hexSplits[iC] = classifyHex(iC);
+        count += hexSplits[iC].diagCount == 0 ? 5 : 6;
+        break;
+      case VolumeCellType::TET:
+        count += 1;
+        break;
       }
+    }
+    blockTetStart[iBlock + 1] = count;
+  });
+
+  // Exclusive prefix sum gives where each block's tets start
+  for (size_t iBlock = 1; iBlock < blockTetStart.size(); iBlock++) {
+    blockTetStart[iBlock] += blockTetStart[iBlock - 1];
+  }
 
-      // Map final tets according to diagonalMap and the number of diagonals not incident to V_0
-      std::array<std::array<size_t, 4>, 6> tetMap = diagonalMap[diagCount];
-      for (size_t k = 0; k < (diagCount == 0 ? 5 : 6); k++) {
+  // Emit the tets
+  std::vector<std::array<uint32_t, 4>> result(blockTetStart.back());
+  parallelForBlocks(cellBlocks, [&](size_t iBlock, size_t blockStart, size_t blockEnd) {
+    size_t tetIdx = blockTetStart[iBlock];
+    for (size_t iC = blockStart; iC < blockEnd; iC++) {
+      const std::array<uint32_t, 8>& cell = cells[iC];
+      switch (cellType(iC)) {
+      case VolumeCellType::HEX: {
+        // Map final tets according to diagonalMap and the number of diagonals not incident to V_0
+        const HexSplit& split = hexSplits[iC];
+        const std::array<std::array<size_t, 4>, 6>& tetMap = diagonalMap[split.diagCount];
+        for (size_t k = 0; k < (split.diagCount == 0 ? 5 : 6); k++) {
+          for (size_t i = 0; i < 4; i++) {
+            result[tetIdx][i] = cell[split.numbering[tetMap[k][i]]];
+          }
+          tetIdx++;
+        }
+        break;
+      }
+      case VolumeCellType::TET:
         for (size_t i = 0; i < 4; i++) {
-          tets[tetIdx][i] = cells[iC][rotatedNumbering[tetMap[k][i]]];
+          result[tetIdx][i] = cell[i];
         }
         tetIdx++;
+        break;
       }
-      break;
-    }
-    case VolumeCellType::TET:
-      for (size_t i = 0; i < 4; i++) {
-        tets[tetIdx][i] = cells[iC][i];
-      }
-      tetIdx++;
-      break;
     }
+  });
+
+  return result;
+}
+
+void VolumeMesh::computeTets() {
+  if (backgroundTetsTask.valid()) {
+    // a background build is already underway, use its result
+    backgroundTetsTask.get();
+    tets = std::move(backgroundTetsResult);
+    backgroundTetsResult.clear();
+  } else {
+    tets = buildTets();
   }
+
+  for (int i = 0; i < 4; i++) {
+    tetCornerVertexInds[i].recomputeIfPopulated();
+  }
+  tetVertexInds.recomputeIfPopulated();
+}
+
+void VolumeMesh::computeTetsInBackground() {
+  if (backgroundTetsTask.valid()) return;
+  backgroundTetsTask = runInBackground([this]() { backgroundTetsResult = buildTets(); });
 }
 
 void VolumeMesh::ensureHaveTets() {
@@ -369,37 +460,30 @@ void VolumeMesh::removeSlicePlaneListener(polyscope::SlicePlane* sp) {
 
 void VolumeMesh::fillSliceGeometryBuffers(render::ShaderProgram& program) {
 
-  // TODO update this to use new standalone buffers
-
-  ensureHaveTets();
-  vertexPositions.ensureHostBufferPopulated();
+  if (program.hasAttribute("a_tetVertexInds")) {
+    // positions get looked up from a texture in the shader
+    program.setAttribute("a_tetVertexInds", tetVertexInds.getRenderAttributeBuffer());
+    program.setTextureFromBuffer("t_vertexPositions", vertexPositionTexture.getRenderTextureBuffer().get());
+    return;
+  }
 
-  // TODO port this to managed buffers
-
-  std::vector<glm::vec3> point1;
-  std::vector<glm::vec3> point2;
-  std::vector<glm::vec3> point3;
-  std::vector<glm::vec3> point4;
-  size_t tetCount = tets.size();
-  point1.resize(tetCount);
-  point2.resize(tetCount);
-  point3.resize(tetCount);
-  point4.resize(tetCount);
-  for (size_t tetIdx = 0; tetIdx < tets.size(); tetIdx++) {
-    point1[tetIdx] = vertexPositions.data[tets[tetIdx][0]];
-    point2[tetIdx] = vertexPositions.data[tets[tetIdx][1]];
-    point3[tetIdx] = vertexPositions.data[tets[tetIdx][2]];
-    point4[tetIdx] = vertexPositions.data[tets[tetIdx][3]];
+  // the slice is computed from the positions themselves, so both sets of attributes can share the same buffers
+  for (int i = 0; i < 4; i++) {
+    std::shared_ptr<render::AttributeBuffer> cornerPositions =
+        vertexPositions.getIndexedRenderAttributeBuffer(tetCornerVertexInds[i]);
+    program.setAttribute("a_point_" + std::to_string(i + 1), cornerPositions);
+    program.setAttribute("a_slice_" + std::to_string(i + 1), cornerPositions);
   }
+}
 
-  program.setAttribute("a_point_1", point1);
-  program.setAttribute("a_point_2", point2);
-  program.setAttribute("a_point_3", point3);
-  program.setAttribute("a_point_4", point4);
-  program.setAttribute("a_slice_1", point1);
-  program.setAttribute("a_slice_2", point2);
-  program.setAttribute("a_slice_3", point3);
-  program.setAttribute("a_slice_4", point4);
+std::string VolumeMesh::getSliceProgramName() {
+  switch (getSliceMode()) {
+  case VolumeMeshSliceMode::Attributes:
+    return "SLICE_TETS";
+  case VolumeMeshSliceMode::PositionTexture:
+    return "SLICE_TETS_TEXTURE";
+  }
+  return "SLICE_TETS";
 }
 
 
@@ -418,6 +502,8 @@ void VolumeMesh::draw() {
     return;
   }
 
+  ensureInteriorFacesMatchSlicing();
+
   render::engine->setBackfaceCull();
 
   // If no quantity is drawing the volume, we should draw it
@@ -477,6 +563,8 @@ void VolumeMesh::drawPick() {
     return;
   }
 
+  ensureInteriorFacesMatchSlicing();
+
   if (pickProgram == nullptr) {
     preparePick();
   }
@@ -509,6 +597,7 @@ void VolumeMesh::preparePick() {
   // Create a new program
   pickProgram = render::engine->requestShader("MESH", addVolumeMeshRules({"MESH_PROPAGATE_PICK_SIMPLE"}),
                                               render::ShaderReplacementDefaults::Pick);
+  trackProgramMemoryUsage(pickProgram); // the pick buffers are owned by the program
 
   fillGeometryBuffers(*pickProgram);
 
@@ -532,14 +621,14 @@ void VolumeMesh::preparePick() {
   std::vector<glm::vec3> faceColor;
 
   // Reserve space
-  vertexColors.resize(3 * nFacesTriangulation());
-  edgeColors.resize(3 * nFacesTriangulation());
-  halfedgeColors.resize(3 * nFacesTriangulation());
-  cornerColors.resize(3 * nFacesTriangulation());
-  faceColor.resize(3 * nFacesTriangulation());
+  vertexColors.resize(3 * nFacesTriangulationDrawn());
+  edgeColors.resize(3 * nFacesTriangulationDrawn());
+  halfedgeColors.resize(3 * nFacesTriangulationDrawn());
+  cornerColors.resize(3 * nFacesTriangulationDrawn());
+  faceColor.resize(3 * nFacesTriangulationDrawn());
 
   size_t iFront = 0;
-  size_t iBack = nFacesTriangulation() - 1;
+  size_t iBack = nFacesTriangulationDrawn() - 1;
   size_t iF = 0;
   for (size_t iC = 0; iC < nCells(); iC++) {
     const std::array<uint32_t, 8>& cell = cells[iC];
@@ -550,6 +639,12 @@ void VolumeMesh::preparePick() {
 
     for (const std::vector<std::array<size_t, 3>>& face : cellStencil(cellT)) {
 
+      // Skip interior faces if they are not in the draw buffers (must match computeConnectivityData())
+      if (faceIsInterior[iF] && !interiorFacesBuilt) {
+        iF++;
+        continue;
+      }
+
       // Emit the actual face in the triangulation
       for (size_t j = 0; j < face.size(); j++) {
         const std::array<size_t, 3>& tri = face[j];
@@ -655,26 +750,44 @@ void VolumeMesh::computeConnectivityData() {
   // To mitigate this issue, we fill the buffer such that all exterior faces come first, then all interior faces, so
   // that exterior faces always win depth ties. This doesn't totally eliminate the problem, but greatly improves the
   // most egregious cases.
+  //
+  // Interior faces are only visible when a slice plane cuts in to the mesh, but in a volume mesh they are nearly all of
+  // the faces. Unless they might be seen (see wantsInteriorFaces()), they are left out of the buffers entirely.
+
+  interiorFacesBuilt = wantsInteriorFaces();
+  if (interiorFacesBuilt) {
+    nFacesTriangulationDrawnCount = nFacesTriangulation();
+  } else {
+    nFacesTriangulationDrawnCount = 0;
+    size_t iF = 0;
+    for (size_t iC = 0; iC < nCells(); iC++) {
+      for (const std::vector<std::array<size_t, 3>>& face : cellStencil(cellType(iC))) {
+        if (!faceIsInterior[iF]) nFacesTriangulationDrawnCount += face.size();
+        iF++;
+      }
+    }
+  }
+  const size_t nTriDrawn = nFacesTriangulationDrawn();
 
   // == Allocate buffers
   triangleVertexInds.data.clear();
-  triangleVertexInds.data.resize(3 * nFacesTriangulation());
+  triangleVertexInds.data.resize(3 * nTriDrawn);
   triangleFaceInds.data.clear();
-  triangleFaceInds.data.resize(3 * nFacesTriangulation());
+  triangleFaceInds.data.resize(3 * nTriDrawn);
   triangleCellInds.data.clear();
-  triangleCellInds.data.resize(3 * nFacesTriangulation());
+  triangleCellInds.data.resize(3 * nTriDrawn);
   triangleCellInds.data.clear();
-  triangleCellInds.data.resize(3 * nFacesTriangulation());
+  triangleCellInds.data.resize(3 * nTriDrawn);
   baryCoord.data.clear();
-  baryCoord.data.resize(3 * nFacesTriangulation());
+  baryCoord.data.resize(3 * nTriDrawn);
   edgeIsReal.data.clear();
-  edgeIsReal.data.resize(3 * nFacesTriangulation());
+  edgeIsReal.data.resize(3 * nTriDrawn);
   faceType.data.clear();
   faceType.data.resize(nFaces());
 
   size_t iF = 0;
   size_t iFront = 0;
-  size_t iBack = nFacesTriangulation() - 1;
+  size_t iBack = nTriDrawn - 1;
   for (size_t iC = 0; iC < nCells(); iC++) {
     const std::array<uint32_t, 8>& cell = cells[iC];
     VolumeCellType cellT = cellType(iC);
@@ -682,6 +795,14 @@ void VolumeMesh::computeConnectivityData() {
     // Loop over all faces of the cell
     for (const std::vector<std::array<size_t, 3>>& face : cellStencil(cellT)) {
 
+      float faceTypeFloat = faceIsInterior[iF] ? 1. : 0.;
+      faceType.data[iF] = faceTypeFloat;
+
+      if (faceIsInterior[iF] && !interiorFacesBuilt) {
+        iF++;
+        continue;
+      }
+
       // Loop over the face's triangulation
       for (size_t j = 0; j < face.size(); j++) {
         const std::array<size_t, 3>& tri = face[j];
@@ -713,9 +834,6 @@ void VolumeMesh::computeConnectivityData() {
         for (int k = 0; k < 3; k++) edgeIsReal.data[3 * iData + k] = edgeRealV;
       }
 
-      float faceTypeFloat = faceIsInterior[iF] ? 1. : 0.;
-      for (int k = 0; k < 3; k++) faceType.data[iF] = faceTypeFloat;
-
       iF++;
     }
   }
@@ -801,6 +919,42 @@ void VolumeMesh::computeCellCenters() {
 }
 
 
+void VolumeMesh::computeTetCornerVertexInds(int iCorner) {
+
+  ensureHaveTets();
+
+  std::vector<uint32_t>& inds = tetCornerVertexInds[iCorner].data;
+  inds.resize(tets.size());
+  parallelFor(tets.size(), [&](size_t iT) { inds[iT] = tets[iT][iCorner]; });
+
+  tetCornerVertexInds[iCorner].markHostBufferUpdated();
+}
+
+void VolumeMesh::computeTetVertexInds() {
+
+  ensureHaveTets();
+
+  tetVertexInds.data.resize(tets.size());
+  parallelFor(tets.size(), [&](size_t iT) {
+    const std::array<uint32_t, 4>& tet = tets[iT];
+    tetVertexInds.data[iT] = glm::uvec4{tet[0], tet[1], tet[2], tet[3]};
+  });
+
+  tetVertexInds.markHostBufferUpdated();
+}
+
+void VolumeMesh::computeVertexPositionTexture() {
+
+  vertexPositions.ensureHostBufferPopulated();
+
+  std::array<uint32_t, 3> texSize = vertexPositionTexture.getTextureSize();
+  vertexPositionTexture.data.resize(static_cast<size_t>(texSize[0]) * texSize[1]);
+  std::copy(vertexPositions.data.begin(), vertexPositions.data.end(), vertexPositionTexture.data.begin());
+
+  vertexPositionTexture.markHostBufferUpdated();
+}
+
+
 VolumeMeshPickResult VolumeMesh::interpretPickResult(const PickResult& rawResult) {
 
   if (rawResult.structure != this) {
@@ -809,15 +963,34 @@ VolumeMeshPickResult VolumeMesh::interpretPickResult(const PickResult& rawResult
     exception("called interpretPickResult(), but the pick result is not from this structure");
   }
 
+  return interpretPickIndex(rawResult.localIndex);
+}
+
+std::vector<VolumeMeshPickResult> VolumeMesh::interpretPickResult(const RegionPickResult& rawResult) {
+
+  if (rawResult.structure != this) {
+    exception("called interpretPickResult(), but the pick result is not from this structure");
+  }
+
+  std::vector<VolumeMeshPickResult> results;
+  results.reserve(rawResult.localIndices.size());
+  for (uint64_t localIndex : rawResult.localIndices) {
+    results.push_back(interpretPickIndex(localIndex));
+  }
+  return results;
+}
+
+VolumeMeshPickResult VolumeMesh::interpretPickIndex(uint64_t localIndex) {
+
   VolumeMeshPickResult result;
 
   // Selection type
-  if (rawResult.localIndex < cellPickIndStart) {
+  if (localIndex < cellPickIndStart) {
     result.elementType = VolumeMeshElement::VERTEX;
-    result.index = rawResult.localIndex;
-  } else if (rawResult.localIndex < nVertices() + nCells()) {
+    result.index = localIndex;
+  } else if (localIndex < nVertices() + nCells()) {
     result.elementType = VolumeMeshElement::CELL;
-    result.index = rawResult.localIndex - cellPickIndStart;
+    result.index = localIndex - cellPickIndStart;
   } else {
     exception("Bad pick index in volume mesh");
   }
@@ -946,6 +1119,16 @@ void VolumeMesh::buildCustomOptionsUI() {
     material.manuallyChanged();
     setMaterial(material.get()); // trigger the other updates that happen on set()
   }
+
+  if (ImGui::BeginMenu("Slice Mode")) {
+    if (ImGui::MenuItem("attributes", NULL, sliceMode.get() == VolumeMeshSliceMode::Attributes))
+      setSliceMode(VolumeMeshSliceMode::Attributes);
+    if (ImGui::MenuItem("position texture", NULL, sliceMode.get() == VolumeMeshSliceMode::PositionTexture))
+      setSliceMode(VolumeMeshSliceMode::PositionTexture);
+    ImGui::EndMenu();
+  }
+
+  if (ImGui::MenuItem("Exterior Only", NULL, getExteriorOnly())) setExteriorOnly(!getExteriorOnly());
 }
 
 
@@ -963,6 +1146,43 @@ void VolumeMesh::refresh() {
   QuantityStructure<VolumeMesh>::refresh(); // call base class version, which refreshes quantities
 }
 
+bool VolumeMesh::wantsInteriorFaces() {
+  if (!getExteriorOnly()) return true;
+
+  // Interior faces can be seen through transparent exterior faces
+  if (getTransparency() < 1.f && render::engine->transparencyEnabled()) return true;
+
+  // ...or through a cut made by a slice plane, if the plane passes through the mesh's bounding box
+  const glm::mat4& T = objectTransform.get();
+  const glm::vec3 bboxMin = std::get<0>(objectSpaceBoundingBox);
+  const glm::vec3 bboxMax = std::get<1>(objectSpaceBoundingBox);
+  for (std::unique_ptr<SlicePlane>& s : state::slicePlanes) {
+    if (!s->getActive() || getIgnoreSlicePlane(s->name)) continue;
+    glm::vec3 center = s->getCenter();
+    glm::vec3 normal = s->getNormal();
+    bool anyBelow = false;
+    bool anyAbove = false;
+    for (int iCorner = 0; iCorner < 8; iCorner++) {
+      glm::vec3 corner{(iCorner & 1) ? bboxMax.x : bboxMin.x, (iCorner & 2) ? bboxMax.y : bboxMin.y,
+                       (iCorner & 4) ? bboxMax.z : bboxMin.z};
+      glm::vec4 worldCorner = T * glm::vec4(corner, 1.);
+      float dist = glm::dot(glm::vec3(worldCorner) / worldCorner.w - center, normal);
+      if (dist < 0.) anyBelow = true;
+      if (dist > 0.) anyAbove = true;
+    }
+    if (anyBelow && anyAbove) return true;
+  }
+  return false;
+}
+
+void VolumeMesh::ensureInteriorFacesMatchSlicing() {
+  if (wantsInteriorFaces() == interiorFacesBuilt) return;
+
+  // The new buffers have a different number of triangles, so all programs drawing them must be rebuilt
+  computeConnectivityData();
+  refresh();
+}
+
 void VolumeMesh::geometryChanged() {
   recomputeGeometryIfPopulated();
   requestRedraw();
@@ -972,6 +1192,7 @@ void VolumeMesh::geometryChanged() {
 void VolumeMesh::recomputeGeometryIfPopulated() {
   faceNormals.recomputeIfPopulated();
   cellCenters.recomputeIfPopulated();
+  vertexPositionTexture.recomputeIfPopulated();
 }
 
 VolumeCellType VolumeMesh::cellType(size_t i) const {
@@ -1024,6 +1245,20 @@ VolumeMesh* VolumeMesh::setInteriorColor(glm::vec3 val) {
 }
 glm::vec3 VolumeMesh::getInteriorColor() { return interiorColor.get(); }
 
+Structure* VolumeMesh::setTransparency(float newVal) {
+  Structure::setTransparency(newVal);
+  ensureInteriorFacesMatchSlicing();
+  return this;
+}
+
+VolumeMesh* VolumeMesh::setExteriorOnly(bool newVal) {
+  exteriorOnly = newVal;
+  ensureInteriorFacesMatchSlicing();
+  requestRedraw();
+  return this;
+}
+bool VolumeMesh::getExteriorOnly() { return exteriorOnly.get(); }
+
 
 VolumeMesh* VolumeMesh::setEdgeColor(glm::vec3 val) {
   edgeColor = val;
@@ -1048,6 +1283,14 @@ VolumeMesh* VolumeMesh::setEdgeWidth(double newVal) {
 }
 double VolumeMesh::getEdgeWidth() { return edgeWidth.get(); }
 
+VolumeMesh* VolumeMesh::setSliceMode(VolumeMeshSliceMode newMode) {
+  sliceMode = newMode;
+  refresh();
+  requestRedraw();
+  return this;
+}
+VolumeMeshSliceMode VolumeMesh::getSliceMode() { return sliceMode.get(); }
+
 
 // === Quantity adder}
 
@@ -57,7 +57,7 @@ void VolumeMeshVertexColorQuantity::drawSlice(polyscope::SlicePlane* sp) {
 std::shared_ptr<render::ShaderProgram> VolumeMeshVertexColorQuantity::createSliceProgram() {
 
   // clang-format off
-  std::shared_ptr<render::ShaderProgram> p = render::engine->requestShader("SLICE_TETS", 
+  std::shared_ptr<render::ShaderProgram> p = render::engine->requestShader(parent.getSliceProgramName(), 
       render::engine->addMaterialRules(parent.getMaterial(),
         addColorRules(
           parent.addVolumeMeshRules(
@@ -72,38 +72,15 @@ std::shared_ptr<render::ShaderProgram> VolumeMeshVertexColorQuantity::createSlic
   parent.fillSliceGeometryBuffers(*p);
   fillSliceColorBuffers(*p);
   render::engine->setMaterial(*p, parent.getMaterial());
+  trackProgramMemoryUsage(p); // the slice buffers are owned by the program
   return p;
 }
 
 void VolumeMeshVertexColorQuantity::fillSliceColorBuffers(render::ShaderProgram& p) {
-
-  // TODO update this to use new standalone buffers
-
-  colors.ensureHostBufferPopulated();
-
-  size_t tetCount = parent.nTets();
-  std::vector<glm::vec3> colorval_1;
-  std::vector<glm::vec3> colorval_2;
-  std::vector<glm::vec3> colorval_3;
-  std::vector<glm::vec3> colorval_4;
-
-  colorval_1.resize(tetCount);
-  colorval_2.resize(tetCount);
-  colorval_3.resize(tetCount);
-  colorval_4.resize(tetCount);
-
-  for (size_t iT = 0; iT < parent.tets.size(); iT++) {
-    colorval_1[iT] = colors.data[parent.tets[iT][0]];
-    colorval_2[iT] = colors.data[parent.tets[iT][1]];
-    colorval_3[iT] = colors.data[parent.tets[iT][2]];
-    colorval_4[iT] = colors.data[parent.tets[iT][3]];
+  for (int i = 0; i < 4; i++) {
+    p.setAttribute("a_value_" + std::to_string(i + 1),
+                   colors.getIndexedRenderAttributeBuffer(parent.tetCornerVertexInds[i]));
   }
-
-  // Store data in buffers
-  p.setAttribute("a_value_1", colorval_1);
-  p.setAttribute("a_value_2", colorval_2);
-  p.setAttribute("a_value_3", colorval_3);
-  p.setAttribute("a_value_4", colorval_4);
 }
 
 void VolumeMeshVertexColorQuantity::createProgram() {
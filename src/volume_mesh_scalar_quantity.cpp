@@ -2,13 +2,165 @@
 
 #include "polyscope/volume_mesh_scalar_quantity.h"
 
+#include "polyscope/parallel.h"
 #include "polyscope/polyscope.h"
 #include "polyscope/render/engine.h"
+#include "polyscope/utilities.h"
 
 #include "imgui.h"
 
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
 namespace polyscope {
 
+namespace {
+
+// Extract the level set of a function which is linear on each tet. A tet with one corner on the other side of the level
+// set from the rest contributes one triangle, and a tet with two corners on each side contributes two. Each triangle
+// corner lies on an edge of the mesh; corners are welded in to vertices by sorting them by their edges.
+VolumeMeshLevelSetMesh marchTets(const std::vector<glm::vec3>& positions, const std::vector<std::array<uint32_t, 4>>& tets,
+                                 const std::vector<float>& values, float isoValue) {
+
+  VolumeMeshLevelSetMesh result;
+  const size_t nTets = tets.size();
+  const size_t minBlockSize = 4096;
+
+  auto isAbove = [&](uint32_t v) { return values[v] > isoValue; };
+  auto tetTriangleCount = [&](const std::array<uint32_t, 4>& tet) {
+    int nAbove = 0;
+    for (int i = 0; i < 4; i++) {
+      if (isAbove(tet[i])) nAbove++;
+    }
+    if (nAbove == 0 || nAbove == 4) return 0;
+    return nAbove == 2 ? 2 : 1;
+  };
+
+  // The level set point on an edge, computed with the endpoints in a fixed order so it does not depend on the tet
+  auto edgePoint = [&](uint32_t vA, uint32_t vB) {
+    if (vA > vB) std::swap(vA, vB);
+    float t = (isoValue - values[vA]) / (values[vB] - values[vA]);
+    return positions[vA] + t * (positions[vB] - positions[vA]);
+  };
+
+  // Edges are keyed by their packed (smaller, larger) vertex indices
+  int vertBits = 0;
+  while ((static_cast<uint64_t>(1) << vertBits) < positions.size()) vertBits++;
+  const uint64_t vertMask = (static_cast<uint64_t>(1) << vertBits) - 1;
+  auto edgeKey = [&](uint32_t vA, uint32_t vB) {
+    if (vA > vB) std::swap(vA, vB);
+    return (static_cast<uint64_t>(vA) << vertBits) | vB;
+  };
+
+  // == Count the triangles from each block of tets, to find where each block writes its output
+  const ParallelPartition tetBlocks = getParallelPartition(nTets, minBlockSize);
+  const size_t nBlocks = tetBlocks.nBlocks;
+  std::vector<size_t> blockTriStart(nBlocks + 1, 0);
+  parallelForBlocks(tetBlocks, [&](size_t iBlock, size_t start, size_t end) {
+    size_t count = 0;
+    for (size_t iT = start; iT < end; iT++) count += tetTriangleCount(tets[iT]);
+    blockTriStart[iBlock + 1] = count;
+  });
+  for (size_t iB = 0; iB < nBlocks; iB++) blockTriStart[iB + 1] += blockTriStart[iB];
+  const size_t nTri = blockTriStart.back();
+  if (3 * nTri > std::numeric_limits<uint32_t>::max()) {
+    exception("level set has too many triangles to index with 32-bit integers");
+  }
+
+  // == Emit triangles, with each corner identified by the key of the edge it lies on
+  std::vector<uint64_t> cornerKeys(3 * nTri);
+  parallelForBlocks(tetBlocks, [&](size_t iBlock, size_t start, size_t end) {
+    size_t iTri = blockTriStart[iBlock];
+    for (size_t iT = start; iT < end; iT++) {
+      const std::array<uint32_t, 4>& tet = tets[iT];
+      if (tetTriangleCount(tet) == 0) continue;
+
+      std::array<uint32_t, 4> above, below;
+      int nAbove = 0;
+      int nBelow = 0;
+      for (int i = 0; i < 4; i++) {
+        if (isAbove(tet[i])) {
+          above[nAbove++] = tet[i];
+        } else {
+          below[nBelow++] = tet[i];
+        }
+      }
+
+      // The polygon where the level set cuts the tet, as the edges its corners lie on, in order around the polygon
+      std::array<std::array<uint32_t, 2>, 4> poly;
+      int nPoly;
+      if (nAbove == 1) {
+        poly = {{{below[0], above[0]}, {below[1], above[0]}, {below[2], above[0]}, {0, 0}}};
+        nPoly = 3;
+      } else if (nAbove == 3) {
+        poly = {{{below[0], above[0]}, {below[0], above[1]}, {below[0], above[2]}, {0, 0}}};
+        nPoly = 3;
+      } else {
+        poly = {{{below[0], above[0]}, {below[0], above[1]}, {below[1], above[1]}, {below[1], above[0]}}};
+        nPoly = 4;
+      }
+
+      // Orient the polygon to face towards larger values. For a linear function, the direction from the centroid of
+      // the lower corners to that of the upper corners is always on the same side as the gradient.
+      glm::vec3 upDir{0., 0., 0.};
+      for (int i = 0; i < nAbove; i++) upDir += positions[above[i]] / static_cast<float>(nAbove);
+      for (int i = 0; i < nBelow; i++) upDir -= positions[below[i]] / static_cast<float>(nBelow);
+      std::array<glm::vec3, 4> p;
+      for (int i = 0; i < nPoly; i++) p[i] = edgePoint(poly[i][0], poly[i][1]);
+      glm::vec3 normal = nPoly == 3 ? glm::cross(p[1] - p[0], p[2] - p[0]) : glm::cross(p[2] - p[0], p[3] - p[1]);
+      if (glm::dot(normal, upDir) < 0) std::reverse(poly.begin(), poly.begin() + nPoly);
+
+      for (int j = 0; j + 2 < nPoly; j++) {
+        cornerKeys[3 * iTri + 0] = edgeKey(poly[0][0], poly[0][1]);
+        cornerKeys[3 * iTri + 1] = edgeKey(poly[j + 1][0], poly[j + 1][1]);
+        cornerKeys[3 * iTri + 2] = edgeKey(poly[j + 2][0], poly[j + 2][1]);
+        iTri++;
+      }
+    }
+  });
+
+  // == Weld corners on the same edge in to one vertex
+  const size_t nCorners = cornerKeys.size();
+  std::vector<uint32_t> sortedCorners(nCorners);
+  std::iota(sortedCorners.begin(), sortedCorners.end(), 0);
+  radixSortPairs(cornerKeys, sortedCorners, 2 * vertBits);
+
+  // Number the runs of equal keys, counting the runs which start in each block and then numbering within each block
+  const ParallelPartition cornerBlocks = getParallelPartition(nCorners, minBlockSize);
+  const size_t nCornerBlocks = cornerBlocks.nBlocks;
+  std::vector<size_t> blockVertStart(nCornerBlocks + 1, 0);
+  auto isRunStart = [&](size_t i) { return i == 0 || cornerKeys[i] != cornerKeys[i - 1]; };
+  parallelForBlocks(cornerBlocks, [&](size_t iBlock, size_t start, size_t end) {
+    size_t count = 0;
+    for (size_t i = start; i < end; i++) {
+      if (isRunStart(i)) count++;
+    }
+    blockVertStart[iBlock + 1] = count;
+  });
+  for (size_t iB = 0; iB < nCornerBlocks; iB++) blockVertStart[iB + 1] += blockVertStart[iB];
+
+  result.vertices.resize(blockVertStart.back());
+  result.triangles.resize(nTri);
+  parallelForBlocks(cornerBlocks, [&](size_t iBlock, size_t start, size_t end) {
+    size_t iVert = blockVertStart[iBlock]; // one past the index of the current run
+    for (size_t i = start; i < end; i++) {
+      if (isRunStart(i)) {
+        uint32_t vA = static_cast<uint32_t>(cornerKeys[i] >> vertBits);
+        uint32_t vB = static_cast<uint32_t>(cornerKeys[i] & vertMask);
+        result.vertices[iVert] = edgePoint(vA, vB);
+        iVert++;
+      }
+      uint32_t iC = sortedCorners[i];
+      result.triangles[iC / 3][iC % 3] = static_cast<uint32_t>(iVert - 1);
+    }
+  });
+
+  return result;
+}
+
+} // namespace
+
 VolumeMeshScalarQuantity::VolumeMeshScalarQuantity(std::string name, VolumeMesh& mesh_, std::string definedOn_,
                                                    const std::vector<float>& values_, DataType dataType_)
     : VolumeMeshQuantity(name, mesh_, true), ScalarQuantity(*this, values_, dataType_), definedOn(definedOn_) {}
@@ -69,46 +221,27 @@ VolumeMeshVertexScalarQuantity::VolumeMeshVertexScalarQuantity(std::string name,
 }
 void VolumeMeshVertexScalarQuantity::fillLevelSetData(render::ShaderProgram& p) {
 
-  // TODO refactor to use new attribute buffers
+  // Slice along the values rather than the positions. The values are stored in the x coordinate of the slice
+  // attributes, and sliced with the vector (1, 0, 0).
 
-  parent.vertexPositions.ensureHostBufferPopulated();
   values.ensureHostBufferPopulated();
+  parent.ensureHaveTets();
+
+  std::array<std::vector<glm::vec3>, 4> sliceVals;
+  for (int i = 0; i < 4; i++) {
+    sliceVals[i].resize(parent.tets.size());
+  }
+  for (size_t iT = 0; iT < parent.tets.size(); iT++) {
+    for (int i = 0; i < 4; i++) {
+      sliceVals[i][iT] = glm::vec3(values.data[parent.tets[iT][i]], 0, 0);
+    }
+  }
 
-  std::vector<glm::vec3> point1;
-  std::vector<glm::vec3> point2;
-  std::vector<glm::vec3> point3;
-  std::vector<glm::vec3> point4;
-  std::vector<glm::vec3> slice1;
-  std::vector<glm::vec3> slice2;
-  std::vector<glm::vec3> slice3;
-  std::vector<glm::vec3> slice4;
-  size_t tetCount = parent.nTets();
-  slice1.resize(tetCount);
-  slice2.resize(tetCount);
-  slice3.resize(tetCount);
-  slice4.resize(tetCount);
-  point1.resize(tetCount);
-  point2.resize(tetCount);
-  point3.resize(tetCount);
-  point4.resize(tetCount);
-  for (size_t i = 0; i < parent.nTets(); i++) {
-    point1[i] = parent.vertexPositions.data[parent.tets[i][0]];
-    point2[i] = parent.vertexPositions.data[parent.tets[i][1]];
-    point3[i] = parent.vertexPositions.data[parent.tets[i][2]];
-    point4[i] = parent.vertexPositions.data[parent.tets[i][3]];
-    slice1[i] = glm::vec3(values.data[parent.tets[i][0]], 0, 0);
-    slice2[i] = glm::vec3(values.data[parent.tets[i][1]], 0, 0);
-    slice3[i] = glm::vec3(values.data[parent.tets[i][2]], 0, 0);
-    slice4[i] = glm::vec3(values.data[parent.tets[i][3]], 0, 0);
+  for (int i = 0; i < 4; i++) {
+    p.setAttribute("a_point_" + std::to_string(i + 1),
+                   parent.vertexPositions.getIndexedRenderAttributeBuffer(parent.tetCornerVertexInds[i]));
+    p.setAttribute("a_slice_" + std::to_string(i + 1), sliceVals[i]);
   }
-  p.setAttribute("a_point_1", point1);
-  p.setAttribute("a_point_2", point2);
-  p.setAttribute("a_point_3", point3);
-  p.setAttribute("a_point_4", point4);
-  p.setAttribute("a_slice_1", slice1);
-  p.setAttribute("a_slice_2", slice2);
-  p.setAttribute("a_slice_3", slice3);
-  p.setAttribute("a_slice_4", slice4);
 }
 
 void VolumeMeshVertexScalarQuantity::setLevelSetUniforms(render::ShaderProgram& p) {
@@ -122,8 +255,7 @@ void VolumeMeshVertexScalarQuantity::draw() {
   auto programToDraw = program;
   if (isDrawingLevelSet) {
     if (levelSetProgram == nullptr) {
-      levelSetProgram = createSliceProgram();
-      fillLevelSetData(*levelSetProgram);
+      levelSetProgram = createLevelSetProgram();
     }
     setLevelSetUniforms(*levelSetProgram);
     programToDraw = levelSetProgram;
@@ -143,6 +275,51 @@ void VolumeMeshVertexScalarQuantity::draw() {
 
 void VolumeMeshVertexScalarQuantity::setLevelSetValue(float f) { levelSetValue = f; }
 
+const VolumeMeshLevelSetMesh& VolumeMeshVertexScalarQuantity::computeLevelSetMesh(float isoValue) {
+
+  // Drop any cached meshes which were computed from old data
+  if (values.getDataVersion() != levelSetMeshCacheValuesVersion ||
+      parent.vertexPositions.getDataVersion() != levelSetMeshCachePositionsVersion) {
+    levelSetMeshCache.clear();
+    levelSetMeshCacheValuesVersion = values.getDataVersion();
+    levelSetMeshCachePositionsVersion = parent.vertexPositions.getDataVersion();
+  }
+
+  for (std::list<std::pair<float, VolumeMeshLevelSetMesh>>::iterator it = levelSetMeshCache.begin();
+       it != levelSetMeshCache.end(); it++) {
+    if (it->first == isoValue) {
+      levelSetMeshCache.splice(levelSetMeshCache.begin(), levelSetMeshCache, it);
+      return levelSetMeshCache.front().second;
+    }
+  }
+
+  values.ensureHostBufferPopulated();
+  parent.vertexPositions.ensureHostBufferPopulated();
+  parent.ensureHaveTets();
+
+  // Keep only a few meshes, dragging the level set value through the UI would otherwise keep every one of them
+  const size_t maxCachedLevelSetMeshes = 4;
+  if (levelSetMeshCache.size() >= maxCachedLevelSetMeshes) {
+    levelSetMeshCache.pop_back();
+  }
+  levelSetMeshCache.emplace_front(isoValue,
+                                  marchTets(parent.vertexPositions.data, parent.tets, values.data, isoValue));
+  return levelSetMeshCache.front().second;
+}
+
+SurfaceMesh* VolumeMeshVertexScalarQuantity::registerLevelSetAsMesh(std::string structureName) {
+
+  // set the name to default
+  if (structureName == "") {
+    structureName = parent.name + " - " + name + " - level set";
+  }
+
+  const VolumeMeshLevelSetMesh& levelSetMesh = computeLevelSetMesh(levelSetValue);
+  SurfaceMesh* surfaceMesh = registerSurfaceMesh(structureName, levelSetMesh.vertices, levelSetMesh.triangles);
+  surfaceMesh->setTransform(parent.getTransform());
+  return surfaceMesh;
+}
+
 void VolumeMeshVertexScalarQuantity::setEnabledLevelSet(bool v) {
   if (v) {
     isDrawingLevelSet = true;
@@ -193,11 +370,11 @@ void VolumeMeshVertexScalarQuantity::setLevelSetVisibleQuantity(std::string name
   // clang-format on
 
   // Fill color buffers
-  parent.fillSliceGeometryBuffers(*levelSetProgram);
   q->fillSliceColorBuffers(*levelSetProgram);
   render::engine->setMaterial(*levelSetProgram, parent.getMaterial());
   fillLevelSetData(*levelSetProgram);
   setLevelSetUniforms(*levelSetProgram);
+  trackProgramMemoryUsage(levelSetProgram);
   showQuantity = q;
 }
 
@@ -210,6 +387,8 @@ void VolumeMeshVertexScalarQuantity::buildScalarOptionsUI() {
   if (ImGui::Checkbox("Level Set", &isDrawingLevelSet)) {
     setEnabledLevelSet(isDrawingLevelSet);
   }
+
+  if (ImGui::MenuItem("Register level set as mesh")) registerLevelSetAsMesh();
 }
 
 void VolumeMeshVertexScalarQuantity::buildCustomUI() {
@@ -262,7 +441,7 @@ void VolumeMeshVertexScalarQuantity::createProgram() {
 
 std::shared_ptr<render::ShaderProgram> VolumeMeshVertexScalarQuantity::createSliceProgram() {
   // clang-format off
-  std::shared_ptr<render::ShaderProgram> p = render::engine->requestShader("SLICE_TETS", 
+  std::shared_ptr<render::ShaderProgram> p = render::engine->requestShader(parent.getSliceProgramName(), 
       render::engine->addMaterialRules(parent.getMaterial(),
         parent.addVolumeMeshRules(
           addScalarRules(
@@ -277,38 +456,36 @@ std::shared_ptr<render::ShaderProgram> VolumeMeshVertexScalarQuantity::createSli
   parent.fillSliceGeometryBuffers(*p);
   fillSliceColorBuffers(*p);
   render::engine->setMaterial(*p, parent.getMaterial());
+  trackProgramMemoryUsage(p); // the slice buffers are owned by the program
   return p;
 }
 
-void VolumeMeshVertexScalarQuantity::fillSliceColorBuffers(render::ShaderProgram& p) {
-
-  // TODO use new attribute buffers
-
-  values.ensureHostBufferPopulated();
-
-  size_t tetCount = parent.nTets();
-  std::vector<float> colorval_1;
-  std::vector<float> colorval_2;
-  std::vector<float> colorval_3;
-  std::vector<float> colorval_4;
+std::shared_ptr<render::ShaderProgram> VolumeMeshVertexScalarQuantity::createLevelSetProgram() {
+  // level sets always slice with attributes, since they slice along the values rather than the positions
+  // clang-format off
+  std::shared_ptr<render::ShaderProgram> p = render::engine->requestShader("SLICE_TETS", 
+      render::engine->addMaterialRules(parent.getMaterial(),
+        parent.addVolumeMeshRules(
+          addScalarRules(
+            {"SLICE_TETS_PROPAGATE_VALUE"}
+          ), 
+        true, true)
+      )
+    );
+  // clang-format on
 
-  colorval_1.resize(tetCount);
-  colorval_2.resize(tetCount);
-  colorval_3.resize(tetCount);
-  colorval_4.resize(tetCount);
+  fillLevelSetData(*p);
+  fillSliceColorBuffers(*p);
+  render::engine->setMaterial(*p, parent.getMaterial());
+  trackProgramMemoryUsage(p);
+  return p;
+}
 
-  for (size_t iT = 0; iT < parent.tets.size(); iT++) {
-    colorval_1[iT] = values.data[parent.tets[iT][0]];
-    colorval_2[iT] = values.data[parent.tets[iT][1]];
-    colorval_3[iT] = values.data[parent.tets[iT][2]];
-    colorval_4[iT] = values.data[parent.tets[iT][3]];
+void VolumeMeshVertexScalarQuantity::fillSliceColorBuffers(render::ShaderProgram& p) {
+  for (int i = 0; i < 4; i++) {
+    p.setAttribute("a_value_" + std::to_string(i + 1),
+                   values.getIndexedRenderAttributeBuffer(parent.tetCornerVertexInds[i]));
   }
-
-  // Store data in buffers
-  p.setAttribute("a_value_1", colorval_1);
-  p.setAttribute("a_value_2", colorval_2);
-  p.setAttribute("a_value_3", colorval_3);
-  p.setAttribute("a_value_4", colorval_4);
   p.setTextureFromColormap("t_colormap", cMap.get());
 }
 
@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include <cmath>
 #include <iostream>
 #include <string>
 
@@ -99,6 +100,25 @@ inline std::tuple<std::vector<glm::vec3>, std::vector<std::vector<size_t>>> getT
   return std::tuple<std::vector<glm::vec3>, std::vector<std::vector<size_t>>>{points, faces};
 };
 
+// A triangulated n x n grid in the xy-plane, with a little bumpiness
+inline std::tuple<std::vector<glm::vec3>, std::vector<std::vector<size_t>>> getGridMesh(size_t n) {
+  std::vector<glm::vec3> points;
+  std::vector<std::vector<size_t>> faces;
+  for (size_t i = 0; i <= n; i++) {
+    for (size_t j = 0; j <= n; j++) {
+      points.emplace_back(i, j, 0.1 * std::sin(0.7 * i + 1.3 * j));
+    }
+  }
+  auto vInd = [&](size_t i, size_t j) { return i * (n + 1) + j; };
+  for (size_t i = 0; i < n; i++) {
+    for (size_t j = 0; j < n; j++) {
+      faces.push_back({vInd(i, j), vInd(i + 1, j), vInd(i + 1, j + 1)});
+      faces.push_back({vInd(i, j), vInd(i + 1, j + 1), vInd(i, j + 1)});
+    }
+  }
+  return std::tuple<std::vector<glm::vec3>, std::vector<std::vector<size_t>>>{points, faces};
+}
+
 inline polyscope::SurfaceMesh* registerTriangleMesh(std::string name = "test1") {
   std::vector<glm::vec3> points;
   std::vector<std::vector<size_t>> faces;
@@ -15,6 +15,7 @@
 #include <array>
 #include <iostream>
 #include <list>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -272,3 +273,220 @@ TEST_F(PolyscopeTest, GroundPlaneTest) {
 
   polyscope::removeAllStructures();
 }
+
+TEST_F(PolyscopeTest, MemoryUsage) {
+
+  auto psMesh = registerTriangleMesh();
+  std::vector<double> vScalar(psMesh->nVertices(), 7.);
+  auto q1 = psMesh->addVertexScalarQuantity("vScalar", vScalar);
+  q1->setEnabled(true);
+  polyscope::show(3);
+
+  // the vertex positions alone are at least this large, both on the host and on the device
+  polyscope::MemoryUsage meshUsage = polyscope::getMemoryUsage(psMesh, false);
+  EXPECT_GE(meshUsage.hostBytes, static_cast<int64_t>(psMesh->nVertices() * sizeof(glm::vec3)));
+  EXPECT_GE(meshUsage.deviceBytes, static_cast<int64_t>(psMesh->nVertices() * sizeof(glm::vec3)));
+
+  // quantities are counted separately
+  polyscope::MemoryUsage qUsage = polyscope::getMemoryUsage(q1);
+  EXPECT_GE(qUsage.hostBytes, static_cast<int64_t>(psMesh->nVertices() * sizeof(float)));
+  EXPECT_GT(qUsage.deviceBytes, 0);
+  polyscope::MemoryUsage allUsage = polyscope::getMemoryUsage(psMesh);
+  EXPECT_EQ(allUsage.hostBytes, meshUsage.hostBytes + qUsage.hostBytes);
+
+  // one report row for the structure and one for the quantity
+  std::vector<polyscope::MemoryUsageEntry> report = polyscope::getMemoryUsageReport();
+  EXPECT_EQ(report.size(), 2);
+  polyscope::MemoryUsage total = polyscope::getTotalMemoryUsage();
+  EXPECT_GE(total.deviceBytes, allUsage.deviceBytes);
+
+  // picking adds the pick buffers
+  polyscope::pickAtBufferInds(glm::ivec2(77, 88));
+  EXPECT_GT(polyscope::getMemoryUsage(psMesh, false).deviceBytes, meshUsage.deviceBytes);
+
+  polyscope::removeAllStructures();
+  EXPECT_EQ(polyscope::getTotalMemoryUsage().hostBytes, 0);
+
+  // attribute buffers are counted by their allocation, which at least doubles when it grows
+  int64_t deviceBytesBefore = polyscope::getTotalMemoryUsage().deviceBytes;
+  std::shared_ptr<polyscope::render::AttributeBuffer> buffer =
+      polyscope::render::engine->generateAttributeBuffer(polyscope::RenderDataType::Vector3Float);
+  buffer->setData(std::vector<glm::vec3>(100));
+  buffer->setData(std::vector<glm::vec3>(101));
+  EXPECT_EQ(buffer->getDataSizeInBytes(), static_cast<int64_t>(101 * sizeof(glm::vec3)));
+  EXPECT_EQ(buffer->getAllocatedSizeInBytes(), static_cast<int64_t>(200 * sizeof(glm::vec3)));
+  EXPECT_EQ(polyscope::getTotalMemoryUsage().deviceBytes - deviceBytesBefore,
+            static_cast<int64_t>(200 * sizeof(glm::vec3)));
+}
+
+TEST_F(PolyscopeTest, HostMemoryBudget) {
+
+  auto psMesh = registerTriangleMesh();
+  polyscope::show(3);
+  psMesh->faceNormals.ensureHostBufferPopulated();
+  glm::vec3 normal0 = psMesh->faceNormals.getValue(0);
+  int64_t bytesBefore = polyscope::render::getTotalManagedBufferHostBytes();
+
+  // with a budget of zero, everything which can be restored gets evicted at the end of the frame
+  polyscope::options::hostMemoryBudget = 0;
+  polyscope::show(1);
+  EXPECT_LT(polyscope::render::getTotalManagedBufferHostBytes(), bytesBefore);
+  EXPECT_EQ(psMesh->faceNormals.data.size(), 0);
+
+  // user data which lives only on the host is never dropped
+  EXPECT_EQ(psMesh->vertexPositions.data.size(), psMesh->nVertices());
+
+  // evicted computed data is recomputed on demand
+  EXPECT_EQ(psMesh->faceNormals.getValue(0), normal0);
+  psMesh->faceNormals.ensureHostBufferPopulated();
+  EXPECT_EQ(psMesh->faceNormals.data.size(), psMesh->nFaces());
+
+  // calling directly reports the number of bytes freed (buffers with queued uploads are not evicted until they are sent)
+  polyscope::render::engine->flushUploadQueue();
+  EXPECT_GT(polyscope::render::enforceHostMemoryBudget(0), 0);
+  EXPECT_EQ(polyscope::render::enforceHostMemoryBudget(-1), 0);
+
+  polyscope::options::hostMemoryBudget = -1;
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, HostMemoryBudgetWireframe) {
+
+  // the wireframe draws expanded attributes, which are computed from the positions and can be recomputed
+  auto psMesh = registerTriangleMesh();
+  psMesh->setEdgeWidth(1.);
+  polyscope::show(3);
+  psMesh->faceNormals.ensureHostBufferPopulated();
+  glm::vec3 normal0 = psMesh->faceNormals.getValue(0);
+
+  polyscope::options::hostMemoryBudget = 0;
+  polyscope::show(1);
+  EXPECT_EQ(psMesh->faceNormals.data.size(), 0);
+  EXPECT_EQ(psMesh->vertexPositions.data.size(), psMesh->nVertices());
+  EXPECT_EQ(psMesh->faceNormals.getValue(0), normal0);
+
+  // drawing again restores whatever the wireframe program needs
+  polyscope::show(1);
+  EXPECT_EQ(psMesh->vertexPositions.data.size(), psMesh->nVertices());
+
+  psMesh->setEdgeWidth(0.); // the edge width persists for later meshes with the same name
+  polyscope::options::hostMemoryBudget = -1;
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, PickRangeReuse) {
+
+  // allocate pick ranges for a bunch of small structures
+  std::vector<polyscope::PointCloud*> clouds;
+  for (int i = 0; i < 20; i++) {
+    clouds.push_back(registerPointCloud("cloud" + std::to_string(i)));
+  }
+  polyscope::pickAtBufferInds(glm::ivec2(77, 88));
+  uint64_t nextIndBefore = polyscope::state::globalContext.nextPickBufferInd;
+
+  // lookups map back to the right structure
+  for (polyscope::PointCloud* cloud : clouds) {
+    uint64_t globalInd = polyscope::pick::localIndexToGlobal({cloud, 2});
+    std::pair<polyscope::Structure*, uint64_t> local = polyscope::pick::globalIndexToLocal(globalInd);
+    EXPECT_EQ(local.first, cloud);
+    EXPECT_EQ(local.second, 2);
+  }
+  EXPECT_EQ(polyscope::pick::globalIndexToLocal(0).first, nullptr);
+  EXPECT_EQ(polyscope::pick::globalIndexToLocal(nextIndBefore).first, nullptr);
+
+  // repeatedly removing and re-registering structures recycles their ranges
+  for (int iter = 0; iter < 10; iter++) {
+    for (int i = 0; i < 20; i += 3) {
+      polyscope::removeStructure("cloud" + std::to_string(i));
+    }
+    polyscope::pickAtBufferInds(glm::ivec2(77, 88));
+    for (int i = 0; i < 20; i += 3) {
+      clouds[i] = registerPointCloud("cloud" + std::to_string(i));
+    }
+    polyscope::pickAtBufferInds(glm::ivec2(77, 88));
+    EXPECT_LE(polyscope::state::globalContext.nextPickBufferInd, nextIndBefore);
+
+    // the index of released ranges by size matches the ranges
+    const std::map<uint64_t, uint64_t>& freeRanges = polyscope::state::globalContext.freePickRanges;
+    const std::multimap<uint64_t, uint64_t>& bySize = polyscope::state::globalContext.freePickRangesBySize;
+    ASSERT_EQ(bySize.size(), freeRanges.size());
+    for (const std::pair<const uint64_t, uint64_t>& sizeAndStart : bySize) {
+      ASSERT_EQ(freeRanges.count(sizeAndStart.second), 1u);
+      EXPECT_EQ(freeRanges.at(sizeAndStart.second) - sizeAndStart.second, sizeAndStart.first);
+    }
+  }
+
+  for (polyscope::PointCloud* cloud : clouds) {
+    uint64_t globalInd = polyscope::pick::localIndexToGlobal({cloud, 3});
+    EXPECT_EQ(polyscope::pick::globalIndexToLocal(globalInd).first, cloud);
+  }
+
+  // removing everything gives back all of the indices
+  polyscope::removeAllStructures();
+  EXPECT_EQ(polyscope::state::globalContext.nextPickBufferInd, 1);
+  EXPECT_TRUE(polyscope::state::globalContext.freePickRanges.empty());
+  EXPECT_TRUE(polyscope::state::globalContext.freePickRangesBySize.empty());
+}
+
+TEST_F(PolyscopeTest, PickWindowCache) {
+  registerPointCloud();
+  polyscope::show(3);
+  polyscope::Context& ctx = polyscope::state::globalContext;
+
+  // a pick renders a window around the pixel
+  polyscope::pickAtBufferInds(glm::ivec2(77, 88));
+  EXPECT_TRUE(ctx.pickCacheValid);
+  glm::ivec4 window = ctx.pickCacheWindow;
+  EXPECT_EQ(window[2], polyscope::options::pickWindowSize);
+  EXPECT_EQ(ctx.pickCacheColors.size(), window[2] * window[3]);
+
+  // nearby queries on an unchanged scene re-use it, even across frames
+  polyscope::show(1);
+  polyscope::pickAtBufferInds(glm::ivec2(80, 85));
+  EXPECT_EQ(ctx.pickCacheWindow, window);
+
+  // far-away queries render a new window
+  glm::ivec2 farPixel{polyscope::view::bufferWidth - 5, 5};
+  polyscope::pickAtBufferInds(farPixel);
+  EXPECT_NE(ctx.pickCacheWindow, window);
+
+  // changes to the scene invalidate it
+  polyscope::requestRedraw();
+  EXPECT_NE(ctx.pickCacheSceneGeneration, ctx.sceneGeneration);
+  polyscope::pickAtBufferInds(farPixel);
+  EXPECT_EQ(ctx.pickCacheSceneGeneration, ctx.sceneGeneration);
+
+  // the old whole-buffer path still works
+  polyscope::options::pickWindowSize = 0;
+  polyscope::pickAtBufferInds(glm::ivec2(77, 88));
+  polyscope::options::pickWindowSize = 1;
+  polyscope::pickAtBufferInds(glm::ivec2(77, 88));
+  EXPECT_EQ(ctx.pickCacheColors.size(), 1);
+  polyscope::options::pickWindowSize = 32;
+
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, RenderSubWindowProjection) {
+  polyscope::show(3);
+
+  // a point which lands at some pixel of the full buffer lands at the same pixel, relative to the window, when only
+  // a window of the buffer is rendered
+  glm::vec4 worldPos{0.1, 0.2, 0.3, 1.};
+  glm::mat4 viewMat = polyscope::view::getCameraViewMatrix();
+  float W = polyscope::view::bufferWidth;
+  float H = polyscope::view::bufferHeight;
+  glm::vec4 clipFull = polyscope::view::getCameraPerspectiveMatrix() * viewMat * worldPos;
+  glm::vec2 pixelFull{(clipFull.x / clipFull.w + 1.) / 2. * W, (clipFull.y / clipFull.w + 1.) / 2. * H};
+
+  glm::ivec4 window{50, 40, 16, 24};
+  polyscope::view::setRenderSubWindow(window);
+  glm::vec4 clipWindow = polyscope::view::getCameraPerspectiveMatrix() * viewMat * worldPos;
+  polyscope::view::clearRenderSubWindow();
+  glm::vec2 pixelWindow{(clipWindow.x / clipWindow.w + 1.) / 2. * window[2],
+                        (clipWindow.y / clipWindow.w + 1.) / 2. * window[3]};
+
+  EXPECT_NEAR(pixelWindow.x, pixelFull.x - window[0], 1e-2);
+  EXPECT_NEAR(pixelWindow.y, pixelFull.y - window[1], 1e-2);
+  EXPECT_NEAR(clipWindow.z / clipWindow.w, clipFull.z / clipFull.w, 1e-6);
+}
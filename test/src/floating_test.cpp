@@ -38,6 +38,23 @@ TEST_F(PolyscopeTest, FloatingImageTest) {
     polyscope::show(3);
   }
 
+  { // ScalarImageQuantity, quantized
+    std::vector<uint8_t> stored(dimX * dimY);
+    for (size_t i = 0; i < stored.size(); i++) stored[i] = static_cast<uint8_t>(i % 200);
+    polyscope::ScalarQuantization quant;
+    quant.type = polyscope::QuantizedScalarType::UInt8;
+    quant.scale = 0.01;
+    quant.offset = -1.;
+    polyscope::ScalarImageQuantity* im = polyscope::addScalarImageQuantityQuantized(
+        "im scalar quantized", dimX, dimY, stored, quant, polyscope::ImageOrigin::UpperLeft);
+    EXPECT_TRUE(im->values.hasTextureEncoding());
+    EXPECT_FLOAT_EQ(im->values.getValue(250), 0.01f * 50 - 1.f);
+    polyscope::show(3);
+    im->setShowFullscreen(true);
+    im->setIsolinesEnabled(true);
+    polyscope::show(3);
+  }
+
   { // ColorImageQuantity
     std::vector<std::array<float, 3>> valsRGB(dimX * dimY, std::array<float, 3>{0.44, 0.55, 0.66});
     polyscope::ColorImageQuantity* im =
@@ -33,3 +33,256 @@ TEST_F(PolyscopeTest, ManagedBufferAccess) {
 
   polyscope::removeAllStructures();
 }
+
+TEST_F(PolyscopeTest, ManagedBufferPartialUpdate) {
+
+  auto psPoints = registerPointCloud("test_cloud1");
+  std::vector<double> vScalar(psPoints->nPoints(), 7.);
+  auto q2 = psPoints->addScalarQuantity("vScalar", vScalar);
+  q2->setEnabled(true);
+  polyscope::show(3); // ensure render buffers exist
+
+  // update a single range, only that entry is sent
+  polyscope::render::ManagedBuffer<glm::vec3>& bufferPos = psPoints->getManagedBuffer<glm::vec3>("points");
+  bufferPos.ensureHostBufferPopulated();
+  bufferPos.data[1] = glm::vec3{0.5, 0.5, 0.5};
+  bufferPos.markHostBufferUpdated(1, 1);
+  polyscope::show(1);
+  EXPECT_EQ(polyscope::render::engine->getUploadStats().uploadCount, 1);
+  EXPECT_EQ(polyscope::render::engine->getUploadStats().uploadBytes, sizeof(glm::vec3));
+  EXPECT_EQ(bufferPos.size(), psPoints->nPoints());
+  EXPECT_EQ(bufferPos.getValue(1), glm::vec3(0.5, 0.5, 0.5));
+
+  // accumulate several ranges and send them together
+  polyscope::render::ManagedBuffer<float>& bufferScalar = q2->getManagedBuffer<float>("values");
+  bufferScalar.ensureHostBufferPopulated();
+  bufferScalar.data[0] = 1.;
+  bufferScalar.data[2] = 3.;
+  bufferScalar.data[3] = 4.;
+  bufferScalar.markHostBufferRangeDirty(0, 1);
+  bufferScalar.markHostBufferRangeDirty(2, 1);
+  bufferScalar.markHostBufferRangeDirty(3, 1);
+  bufferScalar.markHostBufferDirtyRangesUpdated();
+  polyscope::show(1);
+  EXPECT_EQ(bufferScalar.getValue(0), 1.);
+  EXPECT_EQ(bufferScalar.getValue(1), 7.);
+  EXPECT_EQ(bufferScalar.getValue(2), 3.);
+  EXPECT_EQ(bufferScalar.getValue(3), 4.);
+
+  // the adjacent ranges are merged, so there are two uploads
+  EXPECT_EQ(polyscope::render::engine->getUploadStats().uploadCount, 2);
+  EXPECT_EQ(polyscope::render::engine->getUploadStats().uploadBytes, 3 * sizeof(float));
+
+  // out of bounds ranges are an error
+  EXPECT_THROW(bufferPos.markHostBufferUpdated(3, 5), std::runtime_error);
+
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, ManagedBufferPartialUpdateTexture) {
+
+  uint32_t dimX = 8;
+  uint32_t dimY = 10;
+  uint32_t dimZ = 12;
+  polyscope::VolumeGrid* psGrid =
+      polyscope::registerVolumeGrid("test grid", {dimX, dimY, dimZ}, glm::vec3{-3., -3., -3.}, glm::vec3{3., 3., 3.});
+  std::vector<float> vals(psGrid->nNodes(), 0.44);
+  polyscope::VolumeGridNodeScalarQuantity* q = psGrid->addNodeScalarQuantity("vals", vals);
+  q->setEnabled(true);
+  polyscope::show(3);
+
+  polyscope::render::ManagedBuffer<float>& buffer = q->getManagedBuffer<float>("values");
+  buffer.ensureHostBufferPopulated();
+
+  // within a row, spanning rows, and spanning slices
+  buffer.data[3] = 1.;
+  buffer.data[dimX + 5] = 2.;
+  buffer.data[dimX * dimY] = 3.;
+  buffer.markHostBufferRangeDirty(2, 3);
+  buffer.markHostBufferRangeDirty(dimX + 4, 2 * dimX);
+  buffer.markHostBufferRangeDirty(dimX * dimY - 3, dimX * dimY);
+  buffer.markHostBufferDirtyRangesUpdated();
+  polyscope::show(1);
+  EXPECT_EQ(buffer.data.size(), psGrid->nNodes());
+  EXPECT_EQ(buffer.getValue(3), 1.);
+  EXPECT_EQ(buffer.getValue(dimX + 5), 2.);
+  EXPECT_EQ(buffer.getValue(dimX * dimY), 3.);
+
+  // each range is sent as the smallest box which covers it: part of a row, three whole rows, and two whole slices
+  EXPECT_EQ(polyscope::render::engine->getUploadStats().uploadCount, 3);
+  EXPECT_EQ(polyscope::render::engine->getUploadStats().uploadBytes, (3 + 3 * dimX + 2 * dimX * dimY) * sizeof(float));
+
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, ManagedBufferPartialUpdateIndexed) {
+
+  auto psMesh = registerTriangleMesh();
+  std::vector<double> vScalar(psMesh->nVertices(), 7.);
+  auto q1 = psMesh->addVertexScalarQuantity("vScalar", vScalar);
+  q1->setEnabled(true);
+  polyscope::show(3); // ensure the indexed views exist
+
+  // the inverse index map should list exactly the corners which use each vertex
+  polyscope::render::ManagedBuffer<uint32_t>& inds = psMesh->triangleVertexInds;
+  const polyscope::render::IndexInverseMap& inverse = inds.getInverseIndexMap();
+  ASSERT_EQ(inverse.start.size(), psMesh->nVertices() + 1);
+  EXPECT_EQ(inverse.slots.size(), inds.size());
+  for (size_t iV = 0; iV < psMesh->nVertices(); iV++) {
+    for (uint32_t i = inverse.start[iV]; i < inverse.start[iV + 1]; i++) {
+      EXPECT_EQ(inds.getValue(inverse.slots[i]), iV);
+    }
+  }
+
+  // update a few vertex values, which re-gathers only the affected corners
+  polyscope::render::ManagedBuffer<float>& bufferScalar = q1->getManagedBuffer<float>("values");
+  bufferScalar.ensureHostBufferPopulated();
+  bufferScalar.data[1] = 3.;
+  bufferScalar.markHostBufferUpdated(1, 1);
+  polyscope::show(1);
+  EXPECT_EQ(bufferScalar.getValue(1), 3.);
+
+  // at most the corners of that vertex are sent (or just the vertex value, when drawing from shared vertices)
+  size_t nCorners = inverse.start[2] - inverse.start[1];
+  EXPECT_GE(polyscope::render::engine->getUploadStats().uploadBytes, sizeof(float));
+  EXPECT_LE(polyscope::render::engine->getUploadStats().uploadBytes, nCorners * sizeof(float));
+
+  // the inverse map is only defined for index buffers
+  EXPECT_THROW(bufferScalar.getInverseIndexMap(), std::runtime_error);
+
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, ManagedBufferExternalData) {
+
+  auto psPoints = registerPointCloud("test_cloud1");
+  size_t nPts = psPoints->nPoints();
+  polyscope::show(3);
+
+  // wrap caller-owned memory, with an ownership token to keep it alive
+  std::shared_ptr<std::vector<glm::vec3>> extPos =
+      std::make_shared<std::vector<glm::vec3>>(nPts, glm::vec3{1., 2., 3.});
+  polyscope::render::ManagedBuffer<glm::vec3>& bufferPos = psPoints->getManagedBuffer<glm::vec3>("points");
+  bufferPos.setExternalData(extPos->data(), extPos->size(), extPos);
+  EXPECT_TRUE(bufferPos.hasExternalData());
+  EXPECT_EQ(bufferPos.size(), nPts);
+  EXPECT_EQ(bufferPos.getValue(1), glm::vec3(1., 2., 3.));
+  EXPECT_EQ(bufferPos.data.size(), 0); // no host copy
+  psPoints->updateObjectSpaceBounds();
+  EXPECT_TRUE(bufferPos.hasExternalData());
+  polyscope::show(3);
+
+  // modify in place, and partial updates
+  (*extPos)[2] = glm::vec3{4., 5., 6.};
+  bufferPos.markHostBufferUpdated(2, 1);
+  EXPECT_EQ(bufferPos.getValue(2), glm::vec3(4., 5., 6.));
+  polyscope::show(3);
+
+  // needing the host vector copies the values in and releases the memory
+  bufferPos.ensureHostBufferPopulated();
+  EXPECT_FALSE(bufferPos.hasExternalData());
+  EXPECT_EQ(bufferPos.data.size(), nPts);
+  EXPECT_EQ(bufferPos.data[2], glm::vec3(4., 5., 6.));
+
+  // also works for indexed data on a mesh
+  auto psMesh = registerTriangleMesh();
+  std::vector<float> extScalar(psMesh->nVertices(), 3.);
+  auto q1 = psMesh->addVertexScalarQuantity("vScalar", std::vector<double>(psMesh->nVertices(), 7.));
+  q1->setEnabled(true);
+  polyscope::show(3);
+  q1->getManagedBuffer<float>("values").setExternalData(extScalar.data(), extScalar.size());
+  polyscope::show(3);
+  q1->getManagedBuffer<float>("values").releaseExternalData();
+
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, ManagedBufferDeferredUpload) {
+
+  auto psPoints = registerPointCloud("test_cloud1");
+  polyscope::show(3);
+  polyscope::render::ManagedBuffer<glm::vec3>& bufferPos = psPoints->getManagedBuffer<glm::vec3>("points");
+  bufferPos.ensureHostBufferPopulated();
+
+  // many updates within one frame are coalesced in to a single queued upload
+  for (int i = 0; i < 10; i++) {
+    bufferPos.data[0] = glm::vec3{i, 0., 0.};
+    bufferPos.markHostBufferUpdated();
+  }
+  bufferPos.markHostBufferUpdated(1, 1);
+  EXPECT_TRUE(bufferPos.hasQueuedDeviceUpload());
+  EXPECT_EQ(polyscope::render::engine->getUploadQueueSize(), 1);
+  EXPECT_EQ(bufferPos.getValue(0), glm::vec3(9., 0., 0.));
+
+  polyscope::show(1);
+  EXPECT_FALSE(bufferPos.hasQueuedDeviceUpload());
+  const polyscope::render::UploadStats& stats = polyscope::render::engine->getUploadStats();
+  EXPECT_GE(stats.queuedRequests, 11);
+  EXPECT_LT(stats.queuedUploads, stats.queuedRequests);
+  EXPECT_GE(stats.uploadBytes, bufferPos.size() * sizeof(glm::vec3));
+
+  // uploads happen immediately when deferral is disabled
+  polyscope::options::deferRenderUploads = false;
+  bufferPos.markHostBufferUpdated();
+  EXPECT_FALSE(bufferPos.hasQueuedDeviceUpload());
+  polyscope::options::deferRenderUploads = true;
+
+  // picking sends pending updates before rendering
+  bufferPos.markHostBufferUpdated();
+  polyscope::pickAtBufferInds(glm::ivec2(77, 88));
+  EXPECT_FALSE(bufferPos.hasQueuedDeviceUpload());
+
+  // getting the render buffer sends its pending update, so it can be used right away
+  bufferPos.markHostBufferUpdated();
+  bufferPos.getRenderAttributeBuffer();
+  EXPECT_FALSE(bufferPos.hasQueuedDeviceUpload());
+  EXPECT_EQ(polyscope::render::engine->getUploadQueueSize(), 0);
+
+  // removing a structure drops its pending uploads
+  bufferPos.markHostBufferUpdated();
+  polyscope::removeAllStructures();
+  EXPECT_EQ(polyscope::render::engine->getUploadQueueSize(), 0);
+}
+
+TEST_F(PolyscopeTest, ManagedBufferTextureReadback) {
+
+  uint32_t dimX = 8;
+  uint32_t dimY = 10;
+  uint32_t dimZ = 12;
+  polyscope::VolumeGrid* psGrid =
+      polyscope::registerVolumeGrid("test grid", {dimX, dimY, dimZ}, glm::vec3{-3., -3., -3.}, glm::vec3{3., 3., 3.});
+  std::vector<float> vals(psGrid->nNodes(), 0.44);
+  polyscope::VolumeGridNodeScalarQuantity* q = psGrid->addNodeScalarQuantity("vals", vals);
+  q->setEnabled(true);
+  polyscope::show(3);
+
+  // pretend the texture was written directly on the device, so the values only live there
+  polyscope::render::ManagedBuffer<float>& buffer = q->getManagedBuffer<float>("values");
+  buffer.getRenderTextureBuffer();
+  buffer.markRenderTextureBufferUpdated();
+  EXPECT_EQ(buffer.data.size(), 0);
+
+  // synchronous copy-back
+  buffer.getValue(3);
+  EXPECT_EQ(buffer.data.size(), psGrid->nNodes());
+
+  // asynchronous copy-back
+  buffer.markRenderTextureBufferUpdated();
+  polyscope::render::ManagedBufferReadback<float> readback = buffer.ensureHostBufferPopulatedAsync();
+  polyscope::show(1); // the frame is not blocked by the readback
+  readback.wait();
+  EXPECT_TRUE(readback.isReady());
+  EXPECT_EQ(buffer.data.size(), psGrid->nNodes());
+
+  // a readback which is superseded by a host-side update does not overwrite it
+  buffer.markRenderTextureBufferUpdated();
+  readback = buffer.ensureHostBufferPopulatedAsync();
+  buffer.ensureHostBufferAllocated();
+  buffer.data[0] = 7.;
+  buffer.markHostBufferUpdated();
+  readback.wait();
+  EXPECT_EQ(buffer.getValue(0), 7.);
+
+  polyscope::removeAllStructures();
+  readback.wait(); // no-op after the buffer is gone
+}
@@ -2,6 +2,11 @@
 
 #include "polyscope_test.h"
 
+#include "polyscope/parallel.h"
+
+#include <atomic>
+#include <vector>
+
 // ============================================================
 // =============== Scalar Quantity Tests
 // ============================================================
@@ -41,3 +46,147 @@ TEST_F(PolyscopeTest, FlatMaterialTest) {
 
   polyscope::removeAllStructures();
 }
+
+// ============================================================
+// =============== Spatial Index Tests
+// ============================================================
+
+TEST_F(PolyscopeTest, TriangleBVHMatchesBruteForce) {
+  std::vector<glm::vec3> points;
+  std::vector<std::vector<size_t>> faces;
+  std::tie(points, faces) = getGridMesh(20);
+  std::vector<uint32_t> triInds;
+  for (const std::vector<size_t>& f : faces) {
+    for (size_t i = 1; i + 1 < f.size(); i++) {
+      triInds.push_back(f[0]);
+      triInds.push_back(f[i]);
+      triInds.push_back(f[i + 1]);
+    }
+  }
+
+  polyscope::TriangleBVH bvh;
+  bvh.build(points, triInds);
+  EXPECT_EQ(bvh.nTriangles(), triInds.size() / 3);
+
+  // compare against testing every triangle
+  auto bruteForce = [&](glm::vec3 start, glm::vec3 dir) {
+    float tBest = std::numeric_limits<float>::infinity();
+    for (size_t iT = 0; iT < triInds.size() / 3; iT++) {
+      polyscope::TriangleBVH single;
+      single.build(points, {triInds[3 * iT], triInds[3 * iT + 1], triInds[3 * iT + 2]});
+      polyscope::RayHit hit = single.intersect(start, dir);
+      if (hit.hit) tBest = std::min(tBest, hit.t);
+    }
+    return tBest;
+  };
+
+  for (int iRay = 0; iRay < 50; iRay++) {
+    glm::vec3 start{22. * polyscope::randomUnit() - 1., 22. * polyscope::randomUnit() - 1., 2.};
+    glm::vec3 target{22. * polyscope::randomUnit() - 1., 22. * polyscope::randomUnit() - 1., 0.};
+    glm::vec3 dir = target - start;
+    polyscope::RayHit hit = bvh.intersect(start, dir);
+    float tExpected = bruteForce(start, dir);
+    EXPECT_EQ(hit.hit, tExpected < std::numeric_limits<float>::infinity());
+    if (hit.hit) {
+      EXPECT_FLOAT_EQ(hit.t, tExpected);
+      glm::vec3 pA = points[triInds[3 * hit.index + 0]];
+      glm::vec3 pB = points[triInds[3 * hit.index + 1]];
+      glm::vec3 pC = points[triInds[3 * hit.index + 2]];
+      glm::vec3 fromBary = hit.baryCoords.x * pA + hit.baryCoords.y * pB + hit.baryCoords.z * pC;
+      EXPECT_LT(glm::length(fromBary - (start + hit.t * dir)), 1e-4);
+    }
+  }
+
+  // refitting follows moved vertices
+  for (glm::vec3& p : points) p.z += 1.;
+  bvh.refit(points);
+  glm::vec3 start{5.5, 5.5, 3.};
+  glm::vec3 dir{0.1, -0.2, -1.};
+  polyscope::RayHit hit = bvh.intersect(start, dir);
+  EXPECT_FLOAT_EQ(hit.t, bruteForce(start, dir));
+}
+
+TEST_F(PolyscopeTest, PointKDTreeMatchesBruteForce) {
+  std::vector<glm::vec3> points;
+  for (int i = 0; i < 1000; i++) {
+    points.push_back(glm::vec3{polyscope::randomUnit(), polyscope::randomUnit(), polyscope::randomUnit()});
+  }
+  std::vector<float> radii; // a few large ones, so the per-node radius bounds differ
+  for (size_t i = 0; i < points.size(); i++) {
+    radii.push_back(i % 100 == 0 ? 20. : 0.5 + polyscope::randomUnit());
+  }
+
+  polyscope::PointKDTree tree;
+  tree.build(points);
+  EXPECT_EQ(tree.nPoints(), points.size());
+  tree.setRadii(radii);
+  EXPECT_TRUE(tree.hasRadii());
+
+  float radiusScale = 0.01;
+  for (int iRay = 0; iRay < 50; iRay++) {
+    glm::vec3 start{polyscope::randomUnit(), polyscope::randomUnit(), 3.};
+    glm::vec3 dir{0.1 * polyscope::randomUnit(), 0.1 * polyscope::randomUnit(), -1.};
+    polyscope::RayHit hit = tree.intersectSpheres(start, dir, radiusScale);
+
+    // brute force
+    float tBest = std::numeric_limits<float>::infinity();
+    size_t iBest = 0;
+    for (size_t iP = 0; iP < points.size(); iP++) {
+      polyscope::PointKDTree single;
+      single.build({points[iP]});
+      polyscope::RayHit singleHit = single.intersectSpheres(start, dir, radiusScale * radii[iP]);
+      if (singleHit.hit && singleHit.t < tBest) {
+        tBest = singleHit.t;
+        iBest = iP;
+      }
+    }
+
+    EXPECT_EQ(hit.hit, tBest < std::numeric_limits<float>::infinity());
+    if (hit.hit) {
+      EXPECT_EQ(hit.index, iBest);
+      EXPECT_FLOAT_EQ(hit.t, tBest);
+    }
+  }
+}
+
+TEST_F(PolyscopeTest, ParallelPartitionSharedAcrossPasses) {
+  int oldMaxThreads = polyscope::options::maxThreads;
+  polyscope::options::maxThreads = 8;
+
+  // Count per block, then fill at the per-block offsets, as in VolumeMesh::buildTets()
+  const size_t n = 100000;
+  polyscope::ParallelPartition blocks = polyscope::getParallelPartition(n, 1000);
+  EXPECT_EQ(blocks.nBlocks, 8u);
+  std::vector<size_t> blockStart(blocks.nBlocks + 1, 0);
+  polyscope::parallelForBlocks(blocks, [&](size_t iBlock, size_t start, size_t end) {
+    size_t count = 0;
+    for (size_t i = start; i < end; i++) count += i % 3 == 0 ? 2 : 1;
+    blockStart[iBlock + 1] = count;
+  });
+  for (size_t iB = 0; iB < blocks.nBlocks; iB++) blockStart[iB + 1] += blockStart[iB];
+
+  // The thread count changes between the passes, the blocks do not
+  polyscope::options::maxThreads = 3;
+  std::vector<size_t> result(blockStart.back());
+  std::atomic<size_t> nCalls{0};
+  polyscope::parallelForBlocks(blocks, [&](size_t iBlock, size_t start, size_t end) {
+    nCalls++;
+    size_t iOut = blockStart[iBlock];
+    for (size_t i = start; i < end; i++) {
+      for (size_t k = 0; k < (i % 3 == 0 ? 2u : 1u); k++) result[iOut++] = i;
+    }
+    EXPECT_EQ(iOut, blockStart[iBlock + 1]);
+  });
+  EXPECT_EQ(nCalls.load(), blocks.nBlocks);
+
+  size_t iOut = 0;
+  for (size_t i = 0; i < n; i++) {
+    for (size_t k = 0; k < (i % 3 == 0 ? 2u : 1u); k++) {
+      ASSERT_EQ(result[iOut], i);
+      iOut++;
+    }
+  }
+  EXPECT_EQ(iOut, result.size());
+
+  polyscope::options::maxThreads = oldMaxThreads;
+}
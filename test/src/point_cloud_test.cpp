@@ -44,6 +44,52 @@ TEST_F(PolyscopeTest, PointCloudUpdateGeometry) {
   polyscope::removeAllStructures();
 }
 
+TEST_F(PolyscopeTest, PointCloudExternalPositions) {
+  std::shared_ptr<std::vector<glm::vec3>> positions = std::make_shared<std::vector<glm::vec3>>(getPoints());
+
+  // the positions are read in place, with no host-side copy
+  polyscope::PointCloud* psPoints =
+      polyscope::registerPointCloudExternal("external", positions->data(), positions->size(), positions);
+  EXPECT_EQ(psPoints->nPoints(), positions->size());
+  EXPECT_TRUE(psPoints->points.hasExternalData());
+  EXPECT_EQ(psPoints->points.data.size(), 0);
+  EXPECT_EQ(psPoints->points.getValue(2), (*positions)[2]);
+  polyscope::show(3);
+  EXPECT_TRUE(psPoints->points.hasExternalData());
+
+  // modified in place, the owner given with the update is kept
+  (*positions)[2] = glm::vec3{3., 0., 1.};
+  std::shared_ptr<int> owner = std::make_shared<int>(0);
+  psPoints->updatePointPositionsExternal(positions->data(), positions->size(), owner);
+  EXPECT_EQ(psPoints->points.getValue(2), glm::vec3(3., 0., 1.));
+  EXPECT_EQ(owner.use_count(), 2);
+  psPoints->updatePointPositionsExternal(positions->data(), positions->size(), positions);
+  EXPECT_EQ(owner.use_count(), 1);
+  polyscope::show(3);
+
+  // different memory, which the point cloud keeps alive
+  std::shared_ptr<std::vector<glm::vec3>> newPositions =
+      std::make_shared<std::vector<glm::vec3>>(positions->size(), glm::vec3{1., 2., 3.});
+  psPoints->updatePointPositionsExternal(newPositions->data(), newPositions->size(), newPositions);
+  std::weak_ptr<std::vector<glm::vec3>> oldPositions = positions;
+  positions.reset();
+  EXPECT_TRUE(oldPositions.expired());
+  EXPECT_EQ(psPoints->points.getValue(0), glm::vec3(1., 2., 3.));
+  EXPECT_EQ(psPoints->points.data.size(), 0);
+  polyscope::show(3);
+
+  // ray picking reads the positions in place too
+  polyscope::PickResult result = polyscope::rayPick(glm::vec3{1., 2., 5.}, glm::vec3{0., 0., -1.});
+  EXPECT_TRUE(result.isHit);
+  EXPECT_TRUE(psPoints->points.hasExternalData());
+  EXPECT_EQ(psPoints->points.data.size(), 0);
+
+  // the number of points can't change
+  EXPECT_THROW(psPoints->updatePointPositionsExternal(newPositions->data(), 2), std::runtime_error);
+
+  polyscope::removeAllStructures();
+}
+
 TEST_F(PolyscopeTest, PointCloudAppearance) {
   auto psPoints = registerPointCloud();
 
@@ -74,6 +120,93 @@ TEST_F(PolyscopeTest, PointCloudPick) {
   polyscope::removeAllStructures();
 }
 
+TEST_F(PolyscopeTest, PointCloudRayPick) {
+  auto psPoints = registerPointCloud();
+
+  // straight down the z axis, (0, 0, 1) is in front of (0, 0, 0)
+  polyscope::PickResult result = polyscope::rayPick(glm::vec3{0., 0., 5.}, glm::vec3{0., 0., -1.});
+  ASSERT_TRUE(result.isHit);
+  EXPECT_EQ(result.structure, psPoints);
+  EXPECT_EQ(psPoints->interpretPickResult(result).index, 2);
+  EXPECT_NEAR(result.depth, 4. - psPoints->getPointRadius(), 1e-4);
+
+  // moving the points is picked up
+  std::vector<glm::vec3> newPoints = getPoints();
+  newPoints[2] = glm::vec3{3., 0., 1.};
+  psPoints->updatePointPositions(newPoints);
+  result = polyscope::rayPick(glm::vec3{0., 0., 5.}, glm::vec3{0., 0., -1.});
+  ASSERT_TRUE(result.isHit);
+  EXPECT_EQ(psPoints->interpretPickResult(result).index, 3);
+
+  // so is writing the host buffer directly
+  psPoints->points.ensureHostBufferPopulated();
+  psPoints->points.data[3] = glm::vec3{3., 3., 0.};
+  psPoints->points.data[0] = glm::vec3{0., 0., 2.};
+  psPoints->points.markHostBufferUpdated();
+  result = polyscope::rayPick(glm::vec3{0., 0., 5.}, glm::vec3{0., 0., -1.});
+  ASSERT_TRUE(result.isHit);
+  EXPECT_EQ(psPoints->interpretPickResult(result).index, 0);
+
+  // missing everything, and through the screen
+  result = polyscope::rayPick(glm::vec3{10., 10., 5.}, glm::vec3{0., 0., -1.});
+  EXPECT_FALSE(result.isHit);
+  polyscope::rayPickAtScreenCoords(glm::vec2{77., 88.});
+
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, PointCloudPickRegion) {
+  auto psPoints = registerPointCloud();
+
+  // Same as above, just make sure region picks don't crash
+  polyscope::pickInRectangle(glm::ivec2(10, 20), glm::ivec2(110, 70));
+  polyscope::pickInPolygon({{10., 20.}, {110., 30.}, {60., 90.}}, 10.);
+
+  // Decode a read-back window which spans two structures. The window holds rows from the bottom of the buffer up.
+  polyscope::PointCloud* psOther = registerPointCloud("other");
+  polyscope::pickAtBufferInds(glm::ivec2(77, 88)); // so both have pick ranges
+  glm::ivec2 minInds{10, 20};
+  glm::ivec2 maxInds{13, 22};
+  std::vector<std::array<float, 4>> colors(12, std::array<float, 4>{0., 0., 0., 1.});
+  std::vector<float> depths(12, 0.9);
+  auto setPixel = [&](int xInd, int yInd, polyscope::Structure* s, uint64_t localInd, float depth) {
+    size_t iPixel = static_cast<size_t>(maxInds.y - yInd) * 4 + (xInd - minInds.x);
+    glm::vec3 color = polyscope::pick::indToVec(polyscope::pick::localIndexToGlobal({s, localInd}));
+    colors[iPixel] = {color.x, color.y, color.z, 1.};
+    depths[iPixel] = depth;
+  };
+  setPixel(10, 20, psOther, 3, 0.5);
+  setPixel(11, 20, psPoints, 2, 0.5);
+  setPixel(12, 21, psOther, 1, 0.5);
+  setPixel(13, 21, psPoints, 2, 0.4); // nearer than the first pixel of the same point
+  setPixel(10, 22, psPoints, 0, 0.5);
+  setPixel(13, 22, psPoints, 1, 0.5); // outside of the region
+  auto inRegion = [](int xInd, int yInd) { return !(xInd == 13 && yInd == 22); };
+  std::vector<polyscope::RegionPickResult> regionResults =
+      polyscope::pick::decodePickRegion(colors, depths, minInds, maxInds, inRegion, -1.);
+
+  ASSERT_EQ(regionResults.size(), 2);
+  EXPECT_EQ(regionResults[0].structure, psOther); // sorted by name
+  EXPECT_EQ(regionResults[0].localIndices, (std::vector<uint64_t>{1, 3}));
+  EXPECT_EQ(regionResults[1].structure, psPoints);
+  EXPECT_EQ(regionResults[1].localIndices, (std::vector<uint64_t>{0, 2}));
+  glm::vec3 nearest = polyscope::view::screenCoordsAndDepthToWorldPosition(
+      polyscope::view::bufferIndsToScreenCoords(glm::ivec2{13, 21}), 0.4);
+  EXPECT_LT(glm::length(regionResults[1].positions[1] - nearest), 1e-4);
+  EXPECT_EQ(regionResults[1].depths.size(), 2);
+
+  polyscope::RegionPickResult raw;
+  raw.structure = psPoints;
+  raw.localIndices = {0, 2, 3};
+  raw.positions.resize(3);
+  raw.depths.resize(3);
+  std::vector<polyscope::PointCloudPickResult> results = psPoints->interpretPickResult(raw);
+  ASSERT_EQ(results.size(), 3);
+  EXPECT_EQ(results[1].index, 2);
+
+  polyscope::removeAllStructures();
+}
+
 
 TEST_F(PolyscopeTest, PointCloudColor) {
   auto psPoints = registerPointCloud();
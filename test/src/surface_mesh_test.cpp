@@ -121,6 +121,143 @@ TEST_F(PolyscopeTest, SurfaceMeshPick) {
   polyscope::removeAllStructures();
 }
 
+TEST_F(PolyscopeTest, SurfaceMeshPickAllElements) {
+  auto psMesh = registerTriangleMesh();
+
+  // use every element type, so the full pick shader is used
+  std::vector<size_t> ePerm = {5, 3, 1, 2, 4, 0};
+  psMesh->setEdgePermutation(ePerm);
+  psMesh->markHalfedgesAsUsed();
+  std::vector<size_t> cPerm;
+  for (size_t i = 0; i < psMesh->nCorners(); i++) {
+    cPerm.push_back(psMesh->nCorners() - 1 - i);
+  }
+  psMesh->setCornerPermutation(cPerm);
+  polyscope::pickAtBufferInds(glm::ivec2(77, 88));
+
+  // corner picks are reported with the internal corner index
+  size_t cornerPickStart = psMesh->nVertices() + psMesh->nFaces() + psMesh->nEdges() + psMesh->nHalfedges();
+  polyscope::PickResult raw;
+  raw.isHit = true;
+  raw.structure = psMesh;
+  raw.localIndex = cornerPickStart + cPerm[2];
+  polyscope::SurfaceMeshPickResult result = psMesh->interpretPickResult(raw);
+  EXPECT_EQ(result.elementType, polyscope::MeshElement::CORNER);
+  EXPECT_EQ(result.index, 2);
+
+  // same for batches of picks from a region
+  polyscope::RegionPickResult rawRegion;
+  rawRegion.structure = psMesh;
+  rawRegion.localIndices = {1, psMesh->nVertices() + 2, cornerPickStart + cPerm[2], cornerPickStart + cPerm[4]};
+  rawRegion.positions.resize(rawRegion.localIndices.size());
+  rawRegion.depths.resize(rawRegion.localIndices.size());
+  std::vector<polyscope::SurfaceMeshPickResult> results = psMesh->interpretPickResult(rawRegion);
+  ASSERT_EQ(results.size(), 4);
+  EXPECT_EQ(results[0].elementType, polyscope::MeshElement::VERTEX);
+  EXPECT_EQ(results[0].index, 1);
+  EXPECT_EQ(results[1].elementType, polyscope::MeshElement::FACE);
+  EXPECT_EQ(results[1].index, 2);
+  EXPECT_EQ(results[2].elementType, polyscope::MeshElement::CORNER);
+  EXPECT_EQ(results[2].index, 2);
+  EXPECT_EQ(results[3].index, 4);
+
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, SurfaceMeshRayPick) {
+  std::vector<glm::vec3> points;
+  std::vector<std::vector<size_t>> faces;
+  std::tie(points, faces) = getGridMesh(10);
+  auto psMesh = polyscope::registerSurfaceMesh("grid", points, faces);
+
+  // hit the middle of a face, with exact barycentric coordinates
+  glm::vec3 target = (points[faces[7][0]] + points[faces[7][1]] + points[faces[7][2]]) / 3.f;
+  glm::vec3 start = target + glm::vec3{0.1, 0.2, 2.};
+  polyscope::PickResult result = polyscope::rayPick(start, target - start);
+  ASSERT_TRUE(result.isHit);
+  EXPECT_EQ(result.structure, psMesh);
+  EXPECT_LT(glm::length(result.position - target), 1e-4);
+  polyscope::SurfaceMeshPickResult meshResult = psMesh->interpretPickResult(result);
+  EXPECT_EQ(meshResult.elementType, polyscope::MeshElement::FACE);
+  EXPECT_EQ(meshResult.index, 7);
+  EXPECT_NEAR(meshResult.baryCoords.x, 1. / 3., 1e-4);
+
+  // near a vertex picks the vertex
+  glm::vec3 nearVertex = 0.95f * points[faces[7][1]] + 0.05f * target;
+  start = nearVertex + glm::vec3{0., 0., 2.};
+  result = polyscope::rayPick(start, nearVertex - start);
+  ASSERT_TRUE(result.isHit);
+  meshResult = psMesh->interpretPickResult(result);
+  EXPECT_EQ(meshResult.elementType, polyscope::MeshElement::VERTEX);
+  EXPECT_EQ(meshResult.index, faces[7][1]);
+
+  // updated positions and transforms are respected
+  for (glm::vec3& p : points) p.z += 5.;
+  psMesh->updateVertexPositions(points);
+  psMesh->setPosition(glm::vec3{0., 0., -5.});
+  start = target + glm::vec3{0., 0., 2.};
+  result = polyscope::rayPick(start, glm::vec3{0., 0., -1.});
+  ASSERT_TRUE(result.isHit);
+  EXPECT_NEAR(result.depth, 2., 1e-4);
+
+  // as are positions written to the host buffer directly
+  psMesh->vertexPositions.ensureHostBufferPopulated();
+  for (glm::vec3& p : psMesh->vertexPositions.data) p.z += 1.;
+  psMesh->vertexPositions.markHostBufferUpdated();
+  result = polyscope::rayPick(start, glm::vec3{0., 0., -1.});
+  ASSERT_TRUE(result.isHit);
+  EXPECT_NEAR(result.depth, 1., 1e-4);
+
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, SurfaceMeshRayPickNeverDrawn) {
+  // the pick index ranges are usually set up when the mesh is drawn for picking, which never happens here
+  std::vector<glm::vec3> points;
+  std::vector<std::vector<size_t>> faces;
+  std::tie(points, faces) = getGridMesh(10);
+  polyscope::registerPointCloud("other", points);
+  auto psMesh = polyscope::registerSurfaceMesh("grid", points, faces);
+
+  glm::vec3 target = (points[faces[3][0]] + points[faces[3][1]] + points[faces[3][2]]) / 3.f;
+  polyscope::PickResult result = polyscope::rayPick(target + glm::vec3{0., 0., 2.}, glm::vec3{0., 0., -1.});
+  ASSERT_TRUE(result.isHit);
+  EXPECT_EQ(result.structure, psMesh);
+  polyscope::SurfaceMeshPickResult meshResult = psMesh->interpretPickResult(result);
+  EXPECT_EQ(meshResult.elementType, polyscope::MeshElement::FACE);
+  EXPECT_EQ(meshResult.index, 3);
+
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, SurfaceMeshRayPickAfterEviction) {
+  std::vector<glm::vec3> points;
+  std::vector<std::vector<size_t>> faces;
+  std::tie(points, faces) = getGridMesh(10);
+  auto psMesh = polyscope::registerSurfaceMesh("grid", points, faces);
+  polyscope::show(3);
+
+  // build the BVH, then drop the host copies it was built from
+  glm::vec3 target = (points[faces[7][0]] + points[faces[7][1]] + points[faces[7][2]]) / 3.f;
+  ASSERT_TRUE(polyscope::rayPick(target + glm::vec3{0., 0., 2.}, glm::vec3{0., 0., -1.}).isHit);
+  polyscope::options::hostMemoryBudget = 0;
+  polyscope::show(1);
+  EXPECT_EQ(psMesh->triangleVertexInds.data.size(), 0);
+
+  glm::vec3 nearVertex = 0.95f * points[faces[7][1]] + 0.05f * target;
+  polyscope::PickResult result = polyscope::rayPick(nearVertex + glm::vec3{0., 0., 2.}, glm::vec3{0., 0., -1.});
+  ASSERT_TRUE(result.isHit);
+  EXPECT_EQ(psMesh->triangleVertexInds.data.size(), 3 * psMesh->nFacesTriangulation());
+
+  // (the mock backend does not keep device values, so the restored indices cannot be checked here)
+  polyscope::SurfaceMeshPickResult meshResult = psMesh->interpretPickResult(result);
+  EXPECT_EQ(meshResult.elementType, polyscope::MeshElement::VERTEX);
+  EXPECT_LT(meshResult.index, psMesh->nVertices());
+
+  polyscope::options::hostMemoryBudget = -1;
+  polyscope::removeAllStructures();
+}
+
 TEST_F(PolyscopeTest, SurfaceMeshMark) {
   auto psMesh = registerTriangleMesh();
 
@@ -259,6 +396,138 @@ TEST_F(PolyscopeTest, SurfaceMeshScalarCategoricalFace) {
   polyscope::removeAllStructures();
 }
 
+TEST_F(PolyscopeTest, SurfaceMeshEdgeConnectivity) {
+
+  // a triangulated grid, so every interior edge is shared by two faces
+  size_t n = 40;
+  std::vector<glm::vec3> points;
+  std::vector<std::vector<size_t>> faces;
+  std::tie(points, faces) = getGridMesh(n);
+  auto psMesh = polyscope::registerSurfaceMesh("grid", points, faces);
+
+  size_t expectedEdges = 2 * n * (n + 1) + n * n;
+  EXPECT_EQ(psMesh->nEdges(), expectedEdges);
+
+  psMesh->ensureHaveManifoldConnectivity();
+  size_t nBoundary = 0;
+  for (size_t iHe = 0; iHe < psMesh->nHalfedges(); iHe++) {
+    size_t twin = psMesh->twinHalfedge[iHe];
+    if (twin == polyscope::INVALID_IND) {
+      nBoundary++;
+      continue;
+    }
+    EXPECT_EQ(psMesh->twinHalfedge[twin], iHe);
+  }
+  EXPECT_EQ(nBoundary, 4 * n);
+
+  // a reversed edge ordering
+  std::vector<size_t> ePerm(expectedEdges);
+  for (size_t i = 0; i < expectedEdges; i++) ePerm[i] = expectedEdges - 1 - i;
+  psMesh->setEdgePermutation(ePerm);
+  auto q = psMesh->addEdgeScalarQuantity("eScalar", std::vector<double>(expectedEdges, 1.));
+  q->setEnabled(true);
+  polyscope::show(3);
+
+  // edge indices follow the permutation
+  psMesh->triangleAllEdgeInds.ensureHostBufferPopulated();
+  const std::vector<uint32_t>& edgeInds = psMesh->triangleAllEdgeInds.data;
+  ASSERT_EQ(edgeInds.size(), 9 * psMesh->nFaces());
+  EXPECT_EQ(edgeInds[0], expectedEdges - 1); // first edge of the first face is canonical edge 0
+
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, SurfaceMeshParallelGeometry) {
+  std::vector<glm::vec3> points;
+  std::vector<std::vector<size_t>> faces;
+  std::tie(points, faces) = getGridMesh(60);
+  auto psMesh = polyscope::registerSurfaceMesh("grid", points, faces);
+
+  auto computeAll = [&]() {
+    psMesh->vertexNormals.ensureHostBufferPopulated();
+    psMesh->vertexAreas.ensureHostBufferPopulated();
+    psMesh->faceCenters.ensureHostBufferPopulated();
+    return std::make_tuple(psMesh->vertexNormals.data, psMesh->vertexAreas.data, psMesh->faceCenters.data);
+  };
+
+  // results must not depend on the number of threads
+  int oldMaxThreads = polyscope::options::maxThreads;
+  polyscope::options::maxThreads = 1;
+  auto serial = computeAll();
+  polyscope::options::maxThreads = 4;
+  psMesh->refresh();
+  auto parallel = computeAll();
+  EXPECT_TRUE(serial == parallel);
+
+  // and are recomputed when positions change
+  for (glm::vec3& p : points) p *= 2.;
+  psMesh->updateVertexPositions(points);
+  auto scaled = computeAll();
+  EXPECT_NEAR(std::get<1>(scaled)[100], 4. * std::get<1>(serial)[100], 1e-4);
+
+  polyscope::options::maxThreads = oldMaxThreads;
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, SurfaceMeshIndexedDraw) {
+  std::vector<glm::vec3> points;
+  std::vector<std::vector<size_t>> faces;
+  std::tie(points, faces) = getGridMesh(20);
+  auto psMesh = polyscope::registerSurfaceMesh("grid", points, faces);
+  std::vector<double> vScalar(psMesh->nVertices(), 7.);
+  std::vector<glm::vec3> vColors(psMesh->nVertices(), glm::vec3{.2, .3, .4});
+  std::vector<double> fScalar(psMesh->nFaces(), 3.);
+
+  // plain triangle meshes draw indexed, for each shade style
+  EXPECT_TRUE(psMesh->canDrawIndexed());
+  polyscope::show(3);
+  for (polyscope::MeshShadeStyle s :
+       {polyscope::MeshShadeStyle::Smooth, polyscope::MeshShadeStyle::TriFlat, polyscope::MeshShadeStyle::Flat}) {
+    psMesh->setShadeStyle(s);
+    EXPECT_TRUE(psMesh->canDrawIndexed());
+    polyscope::show(3);
+  }
+  int64_t indexedBytes = polyscope::getMemoryUsage(psMesh, false).deviceBytes;
+
+  // vertex quantities draw indexed too, others fall back on expanded attributes
+  psMesh->addVertexScalarQuantity("vScalar", vScalar)->setEnabled(true);
+  polyscope::show(3);
+  psMesh->addVertexColorQuantity("vColor", vColors)->setEnabled(true);
+  polyscope::show(3);
+  psMesh->addFaceScalarQuantity("fScalar", fScalar)->setEnabled(true);
+  polyscope::show(3);
+
+  // the wireframe needs per-corner data
+  psMesh->setEdgeWidth(1.);
+  EXPECT_FALSE(psMesh->canDrawIndexed());
+  polyscope::show(3);
+  psMesh->removeAllQuantities();
+  polyscope::show(3);
+  EXPECT_GT(polyscope::getMemoryUsage(psMesh, false).deviceBytes, indexedBytes);
+
+  psMesh->setEdgeWidth(0.);
+  EXPECT_TRUE(psMesh->canDrawIndexed());
+  polyscope::show(3);
+
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, SurfaceMeshIndexedDrawPolygons) {
+  std::vector<glm::vec3> points = {{0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0}, {2, 0, 0}, {2, 1, 0}};
+  std::vector<std::vector<size_t>> faces = {{0, 1, 2, 3}, {1, 4, 5, 2}};
+  auto psMesh = polyscope::registerSurfaceMesh("quads", points, faces);
+
+  // flat shading polygons uses per-face normals
+  EXPECT_FALSE(psMesh->canDrawIndexed());
+  polyscope::show(3);
+
+  psMesh->setShadeStyle(polyscope::MeshShadeStyle::Smooth);
+  EXPECT_TRUE(psMesh->canDrawIndexed());
+  polyscope::show(3);
+
+  polyscope::removeAllStructures();
+}
+
 TEST_F(PolyscopeTest, SurfaceMeshScalarEdge) {
   auto psMesh = registerTriangleMesh();
   size_t nEdges = 6;
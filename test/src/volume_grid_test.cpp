@@ -1,8 +1,22 @@
 // Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
 
+#include "polyscope/marching_cubes.h"
+#include "polyscope/quantized_scalar_array.h"
+#include "polyscope/raw_volume_file.h"
 #include "polyscope/slice_plane.h"
+#include "polyscope/sparse_volume_grid.h"
 #include "polyscope_test.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <set>
+#include <utility>
+
+#include <glm/gtc/packing.hpp>
+
 
 // ============================================================
 // =============== Volume grid tests
@@ -180,3 +194,610 @@ TEST_F(PolyscopeTest, VolumeGridScalarIsosurfaceAndOpts) {
   polyscope::removeLastSceneSlicePlane();
   polyscope::removeAllStructures();
 }
+
+TEST_F(PolyscopeTest, VolumeGridMarchingCubes) {
+
+  // A sphere on a grid which is several bricks across, with different sizes along each axis
+  glm::uvec3 dim{64, 66, 70};
+  glm::vec3 boundLow{-3., -3., -3.};
+  glm::vec3 boundHigh{3., 3., 3.};
+  std::vector<float> values(dim.x * dim.y * dim.z);
+  for (uint32_t z = 0; z < dim.z; z++) {
+    for (uint32_t y = 0; y < dim.y; y++) {
+      for (uint32_t x = 0; x < dim.x; x++) {
+        glm::vec3 t = glm::vec3{x, y, z} / glm::vec3(dim - 1u);
+        glm::vec3 p = (1.f - t) * boundLow + t * boundHigh;
+        values[(z * dim.y + y) * dim.x + x] = glm::length(p) - 1.f;
+      }
+    }
+  }
+
+  polyscope::IsosurfaceMesh mesh;
+  polyscope::marchingCubes(values, dim, boundLow, boundHigh, 0., mesh);
+  ASSERT_FALSE(mesh.indices.empty());
+  for (const glm::vec3& p : mesh.vertices) {
+    EXPECT_NEAR(glm::length(p), 1., 0.02);
+  }
+
+  // Vertices are welded across bricks, giving a closed, consistently oriented surface with the topology of a sphere
+  std::set<std::pair<uint32_t, uint32_t>> halfedges;
+  size_t nTri = mesh.indices.size() / 3;
+  for (size_t iT = 0; iT < nTri; iT++) {
+    for (int j = 0; j < 3; j++) {
+      std::pair<uint32_t, uint32_t> he{mesh.indices[3 * iT + j], mesh.indices[3 * iT + (j + 1) % 3]};
+      EXPECT_TRUE(halfedges.insert(he).second);
+    }
+  }
+  for (const std::pair<uint32_t, uint32_t>& he : halfedges) {
+    EXPECT_EQ(halfedges.count({he.second, he.first}), 1);
+  }
+  EXPECT_EQ(static_cast<int64_t>(mesh.vertices.size()) - static_cast<int64_t>(nTri / 2), 2);
+
+  // The same grid through a quantity, drawn and then registered from the same extraction
+  polyscope::VolumeGrid* psGrid = polyscope::registerVolumeGrid("marching grid", dim, boundLow, boundHigh);
+  polyscope::VolumeGridNodeScalarQuantity* q = psGrid->addNodeScalarQuantity("sphere", values);
+  q->setEnabled(true);
+  q->setIsosurfaceVizEnabled(true);
+  polyscope::show(3);
+  polyscope::SurfaceMesh* psMesh = q->registerIsosurfaceAsMesh();
+  EXPECT_EQ(psMesh->nVertices(), mesh.vertices.size());
+  EXPECT_EQ(psMesh->nFaces(), nTri);
+
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, VolumeGridBrickRanges) {
+
+  glm::uvec3 dim{64, 66, 70};
+  glm::vec3 boundLow{-3., -3., -3.};
+  glm::vec3 boundHigh{3., 3., 3.};
+  std::vector<float> values(dim.x * dim.y * dim.z);
+  for (uint32_t z = 0; z < dim.z; z++) {
+    for (uint32_t y = 0; y < dim.y; y++) {
+      for (uint32_t x = 0; x < dim.x; x++) {
+        glm::vec3 t = glm::vec3{x, y, z} / glm::vec3(dim - 1u);
+        glm::vec3 p = (1.f - t) * boundLow + t * boundHigh;
+        values[(z * dim.y + y) * dim.x + x] = glm::length(p) - 1.f;
+      }
+    }
+  }
+
+  // Check each brick against the values it covers
+  auto checkRanges = [](const polyscope::GridBrickRanges& ranges, const std::vector<float>& vals, glm::uvec3 valDim,
+                        bool onNodes) {
+    ASSERT_TRUE(ranges.isBuilt());
+    for (size_t iBrick = 0; iBrick < ranges.nBricks(); iBrick++) {
+      glm::uvec3 start, end;
+      ranges.brickCellRange(iBrick, start, end);
+      if (onNodes) end += 1u;
+      float minVal = std::numeric_limits<float>::infinity();
+      float maxVal = -std::numeric_limits<float>::infinity();
+      for (uint32_t z = start.z; z < end.z; z++) {
+        for (uint32_t y = start.y; y < end.y; y++) {
+          for (uint32_t x = start.x; x < end.x; x++) {
+            minVal = std::min(minVal, vals[(z * valDim.y + y) * valDim.x + x]);
+            maxVal = std::max(maxVal, vals[(z * valDim.y + y) * valDim.x + x]);
+          }
+        }
+      }
+      EXPECT_EQ(ranges.getBrickMin(iBrick), minVal);
+      EXPECT_EQ(ranges.getBrickMax(iBrick), maxVal);
+    }
+  };
+
+  polyscope::VolumeGrid* psGrid = polyscope::registerVolumeGrid("brick grid", dim, boundLow, boundHigh);
+  polyscope::VolumeGridNodeScalarQuantity* q = psGrid->addNodeScalarQuantity("sphere", values);
+  const polyscope::GridBrickRanges& ranges = q->getBrickRanges();
+  EXPECT_EQ(ranges.getBrickDim(), glm::uvec3(2, 3, 3));
+  checkRanges(ranges, values, dim, true);
+
+  // Skipping bricks which the surface misses gives the same result
+  size_t nSkipped = 0;
+  for (size_t iBrick = 0; iBrick < ranges.nBricks(); iBrick++) {
+    if (!ranges.brickStraddles(iBrick, 0.5)) nSkipped++;
+  }
+  EXPECT_GT(nSkipped, 0);
+  polyscope::IsosurfaceMesh meshAll, meshSkipped;
+  polyscope::marchingCubes(values, dim, boundLow, boundHigh, 0.5, meshAll);
+  polyscope::marchingCubes(values, dim, boundLow, boundHigh, 0.5, meshSkipped, &ranges);
+  EXPECT_EQ(meshAll.vertices, meshSkipped.vertices);
+  EXPECT_EQ(meshAll.indices, meshSkipped.indices);
+
+  // Building the table from slabs of a few layers gives the same ranges
+  polyscope::GridBrickRanges slabRanges;
+  slabRanges.buildFromSlabs(dim, true, 5 * dim.x * dim.y, [&](size_t start, size_t count, float* out) {
+    std::copy(values.begin() + start, values.begin() + start + count, out);
+  });
+  checkRanges(slabRanges, values, dim, true);
+
+  // A slice of the table bounds the values of the bricks of the slab it covers
+  polyscope::GridBrickRanges slice = ranges.sliceZ(20, 50);
+  EXPECT_EQ(slice.getBrickDim(), glm::uvec3(2, 3, 1));
+  std::vector<float> sliceValues(values.begin() + 20 * dim.x * dim.y, values.begin() + 51 * dim.x * dim.y);
+  polyscope::GridBrickRanges sliceExact;
+  sliceExact.build(sliceValues, glm::uvec3{dim.x, dim.y, 31}, true);
+  for (size_t iBrick = 0; iBrick < slice.nBricks(); iBrick++) {
+    EXPECT_LE(slice.getBrickMin(iBrick), sliceExact.getBrickMin(iBrick));
+    EXPECT_GE(slice.getBrickMax(iBrick), sliceExact.getBrickMax(iBrick));
+  }
+
+  // A partial update re-summarizes the bricks it touches, including across a shared layer of nodes
+  std::vector<float> patch(dim.x * 3, -7.f);
+  size_t patchStart = (32 * dim.y + 40) * dim.x;
+  q->updateDataRange(patch, patchStart);
+  std::copy(patch.begin(), patch.end(), values.begin() + patchStart);
+  checkRanges(q->getBrickRanges(), values, dim, true);
+  EXPECT_EQ(q->getBrickRanges().getBrickMin(q->getBrickRanges().brickIndex({1, 1, 0})), -7.f);
+  EXPECT_EQ(q->getBrickRanges().getBrickMin(q->getBrickRanges().brickIndex({0, 1, 1})), -7.f);
+
+  // A full update rebuilds everything
+  for (float& v : values) v = -v;
+  q->updateData(values);
+  checkRanges(q->getBrickRanges(), values, dim, true);
+
+  // Cell values
+  std::vector<float> cellValues(63 * 65 * 69);
+  for (size_t i = 0; i < cellValues.size(); i++) cellValues[i] = static_cast<float>(i % 1000);
+  polyscope::VolumeGridCellScalarQuantity* qCell = psGrid->addCellScalarQuantity("cells", cellValues);
+  EXPECT_EQ(qCell->getBrickRanges().getBrickDim(), glm::uvec3(2, 3, 3));
+  checkRanges(qCell->getBrickRanges(), cellValues, glm::uvec3(63, 65, 69), false);
+
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, VolumeGridScalarFromFile) {
+
+  // A sphere, quantized to uint16 and written to files in a few layouts
+  glm::uvec3 dim{19, 13, 23};
+  glm::vec3 boundLow{-2., -1.5, -2.5};
+  glm::vec3 boundHigh{2., 1.5, 2.5};
+  auto sphereVal = [&](glm::uvec3 node) {
+    glm::vec3 t = glm::vec3(node) / glm::vec3(dim - 1u);
+    glm::vec3 p = (1.f - t) * boundLow + t * boundHigh;
+    return static_cast<uint16_t>(30000. + 1000. * (glm::length(p - glm::vec3{0.1, 0., 0.2}) - 1.2));
+  };
+  std::vector<float> expected(dim.x * dim.y * dim.z);
+  for (uint32_t z = 0; z < dim.z; z++) {
+    for (uint32_t y = 0; y < dim.y; y++) {
+      for (uint32_t x = 0; x < dim.x; x++) {
+        expected[(z * dim.y + y) * dim.x + x] = sphereVal({x, y, z});
+      }
+    }
+  }
+
+  // big-endian values following a NRRD header
+  std::string nrrdFilename = ::testing::TempDir() + "polyscope_test_volume.nrrd";
+  {
+    std::ofstream out(nrrdFilename, std::ios::binary);
+    out << "NRRD0004\n# a comment\ntype: uint16\ndimension: 3\nsizes: " << dim.x << " " << dim.y << " " << dim.z
+        << "\nendian: big\nencoding: raw\n\n";
+    for (float v : expected) {
+      uint16_t u = static_cast<uint16_t>(v);
+      out.put(static_cast<char>(u >> 8));
+      out.put(static_cast<char>(u & 0xFF));
+    }
+  }
+
+  // float values in padded bricks of 4^3, with a detached header
+  const uint32_t B = 4;
+  std::string nhdrFilename = ::testing::TempDir() + "polyscope_test_volume_bricked.nhdr";
+  std::string brickedFilename = ::testing::TempDir() + "polyscope_test_volume_bricked.raw";
+  {
+    std::ofstream header(nhdrFilename);
+    header << "NRRD0004\ntype: float\ndimension: 3\nsizes: " << dim.x << " " << dim.y << " " << dim.z
+           << "\nendian: little\nencoding: raw\npolyscope_brick_size:=" << B
+           << "\ndata file: polyscope_test_volume_bricked.raw\n\n";
+
+    std::ofstream out(brickedFilename, std::ios::binary);
+    glm::uvec3 brickDim = (dim + B - 1u) / B;
+    for (uint32_t bz = 0; bz < brickDim.z; bz++) {
+      for (uint32_t by = 0; by < brickDim.y; by++) {
+        for (uint32_t bx = 0; bx < brickDim.x; bx++) {
+          for (uint32_t z = 0; z < B; z++) {
+            for (uint32_t y = 0; y < B; y++) {
+              for (uint32_t x = 0; x < B; x++) {
+                glm::uvec3 node = glm::uvec3{bx, by, bz} * B + glm::uvec3{x, y, z};
+                bool inVolume = node.x < dim.x && node.y < dim.y && node.z < dim.z;
+                float v = inVolume ? expected[(node.z * dim.y + node.y) * dim.x + node.x] : 0.f;
+                out.write(reinterpret_cast<const char*>(&v), sizeof(float));
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+
+  std::shared_ptr<polyscope::RawVolumeFile> nrrdFile = polyscope::openRawVolumeFile(nrrdFilename);
+  std::shared_ptr<polyscope::RawVolumeFile> brickedFile = polyscope::openRawVolumeFile(nhdrFilename);
+  for (std::shared_ptr<polyscope::RawVolumeFile> file : {nrrdFile, brickedFile}) {
+    EXPECT_EQ(file->getDim(), dim);
+    EXPECT_EQ(file->nValues(), expected.size());
+    EXPECT_EQ(file->getValue(glm::uvec3(5, 7, 11)), expected[(11 * dim.y + 7) * dim.x + 5]);
+
+    // a range which crosses rows, slices and bricks
+    std::vector<float> readBack(700);
+    file->readValues(1000, readBack.size(), readBack.data());
+    EXPECT_TRUE(std::equal(readBack.begin(), readBack.end(), expected.begin() + 1000));
+  }
+  EXPECT_EQ(brickedFile->getLayout().brickSize, B);
+  EXPECT_TRUE(nrrdFile->getLayout().bigEndian);
+  EXPECT_THROW(polyscope::openRawVolumeFile(::testing::TempDir() + "polyscope_no_such_file.nrrd"), std::runtime_error);
+
+  // Upload the textures in several chunks
+  int64_t oldChunkBytes = polyscope::options::streamedUploadChunkBytes;
+  polyscope::options::streamedUploadChunkBytes = 4 * dim.x * dim.y * 5;
+
+  polyscope::VolumeGrid* psGrid = polyscope::registerVolumeGrid("test grid", dim, boundLow, boundHigh);
+  polyscope::VolumeGridNodeScalarQuantity* q = psGrid->addNodeScalarQuantityFromFile("streamed", nrrdFile);
+  polyscope::VolumeGridNodeScalarQuantity* qBricked = psGrid->addNodeScalarQuantityFromFile("bricked", brickedFile);
+  EXPECT_TRUE(q->values.hasStreamedData());
+  EXPECT_EQ(q->values.size(), expected.size());
+  EXPECT_EQ(q->values.getValue(1234), expected[1234]);
+  q->setEnabled(true);
+  polyscope::show(3);
+  qBricked->setEnabled(true);
+  polyscope::show(3);
+
+  // The isosurface is extracted a slab at a time, and should match extracting it all at once
+  polyscope::IsosurfaceMesh denseMesh;
+  polyscope::marchingCubes(expected, dim, boundLow, boundHigh, 30000., denseMesh);
+  ASSERT_GT(denseMesh.indices.size(), 0u);
+  for (polyscope::VolumeGridNodeScalarQuantity* qIso : {q, qBricked}) {
+    qIso->setIsosurfaceLevel(30000.);
+    qIso->setIsosurfaceVizEnabled(true);
+    polyscope::show(3);
+    polyscope::SurfaceMesh* isoMesh = qIso->registerIsosurfaceAsMesh();
+    EXPECT_EQ(isoMesh->nVertices(), denseMesh.vertices.size());
+    EXPECT_EQ(isoMesh->nFaces(), denseMesh.indices.size() / 3);
+  }
+  EXPECT_TRUE(q->values.hasStreamedData());
+
+  // The brick ranges are built from the stream as well, and match building them from all of the values
+  polyscope::GridBrickRanges denseRanges;
+  denseRanges.build(expected, dim, true);
+  const polyscope::GridBrickRanges& streamedRanges = q->getBrickRanges();
+  EXPECT_TRUE(q->values.hasStreamedData());
+  ASSERT_EQ(streamedRanges.nBricks(), denseRanges.nBricks());
+  for (size_t iBrick = 0; iBrick < denseRanges.nBricks(); iBrick++) {
+    EXPECT_EQ(streamedRanges.getBrickMin(iBrick), denseRanges.getBrickMin(iBrick));
+    EXPECT_EQ(streamedRanges.getBrickMax(iBrick), denseRanges.getBrickMax(iBrick));
+  }
+
+  // Moving the level re-extracts the surface, still without reading everything in
+  polyscope::marchingCubes(expected, dim, boundLow, boundHigh, 29800., denseMesh);
+  q->setIsosurfaceLevel(29800.);
+  EXPECT_EQ(q->registerIsosurfaceAsMesh("moved level")->nVertices(), denseMesh.vertices.size());
+  EXPECT_TRUE(q->values.hasStreamedData());
+
+  // Streamed values can only be replaced as a whole
+  EXPECT_THROW(q->updateDataRange(std::vector<float>{1., 2.}, 10), std::runtime_error);
+
+  // A cell quantity, from a file described by a layout
+  glm::uvec3 cellDim = dim - 1u;
+  std::string cellFilename = ::testing::TempDir() + "polyscope_test_volume_cells.raw";
+  {
+    std::ofstream out(cellFilename, std::ios::binary);
+    out << "header";
+    for (uint32_t i = 0; i < cellDim.x * cellDim.y * cellDim.z; i++) {
+      int16_t v = static_cast<int16_t>(i % 1000) - 500;
+      out.write(reinterpret_cast<const char*>(&v), sizeof(int16_t));
+    }
+  }
+  polyscope::RawVolumeLayout cellLayout;
+  cellLayout.dim = cellDim;
+  cellLayout.dataType = polyscope::RawVolumeDataType::Int16;
+  cellLayout.headerBytes = 6;
+  std::shared_ptr<polyscope::RawVolumeFile> cellFile = polyscope::openRawVolumeFile(cellFilename, cellLayout);
+  EXPECT_EQ(cellFile->getValue(glm::uvec3(3, 0, 0)), -497.);
+  polyscope::VolumeGridCellScalarQuantity* qCell = psGrid->addCellScalarQuantityFromFile("cells", cellFile);
+  qCell->setEnabled(true);
+  polyscope::show(3);
+
+  // Files must match the grid
+  EXPECT_THROW(psGrid->addCellScalarQuantityFromFile("bad", nrrdFile), std::runtime_error);
+  EXPECT_THROW(psGrid->addNodeScalarQuantityFromFile("bad", cellFile), std::runtime_error);
+
+  // Updating the values replaces the streamed ones
+  q->updateData(expected);
+  EXPECT_FALSE(q->values.hasStreamedData());
+  polyscope::show(3);
+
+  polyscope::options::streamedUploadChunkBytes = oldChunkBytes;
+  polyscope::removeAllStructures();
+  nrrdFile.reset();
+  brickedFile.reset();
+  cellFile.reset();
+  std::remove(nrrdFilename.c_str());
+  std::remove(nhdrFilename.c_str());
+  std::remove(brickedFilename.c_str());
+  std::remove(cellFilename.c_str());
+}
+
+TEST_F(PolyscopeTest, VolumeGridScalarQuantized) {
+
+  // Distance to a sphere, quantized to uint16, uint8 and half floats
+  glm::uvec3 dim{11, 14, 9};
+  glm::vec3 boundLow{-2., -1.5, -2.5};
+  glm::vec3 boundHigh{2., 1.5, 2.5};
+  polyscope::VolumeGrid* psGrid = polyscope::registerVolumeGrid("test grid", dim, boundLow, boundHigh);
+
+  std::vector<float> dist(psGrid->nNodes());
+  for (size_t i = 0; i < dist.size(); i++) {
+    dist[i] = glm::length(psGrid->positionOfNodeIndex(i) - glm::vec3{0.1, 0., 0.2}) - 1.2f;
+  }
+
+  polyscope::ScalarQuantization quant16;
+  quant16.type = polyscope::QuantizedScalarType::UInt16;
+  quant16.scale = 1e-4;
+  quant16.offset = -2.;
+  std::vector<uint16_t> stored16(dist.size());
+  std::vector<uint16_t> storedHalf(dist.size());
+  std::vector<float> expected16(dist.size());
+  for (size_t i = 0; i < dist.size(); i++) {
+    stored16[i] = static_cast<uint16_t>(std::lround((dist[i] + 2.) * 1e4));
+    expected16[i] = 1e-4f * stored16[i] - 2.f;
+    storedHalf[i] = glm::packHalf1x16(dist[i]);
+  }
+
+  polyscope::VolumeGridNodeScalarQuantity* q16 = psGrid->addNodeScalarQuantityQuantized("uint16", stored16, quant16);
+  EXPECT_TRUE(q16->hasQuantizedValues());
+  EXPECT_TRUE(q16->values.hasTextureEncoding());
+  EXPECT_EQ(q16->values.getTextureEncodingFormat(), polyscope::TextureFormat::R16);
+  EXPECT_FLOAT_EQ(q16->values.getTextureDecodeScale(), 1e-4f * 65535.f);
+  EXPECT_FLOAT_EQ(q16->values.getTextureDecodeOffset(), -2.f);
+  EXPECT_EQ(q16->values.size(), dist.size());
+  EXPECT_FLOAT_EQ(q16->values.getValue(123), expected16[123]);
+
+  // The data range is exact, from all of the stored values
+  auto expectedRange = std::minmax_element(expected16.begin(), expected16.end());
+  EXPECT_FLOAT_EQ(q16->getDataRange().first, *expectedRange.first);
+  EXPECT_FLOAT_EQ(q16->getDataRange().second, *expectedRange.second);
+  q16->setEnabled(true);
+  q16->setIsolinesEnabled(true);
+  polyscope::show(3);
+
+  polyscope::ScalarQuantization quantHalf;
+  quantHalf.type = polyscope::QuantizedScalarType::Float16;
+  polyscope::VolumeGridNodeScalarQuantity* qHalf =
+      psGrid->addNodeScalarQuantityQuantized("half", storedHalf, quantHalf, polyscope::DataType::SYMMETRIC);
+  EXPECT_EQ(qHalf->values.getTextureEncodingFormat(), polyscope::TextureFormat::R16F);
+  EXPECT_NEAR(qHalf->values.getValue(77), dist[77], 1e-3);
+  qHalf->setEnabled(true);
+  polyscope::show(3);
+
+  // The isosurface matches extracting it from the decoded values
+  polyscope::IsosurfaceMesh denseMesh;
+  polyscope::marchingCubes(expected16, dim, boundLow, boundHigh, 0., denseMesh);
+  ASSERT_GT(denseMesh.indices.size(), 0u);
+  q16->setIsosurfaceLevel(0.);
+  q16->setIsosurfaceVizEnabled(true);
+  polyscope::show(3);
+  polyscope::SurfaceMesh* isoMesh = q16->registerIsosurfaceAsMesh();
+  EXPECT_EQ(isoMesh->nVertices(), denseMesh.vertices.size());
+  EXPECT_EQ(isoMesh->nFaces(), denseMesh.indices.size() / 3);
+
+  // The brick ranges are read from the quantized values a slab at a time, and no decoded copy is kept
+  polyscope::GridBrickRanges decodedRanges;
+  decodedRanges.build(expected16, dim, true);
+  const polyscope::GridBrickRanges& quantizedRanges = q16->getBrickRanges();
+  ASSERT_EQ(quantizedRanges.nBricks(), decodedRanges.nBricks());
+  for (size_t iBrick = 0; iBrick < decodedRanges.nBricks(); iBrick++) {
+    EXPECT_EQ(quantizedRanges.getBrickMin(iBrick), decodedRanges.getBrickMin(iBrick));
+    EXPECT_EQ(quantizedRanges.getBrickMax(iBrick), decodedRanges.getBrickMax(iBrick));
+  }
+  EXPECT_TRUE(q16->values.hasStreamedData());
+  EXPECT_EQ(q16->values.data.size(), 0u);
+
+  // Updates are re-quantized, and the values stay quantized
+  std::vector<float> newValues(dist.size(), 0.5);
+  newValues[3] = 100.; // clamped
+  q16->updateData(newValues);
+  EXPECT_TRUE(q16->values.hasStreamedData());
+  EXPECT_NEAR(q16->values.getValue(0), 0.5, 1e-4);
+  EXPECT_NEAR(q16->values.getValue(3), 1e-4 * 65535. - 2., 1e-4);
+  std::vector<float> newRange{-1., -0.25};
+  q16->updateDataRange(newRange, 10);
+  EXPECT_NEAR(q16->values.getValue(10), -1., 1e-4);
+  EXPECT_NEAR(q16->values.getValue(11), -0.25, 1e-4);
+  polyscope::show(3);
+
+  // Reading all the values in to the host buffer stops streaming, updates afterwards still land
+  q16->values.ensureHostBufferPopulated();
+  EXPECT_FALSE(q16->values.hasStreamedData());
+  newValues[0] = -0.75;
+  q16->updateData(newValues);
+  EXPECT_TRUE(q16->values.hasStreamedData());
+  EXPECT_EQ(q16->values.data.size(), 0u);
+  EXPECT_NEAR(q16->values.getValue(0), -0.75, 1e-4);
+  q16->values.ensureHostBufferPopulated();
+  q16->updateDataRange(std::vector<float>{0.25}, 1);
+  EXPECT_EQ(q16->values.data.size(), 0u);
+  EXPECT_NEAR(q16->values.getValue(1), 0.25, 1e-4);
+  polyscope::show(3);
+
+  // Cell values as uint8
+  polyscope::ScalarQuantization quant8;
+  quant8.type = polyscope::QuantizedScalarType::UInt8;
+  quant8.scale = 0.5;
+  quant8.offset = 10.;
+  std::vector<uint8_t> stored8(psGrid->nCells());
+  for (size_t i = 0; i < stored8.size(); i++) stored8[i] = static_cast<uint8_t>(i % 256);
+  polyscope::VolumeGridCellScalarQuantity* qCell = psGrid->addCellScalarQuantityQuantized("uint8", stored8, quant8);
+  EXPECT_EQ(qCell->values.getTextureEncodingFormat(), polyscope::TextureFormat::R8);
+  EXPECT_FLOAT_EQ(qCell->values.getTextureDecodeScale(), 0.5f * 255.f);
+  EXPECT_FLOAT_EQ(qCell->values.getValue(300), 0.5f * (300 % 256) + 10.f);
+  qCell->setEnabled(true);
+  polyscope::show(3);
+
+  // The stored values are read back as they were given, for uploading without re-encoding
+  polyscope::QuantizedScalarArray array8(stored8, quant8);
+  std::vector<uint8_t> read8(4);
+  array8.readStoredValues(298, 4, read8.data());
+  EXPECT_EQ(read8, std::vector<uint8_t>(stored8.begin() + 298, stored8.begin() + 302));
+  polyscope::QuantizedScalarArray arrayHalf(storedHalf, quantHalf);
+  std::vector<uint16_t> readHalf(3);
+  arrayHalf.readStoredValues(0, 3, readHalf.data());
+  EXPECT_EQ(readHalf, std::vector<uint16_t>(storedHalf.begin(), storedHalf.begin() + 3));
+  EXPECT_THROW(arrayHalf.readStoredValues(storedHalf.size() - 1, 2, readHalf.data()), std::runtime_error);
+
+  // Bad quantizations
+  EXPECT_THROW(psGrid->addCellScalarQuantityQuantized("bad", stored8, quant8, polyscope::DataType::CATEGORICAL),
+               std::runtime_error);
+  polyscope::ScalarQuantization badQuant = quant16;
+  badQuant.scale = 0.;
+  EXPECT_THROW(psGrid->addNodeScalarQuantityQuantized("bad", stored16, badQuant), std::runtime_error);
+  EXPECT_THROW(polyscope::QuantizedScalarArray(stored8, quant16), std::runtime_error);
+
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, SparseVolumeGrid) {
+
+  // A sphere on a grid of 4x4x5 bricks, where only the bricks which the surface passes through are occupied
+  const uint32_t B = 8;
+  glm::uvec3 dim{33, 33, 41};
+  glm::vec3 boundLow{-2., -2., -2.5};
+  glm::vec3 boundHigh{2., 2., 2.5};
+  auto sphereVal = [&](glm::uvec3 node) {
+    glm::vec3 t = glm::vec3(node) / glm::vec3(dim - 1u);
+    glm::vec3 p = (1.f - t) * boundLow + t * boundHigh;
+    return glm::length(p - glm::vec3{0.1, 0., 0.2}) - 1.3f;
+  };
+
+  std::vector<float> denseValues(dim.x * dim.y * dim.z);
+  for (uint32_t z = 0; z < dim.z; z++) {
+    for (uint32_t y = 0; y < dim.y; y++) {
+      for (uint32_t x = 0; x < dim.x; x++) {
+        denseValues[(z * dim.y + y) * dim.x + x] = sphereVal({x, y, z});
+      }
+    }
+  }
+
+  std::vector<glm::uvec3> bricks;
+  std::vector<float> brickValues;
+  for (uint32_t bz = 0; bz < 5; bz++) {
+    for (uint32_t by = 0; by < 4; by++) {
+      for (uint32_t bx = 0; bx < 4; bx++) {
+        std::vector<float> vals;
+        float minVal = std::numeric_limits<float>::infinity();
+        float maxVal = -std::numeric_limits<float>::infinity();
+        for (uint32_t z = 0; z <= B; z++) {
+          for (uint32_t y = 0; y <= B; y++) {
+            for (uint32_t x = 0; x <= B; x++) {
+              float v = sphereVal(glm::uvec3{bx, by, bz} * B + glm::uvec3{x, y, z});
+              minVal = std::min(minVal, v);
+              maxVal = std::max(maxVal, v);
+              vals.push_back(v);
+            }
+          }
+        }
+        if (minVal < 0. && maxVal >= 0.) {
+          bricks.push_back({bx, by, bz});
+          brickValues.insert(brickValues.end(), vals.begin(), vals.end());
+        }
+      }
+    }
+  }
+  ASSERT_LT(bricks.size(), 80u);
+
+  polyscope::SparseVolumeGrid* psGrid =
+      polyscope::registerSparseVolumeGrid("sparse grid", dim, boundLow, boundHigh, B, bricks);
+  EXPECT_TRUE(polyscope::hasSparseVolumeGrid("sparse grid"));
+  EXPECT_EQ(psGrid->nBricks(), bricks.size());
+  EXPECT_EQ(psGrid->findBrick(bricks[3]), 3);
+  EXPECT_EQ(psGrid->findBrick({0, 0, 0}), -1);
+  EXPECT_EQ(psGrid->findBrick({9, 0, 0}), -1);
+  polyscope::show(3);
+
+  // The pool texture has no unused slots, when the bricks can be laid out exactly
+  polyscope::SparseVolumeGridBrickPool pool = psGrid->computeBrickPool(B + 1);
+  EXPECT_EQ(static_cast<size_t>(pool.slotDim.x) * pool.slotDim.y * pool.slotDim.z, bricks.size());
+
+  // Gridcube and isosurface of a node quantity
+  polyscope::SparseVolumeGridNodeScalarQuantity* q = psGrid->addNodeScalarQuantity("sphere", brickValues);
+  EXPECT_EQ(q->getNodeValue(5, {1, 2, 3}), brickValues[5 * 729 + (3 * 9 + 2) * 9 + 1]);
+  q->setEnabled(true);
+
+  // The data range and histogram count each node once, rather than once per brick which holds it
+  std::set<uint64_t> distinctNodes;
+  for (const glm::uvec3& b : bricks) {
+    for (uint32_t z = 0; z <= B; z++) {
+      for (uint32_t y = 0; y <= B; y++) {
+        for (uint32_t x = 0; x <= B; x++) {
+          glm::uvec3 node = b * B + glm::uvec3{x, y, z};
+          distinctNodes.insert((static_cast<uint64_t>(node.z) * dim.y + node.y) * dim.x + node.x);
+        }
+      }
+    }
+  }
+  std::vector<float> distinctValues = psGrid->distinctNodeValues(brickValues);
+  EXPECT_EQ(distinctValues.size(), distinctNodes.size());
+  EXPECT_LT(distinctValues.size(), brickValues.size());
+  EXPECT_EQ(q->getDataRange().first, *std::min_element(distinctValues.begin(), distinctValues.end()));
+  q->setIsosurfaceVizEnabled(true);
+  polyscope::show(3);
+
+  // The surface is the same as from the dense grid, and is welded between bricks
+  polyscope::IsosurfaceMesh denseMesh;
+  polyscope::marchingCubes(denseValues, dim, boundLow, boundHigh, 0., denseMesh);
+  const polyscope::IsosurfaceMesh& mesh = q->getIsosurfaceMesh();
+  EXPECT_EQ(mesh.vertices.size(), denseMesh.vertices.size());
+  EXPECT_EQ(mesh.indices.size(), denseMesh.indices.size());
+  std::set<std::pair<uint32_t, uint32_t>> halfedges;
+  size_t nTri = mesh.indices.size() / 3;
+  for (size_t iT = 0; iT < nTri; iT++) {
+    for (int j = 0; j < 3; j++) {
+      halfedges.insert({mesh.indices[3 * iT + j], mesh.indices[3 * iT + (j + 1) % 3]});
+    }
+  }
+  for (const std::pair<uint32_t, uint32_t>& he : halfedges) {
+    EXPECT_EQ(halfedges.count({he.second, he.first}), 1);
+  }
+  polyscope::SurfaceMesh* psMesh = q->registerIsosurfaceAsMesh();
+  EXPECT_EQ(psMesh->nVertices(), mesh.vertices.size());
+
+  // Updating the values re-extracts the surface
+  for (float& v : brickValues) v -= 0.05f;
+  q->updateData(brickValues);
+  EXPECT_EQ(q->getNodeValue(5, {1, 2, 3}), brickValues[5 * 729 + (3 * 9 + 2) * 9 + 1]);
+  EXPECT_NE(q->getIsosurfaceMesh().vertices.size(), 0u);
+
+  // The brick ranges used to skip bricks follow the values
+  const polyscope::GridBrickRanges& ranges = q->getBrickRanges();
+  ASSERT_EQ(ranges.nBricks(), bricks.size());
+  for (size_t iB = 0; iB < bricks.size(); iB++) {
+    std::vector<float>::const_iterator brickStart = brickValues.begin() + iB * 729;
+    EXPECT_EQ(ranges.getBrickMin(iB), *std::min_element(brickStart, brickStart + 729));
+    EXPECT_EQ(ranges.getBrickMax(iB), *std::max_element(brickStart, brickStart + 729));
+  }
+  q->setIsosurfaceLevel(0.1);
+  polyscope::show(3);
+
+  // Cell quantity, and options
+  std::vector<float> cellValues(psGrid->nCells());
+  for (size_t i = 0; i < cellValues.size(); i++) cellValues[i] = static_cast<float>(i % 100);
+  polyscope::SparseVolumeGridCellScalarQuantity* qCell = psGrid->addCellScalarQuantity("cells", cellValues);
+  EXPECT_EQ(qCell->getCellValue(2, {7, 0, 4}), cellValues[2 * 512 + (4 * 8 + 0) * 8 + 7]);
+  qCell->setEnabled(true);
+  psGrid->setEdgeWidth(1.);
+  psGrid->setCubeSizeFactor(0.5);
+  polyscope::show(3);
+
+  // Picking finds the occupied brick around a clicked element
+  polyscope::PickResult pick;
+  pick.structure = psGrid;
+  pick.position = psGrid->positionOfCellIndex(bricks[4] * B + glm::uvec3{1, 2, 3});
+  polyscope::SparseVolumeGridPickResult gridPick = psGrid->interpretPickResult(pick);
+  EXPECT_EQ(gridPick.elementType, polyscope::VolumeGridElement::CELL);
+  EXPECT_EQ(gridPick.index, bricks[4] * B + glm::uvec3(1, 2, 3));
+  EXPECT_EQ(gridPick.brickIndex, 4);
+
+  // Errors
+  EXPECT_THROW(polyscope::registerSparseVolumeGrid("sparse bad", {30, 33, 33}, boundLow, boundHigh, B, bricks),
+               std::runtime_error);
+  EXPECT_THROW(polyscope::registerSparseVolumeGrid("sparse bad", dim, boundLow, boundHigh, B, {{1, 1, 1}, {1, 1, 1}}),
+               std::runtime_error);
+
+  polyscope::removeAllStructures();
+}
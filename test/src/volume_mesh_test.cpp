@@ -63,6 +63,157 @@ TEST_F(PolyscopeTest, ShowVolumeMesh) {
   polyscope::removeAllStructures();
 }
 
+TEST_F(PolyscopeTest, VolumeMeshFaceAdjacency) {
+
+  // Two tets sharing the face {1,2,3}
+  std::vector<glm::vec3> tetVerts = {{0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {0, 0, 1}, {1, 1, 1}};
+  std::vector<std::array<size_t, 4>> tetCells = {{0, 1, 2, 3}, {1, 2, 3, 4}};
+  polyscope::VolumeMesh* psTets = polyscope::registerTetMesh("tets", tetVerts, tetCells);
+  ASSERT_EQ(psTets->nFaces(), 8);
+  size_t nInterior = 0;
+  for (size_t iF = 0; iF < psTets->nFaces(); iF++) {
+    if (psTets->faceIsInterior[iF]) {
+      nInterior++;
+      EXPECT_EQ(psTets->faceNeighborCell[iF], iF < 4 ? 1 : 0);
+    } else {
+      EXPECT_EQ(psTets->faceNeighborCell[iF], polyscope::INVALID_IND_32);
+    }
+  }
+  EXPECT_EQ(nInterior, 2);
+
+  // A 3x3x3 block of hexes
+  const size_t n = 3;
+  auto vertInd = [&](size_t i, size_t j, size_t k) { return (i * (n + 1) + j) * (n + 1) + k; };
+  std::vector<glm::vec3> hexVerts;
+  for (size_t i = 0; i <= n; i++)
+    for (size_t j = 0; j <= n; j++)
+      for (size_t k = 0; k <= n; k++) hexVerts.push_back(glm::vec3{i, j, k});
+  std::vector<std::array<size_t, 8>> hexCells;
+  for (size_t i = 0; i < n; i++)
+    for (size_t j = 0; j < n; j++)
+      for (size_t k = 0; k < n; k++)
+        hexCells.push_back({vertInd(i, j, k), vertInd(i + 1, j, k), vertInd(i + 1, j + 1, k), vertInd(i, j + 1, k),
+                            vertInd(i, j, k + 1), vertInd(i + 1, j, k + 1), vertInd(i + 1, j + 1, k + 1),
+                            vertInd(i, j + 1, k + 1)});
+  polyscope::VolumeMesh* psHexes = polyscope::registerHexMesh("hexes", hexVerts, hexCells);
+  ASSERT_EQ(psHexes->nFaces(), 6 * n * n * n);
+  nInterior = 0;
+  for (size_t iC = 0; iC < psHexes->nCells(); iC++) {
+    for (size_t iF = psHexes->cellFaceStart[iC]; iF < psHexes->cellFaceStart[iC + 1]; iF++) {
+      if (!psHexes->faceIsInterior[iF]) continue;
+      nInterior++;
+
+      // the neighbor should be adjacent back across one of its faces
+      uint32_t iN = psHexes->faceNeighborCell[iF];
+      ASSERT_LT(iN, psHexes->nCells());
+      size_t nBack = 0;
+      for (size_t iFN = psHexes->cellFaceStart[iN]; iFN < psHexes->cellFaceStart[iN + 1]; iFN++) {
+        if (psHexes->faceNeighborCell[iFN] == iC) nBack++;
+      }
+      EXPECT_EQ(nBack, 1);
+    }
+  }
+  EXPECT_EQ(nInterior, 2 * 3 * (n - 1) * n * n);
+
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, VolumeMeshExteriorOnly) {
+
+  // Two tets sharing a face, so 2 of the 8 faces are interior
+  std::vector<glm::vec3> verts = {{0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {0, 0, 1}, {1, 1, 1}};
+  std::vector<std::array<size_t, 4>> cells = {{0, 1, 2, 3}, {1, 2, 3, 4}};
+  polyscope::VolumeMesh* psVol = polyscope::registerTetMesh("exterior vol", verts, cells);
+  psVol->addVertexScalarQuantity("vals", std::vector<double>(verts.size(), 1.))->setEnabled(true);
+  EXPECT_TRUE(psVol->getExteriorOnly());
+  polyscope::show(3);
+  EXPECT_EQ(psVol->nFacesTriangulationDrawn(), 6);
+  EXPECT_EQ(psVol->triangleVertexInds.size(), 3 * 6);
+
+  // interior faces get built while a slice plane cuts the mesh
+  polyscope::SlicePlane* p = polyscope::addSceneSlicePlane();
+  p->setPose(glm::vec3{0.5, 0.5, 0.5}, glm::vec3{1., 0., 0.});
+  polyscope::show(3);
+  EXPECT_EQ(psVol->nFacesTriangulationDrawn(), 8);
+  EXPECT_EQ(psVol->triangleVertexInds.size(), 3 * 8);
+
+  // but not while the plane misses the mesh
+  p->setPose(glm::vec3{2., 0., 0.}, glm::vec3{1., 0., 0.});
+  polyscope::show(3);
+  EXPECT_EQ(psVol->nFacesTriangulationDrawn(), 6);
+  p->setPose(glm::vec3{0.5, 0.5, 0.5}, glm::vec3{1., 0., 0.});
+
+  psVol->setIgnoreSlicePlane(p->name, true);
+  polyscope::show(3);
+  EXPECT_EQ(psVol->nFacesTriangulationDrawn(), 6);
+
+  psVol->setIgnoreSlicePlane(p->name, false);
+  p->setActive(false);
+  polyscope::show(3);
+  EXPECT_EQ(psVol->nFacesTriangulationDrawn(), 6);
+  p->setActive(true); // (the setting persists to later planes with the same name)
+  polyscope::removeLastSceneSlicePlane();
+
+  // or while the mesh is transparent
+  psVol->setTransparency(0.5);
+  polyscope::show(3);
+  EXPECT_EQ(psVol->nFacesTriangulationDrawn(), 8);
+  psVol->setTransparency(1.);
+  EXPECT_EQ(psVol->nFacesTriangulationDrawn(), 6);
+  polyscope::options::transparencyMode = polyscope::TransparencyMode::None;
+  polyscope::show(3);
+
+  // always build them
+  psVol->setExteriorOnly(false);
+  EXPECT_EQ(psVol->nFacesTriangulationDrawn(), 8);
+  polyscope::show(3);
+  EXPECT_EQ(psVol->triangleVertexInds.size(), 3 * 8);
+
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, VolumeMeshTetsInBackground) {
+  // A strip of hexes with shuffled vertex numbers, so the cells get split in different ways
+  const size_t n = 200;
+  std::vector<glm::vec3> verts;
+  for (size_t i = 0; i <= n; i++) {
+    for (size_t j = 0; j < 4; j++) {
+      verts.push_back(glm::vec3{i, j / 2, j % 2});
+    }
+  }
+  std::vector<size_t> perm(verts.size());
+  std::iota(perm.begin(), perm.end(), 0);
+  std::shuffle(perm.begin(), perm.end(), polyscope::util_mersenne_twister);
+  std::vector<glm::vec3> permVerts(verts.size());
+  for (size_t i = 0; i < verts.size(); i++) permVerts[perm[i]] = verts[i];
+  std::vector<std::array<size_t, 8>> cells;
+  for (size_t i = 0; i < n; i++) {
+    size_t a = 4 * i, b = 4 * (i + 1);
+    cells.push_back({perm[a], perm[b], perm[b + 2], perm[a + 2], perm[a + 1], perm[b + 1], perm[b + 3], perm[a + 3]});
+  }
+
+  polyscope::VolumeMesh* psLazy = polyscope::registerHexMesh("lazy", permVerts, cells);
+  polyscope::options::precomputeVolumeMeshTets = true;
+  polyscope::VolumeMesh* psEager = polyscope::registerHexMesh("eager", permVerts, cells);
+  polyscope::options::precomputeVolumeMeshTets = false;
+
+  psLazy->ensureHaveTets();
+  psEager->ensureHaveTets();
+  EXPECT_GE(psLazy->nTets(), 5 * n);
+  EXPECT_LE(psLazy->nTets(), 6 * n);
+  EXPECT_EQ(psLazy->tets, psEager->tets);
+
+  // removing a structure while its background task may still be running is fine
+  polyscope::options::precomputeVolumeMeshTets = true;
+  polyscope::registerHexMesh("removed", permVerts, cells);
+  polyscope::options::precomputeVolumeMeshTets = false;
+  polyscope::removeStructure("removed");
+
+  polyscope::show(3);
+
+  polyscope::removeAllStructures();
+}
+
 TEST_F(PolyscopeTest, VolumeMeshUpdatePositions) {
   std::vector<glm::vec3> verts;
   std::vector<std::array<int, 8>> cells;
@@ -169,6 +320,51 @@ TEST_F(PolyscopeTest, VolumeMeshScalarVertex) {
   polyscope::removeAllStructures();
 }
 
+TEST_F(PolyscopeTest, VolumeMeshLevelSetAsMesh) {
+
+  // Two tets sharing a face, with values x. The level set at 0.5 cuts one tet in a triangle and the other in a quad.
+  std::vector<glm::vec3> verts = {{0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {0, 0, 1}, {1, 1, 1}};
+  std::vector<std::array<size_t, 4>> cells = {{0, 1, 2, 3}, {1, 2, 3, 4}};
+  polyscope::VolumeMesh* psVol = polyscope::registerTetMesh("level set vol", verts, cells);
+  std::vector<float> vals;
+  for (const glm::vec3& p : verts) vals.push_back(p.x);
+  polyscope::VolumeMeshVertexScalarQuantity* q = psVol->addVertexScalarQuantity("vals", vals);
+
+  const polyscope::VolumeMeshLevelSetMesh& levelSet = q->computeLevelSetMesh(0.5);
+  EXPECT_EQ(levelSet.vertices.size(), 5); // welded, one per cut edge
+  ASSERT_EQ(levelSet.triangles.size(), 3);
+  for (const glm::vec3& p : levelSet.vertices) {
+    EXPECT_NEAR(p.x, 0.5, 1e-5);
+  }
+  for (const std::array<uint32_t, 3>& tri : levelSet.triangles) {
+    glm::vec3 pA = levelSet.vertices[tri[0]];
+    glm::vec3 pB = levelSet.vertices[tri[1]];
+    glm::vec3 pC = levelSet.vertices[tri[2]];
+    EXPECT_GT(glm::cross(pB - pA, pC - pA).x, 0.); // facing towards larger values
+  }
+
+  // cached for each value, until the values change
+  EXPECT_EQ(&q->computeLevelSetMesh(0.5), &levelSet);
+  EXPECT_TRUE(q->computeLevelSetMesh(2.).triangles.empty());
+
+  // only the last few are kept, older ones are computed again
+  for (int i = 0; i < 10; i++) {
+    EXPECT_FALSE(q->computeLevelSetMesh(0.05 + 0.1 * i).triangles.empty());
+  }
+  EXPECT_EQ(q->computeLevelSetMesh(0.5).triangles.size(), 3);
+  for (float& v : vals) v += 0.25;
+  q->updateData(vals);
+  EXPECT_NEAR(q->computeLevelSetMesh(0.5).vertices[0].x, 0.25, 1e-5);
+
+  q->setLevelSetValue(0.5);
+  polyscope::SurfaceMesh* psLevelSet = q->registerLevelSetAsMesh();
+  EXPECT_EQ(psLevelSet->name, "level set vol - vals - level set");
+  EXPECT_EQ(psLevelSet->nFaces(), 3);
+  polyscope::show(3);
+
+  polyscope::removeAllStructures();
+}
+
 TEST_F(PolyscopeTest, VolumeMeshScalarCategoricalVertex) {
   std::vector<glm::vec3> verts;
   std::vector<std::array<int, 8>> cells;
@@ -268,6 +464,52 @@ TEST_F(PolyscopeTest, VolumeMeshInspect) {
   polyscope::removeLastSceneSlicePlane();
 }
 
+TEST_F(PolyscopeTest, VolumeMeshInspectPositionTexture) {
+  std::vector<glm::vec3> verts;
+  std::vector<std::array<int, 8>> cells;
+  std::tie(verts, cells) = getVolumeMeshData();
+  polyscope::VolumeMesh* psVol = polyscope::registerVolumeMesh("vol", verts, cells);
+  psVol->setSliceMode(polyscope::VolumeMeshSliceMode::PositionTexture);
+  EXPECT_EQ(psVol->getSliceMode(), polyscope::VolumeMeshSliceMode::PositionTexture);
+
+  polyscope::SlicePlane* p = polyscope::addSceneSlicePlane();
+  p->setVolumeMeshToInspect("vol");
+  polyscope::show(3);
+
+  // the tets and positions were uploaded compactly
+  EXPECT_EQ(psVol->tetVertexInds.size(), psVol->nTets());
+  ASSERT_EQ(psVol->vertexPositionTexture.data.size(), verts.size());
+  EXPECT_EQ(psVol->vertexPositionTexture.data[3], verts[3]);
+
+  // with quantities
+  std::vector<float> vals(verts.size(), 0.44);
+  auto q1 = psVol->addVertexScalarQuantity("vals", vals);
+  q1->setEnabled(true);
+  polyscope::show(3);
+  std::vector<glm::vec3> colors(verts.size(), glm::vec3{0.2, 0.3, 0.4});
+  auto q2 = psVol->addVertexColorQuantity("colors", colors);
+  q2->setEnabled(true);
+  polyscope::show(3);
+
+  // level sets still work
+  q1->setEnabledLevelSet(true);
+  polyscope::show(3);
+  q1->setEnabledLevelSet(false);
+
+  // moving the vertices updates the texture
+  verts[3] += glm::vec3{0.1, 0., 0.};
+  psVol->updateVertexPositions(verts);
+  EXPECT_EQ(psVol->vertexPositionTexture.data[3], verts[3]);
+  polyscope::show(3);
+
+  // and back again
+  psVol->setSliceMode(polyscope::VolumeMeshSliceMode::Attributes);
+  polyscope::show(3);
+
+  polyscope::removeAllStructures();
+  polyscope::removeLastSceneSlicePlane();
+}
+
 TEST_F(PolyscopeTest, VolumeMeshInspectWithExtra) {
 
   // same as above, but with an additional mesh present